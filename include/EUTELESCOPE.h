@@ -613,6 +613,8 @@ namespace eutelescope
     kEUTelGeometricPixel = 3,
     // add here your implementation
     kEUTelMuPixel = 4,
+    //! EUTelGenericSparsePixel packed in 32 bit words, see EUTelPackedSparseData
+    kEUTelPackedGenericPixel = 5,
     kUnknownPixelType       = 31
   };
 
@@ -0,0 +1,113 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELASSIGNMENTSOLVER_H
+#define EUTELASSIGNMENTSOLVER_H
+
+// system includes <>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Optimal one to one assignment on a sparse, gated cost matrix
+  /*! Rows (e.g. tracks) are matched to columns (e.g. DUT hits). Only
+   *  the pairs passing the user gate are given to the solver, as
+   *  candidates with a non negative cost (usually the distance). Every
+   *  row and every column is used at most once.
+   *
+   *  The solution has the largest possible number of assigned pairs
+   *  and, among those, the smallest total cost. This is what the
+   *  permutation search of the pALPIDEfs analysis was looking for,
+   *  but in polynomial time: the candidates are split into
+   *  independent groups (connected rows and columns) and each group
+   *  is solved with the Hungarian (Kuhn-Munkres) algorithm, O(n^3) in
+   *  the size of the group.
+   *
+   *  Typical usage:
+   *  @code
+   *  solver.reset( noOfTracks, noOfHits );
+   *  for ( ... ) if ( passesGate ) solver.addCandidate( iTrack, iHit, distance );
+   *  solver.solve();
+   *  int iHit = solver.getColumn( iTrack ); // -1 if not assigned
+   *  @endcode
+   */
+  class EUTelAssignmentSolver {
+
+  public:
+
+    //! Default constructor, no row and no column
+    EUTelAssignmentSolver();
+
+    //! Start a new problem
+    /*! All the candidates and the previous solution are removed.
+     */
+    void reset(int noOfRows, int noOfColumns);
+
+    //! Add an allowed pair
+    /*! If the same pair is given more than once the smallest cost is
+     *  kept.
+     *
+     *  @param cost The cost of the pair, it must not be negative
+     */
+    void addCandidate(int row, int column, double cost);
+
+    //! Find the optimal assignment
+    /*! @return The number of assigned rows
+     */
+    int solve();
+
+    //! The column assigned to a row, -1 if none
+    int getColumn(int row) const { return _rowAssignment[row]; }
+
+    //! The row assigned to a column, -1 if none
+    int getRow(int column) const { return _columnAssignment[column]; }
+
+    //! The sum of the costs of the assigned pairs
+    double getTotalCost() const { return _totalCost; }
+
+  private:
+
+    //! An allowed pair
+    struct Candidate {
+      int row;
+      int column;
+      double cost;
+    };
+
+    //! Find the group of a row or column (column nodes follow the rows)
+    int findRoot(int node);
+
+    //! Solve one group of connected rows and columns
+    void solveGroup(std::vector<Candidate> const & candidates);
+
+    //! Number of rows of the current problem
+    int _noOfRows;
+
+    //! Number of columns of the current problem
+    int _noOfColumns;
+
+    //! The allowed pairs
+    std::vector<Candidate> _candidates;
+
+    //! The column assigned to each row
+    std::vector<int> _rowAssignment;
+
+    //! The row assigned to each column
+    std::vector<int> _columnAssignment;
+
+    //! The total cost of the solution
+    double _totalCost;
+
+    //! Union find parents of rows and columns
+    std::vector<int> _parent;
+  };
+
+}
+
+#endif
@@ -10,6 +10,7 @@
 #define EUTELCALIBRATEEVENTPROCESSOR_H 1
 
 // eutelescope includes ".h"
+#include "EUTelCalibrationKernel.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -113,6 +114,10 @@ namespace eutelescope {
    *  skipped. If this parameter is set to -1 then the control is
    *  by-passed
    *
+   *  @param CalibrationKernel Select the calibration code: 0 for the
+   *  scalar loops, 1 for the array based EUTelCalibrationKernel, 2
+   *  for the scalar loops cross-checked against the kernel.
+   *
    *  @param DataCollectionName The name of the output calibrated data
    *  collection
    *
@@ -211,6 +216,29 @@ namespace eutelescope {
      */
     void initializeGeometry( LCEvent * event ) throw ( marlin::SkipEventException );
 
+    //! Calibrate one detector with the array based kernel
+    /*! This is the EUTelCalibrationKernel implementation of the
+     *  pedestal subtraction and of both common mode algorithms. The
+     *  event rejection follows the same rules as the scalar code.
+     *
+     *  @param iDetector The position of the detector in the input collection
+     *  @param sensorID The sensor ID of the detector
+     *  @param adc The raw ADC values
+     *  @param pedestal The pedestal values
+     *  @param noise The noise values
+     *  @param status The pixel status values
+     *  @param output The calibrated signal, resized to the number of pixels
+     *  @param skippedPixel The number of pixels above the hit rejection cut
+     *  @param skippedRow The number of rows rejected by the row wise common mode
+     *  @param fillHisto Fill the common mode histograms
+     *
+     *  @return false if the event has to be rejected because of the
+     *  common mode
+     */
+    bool calibrateWithKernel( size_t iDetector, int sensorID, const ShortVec & adc, const FloatVec & pedestal,
+                              const FloatVec & noise, const ShortVec & status, FloatVec & output,
+                              int & skippedPixel, int & skippedRow, bool fillHisto );
+
   protected:
 
     //! Input collection name.
@@ -322,6 +350,13 @@ namespace eutelescope {
      */
     std::string _histoInfoFileName;
 
+    //! Calibration code selection
+    /*! 0 for the scalar loops, 1 for the array based kernel and 2 to
+     *  run both and compare the kernel output with the scalar one,
+     *  the latter being written to the output collection.
+     */
+    int _calibrationKernel;
+
   private:
 
     //! First pixel along X
@@ -433,6 +468,12 @@ namespace eutelescope {
      */
     bool _isGeometryReady;
 
+    //! The array based calibration kernel
+    EUTelCalibrationKernel _kernel;
+
+    //! The kernel output used for the comparison with the scalar code
+    FloatVec _kernelOutput;
+
   };
 
   //! A global instance of the processor
@@ -0,0 +1,82 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELCLUSTERCHARGEPROFILE_H
+#define EUTELCLUSTERCHARGEPROFILE_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Charge figures of merit of a cluster for many N at once
+  /*! The pixels of a cluster are given once, then the charge of the N
+   *  highest pixels and the charge of NxN windows can be asked for any
+   *  number of N:
+   *
+   *  - the N highest charges come from a single partial sort up to
+   *    the largest requested N followed by prefix sums, instead of a
+   *    full sort for every N;
+   *  - the window charges come from a summed area table over the
+   *    bounding box of the cluster, built on the first request, each
+   *    window is then four lookups.
+   *
+   *  The definitions are the ones of the cluster classes: if N is not
+   *  smaller than the number of pixels the total charge is returned,
+   *  a window of size N covers the pixels up to N/2 (integer
+   *  division) away from its centre.
+   */
+  class EUTelClusterChargeProfile {
+
+  public:
+
+    //! Default constructor, no pixel
+    EUTelClusterChargeProfile();
+
+    //! Reserve the memory for a number of pixels
+    void reserve(size_t noOfPixels);
+
+    //! Add a pixel
+    void addPixel(int x, int y, float signal);
+
+    //! The number of pixels
+    size_t size() const { return _signals.size(); }
+
+    //! The sum of all the signals, in the order of the pixels
+    float getTotalCharge() const;
+
+    //! The charge of the N highest pixels, for each given N
+    std::vector<float> getHighestCharges(std::vector<int> const & nPixels) const;
+
+    //! The charge of a xSize x ySize window centred on a pixel
+    float getWindowCharge(int xCenter, int yCenter, int xSize, int ySize) const;
+
+    //! The charge of NxN windows centred on a pixel, for each given N
+    std::vector<float> getWindowCharges(int xCenter, int yCenter, std::vector<int> const & sizes) const;
+
+  private:
+
+    //! Build the summed area table if needed
+    void buildTable() const;
+
+    std::vector<int> _xCoords;
+    std::vector<int> _yCoords;
+    std::vector<float> _signals;
+
+    //! Summed area table with one row and one column of zeros in front
+    mutable std::vector<double> _table;
+    mutable bool _tableValid;
+    mutable int _xMin, _yMin;
+    mutable int _width, _height;
+  };
+
+}
+
+#endif
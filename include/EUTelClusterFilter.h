@@ -26,6 +26,7 @@
 namespace eutelescope {
 
   class EUTelVirtualCluster;
+  class EUTelClusterSummary;
 
   //! Cluster filter
   /*! This processor is used during the analysis chain to perform a
@@ -343,10 +344,12 @@ namespace eutelescope {
      *  _clusterMinTotalChargeVec.
      *
      *  @param cluster The cluster under test.
+     *  @param summary The stored summary of the cluster, used instead of
+     *  the cluster when valid.
      *  @return True if the @c cluster has a charge below its own threshold.
      *
      */
-    bool isAboveMinTotalCharge(EUTelVirtualCluster * cluster) const ;
+    bool isAboveMinTotalCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const ;
 
 
     //! Check if the total cluster SNR is above a certain value
@@ -415,10 +418,13 @@ namespace eutelescope {
     /*! This cut is working on the charge collected by a subframe N x
      *  N pixels wide centered around the seed.
      *
+     *  The 3x3 and 5x5 charges are taken from the summary when valid.
+     *
      *  @param cluster The cluster under test.
+     *  @param summary The stored summary of the cluster.
      *  @return True if the charge is above threshold.
      */
-    bool isAboveNxNMinCharge(EUTelVirtualCluster * cluster) const;
+    bool isAboveNxNMinCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const;
 
     //! Check against the SNR collected by N x N pixels
     /*! This cut is working on the SNR collected by a subframe N x
@@ -435,8 +441,10 @@ namespace eutelescope {
      *
      *  @return True if the seed pixel charge is above threshold
      *  @param cluster The cluster under test.
+     *  @param summary The stored summary of the cluster, used instead of
+     *  the cluster when valid.
      */
-    bool isAboveMinSeedCharge(EUTelVirtualCluster * cluster) const;
+    bool isAboveMinSeedCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const;
 
     //! Seed SNR cut
     /*! This is used to select clusters having a seed pixel SNR above
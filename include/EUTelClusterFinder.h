@@ -0,0 +1,130 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELCLUSTERFINDER_H
+#define EUTELCLUSTERFINDER_H
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Connected-component search for sparse pixel data
+  /*! This class groups the hit pixels of one sensor plane into
+   *  clusters. It is used by the sparse, the geometric and the
+   *  classic clustering processors, which only have to fill the
+   *  pixel coordinates and turn the returned index lists into
+   *  their cluster objects.
+   *
+   *  Two engines are available:
+   *
+   *  @li Iterative: the original algorithm, which grows a cluster
+   *  by repeatedly scanning all remaining hits. It is O(n^2) per
+   *  plane and kept as reference.
+   *
+   *  @li Sweep: the hits are sorted once along x, neighbour
+   *  candidates are then found by range queries on the sorted
+   *  list. This scales with n log n.
+   *
+   *  Both engines return exactly the same clusters in the same
+   *  order: clusters are ordered by their first hit in the input,
+   *  the hits within a cluster are in breadth-first order starting
+   *  from that hit, where the neighbours of each hit are added in
+   *  input order. Thus output files do not depend on the engine.
+   */
+  class EUTelClusterFinder {
+
+  public:
+
+    //! Available clustering engines
+    enum Engine { kIterative, kSweep };
+
+    //! A cluster is a list of indices into the input hit vector
+    typedef std::vector< std::vector< size_t > > ClusterIndexVec;
+
+    //! Hit on the integer pixel index grid
+    struct SparseHit {
+      int x, y;
+    };
+
+    //! Hit described by its geometric position and bounding box
+    /*! The boundaries are half the pixel dimensions, as in
+     *  EUTelGeometricPixel.
+     */
+    struct GeometricHit {
+      float posX, posY;
+      float boundX, boundY;
+      float time;
+    };
+
+    //! Convert the steering parameter into an engine
+    /*! @param name Either "Iterative" or "Sweep"
+     *
+     *  @throw InvalidParameterException for any other name
+     */
+    static Engine engineFromString(std::string const & name);
+
+    //! Cluster hits on the pixel index grid
+    /*! Two hits are neighbours if dx*dx+dy*dy <= minDistanceSquared,
+     *  which is the SparseMinDistanceSquared semantics of the
+     *  clustering processors (touching == 2).
+     *
+     *  @param hits The hits of one plane
+     *  @param minDistanceSquared The squared neighbourhood distance
+     *  @param engine The engine to be used
+     *  @param clusters The output clusters, previous content is discarded
+     */
+    static void findSparseClusters(std::vector<SparseHit> const & hits, int minDistanceSquared,
+                                   Engine engine, ClusterIndexVec & clusters);
+
+    //! Cluster hits by touching bounding boxes
+    /*! Two hits are neighbours if their bounding boxes touch, with a
+     *  1% tolerance accounting for the single precision of the
+     *  geometry framework, and their time difference is within cutT.
+     *
+     *  @param hits The hits of one plane
+     *  @param cutT The time cut
+     *  @param engine The engine to be used
+     *  @param clusters The output clusters, previous content is discarded
+     */
+    static void findGeometricClusters(std::vector<GeometricHit> const & hits, float cutT,
+                                      Engine engine, ClusterIndexVec & clusters);
+
+    //! The neighbourhood definition used for the sparse hits
+    static inline bool areNeighbours(SparseHit const & a, SparseHit const & b, int minDistanceSquared) {
+      int dX = a.x - b.x;
+      int dY = a.y - b.y;
+      return dX*dX+dY*dY <= minDistanceSquared;
+    }
+
+    //! The neighbourhood definition used for the geometric hits
+    static inline bool areNeighbours(GeometricHit const & a, GeometricHit const & b, float cutT) {
+      float dX = a.posX - b.posX;
+      float dY = a.posY - b.posY;
+      float dT = a.time - b.time;
+      float cutX = (a.boundX+b.boundX)*1.01; //this additional 1% is accounting for precision
+      float cutY = (a.boundY+b.boundY)*1.01; //uncertainty with the geo framework
+      return (dX*dX <= cutX*cutX) && (dY*dY <= cutY*cutY) && (dT*dT <= cutT*cutT);
+    }
+
+  private:
+
+    //! Reference implementation, repeatedly scanning all remaining hits
+    template<class HitType, class CutType>
+    static void iterativeClustering(std::vector<HitType> const & hits, CutType cut, ClusterIndexVec & clusters);
+
+    //! Breadth-first growth of the clusters using a neighbour finder
+    template<class NeighbourFinder>
+    static void sweepClustering(size_t nHits, NeighbourFinder & finder, ClusterIndexVec & clusters);
+  };
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELCLUSTERSUMMARY_H
+#define EUTELCLUSTERSUMMARY_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <EVENT/LCGenericObject.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCGenericObjectImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <string>
+
+namespace eutelescope {
+
+  //! Compact record of the properties of a sparse cluster
+  /*! The clustering computes the properties used downstream (seed,
+   *  size, charges and centre of gravity) once per cluster, in a pass
+   *  over the pixels without allocation. The summaries are stored in
+   *  a transient LCGenericObject collection next to the pulse
+   *  collection, one element per pulse and in the same order, so that
+   *  the hit maker and the other readers don't have to rebuild the
+   *  cluster from its TrackerData.
+   *
+   *  The definitions are the ones of EUTelSparseClusterImpl: the seed
+   *  is the first pixel with the highest signal, the NxN charges are
+   *  summed around the seed.
+   */
+  class EUTelClusterSummary {
+
+  public:
+
+    //! Default constructor, the summary is not valid
+    EUTelClusterSummary();
+
+    //! Compute the summary of a cluster
+    /*! @throw UnknownDataTypeException if the pixel type is not known
+     */
+    EUTelClusterSummary(IMPL::TrackerDataImpl const * data, SparsePixelType type);
+
+    //! Read a summary stored in the event
+    explicit EUTelClusterSummary(EVENT::LCGenericObject const * object);
+
+    //! The summary as an LCIO object, owned by the caller
+    IMPL::LCGenericObjectImpl * makeGenericObject() const;
+
+    //! False for placeholders of clusters without a summary
+    bool isValid() const { return _noOfPixels > 0; }
+
+    //! The number of pixels
+    int getNoOfPixels() const { return _noOfPixels; }
+
+    //! The coordinates of the seed pixel
+    void getSeedCoord(int & xSeed, int & ySeed) const { xSeed = _xSeed; ySeed = _ySeed; }
+
+    //! The size of the bounding box
+    void getClusterSize(int & xSize, int & ySize) const { xSize = _xMax - _xMin + 1; ySize = _yMax - _yMin + 1; }
+
+    //! The sum of all the signals
+    float getTotalCharge() const { return _totalCharge; }
+
+    //! The signal of the seed pixel
+    float getSeedCharge() const { return _seedCharge; }
+
+    //! The charge of the 3x3 pixels around the seed
+    float getCharge3x3() const { return _charge3x3; }
+
+    //! The charge of the 5x5 pixels around the seed
+    float getCharge5x5() const { return _charge5x5; }
+
+    //! The centre of gravity in pixel coordinates
+    void getCenterOfGravity(float & xCoG, float & yCoG) const { xCoG = _xCoG; yCoG = _yCoG; }
+
+    //! The centre of gravity relative to the seed pixel
+    void getCenterOfGravityShift(float & xShift, float & yShift) const { xShift = _xCoGShift; yShift = _yCoGShift; }
+
+    //! The name of the summary collection of a pulse collection
+    static std::string getCollectionName(std::string const & pulseCollectionName);
+
+    //! The summary collection matching a pulse collection
+    /*! @return null if the collection doesn't exist or if it doesn't
+     *  have one element per pulse, the clusters have then to be read
+     *  from their TrackerData
+     */
+    static IMPL::LCCollectionVec * getCollection(EVENT::LCEvent * event, std::string const & pulseCollectionName, int noOfPulses);
+
+  private:
+
+    int _noOfPixels;
+    int _xSeed, _ySeed;
+    int _xMin, _xMax, _yMin, _yMax;
+    float _totalCharge;
+    float _seedCharge;
+    float _charge3x3;
+    float _charge5x5;
+    float _xCoG, _yCoG;
+    float _xCoGShift, _yCoGShift;
+  };
+
+}
+
+#endif
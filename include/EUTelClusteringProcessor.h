@@ -17,6 +17,9 @@
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelClusterFinder.h"
+#include "EUTelThreadPool.h"
+#include "EUTelMatrixDecoder.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -30,6 +33,7 @@
 
 // lcio includes <.h>
 #include <IMPL/TrackerRawDataImpl.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
@@ -38,6 +42,7 @@
 #include <cmath>
 #include <vector>
 #include <list>
+#include <memory>
 
 namespace eutelescope {
 
@@ -134,6 +139,14 @@ namespace eutelescope {
    *  @param HistoInfoFileName This is the name of the XML file
    *  containing the histogram booking information.
    *
+   *  @param ClusteringEngine The EUTelClusterFinder engine used by
+   *  the sparse clustering, either Iterative or Sweep.
+   *
+   *  @param NumberOfThreads The number of threads running the sparse
+   *  clustering of the sensor planes of an event concurrently. 1
+   *  (default) is serial, 0 uses all available cores. The output
+   *  does not depend on this setting.
+   *
    *  @since Since version v00-00-09, this processor requires GEAR to
    *  be initialized because the geometry information are no more
    *  taken from the input file Run Header but they are gathered from
@@ -525,6 +538,32 @@ namespace eutelescope {
     //! TODO: Documentation
     void sparseClustering(LCEvent * evt, LCCollectionVec * pulse);
 
+    //! Input and output of the sparse clustering of one sensor plane
+    struct SparsePlaneClusters {
+      TrackerDataImpl * zsData;
+      //! Storage type of the input pixels
+      SparsePixelType type;
+      int sensorID;
+      //! Index of the plane in the input collection
+      unsigned int idetector;
+      TrackerDataImpl * noise;
+      EUTelMatrixDecoder matrixDecoder;
+      //! Number of hit pixels in the input
+      size_t nPixels;
+      //! The clusters passing the seed and cluster SNR cuts
+      std::vector<std::unique_ptr<TrackerDataImpl> > clusters;
+
+      SparsePlaneClusters(TrackerDataImpl * data, SparsePixelType storageType, int id, unsigned int index, TrackerDataImpl * noiseData, EUTelMatrixDecoder const & decoder):
+        zsData(data), type(storageType), sensorID(id), idetector(index), noise(noiseData), matrixDecoder(decoder), nPixels(0), clusters() {}
+    };
+
+    //! Sparse clustering of a single plane
+    /*! Only reads the input, noise and hot pixel data of the given
+     *  plane, thus it can be executed concurrently for different
+     *  planes.
+     */
+    void sparseClusteringPlane(SparsePlaneClusters & plane) const;
+
 
     //! Input collection name for NZS data
     /*! The input collection is the calibrated data one coming from
@@ -711,6 +750,22 @@ namespace eutelescope {
      */
     float _sparseMinDistance;
 
+    //! Name of the engine used for the sparse cluster search
+    /*! Either "Iterative" or "Sweep", see EUTelClusterFinder. Both
+     *  produce identical clusters, Sweep scales better with the
+     *  pixel multiplicity.
+     */
+    std::string _clusteringEngineName;
+
+    //! The engine resolved from _clusteringEngineName in init()
+    EUTelClusterFinder::Engine _clusteringEngine;
+
+    //! Number of threads used by the sparse clustering
+    int _nThreads;
+
+    //! The pool executing the per plane sparse clustering
+    std::unique_ptr<EUTelThreadPool> _threadPool;
+
     //! Current event number.
     /*! This number is used to store the current event number NOTE that
      * events are counted from 0 and on a run base
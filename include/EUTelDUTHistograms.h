@@ -13,6 +13,7 @@
 
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
+#include "EUTelAssignmentSolver.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -217,6 +218,14 @@ protected:
     double _zDUT;
     double _distMax;
 
+    //! Match hits and tracks with the optimal assignment
+    /*! When false each track takes in turn its nearest free hit.
+     */
+    bool _optimalMatching;
+
+    //! The solver used for the optimal matching
+    EUTelAssignmentSolver _assignmentSolver;
+
     double _pitchX;
     double _pitchY;
 
@@ -83,6 +83,8 @@ namespace daffitter{
     Eigen::Matrix<T, 3, 1> ref0, ref1, ref2;
     //Norm vector
     Eigen::Matrix<T, 3, 1> norm;
+    //Measurement indexes sorted by x, for window searches
+    std::vector<size_t> xOrder;
 
   public:
     //Measurements in plane
@@ -108,7 +110,10 @@ namespace daffitter{
     void addMeasurement(Measurement<T> m) { meas.push_back(m);}
     void setTotWeight(T weight){ sumWeights = weight;}
     T getTotWeight() const { return(sumWeights); };
-    void clear(){ meas.clear(); measZ = zPosition;}
+    void clear(){ meas.clear(); xOrder.clear(); measZ = zPosition;}
+    //Spatial index, must be rebuilt when measurements are added
+    void buildIndex();
+    void findMeasurements(T xMin, T xMax, T yMin, T yMax, std::vector<int>& found) const;
     T getMeasZ() const { return(measZ); }
     void setMeasZ(T z)  { measZ = z; }
     //ref points
@@ -192,7 +197,7 @@ namespace daffitter{
     T m_dafChi2, m_ckfChi2, m_chi2OverNdof, m_sqrClusterRadius;
     size_t m_skipMax;
     
-    int addNeighbors(std::vector<PlaneHit<T> > &candidate, std::list<PlaneHit<T> > &hits);
+    void buildIndexes();
     T runTweight(T t, daffitter::TrackCandidate<T,N>& candidate);
     T fitPlanesInfoDafInner(daffitter::TrackCandidate<T,N>& candidate);
     T fitPlanesInfoDafBiased(daffitter::TrackCandidate<T,N>& candidate);
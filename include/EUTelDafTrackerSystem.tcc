@@ -136,6 +136,33 @@ void FitPlane<T>::setSigmaY(T sigmaY){
   sigmas(1) = sigmaY; invMeasVar(1) = 1.0/(sigmaY * sigmaY);
 }
 
+template<typename T>
+void FitPlane<T>::buildIndex(){
+  //Sort the measurement indexes by x, used for window searches
+  xOrder.resize(meas.size());
+  for(size_t ii = 0; ii < meas.size(); ii++){ xOrder.at(ii) = ii; }
+  sort(xOrder.begin(), xOrder.end(), [this](size_t a, size_t b){ return( meas[a].getX() < meas[b].getX() ); });
+}
+
+template<typename T>
+void FitPlane<T>::findMeasurements(T xMin, T xMax, T yMin, T yMax, std::vector<int>& found) const {
+  //Indexes of all measurements inside the window, in increasing order. buildIndex must be called first.
+  found.clear();
+  typename std::vector<size_t>::const_iterator it =
+    lower_bound(xOrder.begin(), xOrder.end(), xMin, [this](size_t a, T x){ return( meas[a].getX() < x ); });
+  for(; it != xOrder.end() and meas[*it].getX() <= xMax; it++){
+    T y = meas[*it].getY();
+    if(y >= yMin and y <= yMax){ found.push_back(*it); }
+  }
+  sort(found.begin(), found.end());
+}
+
+template <typename T>
+inline T windowMargin(T center, T halfWidth){
+  //Widen search windows, so that rounding never loses a measurement passing the exact cut
+  return( halfWidth * 1e-3f + (1 + fabs(center)) * 1e-5f );
+}
+
 template<typename T>
 void PlaneHit<T>::print() {
   //Print info on PlaneHit
@@ -255,20 +282,9 @@ inline bool clusterSort(PlaneHit<T>& a, PlaneHit<T>& b) {
 }
 
 template <typename T,size_t N>
-inline int TrackerSystem<T, N>::addNeighbors(vector<PlaneHit<T> > &candidate, list<PlaneHit<T> > &hits){
-  // Part of the cluster tracker. Checks distances to measurements, and adds measurement to cluster maybe.
-  int counter(0); //How many hits are added to the cluster this iteration?
-  for(typename list<PlaneHit<T> >::iterator hit = hits.begin(); hit != hits.end(); hit++ ){
-    for(typename vector<PlaneHit<T> >::iterator cand = candidate.begin(); cand != candidate.end(); cand++){
-      Eigen::Matrix<T, 2, 1> resids = (*hit).getM() - (*cand).getM();
-      if(resids.squaredNorm() > m_sqrClusterRadius ) { continue;}
-      candidate.push_back((*hit));
-      hit = hits.erase(hit);
-      counter ++;
-      break;
-    }
-  }
-  return (counter);
+void TrackerSystem<T, N>::buildIndexes(){
+  // Build the spatial index of the measurements in all planes, needed by the track finders.
+  for(size_t ii = 0; ii < planes.size(); ii++){ planes.at(ii).buildIndex(); }
 }
 
 template <typename T,size_t N>
@@ -287,50 +303,74 @@ void TrackerSystem<T, N>::index0tracker(){
 template <typename T,size_t N>
 void TrackerSystem<T, N>::clusterTracker(){
   //A track fitter that propagates measurements into z = 0, then assumes measurement clusters are track candidates.
-  list<PlaneHit<T> > availableHits;
-  //Add all meas points to list
+  //Clusters are grown from the first unused measurement, neighbours are looked up in the spatial index of each plane.
+  buildIndexes();
+  T radius = sqrt(m_sqrClusterRadius);
+  vector<T> xShift(planes.size()), yShift(planes.size());
+  vector< vector<bool> > used(planes.size());
   for(size_t ii = 0; ii < planes.size(); ii++){
-    if(planes.at(ii).isExcluded()) { continue;}
-    T xShift = -1 * getNominalXdz() * planes.at(ii).getZpos();
-    T yShift = -1 * getNominalYdz() * planes.at(ii).getZpos();
-    for(size_t mm = 0; mm < planes.at(ii).meas.size(); mm++){
-      PlaneHit<T> a(planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift, ii, mm);
-      availableHits.push_back( a );
-    }
-  }
-  //Sort by radius from origin
-  //availableHits.sort(clusterSort<T>);
-  while( not availableHits.empty() ){
-    vector<PlaneHit<T> > candidate;
-    candidate.push_back( availableHits.front() );
-    availableHits.pop_front();
-    while( addNeighbors( candidate , availableHits ) > 0) {;}
-    //If we find enough hits, we make a candidate
-
-    if(candidate.size() < getMinClusterSize() ){ continue; }
-    if(m_nTracks >= m_maxCandidates) {
-      std::cout << "Maximum number of track candidates(" << m_maxCandidates 
-		<< ") reached in DAF fitter! If this happens a lot, your configuration is probably off." 
-		<< " If you are sure you config is right, see trackersystem.h on how to increase it." << std::endl;
-      return;
-    }
+    xShift.at(ii) = -1 * getNominalXdz() * planes.at(ii).getZpos();
+    yShift.at(ii) = -1 * getNominalYdz() * planes.at(ii).getZpos();
+    used.at(ii).assign(planes.at(ii).meas.size(), false);
+  }
+  vector<int> found;
+  for(size_t seedPlane = 0; seedPlane < planes.size(); seedPlane++){
+    if(planes.at(seedPlane).isExcluded()) { continue;}
+    for(size_t seed = 0; seed < planes.at(seedPlane).meas.size(); seed++){
+      if(used.at(seedPlane).at(seed)) { continue; }
+      used.at(seedPlane).at(seed) = true;
+      vector<PlaneHit<T> > candidate;
+      Measurement<T>& sm = planes.at(seedPlane).meas.at(seed);
+      candidate.push_back( PlaneHit<T>(sm.getX() + xShift.at(seedPlane), sm.getY() + yShift.at(seedPlane), seedPlane, seed) );
+      //The candidate vector serves as queue of hits whose neighbours are still to be added
+      for(size_t cc = 0; cc < candidate.size(); cc++){
+	Eigen::Matrix<T, 2, 1> center = candidate.at(cc).getM();
+	for(size_t ii = 0; ii < planes.size(); ii++){
+	  if(planes.at(ii).isExcluded()) { continue;}
+	  T x = center(0) - xShift.at(ii);
+	  T y = center(1) - yShift.at(ii);
+	  T dx = radius + windowMargin(x, radius);
+	  T dy = radius + windowMargin(y, radius);
+	  planes.at(ii).findMeasurements(x - dx, x + dx, y - dy, y + dy, found);
+	  for(size_t ff = 0; ff < found.size(); ff++){
+	    int mm = found.at(ff);
+	    if(used.at(ii).at(mm)) { continue; }
+	    Measurement<T>& m = planes.at(ii).meas.at(mm);
+	    PlaneHit<T> a(m.getX() + xShift.at(ii), m.getY() + yShift.at(ii), ii, mm);
+	    Eigen::Matrix<T, 2, 1> resids = a.getM() - center;
+	    if(resids.squaredNorm() > m_sqrClusterRadius ) { continue;}
+	    used.at(ii).at(mm) = true;
+	    candidate.push_back(a);
+	  }
+	}
+      }
+      //If we find enough hits, we make a candidate
+
+      if(candidate.size() < getMinClusterSize() ){ continue; }
+      if(m_nTracks >= m_maxCandidates) {
+        std::cout << "Maximum number of track candidates(" << m_maxCandidates 
+		  << ") reached in DAF fitter! If this happens a lot, your configuration is probably off." 
+		  << " If you are sure you config is right, see trackersystem.h on how to increase it." << std::endl;
+        return;
+      }
 
-    TrackCandidate<T,N> cnd(planes.size());
+      TrackCandidate<T,N> cnd(planes.size());
 
-    cnd.ndof = 0;
-    cnd.chi2 = 0;
-    for(size_t ii = 0; ii < planes.size(); ii++){
-      cnd.weights.at(ii).resize( planes.at(ii).meas.size());
-      if( planes.at(ii).meas.size() > 0 ) { 
-	cnd.weights.at(ii).setZero();
+      cnd.ndof = 0;
+      cnd.chi2 = 0;
+      for(size_t ii = 0; ii < planes.size(); ii++){
+        cnd.weights.at(ii).resize( planes.at(ii).meas.size());
+        if( planes.at(ii).meas.size() > 0 ) { 
+	  cnd.weights.at(ii).setZero();
+        }
       }
+      for(size_t ii = 0; ii < candidate.size(); ii++){
+        PlaneHit<T>& hit = candidate.at(ii);
+        cnd.weights.at( hit.getPlane() )( hit.getIndex()) = 1.0;
+      }
+      tracks.push_back(cnd);
+      m_nTracks++;
     }
-    for(size_t ii = 0; ii < candidate.size(); ii++){
-      PlaneHit<T>& hit = candidate.at(ii);
-      cnd.weights.at( hit.getPlane() )( hit.getIndex()) = 1.0;
-    }
-    tracks.push_back(cnd);
-    m_nTracks++;
   }
 }
 
@@ -809,6 +849,7 @@ void TrackerSystem<T, N>::fitPlanesKF(TrackCandidate<T, N>& candidate){
 template <typename T,size_t N>
 void TrackerSystem<T, N>::combinatorialKF(){
   // Combinatorial Kalman filter track finder.
+  buildIndexes();
   vector<int> indexes(planes.size(), -1);
   TrackEstimate<T,N> e;
 
@@ -908,7 +949,27 @@ void TrackerSystem<T, N>::fitPermutation(int plane, TrackEstimate<T, N> &est, si
     }
   }
 
-  for(int hit = 0; hit < (int)planes.at(plane).meas.size(); hit++){
+  //Only measurements inside the window around the prediction can pass the cuts below
+  vector<int> hits;
+  if(nMeas > 1){
+    T dx = sqrt(getCKFChi2Cut() * errv(0));
+    T dy = sqrt(getCKFChi2Cut() * errv(1));
+    dx += windowMargin<T>(state(0), dx);
+    dy += windowMargin<T>(state(1), dy);
+    planes.at(plane).findMeasurements(state(0) - dx, state(0) + dx, state(1) - dy, state(1) + dy, hits);
+  } else if(nMeas == 1){
+    T dz = planes.at(plane).getZpos() - oldZ;
+    T x = oldX + getNominalXdz() * dz;
+    T y = oldY + getNominalYdz() * dz;
+    T dx = fabs(getXdzMaxDeviance() * dz);
+    T dy = fabs(getYdzMaxDeviance() * dz);
+    dx += windowMargin<T>(x, dx);
+    dy += windowMargin<T>(y, dy);
+    planes.at(plane).findMeasurements(x - dx, x + dx, y - dy, y + dy, hits);
+  }
+
+  for(size_t ii = 0; ii < hits.size(); ii++){
+    int hit = hits.at(ii);
     Measurement<T>& mm = planes.at(plane).meas.at(hit);
     bool filterMeas = false;
     if( nMeas > 1) { 
@@ -248,6 +248,9 @@ namespace eutelescope {
      *  reconstruct the LCIO data structure needed for basic data
      *  analysis like the pedestal and noise distribution.
      *
+     *  The input file is memory mapped (see EUTelMappedFile) and the
+     *  events are decoded in place, while the next one is prefetched.
+     *
      *  @param numEvents This is the total number of events the should
      *  be processed. This value it is actually passed to the
      *  DataSourceProcessor by the ProcessorMgr
@@ -261,7 +264,8 @@ namespace eutelescope {
     virtual void init ();
     
     //! End method
-    /*! It deletes the EUTelEUDRBReader::_buffer array
+    /*! It just prints a message, the input file is unmapped at the
+     *  end of readDataSource()
      */
     virtual void end ();
     
@@ -281,9 +285,6 @@ namespace eutelescope {
      *  information for the data processing
      */ 
     EUDRBFileHeader * _fileHeader;
-    
-    //! The buffer container
-    int * _buffer;
         
   };
 
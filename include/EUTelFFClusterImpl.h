@@ -13,6 +13,7 @@
 // personal includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelVirtualCluster.h"
+#include "EUTelClusterChargeProfile.h"
 
 // marlin includes ".h"
 
@@ -243,9 +244,8 @@ namespace eutelescope {
      *  getClusterCharge(int) method. This one is actually avoiding to
      *  re-sort the signal vector all the times it is called. 
      *
-     *  This method is getting the signal array and sort it once in
-     *  descending order. Then the sorted array is integrated
-     *  according to the number of pixels in the @c nPixels vector.     
+     *  The signal array is sorted once, only up to the largest number
+     *  of pixels, and the charges are read from its prefix sums.
      *
      *  @param nPixels The list of number of pixels
      *  @return The charges for each number of pixels
@@ -262,6 +262,15 @@ namespace eutelescope {
      */ 
     float getClusterCharge(int xSize, int ySize) const;
 
+    //! Get the cluster charge within several square subframes
+    /*! All the subframes are computed from a single summed area
+     *  table of the frame.
+     *
+     *  @param nxnSizes The list of subframe sizes
+     *  @return The charges for each subframe size
+     */
+    std::vector<float> getClusterChargeNxN(std::vector<int > nxnSizes) const;
+
     //! Get the center of gravity shift
     /*! This method is used to calculate the signed distance of the
      *  charge center of gravity from the seed coordinates. With this
@@ -395,6 +404,9 @@ namespace eutelescope {
     void print(std::ostream& os)  const;
 
   protected:
+
+    //! Fill a charge profile with the frame pixels, the seed being at (0, 0)
+    void fillChargeProfile(EUTelClusterChargeProfile & profile) const;
     
     //! Noise values vector
     std::vector<float > _noiseValues;
@@ -0,0 +1,140 @@
+/*
+ * File:   EUTelGeometrySnapshot.h
+ *
+ */
+#ifndef EUTELGEOMETRYSNAPSHOT_H
+#define	EUTELGEOMETRYSNAPSHOT_H
+
+// C++
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Eigen
+#include <Eigen/Core>
+
+// EUTELESCOPE
+#include "EUTelMaterialBudgetMap.h"
+
+// ROOT
+#include "TGeoManager.h"
+
+/** @class EUTelGeometrySnapshot
+ * Immutable, read-only copy of the telescope geometry.
+ *
+ * A snapshot is created by EUTelGeometryTelescopeGeoDescription::createSnapshot()
+ * and holds the transformations, axes and radiation lengths of all planes as
+ * they were at the time of creation. All queries are const and, except for
+ * findRad, do not touch any shared state, thus a snapshot can be queried from
+ * many threads concurrently.
+ *
+ * findRad ray traces through TGeo. If TGeo was switched into multi-threaded
+ * mode by createSnapshot(maxThreads > 1), every thread uses its own
+ * TGeoNavigator. Otherwise TGeo only has the navigator shared with the
+ * EUTelGeometryTelescopeGeoDescription, and the calls are serialised with
+ * the navigation of the description on a lock shared with it.
+ *
+ * Alignment updates applied to the EUTelGeometryTelescopeGeoDescription after
+ * the creation are not reflected, a new snapshot has to be created instead.
+ * The snapshot shares the ownership of the TGeoManager it was created from,
+ * it stays valid if the description rebuilds its geometry.
+ */
+namespace eutelescope {
+namespace geo {
+
+class EUTelGeometryTelescopeGeoDescription;
+
+class EUTelGeometrySnapshot
+{
+	friend class EUTelGeometryTelescopeGeoDescription;
+
+  public:
+	/** Vector of all sensor IDs, sorted along z */
+	std::vector<int> const & sensorIDsVec() const { return _sensorIDVec; };
+
+	/** Returns true if the snapshot contains the given sensor */
+	bool hasPlane(int sensorID) const;
+
+	/** Coordinate transformations, see the EUTelGeometryTelescopeGeoDescription
+	 * counterparts. The batched versions act on nPoints consecutive (x,y,z)
+	 * triplets. */
+	void local2Master( int sensorID, const double localPos[], double globalPos[], size_t nPoints = 1 ) const;
+	void master2Local( int sensorID, const double globalPos[], double localPos[], size_t nPoints = 1 ) const;
+	void local2MasterVec( int sensorID, const double localVec[], double globalVec[], size_t nPoints = 1 ) const;
+	void master2LocalVec( int sensorID, const double globalVec[], double localVec[], size_t nPoints = 1 ) const;
+
+	/** Plane centre in global coordinates */
+	Eigen::Vector3d siPlanePosition(int sensorID) const;
+
+	/** Plane normal vector (local z axis) in global coordinates */
+	Eigen::Vector3d siPlaneNormal(int sensorID) const;
+
+	/** Local x axis in global coordinates */
+	Eigen::Vector3d siPlaneXAxis(int sensorID) const;
+
+	/** Local y axis in global coordinates */
+	Eigen::Vector3d siPlaneYAxis(int sensorID) const;
+
+	/** Sensor thickness */
+	double siPlaneZSize(int sensorID) const { return plane(sensorID).zSize; };
+
+	/** Material budget map of the geometry at the time of creation, null if
+	 * it was not initialised. Its queries do not need any ray tracing. */
+	std::shared_ptr<EUTelMaterialBudgetMap const> materialBudgetMap() const { return _materialBudgetMap; };
+
+	/** Radiation length of the plane for a particle with the given global incidence direction,
+	 * taken from the material budget map at the plane centre if available */
+	double planeRadLengthGlobalIncidence(int sensorID, Eigen::Vector3d incidenceDir) const;
+
+	/** Radiation length of the plane for a particle with the given local incidence direction,
+	 * taken from the material budget map at the plane centre if available */
+	double planeRadLengthLocalIncidence(int sensorID, Eigen::Vector3d incidenceDir) const;
+
+	/** Radiation length along the straight line between the two points,
+	 * ray traced with the TGeoNavigator of the calling thread, or under
+	 * a lock if TGeo is not in multi-threaded mode */
+	double findRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) const;
+
+  private:
+	struct Plane
+	{
+		/** Row-major rotation followed by translation, local to master */
+		std::array<double,12> transform;
+		/** Sensor thickness */
+		double zSize;
+		/** Radiation length at normal incidence */
+		double normRad;
+		/** Flag if this slot is occupied */
+		bool valid;
+	};
+
+	/** Only EUTelGeometryTelescopeGeoDescription creates snapshots */
+	EUTelGeometrySnapshot(std::shared_ptr<TGeoManager> geoManager, std::shared_ptr<std::mutex> navigationMutex,
+	                      std::vector<int> const & sensorIDVec);
+
+	Plane const & plane(int sensorID) const;
+
+	/** The TGeo geometry used for ray tracing, it is never modified */
+	std::shared_ptr<TGeoManager> _geoManager;
+
+	/** True if TGeo provides one navigator per thread */
+	bool _multiThreadNavigation;
+
+	/** Serialises findRad on the shared navigator otherwise, shared with
+	 * the geometry description */
+	std::shared_ptr<std::mutex> _navigationMutex;
+
+	/** Sensor IDs sorted along z */
+	std::vector<int> _sensorIDVec;
+
+	/** Plane information indexed by the sensorID */
+	std::vector<Plane> _planes;
+
+	/** Shared with the geometry description, it is never modified */
+	std::shared_ptr<EUTelMaterialBudgetMap const> _materialBudgetMap;
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELGEOMETRYSNAPSHOT_H */
@@ -8,8 +8,10 @@
 // C++
 #include <map>
 #include <string>
+#include <vector>
 #include <array>
 #include <memory>
+#include <mutex>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -25,6 +27,8 @@
 // EUTELESCOPE
 #include "EUTelUtility.h"
 #include "EUTelGenericPixGeoMgr.h"
+#include "EUTelGeometrySnapshot.h"
+#include "EUTelMaterialBudgetMap.h"
 
 
 // ROOT
@@ -337,8 +341,44 @@ class EUTelGeometryTelescopeGeoDescription
 
 	double FindRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt);
 
+	/** Creates an immutable snapshot of the current geometry which can be
+	 * queried from several threads concurrently. It has to be recreated after
+	 * any alignment update.
+	 *
+	 * @param maxThreads if larger than one, TGeo is switched into multi-threaded
+	 * mode, providing one navigator per thread for the ray tracing in
+	 * EUTelGeometrySnapshot::findRad. This is only done once per job. Otherwise
+	 * the findRad calls of the snapshot are serialised on the single navigator.
+	 */
+	std::shared_ptr<EUTelGeometrySnapshot const> createSnapshot(int maxThreads = 0);
+
+	/** Radiation length of the plane for a particle crossing its centre. If
+	 * the material budget map is initialised, it is used instead of the
+	 * normal incidence value scaled with the incidence angle. */
 	double planeRadLengthGlobalIncidence(int planeID, Eigen::Vector3d incidenceDir);
 	double planeRadLengthLocalIncidence(int planeID, Eigen::Vector3d incidenceDir);
+
+	/** Samples the material budget of all planes and of the gaps between
+	 * consecutive planes from TGeo, see EUTelMaterialBudgetMap. The largest
+	 * deviations from the ray tracing are printed for each layer. This has
+	 * to be called again if the plane positions change by more than the
+	 * required accuracy of the gap material.
+	 */
+	void initializeMaterialBudgetMap(EUTelMaterialBudgetMap::Binning const & binning);
+
+	/** The material budget map, null if it has not been initialised */
+	std::shared_ptr<EUTelMaterialBudgetMap const> materialBudgetMap() const { return _materialBudgetMap; };
+
+	/** Radiation length of the plane for a particle entering it at the local
+	 * position (x,y) with the given local direction. Taken from the material
+	 * budget map if initialised, ray traced with FindRad otherwise. */
+	double planeRadLength(int planeID, double localX, double localY, Eigen::Vector3d const & localDir);
+
+	/** Radiation length of the gap between the plane and the next one along z,
+	 * for a particle leaving the plane at the local position (x,y). Taken
+	 * from the material budget map if initialised, ray traced with FindRad
+	 * otherwise. Zero for the last plane. */
+	double gapRadLength(int planeID, double localX, double localY, Eigen::Vector3d const & localDir);
 	
 	void local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos);
 	void master2Local( int sensorID, std::array<double,3> const & globalPos, std::array<double,3>& localPos);
@@ -350,6 +390,13 @@ class EUTelGeometryTelescopeGeoDescription
 	void local2MasterVec( int, const double[], double[] );
 	void master2LocalVec( int, const double[], double[] );
 
+	/** Batched versions of the above transformations, they act on
+	 * nPoints consecutive (x,y,z) triplets. Input and output may alias. */
+	void local2Master( int sensorID, const double localPos[], double globalPos[], size_t nPoints );
+	void master2Local( int sensorID, const double globalPos[], double localPos[], size_t nPoints );
+	void local2MasterVec( int sensorID, const double localVec[], double globalVec[], size_t nPoints );
+	void master2LocalVec( int sensorID, const double globalVec[], double localVec[], size_t nPoints );
+
 	bool findIntersectionWithCertainID(	float x0, float y0, float z0, 
 						float px, float py, float pz, 
 						float beamQ, int nextPlaneID, float outputPosition[],
@@ -378,8 +425,10 @@ class EUTelGeometryTelescopeGeoDescription
 	 * descriptions are being done, currently.
 	 */
 
-	/** Geometry manager global object */
-	std::unique_ptr<TGeoManager> _geoManager = nullptr;
+	/** Geometry manager global object, shared with the snapshots created
+	 * from it. A replaced manager is deleted once no snapshot uses it any
+	 * more, the current one is left to ROOT. */
+	std::shared_ptr<TGeoManager> _geoManager = nullptr;
 
 private:
 	/** reading initial info from gear: part of contructor */
@@ -401,11 +450,34 @@ private:
 
 	void translateSiPlane2TGeo(TGeoVolume*,int );
 
-	void clearMemoizedValues() { _planeNormalMap.clear(); _planeXMap.clear(); _planeYMap.clear(); _planeRadMap.clear(); }
+	void clearMemoizedValues() { _planeNormalMap.clear(); _planeXMap.clear(); _planeYMap.clear(); _planeRadMap.clear(); _planeTransformValid.clear(); }
+
+	/** Returns the cached local to master transformation of the plane,
+	 * it is read from TGeo on first use after clearMemoizedValues().
+	 * The first nine elements are the row-major rotation matrix, the
+	 * last three the translation. */
+	std::array<double,12> const & planeTransform(int sensorID);
+
+	/** Local z boundaries of the gap behind the plane, false for the last plane */
+	bool gapBoundaries(int sensorID, double& zBegin, double& zEnd);
+
+	/** Ray traces a layer of the plane between the local z boundaries */
+	double traceLayerRadLength(int sensorID, double localX, double localY, Eigen::Vector3d const & localDir, double zBegin, double zEnd);
+
 	std::map<int, TVector3> _planeNormalMap;
 	std::map<int, TVector3> _planeXMap;
 	std::map<int, TVector3> _planeYMap;
 	std::map<int, double> _planeRadMap;
+
+	/** Cached transformations, indexed by sensorID */
+	std::vector<std::array<double,12> > _planeTransforms;
+	std::vector<bool> _planeTransformValid;
+
+	/** Precomputed material budget, shared with the snapshots */
+	std::shared_ptr<EUTelMaterialBudgetMap const> _materialBudgetMap;
+
+	/** Serialises the navigation on the TGeo geometry, shared with the snapshots */
+	std::shared_ptr<std::mutex> _navigationMutex;
 };
         
 inline EUTelGeometryTelescopeGeoDescription& gGeometry( gear::GearMgr* _g = marlin::Global::GEAR )
@@ -0,0 +1,116 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELHOTPIXELMASK_H
+#define EUTELHOTPIXELMASK_H
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <IMPL/TrackerHitImpl.h>
+
+// system includes <>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Per sensor bitmap of hot (noisy) pixels
+  /*! The hot pixel collection written by the noisy pixel finders is
+   *  read once and turned into one dense bitmap per sensor, covering
+   *  the bounding box of the hot pixels of that sensor. Sensors are
+   *  indexed directly by their ID, so that isHot() is a couple of
+   *  comparisons and a bit test, without any allocation.
+   *
+   *  This replaces the string keyed maps, the sorted Cantor encoded
+   *  vectors and the pixel pair lists previously used by the hit
+   *  filter, the alignment and the noisy pixel processors.
+   */
+  class EUTelHotPixelMask {
+
+  public:
+
+    //! A hot pixel
+    struct HotPixel {
+      int sensorID;
+      int x, y;
+    };
+
+    //! Default constructor, the mask is empty
+    EUTelHotPixelMask();
+
+    //! Read the hot pixel collection
+    /*! Only collections of EUTelGenericSparsePixel are supported, the
+     *  elements of other pixel types are reported and skipped. The
+     *  previous content of the mask is replaced.
+     *
+     *  @param event The event holding the collection, usually the
+     *  first one
+     *  @param collectionName The name of the hot pixel collection
+     *  @return false if the collection is not available, the mask is
+     *  then empty
+     */
+    bool load(EVENT::LCEvent * event, std::string const & collectionName);
+
+    //! Build the mask from a list of hot pixels
+    void build(std::vector<HotPixel> const & pixels);
+
+    //! Remove all pixels from the mask
+    void clear();
+
+    //! True if no pixel is masked
+    bool empty() const { return _noOfHotPixels == 0; }
+
+    //! The total number of masked pixels
+    size_t size() const { return _noOfHotPixels; }
+
+    //! Check a pixel
+    /*! Pixels of unknown sensors or outside the bounding box of the
+     *  sensor hot pixels are not hot.
+     */
+    inline bool isHot(int sensorID, int x, int y) const {
+      if( sensorID < 0 || static_cast<size_t>( sensorID ) >= _sensorMasks.size() ) return false;
+      SensorMask const & mask = _sensorMasks[sensorID];
+      //the unsigned conversion turns coordinates below the minimum into large values
+      unsigned int dx = static_cast<unsigned int>( x - mask.xMin );
+      unsigned int dy = static_cast<unsigned int>( y - mask.yMin );
+      if( dx >= mask.width || dy >= mask.height ) return false;
+      size_t bit = static_cast<size_t>( dy ) * mask.width + dx;
+      return ( mask.bits[bit >> 6] >> ( bit & 63 ) ) & 1;
+    }
+
+    //! Check the pixels of a hit
+    /*! Only hits made from sparse clusters are checked, the pixels of
+     *  the other cluster types are not available and such hits are
+     *  never considered hot.
+     *
+     *  @return true if any of the hit pixels is hot
+     */
+    bool hitContainsHotPixels(IMPL::TrackerHitImpl const * hit) const;
+
+  private:
+
+    //! The bitmap of one sensor
+    struct SensorMask {
+      int xMin, yMin;
+      unsigned int width, height;
+      std::vector<std::uint64_t> bits;
+    };
+
+    //! The sensor bitmaps indexed by sensor ID
+    std::vector<SensorMask> _sensorMasks;
+
+    //! The total number of masked pixels
+    size_t _noOfHotPixels;
+  };
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELMAPPEDFILE_H
+#define EUTELMAPPEDFILE_H
+
+// system includes <>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace eutelescope {
+
+  //! Read only, memory mapped view of a raw data file
+  /*! The native readers of the old DAQ formats decode fixed size
+   *  records (header, data block, trailer) one after the other. With
+   *  the file mapped into memory, the records are decoded directly
+   *  from the page cache: there is no read call per record and no
+   *  copy into an intermediate buffer.
+   *
+   *  The mapping is advised for sequential access, prefetch() can be
+   *  used to ask the kernel to read ahead the next record while the
+   *  current one is being decoded.
+   */
+  class EUTelMappedFile {
+
+  public:
+
+    //! Default constructor, no file is mapped
+    EUTelMappedFile();
+
+    //! Destructor, unmaps the file
+    ~EUTelMappedFile();
+
+    //! Map a file
+    /*! A previously mapped file is unmapped first.
+     *
+     *  @param fileName The name of the file
+     *  @return false if the file cannot be opened or mapped
+     */
+    bool open(std::string const & fileName);
+
+    //! Unmap the file
+    void close();
+
+    //! True if a file is mapped
+    bool isOpen() const { return _isOpen; }
+
+    //! The beginning of the mapped file, NULL for an empty file
+    char const * data() const { return _data; }
+
+    //! The size of the mapped file in bytes
+    size_t size() const { return _size; }
+
+    //! Ask the kernel to read ahead a region of the file
+    /*! This is only a hint, the call returns immediately. Regions
+     *  exceeding the file are truncated.
+     *
+     *  @param offset The beginning of the region in bytes
+     *  @param length The length of the region in bytes
+     */
+    void prefetch(size_t offset, size_t length) const;
+
+    //! Copy a POD object from the mapped region
+    /*! The data words of the raw formats are not necessarily aligned
+     *  to their size within the file, memcpy takes care of it and is
+     *  translated into a plain load by the compiler.
+     */
+    template<class T>
+    static inline T read(char const * address) {
+      T value;
+      std::memcpy( &value, address, sizeof(T) );
+      return value;
+    }
+
+  private:
+
+    //! Copying a mapping is not supported
+    EUTelMappedFile(EUTelMappedFile const &);
+    EUTelMappedFile & operator=(EUTelMappedFile const &);
+
+    //! The mapped region
+    char * _data;
+
+    //! The size of the mapped region
+    size_t _size;
+
+    //! True if a file is mapped, also for an empty file
+    bool _isOpen;
+  };
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * File:   EUTelMaterialBudgetMap.h
+ *
+ */
+#ifndef EUTELMATERIALBUDGETMAP_H
+#define	EUTELMATERIALBUDGETMAP_H
+
+// C++
+#include <array>
+#include <functional>
+#include <map>
+#include <vector>
+
+//Eigen
+#include <Eigen/Core>
+
+/** @class EUTelMaterialBudgetMap
+ * Precomputed radiation length X/X0 of the planes and of the gaps between them.
+ *
+ * Each layer is a slab in the local frame of a plane, between the local
+ * z coordinates zBegin and zEnd. Its material budget is sampled once by ray
+ * tracing, on a grid of the local (x,y) entry point and of the polar angle
+ * theta of the local direction, and is then trilinearly interpolated. Queries
+ * are const, without any TGeo navigation, and can be done from several
+ * threads.
+ *
+ * The value stored on the grid is X/X0 * cos(theta), the material budget
+ * along the layer normal, and the query divides it by the cosine of the
+ * actual direction. Accuracy:
+ * - for a homogeneous slab the map is exact at all angles, as the ray
+ *   tracing would give t/X0/cos(theta) as well,
+ * - for structures varying within the layer, the interpolation error is
+ *   measured at build time against the ray tracing, on the centres of the
+ *   grid cells (the points farthest from the samples) and at an azimuth
+ *   in between the sampled ones. getMaxAbsoluteError and getMaxRelativeError
+ *   return the largest deviations found, they have to be checked against
+ *   the needs of the fit when choosing the binning,
+ * - entry points outside the sampled area are clamped to its border and
+ *   angles beyond maxAngle use the normalised value at maxAngle, the
+ *   accuracy bounds do not hold there.
+ *
+ * The map is built in the local frames, thus a plane map is unaffected
+ * by alignment corrections. For the gaps, the distance to the next plane
+ * is taken along the normal of the upstream plane, relative tilts of the
+ * planes are neglected, which is irrelevant for the air in between.
+ */
+namespace eutelescope {
+namespace geo {
+
+class EUTelMaterialBudgetMap
+{
+  public:
+	/** Radiation length of the straight line between two global points */
+	typedef std::function<double(Eigen::Vector3d const &, Eigen::Vector3d const &)> RadSampler;
+
+	/** Sampling of the layers */
+	struct Binning
+	{
+		/** Number of grid points along the local x and y axes, at least two */
+		int nX = 11;
+		int nY = 11;
+		/** Number of grid points in the polar angle, from zero to maxAngle, at least two */
+		int nAngle = 6;
+		/** Largest sampled polar angle, in rad */
+		double maxAngle = 0.5;
+		/** Number of azimuths averaged at each angle */
+		int nAzimuth = 4;
+	};
+
+	explicit EUTelMaterialBudgetMap(Binning const & binning);
+
+	/** Sample the material of a layer of a plane.
+	 *
+	 * @param transform local to master transformation of the plane, row-major
+	 * rotation followed by the translation
+	 * @param xSize, ySize sampled area around the plane centre
+	 * @param zBegin, zEnd local z boundaries of the layer
+	 * @param sampler full ray tracing, e.g. EUTelGeometryTelescopeGeoDescription::FindRad
+	 */
+	void addPlane( int sensorID, std::array<double,12> const & transform, double xSize, double ySize,
+	               double zBegin, double zEnd, RadSampler const & sampler );
+
+	/** Sample the gap behind a plane, same parameters as addPlane */
+	void addGap( int sensorID, std::array<double,12> const & transform, double xSize, double ySize,
+	             double zBegin, double zEnd, RadSampler const & sampler );
+
+	bool hasPlane(int sensorID) const { return _planes.count(sensorID) > 0; };
+	bool hasGap(int sensorID) const { return _gaps.count(sensorID) > 0; };
+
+	/** X/X0 of the plane for the given local entry point and local direction */
+	double planeRadLength( int sensorID, double localX, double localY, Eigen::Vector3d const & localDir ) const;
+
+	/** X/X0 of the gap behind the plane for the given local exit point and local direction */
+	double gapRadLength( int sensorID, double localX, double localY, Eigen::Vector3d const & localDir ) const;
+
+	/** Largest deviations from the ray tracing measured when sampling the layer,
+	 * the relative one is taken w.r.t. the ray traced value */
+	double getMaxAbsoluteError( int sensorID, bool gap = false ) const;
+	double getMaxRelativeError( int sensorID, bool gap = false ) const;
+
+  private:
+	struct Layer
+	{
+		double xMin, yMin, xStep, yStep;
+		/** X/X0 * cos(theta), index (iAngle * nY + iY) * nX + iX */
+		std::vector<float> values;
+		double maxAbsoluteError;
+		double maxRelativeError;
+	};
+
+	Layer sampleLayer( std::array<double,12> const & transform, double xSize, double ySize,
+	                   double zBegin, double zEnd, RadSampler const & sampler ) const;
+
+	/** Average over the azimuths of the ray traced X/X0 * cos(theta) */
+	double sampleNormalised( std::array<double,12> const & transform, double x, double y, double theta,
+	                         double zBegin, double zEnd, RadSampler const & sampler ) const;
+
+	/** Ray traced X/X0 for one direction */
+	double traceRadLength( std::array<double,12> const & transform, double x, double y, double theta, double phi,
+	                       double zBegin, double zEnd, RadSampler const & sampler ) const;
+
+	double interpolate( Layer const & layer, double localX, double localY, Eigen::Vector3d const & localDir ) const;
+
+	Layer const & layer( std::map<int, Layer> const & layers, int sensorID ) const;
+
+	Binning _binning;
+	double _angleStep;
+
+	std::map<int, Layer> _planes;
+	std::map<int, Layer> _gaps;
+};
+
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELMATERIALBUDGETMAP_H */
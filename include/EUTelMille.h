@@ -14,6 +14,7 @@
 #ifdef USE_GEAR
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelHotPixelMask.h"
 
 //#include "TrackerHitImpl2.h"
 #include "IMPL/TrackerHitImpl.h"
@@ -40,13 +41,12 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <utility>
 
 #if defined(USE_ROOT) || defined(MARLIN_USE_ROOT)
-#include <TMinuit.h>
 #include <TSystem.h>
 #include <TMath.h>
 #include <TVector3.h>
-class TMinuit;
 #else
 #error *** You need ROOT to compile this code.  *** 
 #endif
@@ -155,11 +155,9 @@ namespace eutelescope {
       {
         return (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
       }
-      double fit (double *x)
+      double fit (const double *x) const
       {
         double chi2 = 0.0;
-   
-        const unsigned int n = 3;
 
         const double b0 = x[0];
         const double b1 = x[1];
@@ -172,7 +170,7 @@ namespace eutelescope {
         const double c1 = -1.0*TMath::Cos(beta) * TMath::Sin(alpha);
         const double c2 = TMath::Cos(alpha) * TMath::Cos(beta);
     
-        double c[n] = {c0, c1, c2}; 
+        double c[3] = {c0, c1, c2}; 
         for(size_t i = 0; i < n;i++)
           {
             const double p0 = hitsarray[i].x;
@@ -183,10 +181,10 @@ namespace eutelescope {
             const double resol_y = hitsarray[i].resolution_y;
             const double resol_z = hitsarray[i].resolution_z;
         
-            const double pmb[n] = {p0-b0, p1-b1, p2-b2}; //p - b
+            const double pmb[3] = {p0-b0, p1-b1, p2-b2}; //p - b
         
             const double coeff = dot(c, pmb);
-            const double t[n] = {
+            const double t[3] = {
               b0 + c0 * coeff - p0,
               b1 + c1 * coeff - p1,
               b2 + c2 * coeff - p2
@@ -200,6 +198,19 @@ namespace eutelescope {
  
         return chi2;
       }
+
+      //! Minimise the chi2 of fit with Gauss-Newton iterations
+      /*! The starting values of the parameters (b0, b1, delta, psi)
+       *  are read from x, which is overwritten by the fitted ones. The
+       *  derivatives of the residuals are analytic, so that the fit
+       *  converges in a few iterations from the analytic straight line
+       *  estimate. Nothing is shared between calls, several tracks can
+       *  be fitted at the same time.
+       *
+       *  @return false if the fit did not converge
+       */
+      bool minimise(double *x, double &chi2) const;
+
     private:
       //std::vector<hit> hitsarray;
     hit *hitsarray;
@@ -243,11 +254,20 @@ namespace eutelescope {
                           );
 
 
+    //searches for track candidates - with omits!
+    /*! Prepares the hits sorted in x for the residual windows and
+     *  starts findtracks2 on the first plane.
+     */
+    virtual void findTrackCandidates(
+                            std::vector<IntVec > &indexarray, //resulting vector of hit indizes
+                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_hitsArray //contains all hits for each plane
+                            );
+
     //recursive method which searches for track candidates - with omits!
     virtual void findtracks2(
                             int missinghits,
                             std::vector<IntVec > &indexarray, //resulting vector of hit indizes
-                            IntVec vec, //for internal use
+                            IntVec &path, //hit index of each plane on the current candidate, one entry per plane
                             std::vector<std::vector<EUTelMille::HitsInPlane> > &_hitsArray, //contains all hits for each plane
                             unsigned int i, //plane number
                             int y //hit index number
@@ -299,7 +319,7 @@ namespace eutelescope {
     virtual void processRunHeader (LCRunHeader * run);
 
     //! Called for first event per run
-    /*! Reads hotpixel information from hotPixelCollection into hotPixelMap
+    /*! Reads hotpixel information from hotPixelCollection into the hot pixel mask
      * to be used in the sensor exclusion area logic 
      */
     virtual void  FillHotPixelMap(LCEvent *event);
@@ -385,16 +405,11 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! Vector of map arrays, keeps record of hit pixels 
-    /*! The vector elements are sorted by Detector ID
-     *  For each Detector unique ID element a map of pixels is created. 
-     *  first level key   sensor unique 
-     *              value sensor map
-     *  sensor map key    unique row number
-     *             value  vector of column numbers.
+    //! Hot pixel mask
+    /*! Filled from the hot pixel collection at the first event, hits
+     *  containing a hot pixel are not used for the alignment.
      */
-    
-    std::map<std::string, bool > _hotPixelMap;
+    EUTelHotPixelMask _hotPixelMask;
 
     //! Sensor ID vector
     IntVec _sensorIDVec;
@@ -569,6 +584,16 @@ namespace eutelescope {
     //! Limits the pixels on each sensor-plane to a sub-rectangular  
     RectangularArray _rect;
 
+    //! The x position and index of the hits of each plane, sorted in x
+    /*! Used by findtracks2 to find the hits within the residual window
+     *  of a plane with a range query. Kept between events to avoid
+     *  reallocations.
+     */
+    std::vector<std::vector<std::pair<double, int > > > _hitsSortedInX;
+
+    //! The hits of each plane passing the residual window, sorted by index
+    std::vector<IntVec > _hitsInWindow;
+
   };
 
   //! A global instance of the processor
@@ -0,0 +1,165 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELPACKEDSPARSEDATA_H
+#define EUTELPACKEDSPARSEDATA_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
+
+// lcio includes <.h>
+#include <LCIOTypes.h>
+
+// system includes <>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace eutelescope {
+
+  //! Packed storage of generic sparse pixels
+  /*! This class defines the kEUTelPackedGenericPixel storage of
+   *  EUTelGenericSparsePixel in the charge values of a TrackerData.
+   *  Instead of one float per field, each pixel takes two 32 bit
+   *  words with fixed width fields:
+   *
+   *  - word 0: x coordinate (bits 0-15), y coordinate (bits 16-31)
+   *  - word 1: signal (bits 0-15), time (bits 16-31)
+   *
+   *  All the fields are 16 bit two's complement integers, so the
+   *  signal has to be an integer number between -32768 and 32767, as
+   *  for digital and ToT sensors. The words are copied bit by bit into
+   *  the float charge values, they must never be used as numbers.
+   *
+   *  Pixels are decoded on the fly while iterating, without building
+   *  a vector:
+   *  @code
+   *  EUTelPackedSparseData packed( zsData->getChargeValues() );
+   *  for ( auto const & pixel: packed ) pixel.getXCoord();
+   *  @endcode
+   */
+  class EUTelPackedSparseData {
+
+  public:
+
+    //! The number of charge values used by each pixel
+    static const size_t kWordsPerPixel = 2;
+
+    //! Forward iterator decoding one pixel at a time
+    class const_iterator : public std::iterator<std::forward_iterator_tag, EUTelGenericSparsePixel> {
+    public:
+      const_iterator(lcio::FloatVec const & data, size_t index): _data(&data), _index(index), _pixel() { }
+
+      EUTelGenericSparsePixel const & operator*() const {
+        _pixel = decodePixel( *_data, _index );
+        return _pixel;
+      }
+
+      EUTelGenericSparsePixel const * operator->() const { return &( operator*() ); }
+
+      const_iterator & operator++() {
+        _index += kWordsPerPixel;
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        const_iterator old( *this );
+        _index += kWordsPerPixel;
+        return old;
+      }
+
+      bool operator==(const_iterator const & other) const { return _index == other._index; }
+      bool operator!=(const_iterator const & other) const { return _index != other._index; }
+
+    private:
+      lcio::FloatVec const * _data;
+      size_t _index;
+      mutable EUTelGenericSparsePixel _pixel;
+    };
+
+    //! Only available constructor, the data must outlive this object
+    explicit EUTelPackedSparseData(lcio::FloatVec const & data): _data(data) { }
+
+    //! The number of pixels
+    size_t size() const { return _data.size() / kWordsPerPixel; }
+
+    //! True if there is no pixel
+    bool empty() const { return size() == 0; }
+
+    //! The first pixel
+    const_iterator begin() const { return const_iterator( _data, 0 ); }
+
+    //! Past the last pixel
+    const_iterator end() const { return const_iterator( _data, size() * kWordsPerPixel ); }
+
+    //! Decode the i-th pixel
+    EUTelGenericSparsePixel operator[](size_t i) const { return decodePixel( _data, i * kWordsPerPixel ); }
+
+    //! Append a pixel to the charge values
+    /*! @throw std::invalid_argument if the signal is not an integer
+     *  fitting in 16 bits
+     */
+    static void pushPixel(EUTelGenericSparsePixel const & pixel, lcio::FloatVec & data) {
+      float signal = pixel.getSignal();
+      if( !( signal >= -32768.f && signal <= 32767.f ) || static_cast<short>( signal ) != signal ) {
+        throw std::invalid_argument( "EUTelPackedSparseData: the pixel signal is not a 16 bit integer" );
+      }
+      pushWord( pixel.getXCoord(), pixel.getYCoord(), data );
+      pushWord( static_cast<short>( signal ), pixel.getTime(), data );
+    }
+
+    //! Decode the pixel starting at the given charge value
+    static EUTelGenericSparsePixel decodePixel(lcio::FloatVec const & data, size_t index) {
+      uint32_t coordinates = getWord( data, index );
+      uint32_t content = getWord( data, index + 1 );
+      return EUTelGenericSparsePixel( lowField( coordinates ), highField( coordinates ),
+                                      static_cast<float>( lowField( content ) ), highField( content ) );
+    }
+
+  private:
+
+    //! Append two 16 bit fields as a charge value
+    /*! The bits are copied in memory, a float register could alter
+     *  the words looking like a NaN.
+     */
+    static void pushWord(short low, short high, lcio::FloatVec & data) {
+      uint32_t word = static_cast<uint16_t>( low ) | static_cast<uint32_t>( static_cast<uint16_t>( high ) ) << 16;
+      data.push_back( 0.f );
+      std::memcpy( &data.back(), &word, sizeof( word ) );
+    }
+
+    //! The 32 bits of a charge value
+    static uint32_t getWord(lcio::FloatVec const & data, size_t index) {
+      uint32_t word;
+      std::memcpy( &word, &data[index], sizeof( word ) );
+      return word;
+    }
+
+    static short lowField(uint32_t word) { return static_cast<short>( static_cast<uint16_t>( word & 0xFFFF ) ); }
+    static short highField(uint32_t word) { return static_cast<short>( static_cast<uint16_t>( word >> 16 ) ); }
+
+    //! The charge values holding the packed pixels
+    lcio::FloatVec const & _data;
+  };
+
+  //! True for the storage types of EUTelGenericSparsePixel
+  /*! Readers of zero suppressed data have to accept both types and
+   *  pass the storage type to EUTelTrackerDataInterfacerImpl (or use
+   *  getSparseData or forEachPixel). Clusters are never packed, the
+   *  clustering processors write them as kEUTelGenericSparsePixel.
+   */
+  inline bool isGenericSparsePixelStorage(int type) {
+    return type == kEUTelGenericSparsePixel || type == kEUTelPackedGenericPixel;
+  }
+
+}
+
+#endif
@@ -167,6 +167,14 @@ namespace eutelescope {
    *  additional loop to better identify hit candidate; to be
    *  performed when calculating pedestal from beam runs.
    *
+   *  <h2>Single pass estimation</h2>
+   *  @param SinglePassEstimation Switch to calculate pedestal, noise,
+   *  common mode and bad pixel masks in one pass over the data,
+   *  without rewinding the input files.
+   *  @param SinglePassWarmUpEvents Number of events buffered at the
+   *  beginning of the single pass estimation to get robust starting
+   *  values for the hit rejection.
+   *
    *  <h2>Other controls</h2>
    *  @param FirstEvent First event to be used for pedestal calculation
    *  @param LastEvent Last event to be used for pedestal calculation
@@ -377,6 +385,39 @@ namespace eutelescope {
      */
     void additionalMaskingLoop(LCEvent * evt);
 
+    //! Single pass pedestal and noise estimation
+    /*! This method replaces the pre-loop, the first loop, the common
+     *  mode loops and the additional masking loop when the user sets
+     *  SinglePassEstimation. All quantities are obtained in one pass
+     *  over the events, so no RewindDataFilesException is thrown.
+     *
+     *  \li The first _singlePassWarmUpEvents events are buffered. The
+     *  median and the median absolute deviation of each pixel in this
+     *  sample are used as starting values of pedestal and noise. In
+     *  contrast to mean and RMS they are hardly affected by the few
+     *  hits in the sample, this is what the pre-loop is doing in the
+     *  iterative method.
+     *
+     *  \li Every event, including the buffered ones, is then common
+     *  mode corrected against the current pedestal and noise values,
+     *  with the same algorithm and cuts used in otherLoop(). Pixels
+     *  passing the hit rejection update a running mean and variance
+     *  (Welford's algorithm). As soon as a pixel has collected
+     *  _singlePassWarmUpEvents entries, its running values are used
+     *  for the hit rejection instead of the starting values.
+     *
+     *  \li If the AdditionalMaskingLoop is selected, pixels above
+     *  three times the current noise are counted on the fly and
+     *  masked at the end according to their firing frequency.
+     *
+     *  The results are comparable to the iterative method with one
+     *  common mode iteration. The price is the memory needed for the
+     *  buffered events.
+     *
+     *  @param evt The LCEvent containing all the input collections.
+     */
+    void singlePassLoop(LCEvent * evt);
+
     //! Book histograms
     /*! This method is used to prepare the needed directory structure
      *  within the current ITree folder and books all required
@@ -488,6 +529,15 @@ namespace eutelescope {
     //! Simple rewind
     virtual void simpleRewind();
 
+    //! Finishes up the single pass estimation
+    /*! The running mean and variance are moved into the pedestal and
+     *  noise vectors, the bad pixels are masked and the output file
+     *  is written.
+     *
+     *  @throw StopProcessingException to stop the looping
+     */
+    virtual void finalizeSinglePass();
+
     //! Initialize the geometry
     /*! This method is used to get from the current event.
      *
@@ -787,8 +837,57 @@ namespace eutelescope {
      */
     bool _preLoopSwitch;
 
+    //! Switch for the single pass estimation
+    /*! @see EUTelPedestalNoiseProcessor::singlePassLoop(LCEvent*)
+     */
+    bool _singlePassEstimation;
+
+    //! Number of warm up events for the single pass estimation
+    /*! These events are buffered to calculate the robust starting
+     *  values of pedestal and noise. This is also the number of
+     *  entries a pixel needs before its running values are used for
+     *  the hit rejection.
+     */
+    int _singlePassWarmUpEvents;
+
   private:
 
+    //! Calculate the common mode correction of a detector
+    /*! The common mode is calculated with the selected algorithm,
+     *  excluding hit candidates and bad pixels according to the
+     *  current _pedestal, _noise and _status.
+     *
+     *  @param adcValues The raw signals of the detector
+     *  @param iDetector The detector index
+     *  @param commonModeCorVec The correction for each pixel
+     *  @param skippedPixel The number of hit candidates
+     *  @param skippedRow The number of skipped rows (only with RowWise)
+     *
+     *  @return false if the event has to be discarded for this detector
+     */
+    bool commonModeCorrection(const ShortVec & adcValues, size_t iDetector, std::vector< float > & commonModeCorVec,
+                              int & skippedPixel, int & skippedRow);
+
+    //! Mask pixels firing too often
+    /*! @param noOfEvents The number of events used to fill _hitCounter
+     */
+    void maskFiringPixel(int noOfEvents);
+
+    //! Write pedestal, noise and status to the output file
+    /*! @return false if the output file cannot be opened
+     */
+    bool writeConditionFile();
+
+    //! End of the single pass warm up
+    /*! Calculates the robust starting values from the buffered
+     *  events, masks the bad pixels and feeds the buffered events to
+     *  the running estimation.
+     */
+    void endWarmUp();
+
+    //! Update the single pass running estimation with one detector frame
+    void singlePassUpdate(size_t iDetector, const ShortVec & adcValues);
+
     //! Detector name
     /*! This string is used to copy the detector name from the run
      *  header to the event "header"
@@ -1009,6 +1108,21 @@ namespace eutelescope {
     //! Additional bad masking loop
     bool _additionalMaskingLoop;
 
+    //! Single pass running mean of each pixel
+    std::vector< std::vector< double > > _runningMean;
+
+    //! Single pass running sum of squared deviations of each pixel
+    std::vector< std::vector< double > > _runningM2;
+
+    //! Single pass number of entries of each pixel
+    std::vector< IntVec > _runningEntries;
+
+    //! Events buffered during the single pass warm up, per detector
+    std::vector< std::vector< ShortVec > > _warmUpFrames;
+
+    //! True once the single pass warm up is over
+    bool _isWarmUpDone;
+
   };
 
   //! A global instance of the processor
@@ -0,0 +1,74 @@
+#ifndef EUTELPIXELGEOMETRYTABLE_H
+#define	EUTELPIXELGEOMETRYTABLE_H
+
+  /** @class EUTelPixelGeometryTable
+	* This class holds a flat, index-addressed table of the geometric
+	* properties of every pixel of a plane as described by the pixel
+	* geometry framework. For each pixel the centre (in the local frame
+	* of the plane, i.e. after applying all transforms from the pixel
+	* node up to the sensitive area) as well as the half-widths of the
+	* bounding box are stored.
+	* The table is filled once from the TGeo description provided by the
+	* EUTelGenericPixGeoDescr of the plane. Afterwards lookups are pure
+	* array accesses and do neither require any string handling nor any
+	* TGeo navigation, which makes it suitable for hot loops such as the
+	* geometric clustering.
+    */
+
+//STL
+#include <string>
+#include <vector>
+
+//EUTelescope
+#include "EUTelGenericPixGeoDescr.h"
+
+namespace eutelescope {
+namespace geo {
+
+class EUTelPixelGeometryTable {
+
+	public:
+
+	  /** Geometric properties of a single pixel */
+		struct PixelGeometry
+		{
+			/** Centre of the pixel in the local plane frame */
+			float posX, posY;
+			/** Half-widths of the bounding box of the pixel */
+			float boundX, boundY;
+		};
+
+	  /** Constructor, walks the TGeo description of the plane once and fills the table
+		* @param geoDescr is the pixel geometry description of the plane
+		* @param planePath is the TGeo path of the plane the pixel geometry has been loaded into
+		*/
+		EUTelPixelGeometryTable(EUTelGenericPixGeoDescr* geoDescr, std::string const & planePath);
+
+	  /** Returns true if the pixel index is covered by the table */
+		inline bool contains(int x, int y) const
+		{
+			return x >= _minX && x <= _maxX && y >= _minY && y <= _maxY;
+		}
+
+	  /** Returns the geometric properties of pixel (x,y), no range check is done
+		* @see contains() */
+		inline PixelGeometry const & at(int x, int y) const
+		{
+			return _table[ (x-_minX)*_noOfPixelsY + (y-_minY) ];
+		}
+
+	  /** Number of pixels stored in the table */
+		inline size_t size() const { return _table.size(); }
+
+	protected:
+		int _minX, _maxX, _minY, _maxY;
+		int _noOfPixelsY;
+
+		/** The actual table, row-major in x */
+		std::vector<PixelGeometry> _table;
+};
+
+} //namespace geo
+} //namespace eutelescope
+
+#endif	//EUTELPIXELGEOMETRYTABLE_H
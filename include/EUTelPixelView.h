@@ -0,0 +1,249 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELPIXELVIEW_H
+#define EUTELPIXELVIEW_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelSimpleSparsePixel.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelGeometricPixel.h"
+#include "EUTelMuPixel.h"
+#include "EUTelPackedSparseData.h"
+
+// lcio includes <.h>
+#include <LCIOTypes.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <iterator>
+
+namespace eutelescope {
+
+  //! Decoding of one pixel from the charge values of a TrackerData
+  /*! This template has to be specialised for every pixel type, with
+   *  the number of charge values per pixel (stride) and the decoding
+   *  of the pixel starting at a given charge value. It is the only
+   *  place where the float layout of the pixels is read.
+   */
+  template<class PixelType>
+  struct EUTelPixelDecoder;
+
+  template<>
+  struct EUTelPixelDecoder<EUTelSimpleSparsePixel> {
+    static const size_t stride = 3;
+    static EUTelSimpleSparsePixel decode(lcio::FloatVec const & data, size_t index) {
+      return EUTelSimpleSparsePixel( static_cast<short>( data[index] ),
+                                     static_cast<short>( data[index + 1] ),
+                                     static_cast<float>( data[index + 2] ) );
+    }
+  };
+
+  template<>
+  struct EUTelPixelDecoder<EUTelGenericSparsePixel> {
+    static const size_t stride = 4;
+    static EUTelGenericSparsePixel decode(lcio::FloatVec const & data, size_t index) {
+      return EUTelGenericSparsePixel( static_cast<short>( data[index] ),
+                                      static_cast<short>( data[index + 1] ),
+                                      static_cast<float>( data[index + 2] ),
+                                      static_cast<short>( data[index + 3] ) );
+    }
+  };
+
+  template<>
+  struct EUTelPixelDecoder<EUTelGeometricPixel> {
+    static const size_t stride = 8;
+    static EUTelGeometricPixel decode(lcio::FloatVec const & data, size_t index) {
+      return EUTelGeometricPixel( static_cast<short>( data[index] ),
+                                  static_cast<short>( data[index + 1] ),
+                                  static_cast<float>( data[index + 2] ),
+                                  static_cast<short>( data[index + 3] ),
+                                  data[index + 4],
+                                  data[index + 5],
+                                  data[index + 6],
+                                  data[index + 7] );
+    }
+  };
+
+  template<>
+  struct EUTelPixelDecoder<EUTelMuPixel> {
+    static const size_t stride = 7;
+    static EUTelMuPixel decode(lcio::FloatVec const & data, size_t index) {
+      return EUTelMuPixel( static_cast<short>( data[index] ),
+                           static_cast<short>( data[index + 1] ),
+                           static_cast<float>( data[index + 2] ),
+                           static_cast<short>( data[index + 3] ),
+                           static_cast<short>( data[index + 4] ),
+                           static_cast<long long unsigned>( data[index + 5] ) |
+                           static_cast<long long unsigned>( data[index + 6] ) << 32 );
+    }
+  };
+
+  //! Non owning, read only view of the pixels of a TrackerData
+  /*! Contrary to EUTelTrackerDataInterfacerImpl, nothing is copied nor
+   *  allocated: the pixels are decoded from the charge values while
+   *  iterating and there is no virtual call. This is the preferred way
+   *  to read sparse data, the interfacer is only needed to write them.
+   *
+   *  The TrackerData must outlive the view and must not be modified
+   *  while iterating.
+   *
+   *  @code
+   *  EUTelPixelView<EUTelGenericSparsePixel> pixels( zsData );
+   *  for ( auto const & pixel: pixels ) pixel.getXCoord();
+   *  @endcode
+   */
+  template<class PixelType>
+  class EUTelPixelView {
+
+  public:
+
+    //! Forward iterator decoding one pixel at a time
+    class const_iterator : public std::iterator<std::forward_iterator_tag, PixelType> {
+    public:
+      const_iterator(lcio::FloatVec const & data, size_t index): _data(&data), _index(index), _pixel() { }
+
+      PixelType const & operator*() const {
+        _pixel = EUTelPixelDecoder<PixelType>::decode( *_data, _index );
+        return _pixel;
+      }
+
+      PixelType const * operator->() const { return &( operator*() ); }
+
+      const_iterator & operator++() {
+        _index += EUTelPixelDecoder<PixelType>::stride;
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        const_iterator old( *this );
+        _index += EUTelPixelDecoder<PixelType>::stride;
+        return old;
+      }
+
+      bool operator==(const_iterator const & other) const { return _index == other._index; }
+      bool operator!=(const_iterator const & other) const { return _index != other._index; }
+
+    private:
+      lcio::FloatVec const * _data;
+      size_t _index;
+      mutable PixelType _pixel;
+    };
+
+    //! View over the charge values of a TrackerData
+    explicit EUTelPixelView(IMPL::TrackerDataImpl const * data): _data( data->getChargeValues() ) { }
+
+    //! View over charge values
+    explicit EUTelPixelView(lcio::FloatVec const & data): _data( data ) { }
+
+    //! The number of pixels
+    size_t size() const { return _data.size() / EUTelPixelDecoder<PixelType>::stride; }
+
+    //! True if there is no pixel
+    bool empty() const { return size() == 0; }
+
+    //! The first pixel
+    const_iterator begin() const { return const_iterator( _data, 0 ); }
+
+    //! Past the last pixel
+    const_iterator end() const { return const_iterator( _data, size() * EUTelPixelDecoder<PixelType>::stride ); }
+
+    //! Decode the i-th pixel (non range checked)
+    PixelType operator[](size_t i) const { return EUTelPixelDecoder<PixelType>::decode( _data, i * EUTelPixelDecoder<PixelType>::stride ); }
+
+  private:
+    //! The charge values holding the pixels
+    lcio::FloatVec const & _data;
+  };
+
+  namespace pixelview {
+
+    //! Call the function for one pixel, false if it asks to stop
+    template<class Function, class PixelType>
+    auto visit(Function & function, PixelType const & pixel, int) -> decltype( bool( function( pixel ) ) ) {
+      return function( pixel );
+    }
+
+    //! Functions returning nothing never stop the iteration
+    template<class Function, class PixelType>
+    bool visit(Function & function, PixelType const & pixel, long) {
+      function( pixel );
+      return true;
+    }
+
+    //! Call the function for the pixels of a range until it asks to stop
+    template<class Range, class Function>
+    void visitAll(Range const & pixels, Function & function) {
+      for( auto const & pixel: pixels ) {
+        if( !visit( function, pixel, 0 ) ) break;
+      }
+    }
+
+  }
+
+  //! Call a function for every pixel of a TrackerData
+  /*! The pixel type is resolved once, then the function is called with
+   *  the concrete pixel type (as a const reference) for each pixel,
+   *  without virtual calls nor copies of the pixel collection. The
+   *  function has to accept all the pixel types, e.g. a generic lambda
+   *  or a function taking EUTelBaseSparsePixel const &.
+   *
+   *  If the function returns a bool, the iteration stops at the first
+   *  pixel for which it returns false.
+   *
+   *  @return false if the pixel type is unknown
+   */
+  template<class Function>
+  bool forEachPixel(IMPL::TrackerDataImpl const * data, SparsePixelType type, Function && function) {
+    switch( type ) {
+      case kEUTelSimpleSparsePixel:
+        pixelview::visitAll( EUTelPixelView<EUTelSimpleSparsePixel>( data ), function );
+        return true;
+      case kEUTelGenericSparsePixel:
+        pixelview::visitAll( EUTelPixelView<EUTelGenericSparsePixel>( data ), function );
+        return true;
+      case kEUTelGeometricPixel:
+        pixelview::visitAll( EUTelPixelView<EUTelGeometricPixel>( data ), function );
+        return true;
+      case kEUTelMuPixel:
+        pixelview::visitAll( EUTelPixelView<EUTelMuPixel>( data ), function );
+        return true;
+      case kEUTelPackedGenericPixel:
+        pixelview::visitAll( EUTelPackedSparseData( data->getChargeValues() ), function );
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  //! Call a function for every pixel of a generic pixel storage
+  /*! As forEachPixel, restricted to kEUTelGenericSparsePixel and
+   *  kEUTelPackedGenericPixel, so that the function may take
+   *  EUTelGenericSparsePixel const & and read the time of the pixels.
+   *
+   *  @return false if the data are not stored as generic pixels
+   */
+  template<class Function>
+  bool forEachGenericPixel(IMPL::TrackerDataImpl const * data, SparsePixelType type, Function && function) {
+    switch( type ) {
+      case kEUTelGenericSparsePixel:
+        pixelview::visitAll( EUTelPixelView<EUTelGenericSparsePixel>( data ), function );
+        return true;
+      case kEUTelPackedGenericPixel:
+        pixelview::visitAll( EUTelPackedSparseData( data->getChargeValues() ), function );
+        return true;
+      default:
+        return false;
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * File:   EUTelPlaneTransform.h
+ *
+ */
+#ifndef EUTELPLANETRANSFORM_H
+#define	EUTELPLANETRANSFORM_H
+
+// C++
+#include <array>
+#include <cstddef>
+
+/** Batched coordinate transformations with the flat local to master
+ * transformation of a plane: the row-major rotation matrix followed by the
+ * translation. All functions act on nPoints consecutive (x,y,z) triplets,
+ * input and output may alias. They are shared by
+ * EUTelGeometryTelescopeGeoDescription and EUTelGeometrySnapshot.
+ */
+namespace eutelescope {
+namespace geo {
+namespace planetransform {
+
+inline void local2Master( std::array<double,12> const & m, const double localPos[], double globalPos[], size_t nPoints ) {
+	for( size_t i = 0; i < 3*nPoints; i += 3 ) {
+		double const x = localPos[i], y = localPos[i+1], z = localPos[i+2];
+		globalPos[i]   = m[0]*x + m[1]*y + m[2]*z + m[9];
+		globalPos[i+1] = m[3]*x + m[4]*y + m[5]*z + m[10];
+		globalPos[i+2] = m[6]*x + m[7]*y + m[8]*z + m[11];
+	}
+}
+
+inline void master2Local( std::array<double,12> const & m, const double globalPos[], double localPos[], size_t nPoints ) {
+	for( size_t i = 0; i < 3*nPoints; i += 3 ) {
+		double const x = globalPos[i]-m[9], y = globalPos[i+1]-m[10], z = globalPos[i+2]-m[11];
+		localPos[i]   = m[0]*x + m[3]*y + m[6]*z;
+		localPos[i+1] = m[1]*x + m[4]*y + m[7]*z;
+		localPos[i+2] = m[2]*x + m[5]*y + m[8]*z;
+	}
+}
+
+inline void local2MasterVec( std::array<double,12> const & m, const double localVec[], double globalVec[], size_t nPoints ) {
+	for( size_t i = 0; i < 3*nPoints; i += 3 ) {
+		double const x = localVec[i], y = localVec[i+1], z = localVec[i+2];
+		globalVec[i]   = m[0]*x + m[1]*y + m[2]*z;
+		globalVec[i+1] = m[3]*x + m[4]*y + m[5]*z;
+		globalVec[i+2] = m[6]*x + m[7]*y + m[8]*z;
+	}
+}
+
+inline void master2LocalVec( std::array<double,12> const & m, const double globalVec[], double localVec[], size_t nPoints ) {
+	for( size_t i = 0; i < 3*nPoints; i += 3 ) {
+		double const x = globalVec[i], y = globalVec[i+1], z = globalVec[i+2];
+		localVec[i]   = m[0]*x + m[3]*y + m[6]*z;
+		localVec[i+1] = m[1]*x + m[4]*y + m[7]*z;
+		localVec[i+2] = m[2]*x + m[5]*y + m[8]*z;
+	}
+}
+
+} // namespace planetransform
+} // namespace geo
+} // namespace eutelescope
+#endif	/* EUTELPLANETRANSFORM_H */
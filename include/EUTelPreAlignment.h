@@ -11,6 +11,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelReferenceHit.h"
+#include "EUTelHotPixelMask.h"
 
 //ROOT includes
 #include "TVector3.h"
@@ -131,7 +132,7 @@ namespace eutelescope {
     virtual bool hitContainsHotPixels( TrackerHitImpl   * hit) ;
 
     //! Called for first event per run
-    /*! Reads hotpixel information from hotPixelCollection into hotPixelMap
+    /*! Reads hotpixel information from hotPixelCollection into the hot pixel mask
      * to be used in the sensor exclusion area logic 
      */
     virtual void  FillHotPixelMap(LCEvent *event);
@@ -143,14 +144,11 @@ namespace eutelescope {
      */
     std::string _hotPixelCollectionName;
 
-    //! map of vectors, keeps record of hit pixels 
-    /*! 
-     *  For each Detector a vector is stored in a map.
-     *  Each vector holds pairs of integers (representing X and Y pixel array positions).
-     *  If an element (i.e. the X and Y position of a pixel) is present in the vector,
-     *  this indicates that the corresponding pixel was marked "hot"
+    //! Hot pixel mask
+    /*! Filled from the hot pixel collection at the first event, hits
+     *  containing a hot pixel are ignored in the correlation.
      */
-    std::map<int, std::vector<std::pair<short, short> > > _hotPixelMap;
+    EUTelHotPixelMask _hotPixelMask;
  
     //! How many events are needed to get reasonable correlation plots 
     /*! (and Offset DB values) 
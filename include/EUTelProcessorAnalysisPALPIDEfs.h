@@ -22,6 +22,7 @@
 #include "TH2.h"
 #include "TProfile2D.h"
 #include "cluster.h"
+#include "EUTelAssignmentSolver.h"
 #include "CrossSection.hpp"
 
 class EUTelProcessorAnalysisPALPIDEfs : public marlin::Processor {
@@ -97,6 +98,9 @@ protected:
   std::map<int,int> xPairs;
   std::map<int,int> yPairs;
   std::vector< std::vector<int> > symmetryGroups;
+  Cluster::ShapeIndex clusterShapeIndex;
+  std::vector<int> clusterShapeGroup;
+  eutelescope::EUTelAssignmentSolver _assignmentSolver;
   double zDistance;
   int _nEvents;
   int _nEventsFake;
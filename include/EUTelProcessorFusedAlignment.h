@@ -0,0 +1,198 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+// built only if USE_GEAR
+#if defined(USE_GEAR)
+#ifndef EUTELPROCESSORFUSEDALIGNMENT_H
+#define EUTELPROCESSORFUSEDALIGNMENT_H
+
+// eutelescope includes ".h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerHitImpl.h>
+#include <IMPL/LCCollectionVec.h>
+
+// ROOT includes
+#include "TRotation.h"
+#include "TVector3.h"
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Apply a chain of alignment collections in a single pass
+  /*! This processor replaces a chain of EUTelApplyAlignmentProcessor
+   *  instances (gear, prealignment, alignment, alignment2, ...). At
+   *  the first event of each run, the alignment collections are
+   *  composed into a single affine transform per sensor
+   *
+   *  x' = R x + t
+   *
+   *  together with its inverse. Each hit is then transformed once and
+   *  a single output collection is written, instead of one copy of the
+   *  hit collection per alignment step.
+   *
+   *  <h4>Input collections</h4>
+   *  <br><b>InputHit</b>.
+   *  The collection of TrackerHit to be aligned.
+   *
+   *  <br><b>AlignmentCollectionNames</b>.
+   *  The EUTelAlignmentConstant collections, in the order in which
+   *  they have to be applied. The special name <b>gear</b> stands for
+   *  the plane rotations of the GEAR file, as in
+   *  EUTelApplyAlignmentProcessor.
+   *
+   *  <br><b>ReferenceCollection</b>.
+   *  The EUTelReferenceHit collection giving the sensor centres around
+   *  which the rotations are done. As for the chained processors, the
+   *  centres are shifted by the offsets of each step before the next
+   *  one. If the collection is not available, the rotations are done
+   *  around the origin.
+   *
+   *  <h4>Output</h4>
+   *  <br><b>OutputHit</b>.
+   *  The collection of TrackerHit with all the steps applied (direct)
+   *  or undone (reverse).
+   *
+   *  @param CorrectionMethod 0 for shifts only, 1 for rotation first.
+   *
+   *  @param ApplyAlignmentDirection 0 to apply the chain, 1 to undo
+   *  it. Reverse is the exact inverse of direct: undoing the chain on
+   *  aligned hits gives back the input hits.
+   *
+   *  @param IntermediateHitCollectionNames For debugging only. If not
+   *  empty, one name for each step but the last: the hit collection
+   *  after each step is written as well.
+   */
+  class EUTelProcessorFusedAlignment : public marlin::Processor {
+
+  public:
+
+    //! Returns a new instance of EUTelProcessorFusedAlignment
+    /*! This method returns an new instance of the this processor.  It
+     *  is called by Marlin execution framework and it shouldn't be
+     *  called/used by the final user.
+     *
+     *  @return a new EUTelProcessorFusedAlignment.
+     */
+    virtual Processor * newProcessor() {
+      return new EUTelProcessorFusedAlignment;
+    }
+
+    //! Default constructor
+    EUTelProcessorFusedAlignment ();
+
+    //! Called at the job beginning.
+    /*! It checks the consistency of the steering parameters.
+     */
+    virtual void init ();
+
+    //! Called for every run.
+    /*! The transforms are composed again at the first event of the
+     *  run, since the alignment constants may change with the run.
+     *
+     *  @param run the LCRunHeader of the this current run
+     */
+    virtual void processRunHeader (LCRunHeader * run);
+
+    //! Called every event
+    /*! Composes the transforms on the first event of a run and applies
+     *  them to the input hits.
+     *
+     *  @param evt the current LCEvent event as passed by the
+     *  ProcessMgr
+     */
+    virtual void processEvent (LCEvent * evt);
+
+    //! Called after data processing.
+    virtual void end();
+
+  protected:
+
+    //! An affine transform x' = rotation * x + translation
+    struct AffineTransform {
+      TRotation rotation;
+      TVector3 translation;
+
+      //! The transform applying first other, then this one
+      AffineTransform after(AffineTransform const & other) const;
+
+      //! The inverse transform
+      AffineTransform inverse() const;
+    };
+
+    //! The transforms of all the sensors for one output collection
+    /*! Indexed by sensor ID, sensors without any constant keep the
+     *  identity.
+     */
+    typedef std::vector<AffineTransform > SensorTransforms;
+
+    //! Compose the alignment steps found in the event
+    /*! @throw DataNotAvailableException if an alignment collection is
+     *  missing
+     */
+    void composeTransforms(LCEvent * event);
+
+    //! The transforms of one alignment collection for every sensor
+    /*! The reference positions are updated with the offsets of the
+     *  step, as the chained processors do with their output reference
+     *  hit collections.
+     */
+    SensorTransforms getStepTransforms(LCEvent * event, std::string const & alignmentCollectionName, std::vector<TVector3 > & referencePositions) const;
+
+    //! The transforms of the GEAR plane rotations
+    SensorTransforms getGearTransforms() const;
+
+    //! Transform all the hits of the input collection
+    IMPL::LCCollectionVec * transformHits(IMPL::LCCollectionVec * inputCollection, SensorTransforms const & transforms) const;
+
+    //! Input collection name.
+    std::string _inputHitCollectionName;
+
+    //! Output collection name.
+    std::string _outputHitCollectionName;
+
+    //! The alignment collections, in the order they are applied
+    std::vector<std::string > _alignmentCollectionNames;
+
+    //! The reference hit collection name
+    std::string _referenceHitCollectionName;
+
+    //! The intermediate hit collections, only for debugging
+    std::vector<std::string > _intermediateHitCollectionNames;
+
+    //! Correction method, 0 for shifts only, 1 for rotation first
+    int _correctionMethod;
+
+    //! 0 to apply the alignment, 1 to undo it
+    int _applyAlignmentDirection;
+
+    //! The transforms of the intermediate collections and of the output, the last one
+    std::vector<SensorTransforms > _stageTransforms;
+
+    //! True until the transforms are composed for the current run
+    bool _isFirstEvent;
+
+    //! Current run number.
+    int _iRun;
+
+    //! Current event number.
+    int _iEvt;
+  };
+
+  //! A global instance of the processor
+  EUTelProcessorFusedAlignment gEUTelProcessorFusedAlignment;
+
+}
+#endif
+#endif // GEAR
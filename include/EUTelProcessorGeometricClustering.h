@@ -13,6 +13,9 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelPixelGeometryTable.h"
+#include "EUTelClusterFinder.h"
+#include "EUTelThreadPool.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -30,6 +33,7 @@
 
 // lcio includes <.h>
 #include <IMPL/TrackerRawDataImpl.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
@@ -37,6 +41,8 @@
 #include <map>
 #include <cmath>
 #include <vector>
+#include <memory>
+#include <utility>
 
 namespace eutelescope {
 
@@ -56,6 +62,10 @@ namespace eutelescope {
    *  in single precision, the code accounts for uncertainty by allowing
    *  a 1% deviation.
    *
+   *  The pixel positions and dimensions are read once during init()
+   *  into a per-sensor EUTelPixelGeometryTable, thus the clustering
+   *  itself does not require any TGeo navigation.
+   *
    *  Given that the proximity is well defined, no additional arguments
    *  must be provided. If wanted, a time cut can be set. This will also
    *  require hits to be temporally in promximity. If not set not cut will
@@ -89,6 +99,15 @@ namespace eutelescope {
    *  @param HistoInfoFileName This is the name of the XML file
    *  containing the histogram booking information.
    *
+   *  @param ClusteringEngine The EUTelClusterFinder engine used to
+   *  group the hits, either Iterative or Sweep. Both produce the same
+   *  clusters, Sweep scales better with the number of hits.
+   *
+   *  @param NumberOfThreads The number of threads clustering the
+   *  sensor planes of an event concurrently. 1 (default) clusters
+   *  serially, 0 uses all available cores. The output does not
+   *  depend on this setting.
+   *
    */
 
 class EUTelProcessorGeometricClustering :public marlin::Processor , public marlin::EventModifier {
@@ -300,6 +319,48 @@ private:
      */
     std::vector<int > _ExcludedPlanes;
 
+    //! Pixel geometry tables
+    /*! Map correlating the sensorID with the table holding the
+     *  position and dimensions of all its pixels. Planes sharing
+     *  the same pixel geometry description share the same table.
+     */
+    std::map<int, std::shared_ptr<geo::EUTelPixelGeometryTable const> > _pixelGeometryTables;
+
+    //! Name of the clustering engine as set in the steering file
+    std::string _clusteringEngineName;
+
+    //! The clustering engine used by the EUTelClusterFinder
+    EUTelClusterFinder::Engine _clusteringEngine;
+
+    //! Number of threads used to cluster the planes of an event
+    int _nThreads;
+
+    //! The pool executing the per plane clustering
+    std::unique_ptr<EUTelThreadPool> _threadPool;
+
+    //! Input and output of the clustering of one sensor plane
+    struct PlaneClusters {
+      TrackerDataImpl* zsData;
+      int sensorID;
+      SparsePixelType type;
+      geo::EUTelPixelGeometryTable const * pixelGeometry;
+      //! Number of hit pixels in the input
+      size_t nPixels;
+      //! Hit pixels outside of the pixel matrix, they are ignored
+      std::vector<std::pair<short,short> > skippedPixels;
+      //! The found clusters in the order of the EUTelClusterFinder
+      std::vector<std::unique_ptr<TrackerDataImpl> > clusters;
+      //! The total charge of each cluster
+      std::vector<float> charges;
+    };
+
+    //! Find the clusters of a single plane
+    /*! This method only reads the input data of the given plane, its
+     *  pixel geometry table and the steering parameters, thus it can
+     *  be executed concurrently for different planes.
+     */
+    void findPlaneClusters(PlaneClusters & plane) const;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     //! Map for pointer to cluster signal histograms.
     std::map<int,AIDA::IBaseHistogram*> _clusterSignalHistos;
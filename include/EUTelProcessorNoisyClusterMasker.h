@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelHotPixelMask.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -142,8 +143,8 @@ class EUTelProcessorNoisyClusterMasker : public marlin::Processor {
 	/*! False is everything is OK, true otherwise */
 	bool  _wrongDataFormat;
 
-	//! Map linking the noise vectors of each plane to the plane ID
-	std::map<int, std::vector<int> > _noisyPixelMap;
+	//! Mask of the noisy pixels of all planes
+	EUTelHotPixelMask _noisyPixelMask;
 
 	//! Map counting the removed hot pixels per plane
 	std::map<int, int> _maskedNoisyClusters;
@@ -11,6 +11,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
+#include "EUTelHotPixelMask.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -98,7 +99,8 @@ class EUTelProcessorNoisyPixelRemover : public marlin::Processor {
 	//! Collection name for noisy pixel collection
 	std::string _noisyPixelCollectionName; 
 	
-	std::map<int, std::vector<int>> _noisyPixelMap;
+	//! Mask of the noisy pixels, read at the first event
+	EUTelHotPixelMask _noisyPixelMask;
 	bool _firstEvent = true;
 };
 
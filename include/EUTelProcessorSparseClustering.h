@@ -13,6 +13,9 @@
 // eutelescope includes ".h"
 #include "EUTelExceptions.h"
 #include "EUTELESCOPE.h"
+#include "EUTelClusterFinder.h"
+#include "EUTelThreadPool.h"
+#include "EUTelClusterSummary.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -30,6 +33,7 @@
 
 // lcio includes <.h>
 #include <IMPL/TrackerRawDataImpl.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
@@ -37,6 +41,7 @@
 #include <map>
 #include <cmath>
 #include <vector>
+#include <memory>
 
 namespace eutelescope {
 
@@ -89,6 +94,15 @@ namespace eutelescope {
    *  @param HistoInfoFileName This is the name of the XML file
    *  containing the histogram booking information.
    *
+   *  @param ClusteringEngine The EUTelClusterFinder engine used to
+   *  group the hits, either Iterative or Sweep. Both produce the same
+   *  clusters, Sweep scales better with the number of hits.
+   *
+   *  @param NumberOfThreads The number of threads clustering the
+   *  sensor planes of an event concurrently. 1 (default) clusters
+   *  serially, 0 uses all available cores. The output does not
+   *  depend on this setting.
+   *
    */
 
 class EUTelProcessorSparseClustering :public marlin::Processor , public marlin::EventModifier {
@@ -348,6 +362,38 @@ private:
  
     //! Squared cut value for distance in pixel index count (integer!)
     int _sparseMinDistanceSquared;
+
+    //! Name of the clustering engine as set in the steering file
+    std::string _clusteringEngineName;
+
+    //! The clustering engine used by the EUTelClusterFinder
+    EUTelClusterFinder::Engine _clusteringEngine;
+
+    //! Number of threads used to cluster the planes of an event
+    int _nThreads;
+
+    //! The pool executing the per plane clustering
+    std::unique_ptr<EUTelThreadPool> _threadPool;
+
+    //! Input and output of the clustering of one sensor plane
+    struct PlaneClusters {
+      TrackerDataImpl* zsData;
+      int sensorID;
+      SparsePixelType type;
+      //! The pixel type of the clusters, packed pixels are stored unpacked
+      SparsePixelType clusterType;
+      //! The found clusters in the order of the EUTelClusterFinder
+      std::vector<std::unique_ptr<TrackerDataImpl>> clusters;
+      //! The summary of each found cluster
+      std::vector<EUTelClusterSummary> summaries;
+    };
+
+    //! Find the clusters of a single plane
+    /*! This method only reads the input data of the given plane and
+     *  the steering parameters, thus it can be executed concurrently
+     *  for different planes.
+     */
+    void findPlaneClusters(PlaneClusters & plane) const;
 };
 
 //! A global instance of the processor
@@ -17,6 +17,7 @@
 #include "EUTelBaseSparsePixel.h"
 #include "EUTelGenericSparsePixel.h"
 #include "EUTelExceptions.h"
+#include "EUTelClusterChargeProfile.h"
 
 #ifdef USE_MARLIN
 // marling includes ".h"
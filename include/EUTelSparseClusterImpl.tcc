@@ -308,54 +308,37 @@ namespace eutelescope {
   template<class PixelType>
   float EUTelSparseClusterImpl<PixelType>::getClusterCharge(int nPixel) const {
 
-
     if ( static_cast<unsigned int> (nPixel) >= this->size() ) {
       return getTotalCharge();
     }
-
-    std::vector<float > allSignals;
-   
-    auto& pixelVec = this->getPixels();
-    for( auto& pixel: pixelVec ) {
-      allSignals.push_back( pixel.getSignal() );
-    }
-
-    std::vector<float >::iterator iter = allSignals.begin();
-    sort( allSignals.begin(), allSignals.end(), std::greater<float>() );
-
-    float charge = 0;
-    while ( iter != allSignals.begin() + nPixel ) {
-      charge += *(iter);
-      ++iter;
-    }
-    return charge;
+    return getClusterCharge( std::vector<int >( 1, nPixel ) ).front();
   }
 
   template<class PixelType>
   std::vector<float > EUTelSparseClusterImpl<PixelType>::getClusterCharge(std::vector<int > nPixels) const {
     
-    std::vector<float > clusterSignal;
-    std::vector<float > allSignals;
-    
+    EUTelClusterChargeProfile profile;
     auto& pixelVec = this->getPixels();
+    profile.reserve( pixelVec.size() );
     for( auto& pixel: pixelVec ) {
-      allSignals.push_back( pixel.getSignal() );
+      profile.addPixel( pixel.getXCoord(), pixel.getYCoord(), pixel.getSignal() );
     }
+    return profile.getHighestCharges( nPixels );
+  }
 
-    sort( allSignals.begin(), allSignals.end(), std::greater<float>() );
-    std::vector<float >::iterator iter;
-    
-    for (size_t i = 0; i < nPixels.size(); i++ ) {
-      iter = allSignals.begin();
-      float charge = 0;
-      while ( iter != allSignals.begin() + nPixels[i]
-            && iter != allSignals.end() ) {//add or for allsignals.end
-	charge += (*iter);
-	++iter;
-      }
-      clusterSignal.push_back(charge);
+  template<class PixelType>
+  std::vector<float > EUTelSparseClusterImpl<PixelType>::getClusterChargeNxN(std::vector<int > nxnSizes) const {
+
+    int xSeed, ySeed;
+    getSeedCoord(xSeed, ySeed);
+
+    EUTelClusterChargeProfile profile;
+    auto& pixelVec = this->getPixels();
+    profile.reserve( pixelVec.size() );
+    for( auto& pixel: pixelVec ) {
+      profile.addPixel( pixel.getXCoord(), pixel.getYCoord(), pixel.getSignal() );
     }
-    return clusterSignal;
+    return profile.getWindowCharges( xSeed, ySeed, nxnSizes );
   }
 
   template<class PixelType> 
@@ -78,6 +78,10 @@ namespace eutelescope {
     /*! This methods reads the input ASCII file, produced by the
      *  SUCIMA Imager DAQ and converts it into a LCIO file with a run
      *  header and the event structure.
+     *
+     *  The data files are memory mapped (see EUTelMappedFile) and the
+     *  records are decoded in place, while the next record is
+     *  prefetched.
      */
     virtual void readDataSource (int numEvents);
 
@@ -88,7 +92,8 @@ namespace eutelescope {
     virtual void init ();
 
     //! End method
-    /*! It deletes the EUTelStrasMimoTelReader::_buffer array
+    /*! It just prints a message, each data file is unmapped as soon
+     *  as it is converted.
      */
     virtual void end ();
 
@@ -345,14 +350,6 @@ namespace eutelescope {
 
   protected:
 
-    //! Data block
-    /*! This is used to read the data block in between the event
-     *  header and the trailer. It has a size that is variable and
-     *  defined once forever in the StrasRunHeader::DataSz.
-     *
-     */ 
-    int * _dataBuffer;
-
     //! Input run number
     /*! This is the run number and it is read directly from the
      *  steering file. This number is used as a replacement of the
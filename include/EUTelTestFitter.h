@@ -194,6 +194,25 @@ namespace eutelescope {
    *        numerical precision (numbering of fit hypothesis) is no
    *        longer relevant.
    *
+   * \param BranchAndBoundSearch Flag for the branch-and-bound track
+   *        search (optional, default is false). Hit hypotheses are
+   *        built plane by plane and the \f$ \chi^{2} \f$ of the hits
+   *        selected so far is updated incrementally. As it can only
+   *        grow when further hits are added, all hypotheses sharing a
+   *        hit selection which fails the \f$ \chi^{2} \f$ cuts are
+   *        rejected at once. Only hypotheses which can pass the cuts
+   *        are fitted with the full fit, so the selected tracks are
+   *        the same as with the default search. With nominal
+   *        resolution, beam constraint and a beam slope in Y, the
+   *        incremental \f$ \chi^{2} \f$ is not the one of the fit
+   *        and all hypotheses passing the preselection are fitted.
+   *
+   * \param BranchAndBoundCheck Cross-check of the branch-and-bound
+   *        search (optional, default is false). The exhaustive search
+   *        is run on the same hits as well, events where the tracks
+   *        differ are reported and counted. For validation only, as
+   *        it costs the time of both searches.
+   *
    * \param Chi2Max Maximum \f$ \chi^{2} \f$ for accepted track fit.
    *
    * \param SearchMultipleTracks Flag for searching multiple tracks in
@@ -284,6 +303,11 @@ namespace eutelescope {
    *      telescope layers, beam tilt can be taken into account by
    *      setting parameters \e BeamSlopeX and \e BeamSlopeY
    *
+   *  \li Use the branch-and-bound search (set \e BranchAndBoundSearch
+   *      to \e true ). Bad hit combinations are then rejected as soon
+   *      as the first wrong hit is added, which helps most for large
+   *      hit multiplicities.
+   *
    *  \li Use track preselection based on slope (set \e UseSlope to \e true ).
    *      This helps a lot especially when the beam is well collimated
    *      and the energy is high (scattering in telescope planes
@@ -517,6 +541,8 @@ namespace eutelescope {
     int _allowMissingHits;
     int _allowSkipHits;
     int _maxPlaneHits;
+    bool _branchAndBoundSearch;
+    bool _branchAndBoundCheck;
 
     bool _searchMultipleTracks;
 
@@ -612,6 +638,11 @@ namespace eutelescope {
      */
     int _noOfEventWOTrack;
 
+    //! Number of events with different tracks in the two searches
+    /*! Only counted if BranchAndBoundCheck is set.
+     */
+    int _noOfBranchAndBoundMismatch;
+
     //! Total number of reconstructed tracks
     /*! This is the total number of tracks the processor was able to
      * reconstruct.
@@ -0,0 +1,107 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef EUTELTHREADPOOL_H
+#define EUTELTHREADPOOL_H
+
+// system includes <>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Minimal fixed size thread pool for data parallel work within an event
+  /*! The pool is meant for processors which have to do the same,
+   *  independent piece of work for each sensor plane of an event,
+   *  e.g. the clustering. run() executes a task for all indices
+   *  0 ... nTasks-1 and returns only once all of them are finished,
+   *  the calling thread takes part in the work.
+   *
+   *  The tasks must not touch any shared, non thread safe state.
+   *  In particular LCIO encoders and decoders as well as streamlog
+   *  have to be used before or after run(), not from within a task.
+   *
+   *  If a task throws, the remaining tasks are still executed and the
+   *  exception of the task with the lowest index is rethrown by run(),
+   *  thus the behaviour does not depend on the scheduling.
+   */
+  class EUTelThreadPool {
+
+  public:
+
+    //! Constructor
+    /*! @param nThreads The number of threads working on a run() call,
+     *  including the calling one. 1 executes all tasks serially in the
+     *  calling thread, 0 uses one thread per available core.
+     */
+    explicit EUTelThreadPool(unsigned nThreads);
+
+    //! Destructor, stops and joins all worker threads
+    ~EUTelThreadPool();
+
+    //! The number of threads working on a run() call
+    unsigned size() const { return static_cast<unsigned>( _workers.size() ) + 1; }
+
+    //! Execute task(i) for all i in [0, nTasks) and wait for them
+    void run(size_t nTasks, std::function<void(size_t)> const & task);
+
+  private:
+
+    //! Copying a pool is not supported
+    EUTelThreadPool(EUTelThreadPool const &);
+    EUTelThreadPool & operator=(EUTelThreadPool const &);
+
+    //! Main loop of the worker threads
+    void workerLoop();
+
+    //! Grab and execute tasks of the current batch until none is left
+    void work();
+
+    //! The worker threads, the caller of run() is not included
+    std::vector<std::thread> _workers;
+
+    //! Protects all members below except _nextTask
+    std::mutex _mutex;
+
+    //! Signals the workers that a new batch is available or the pool stops
+    std::condition_variable _wakeUp;
+
+    //! Signals run() that a worker left the current batch
+    std::condition_variable _done;
+
+    //! The task of the current batch, nullptr if there is none
+    std::function<void(size_t)> const * _task;
+
+    //! Number of tasks in the current batch
+    size_t _nTasks;
+
+    //! The next task index to be executed
+    std::atomic<size_t> _nextTask;
+
+    //! Number of workers currently working on the batch
+    unsigned _nActive;
+
+    //! Counter of the batches, used to wake up each worker once per batch
+    unsigned long _batch;
+
+    //! Set by the destructor to terminate the workers
+    bool _stop;
+
+    //! The exceptions thrown by the tasks, indexed by the task
+    std::vector<std::exception_ptr> _errors;
+  };
+
+}
+
+#endif
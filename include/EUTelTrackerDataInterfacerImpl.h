@@ -15,6 +15,8 @@
 #include "EUTelGenericSparsePixel.h"
 #include "EUTelGeometricPixel.h"
 #include "EUTelMuPixel.h"
+#include "EUTelPackedSparseData.h"
+#include "EUTelPixelView.h"
 #include "EUTelTrackerDataInterfacer.h"
 
 #ifdef USE_MARLIN
@@ -16,9 +16,26 @@ namespace eutelescope {
 	EUTelTrackerDataInterfacerImpl<PixelType>::EUTelTrackerDataInterfacerImpl(IMPL::TrackerDataImpl* data): 
 	_trackerData(data), 
 	_type(), 
+	_storageType(),
 	_pixelVec() {
 		auto pixel = std::make_unique<PixelType>();
 		_type = pixel->getSparsePixelType();
+		_storageType = _type;
+		_pixelVec.clear();
+		fillPixelVec();
+	}
+
+	template<class PixelType>
+	EUTelTrackerDataInterfacerImpl<PixelType>::EUTelTrackerDataInterfacerImpl(IMPL::TrackerDataImpl* data, SparsePixelType storageType): 
+	_trackerData(data), 
+	_type(), 
+	_storageType(storageType),
+	_pixelVec() {
+		auto pixel = std::make_unique<PixelType>();
+		_type = pixel->getSparsePixelType();
+		if( _storageType != _type && !( _type == kEUTelGenericSparsePixel && _storageType == kEUTelPackedGenericPixel ) ) {
+			throw std::invalid_argument( "EUTelTrackerDataInterfacerImpl: pixel type and storage type not compatible" );
+		}
 		_pixelVec.clear();
 		fillPixelVec();
 	}
@@ -178,18 +178,7 @@ namespace eutelescope {
                 const std::vector< unsigned int >&,
                 unsigned int = 0);
 
-        /*!
-         * Checks if a hit belongs to a hot-pixel-map
-         */
-
-        //! Called for first event per run
-        /*! Reads hotpixel information from hotPixelCollection into hotPixelMap
-         * to be used in the sensor exclusion area logic 
-         */
-
-
 	int cantorEncode(int X, int Y);
-	std::map<int, std::vector<int>> readNoisyPixelList(LCEvent* event, std::string const & noisyPixelCollectionName);
 	
 	std::unique_ptr<EUTelClusterDataInterfacerBase> getClusterData(IMPL::TrackerDataImpl* const data, SparsePixelType type);
 	std::unique_ptr<EUTelClusterDataInterfacerBase> getClusterData(IMPL::TrackerDataImpl* const data, int type);
@@ -197,10 +186,6 @@ namespace eutelescope {
 	std::unique_ptr<EUTelTrackerDataInterfacer> getSparseData(IMPL::TrackerDataImpl* const data, SparsePixelType type);
 	std::unique_ptr<EUTelTrackerDataInterfacer> getSparseData(IMPL::TrackerDataImpl* const data, int type);
 
-        std::map<std::string, bool > FillHotPixelMap(EVENT::LCEvent *event, const std::string& hotPixelCollectionName);
-
-        bool HitContainsHotPixels(const IMPL::TrackerHitImpl * hit, const std::map<std::string, bool >& hotPixelMap);
-
 		std::unique_ptr<EUTelVirtualCluster> GetClusterFromHit(const IMPL::TrackerHitImpl*);
 
         int getSensorIDfromHit( EVENT::TrackerHit* hit);
@@ -161,6 +161,20 @@ namespace eutelescope {
      */ 
     virtual float getClusterCharge(int xSize, int ySize) const = 0; 
 
+    //! Return the charge of several square subsets of the cluster
+    /*! Same as getClusterCharge(int, int) with xSize = ySize = N for
+     *  each given N. Implementations can override it to compute all
+     *  the windows at once.
+     *
+     *  @param nxnSizes The list of window sizes
+     *  @return The charges for each window size
+     */
+    virtual std::vector<float > getClusterChargeNxN(std::vector<int > nxnSizes) const {
+      std::vector<float > charges;
+      for ( size_t i = 0; i < nxnSizes.size(); ++i ) charges.push_back( getClusterCharge( nxnSizes[i], nxnSizes[i] ) );
+      return charges;
+    }
+
     //! Return the center of gravity shift from the seed coordinates
     /*! Having a charge distribution it is possible to calculate the
      *  charge center of gravity of the cluster. This will not
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <fstream>
 #include <map>
+#include <vector>
 #include <iterator>
 #include <string>
 #include <cmath>
@@ -244,6 +245,31 @@ namespace TDS {
     void setPointerToIntegrationStorage(TDSIntegrationStorage * val_integrationStorage);
 
 
+    //! Initialization of table-driven charge sharing (optional)
+    /*! The integrals over all pixels of the integration range are
+     *  computed once for the centres of a grid of segments of the
+     *  pixel (sub-pixel position along L and W, depth along H), with
+     *  the same approximation as for the integration storage. Each step
+     *  is then processed by table lookups: contributions of all its
+     *  integration points are summed in a dense local buffer which is
+     *  added to the pixels' charge map once per step.
+     *  <br>
+     *  The table is built for the current charge distribution
+     *  parameters, pixel sizes and integration range. It is rebuilt
+     *  automatically at the next update if any of them changes. When
+     *  enabled, the integration storage is not used.
+     *  <br>
+     *  Should be called after initializeIntegration and after setting
+     *  the pixel sizes. Building takes segmentsAlongL * segmentsAlongW
+     *  * segmentsAlongH * integMaxNumberPixelsAlongL *
+     *  integMaxNumberPixelsAlongW integrations.
+     */
+
+    void initializeChargeSharingTable(const unsigned int segmentsAlongL=10,
+                                      const unsigned int segmentsAlongW=10,
+                                      const unsigned int segmentsAlongH=10);
+
+
     //! Set maximal range along L of considered pixels during integration
     /*! Considered are integMaxNumberPixelsAlongL/2 left, the same right,
      *  integMaxNumberPixelsAlongW/2 down, the same up from the pixel
@@ -595,6 +621,35 @@ namespace TDS {
     bool useIntegrationStorage;
 
 
+    // Table-driven charge sharing
+    bool useChargeSharingTable;
+    unsigned int tableSegmentsAlongL, tableSegmentsAlongW, tableSegmentsAlongH;
+
+    // Integrals for all segments and pixels of the integration range, index
+    // (((segmentL*tableSegmentsAlongW + segmentW)*tableSegmentsAlongH + segmentH)*integMaxNumberPixelsAlongL + pixelL)*integMaxNumberPixelsAlongW + pixelW
+    std::vector<double> chargeSharingTable;
+
+    // Parameters the table was built for
+    double tableHeight, tableLambda, tableReflectedContribution, tablePixelLength, tablePixelWidth;
+    size_t tableGslCalls;
+    bool tableAddReflectedContribution;
+    std::string tableDetectorType;
+    unsigned int tableMaxNumberPixelsAlongL, tableMaxNumberPixelsAlongW;
+
+    // Dense buffer of the pixels touched by one step, and flags of touched pixels
+    std::vector<double> stepBuffer;
+    std::vector<char> stepBufferTouched;
+
+    // Compute all integrals of the table
+    void buildChargeSharingTable();
+
+    // Is the table built for the current parameters?
+    bool isChargeSharingTableValid() const;
+
+    // Add charge contribution of the integration points of a step using the table
+    void updateFromTable(const TDSStep & step, const unsigned int integStepsNumber, const double integStep, const double integChargePerStep);
+
+
     // Integration part variables (GSL - C library)
     const gsl_rng_type *gsl_T;
     gsl_rng *gsl_r;
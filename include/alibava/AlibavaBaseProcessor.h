@@ -12,6 +12,9 @@
 // alibava includes ".h"
 #include "ALIBAVA.h"
 
+// eutelescope includes ".h"
+#include "EUTelExceptions.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 
@@ -28,9 +31,58 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <map>
+#include <utility>
 
 namespace alibava {
 	
+	//! Typed histogram pointers addressed by chip and channel
+	/*! The histograms are booked and stored in the root object map
+	 *  once, then their pointers are kept here so that filling them
+	 *  does not need to build their names, to look them up in the map
+	 *  and to cast them for every channel of every event.
+	 *  Histograms booked once per chip use channel 0.
+	 *
+	 *  Unknown chips and channels, and entries not set, give a null
+	 *  pointer.
+	 */
+	template <class T>
+	class AlibavaHistogramRegistry {
+		
+	public:
+		AlibavaHistogramRegistry() { clear(); }
+		
+		// sets all the entries to null
+		void clear() {
+			for (int ichip=0; ichip<ALIBAVA::NOOFCHIPS; ichip++)
+				for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++)
+					_histos[ichip][ichan] = 0;
+		}
+		
+		// stores the histogram of a channel
+		void set(int ichip, int ichan, T * histo) {
+			if (isValid(ichip, ichan)) _histos[ichip][ichan] = histo;
+		}
+		
+		// stores the histogram of a chip
+		void set(int ichip, T * histo) { set(ichip, 0, histo); }
+		
+		// returns the histogram of a channel
+		T * get(int ichip, int ichan) const {
+			return isValid(ichip, ichan) ? _histos[ichip][ichan] : 0;
+		}
+		
+		// returns the histogram of a chip
+		T * get(int ichip) const { return get(ichip, 0); }
+		
+	private:
+		bool isValid(int ichip, int ichan) const {
+			return ichip >= 0 && ichip < ALIBAVA::NOOFCHIPS && ichan >= 0 && ichan < ALIBAVA::NOOFCHANNELS;
+		}
+		
+		T * _histos[ALIBAVA::NOOFCHIPS][ALIBAVA::NOOFCHANNELS];
+	};
+	
 	//! Pedestal and noise  processor for Marlin.
 	
 	
@@ -59,6 +111,35 @@ namespace alibava {
 		// checks if the root object exists in _rootObjectMap
 		bool doesRootObjectExists(std::string aHistoName);
 		
+		// stores a newly booked root object in _rootObjectMap and returns it
+		// if an object of the same type is already stored with this name, the
+		// new one is deleted and the stored one is returned instead, so only
+		// the returned pointer may be used after the call. An object of another
+		// type stored with this name is an error, the new one is deleted
+		template <class T>
+		T * registerRootObject(std::string aHistoName, T * object) {
+			std::pair<std::map<std::string, TObject*>::iterator, bool> inserted =
+				_rootObjectMap.insert(std::make_pair(aHistoName, static_cast<TObject*>(object)));
+			if (inserted.second) return object;
+			
+			T * existing = dynamic_cast<T*>(inserted.first->second);
+			if (existing == 0) {
+				delete object;
+				streamlog_out ( ERROR5 ) << "A root object of another type is already registered as " << aHistoName << std::endl;
+				throw eutelescope::InvalidParameterException("Root object name registered with another type: " + aHistoName);
+			}
+			if (existing != object) delete object;
+			return existing;
+		}
+		
+		// returns the root object of _rootObjectMap with this name and type, null if there is none
+		// meant to fill an AlibavaHistogramRegistry after booking, not to be used per event
+		template <class T>
+		T * findRootObject(std::string aHistoName) const {
+			std::map<std::string, TObject*>::const_iterator it = _rootObjectMap.find(aHistoName);
+			return it != _rootObjectMap.end() ? dynamic_cast<T*>(it->second) : 0;
+		}
+		
 		
 		///////////////////////////
 		// Input/Output Collection
@@ -91,8 +172,8 @@ namespace alibava {
 		void setPedestalCollectionName(std::string pedestalCollectionName);
 		std::string getPedestalCollectionName();
 
-		// to access the pedestal values of a chip
-		EVENT::FloatVec getPedestalOfChip(int chipnum);
+		// to access the pedestal values of a chip, empty if they are not set
+		const EVENT::FloatVec & getPedestalOfChip(int chipnum);
 		
 		// to access the pedestal value of a channel
 		float getPedestalAtChannel(int chipnum, int channum);
@@ -104,8 +185,8 @@ namespace alibava {
 		void setNoiseCollectionName(std::string noiseCollectionName);
 		std::string getNoiseCollectionName();
 				
-		// to access the noise values of a chip
-		EVENT::FloatVec getNoiseOfChip(int chipnum);
+		// to access the noise values of a chip, empty if they are not set
+		const EVENT::FloatVec & getNoiseOfChip(int chipnum);
 		
 		// to access the noise value of a channel
 		float getNoiseAtChannel(int chipnum, int channum);
@@ -125,8 +206,8 @@ namespace alibava {
 		void setChargeCalCollectionName(std::string chargeCalCollectionName);
 		std::string getChargeCalCollectionName();
 
-		// to access the chargeCal values of a chip
-		EVENT::FloatVec getChargeCalOfChip(int chipnum);
+		// to access the chargeCal values of a chip, empty if they are not set
+		const EVENT::FloatVec & getChargeCalOfChip(int chipnum);
 		
 		// to access the chargeCal value of a channel
 		float getChargeCalAtChannel(int chipnum, int channum);
@@ -263,14 +344,21 @@ namespace alibava {
 		
 		
 		
+		// the values are not copied, these maps point to the
+		// content of the files shared by all the processors through
+		// AlibavaPedNoiCalIOManager::getPedNoiCalViewForChip
+		
 		// a map to store pedestal values for chips
-		std::map<int , EVENT::FloatVec > _pedestalMap;
+		std::map<int , const EVENT::FloatVec * > _pedestalMap;
 		
 		// a map to store noise values for chips
-		std::map<int , EVENT::FloatVec > _noiseMap;
+		std::map<int , const EVENT::FloatVec * > _noiseMap;
 		
 		// a map to store charge calibration values for chips
-		std::map<int , EVENT::FloatVec > _chargeCalMap;
+		std::map<int , const EVENT::FloatVec * > _chargeCalMap;
+		
+		// returns the values of a chip in one of the maps above, empty if there are none
+		const EVENT::FloatVec & getValuesOfChip(const std::map<int , const EVENT::FloatVec * > & valueMap, int chipnum) const;
 
 		
 		bool _isPedestalValid;
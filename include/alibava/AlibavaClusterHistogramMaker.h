@@ -20,6 +20,8 @@
 
 // ROOT includes <>
 #include "TObject.h"
+class TH1D;
+class TProfile;
 
 // system includes <>
 #include <string>
@@ -183,6 +185,22 @@ namespace alibava {
 
 		// Eta vs Cluster size
 		std::string _etaVSClusterSize;
+		
+		/////////////////////////////////////////
+		// Histograms, resolved in bookHistos() //
+		/////////////////////////////////////////
+		
+		// resolves the histograms created from the XML file
+		void resolveHistos();
+		
+		TH1D * _maskedEventsHisto;
+		AlibavaHistogramRegistry<TH1D> _etaHistos;
+		// eta histograms indexed by cluster size, 2 to 5, and 6 for larger clusters
+		AlibavaHistogramRegistry<TH1D> _etaHistosPerClusterSize;
+		AlibavaHistogramRegistry<TH1D> _clusterSizeHistos;
+		AlibavaHistogramRegistry<TH1D> _hitAmplitudeHistos;
+		AlibavaHistogramRegistry<TProfile> _etaVSCoGHistos;
+		AlibavaHistogramRegistry<TProfile> _etaVSClusterSizeHistos;
 	};
 	
 	//! A global instance of the processor
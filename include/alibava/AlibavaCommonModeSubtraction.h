@@ -20,6 +20,7 @@
 
 // ROOT includes <>
 #include "TObject.h"
+class TH1D;
 
 // system includes <>
 #include <string>
@@ -172,6 +173,12 @@ namespace alibava {
 		 *  returns a name
 		 */
 		std::string getSignalCorrectionName();
+		
+		//! The channel histograms, resolved in bookHistos()
+		AlibavaHistogramRegistry<TH1D> _chanDataHistos;
+		
+		//! The signal correction histogram, resolved in bookHistos()
+		TH1D * _signalCorrectionHisto;
 	
 
 	};
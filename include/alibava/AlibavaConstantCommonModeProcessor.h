@@ -22,6 +22,8 @@
 
 // ROOT includes <>
 #include "TObject.h"
+class TH1D;
+class TH2D;
 
 // system includes <>
 #include <string>
@@ -204,6 +206,10 @@ namespace alibava {
 		//! vector to store intermediate/final common mode error value
 		EVENT::FloatVec _commonmodeerror;
 		
+		//! The correction histograms, resolved in bookHistos()
+		TH1D * _commonCorrectionHisto;
+		TH2D * _commonCorrectionVsEventHisto;
+		
 		
 	};
 	
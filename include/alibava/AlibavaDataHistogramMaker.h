@@ -20,6 +20,9 @@
 
 // ROOT includes <>
 #include "TObject.h"
+class TH1D;
+class TH2D;
+class TProfile;
 
 // system includes <>
 #include <string>
@@ -181,6 +184,28 @@ namespace alibava {
 		//! Name of the Temperature vs EventNum histogram
 		std::string _temperatureVsEventNumHistoName;
 
+		/////////////////////////////////////////
+		// Histograms, resolved in bookHistos() //
+		/////////////////////////////////////////
+		
+		//! Resolves the histograms created from the XML file
+		void resolveHistos();
+		
+		TH1D * _maskedEventsHisto;
+		TH1D * _timeHisto;
+		TProfile * _timeVsEventNumHisto;
+		TH1D * _temperatureHisto;
+		TProfile * _temperatureVsEventNumHisto;
+		TH1D * _calChargeHisto;
+		TH1D * _delayHisto;
+		
+		AlibavaHistogramRegistry<TH1D> _signalHistos;
+		AlibavaHistogramRegistry<TH2D> _signalVsTimeHistos;
+		AlibavaHistogramRegistry<TH2D> _signalVsTempHistos;
+		AlibavaHistogramRegistry<TH1D> _snrHistos;
+		AlibavaHistogramRegistry<TH2D> _snrVsTimeHistos;
+		AlibavaHistogramRegistry<TH2D> _snrVsTempHistos;
+
 	};
 	
 	//! A global instance of the processor
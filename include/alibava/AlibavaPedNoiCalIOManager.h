@@ -18,6 +18,7 @@
 #include <IMPL/LCCollectionVec.h>
 
 // system includes <>
+#include <map>
 #include <string>
 
 namespace alibava {
@@ -30,13 +31,45 @@ namespace alibava {
 		
 		void createFile(std::string filename, lcio::LCRunHeaderImpl* runHeader);
 		
+		// data vectors of each chip, for each collection name
+		typedef std::map<std::string, std::map<int, lcio::FloatVec> > CollectionData;
+		
 		void addToFile(std::string filename, std::string collectionName, int chipnum, lcio::FloatVec datavec);
 		
+		// adds or replaces all the given collections and chips, reading and writing the file only once
+		void addToFile(std::string filename, const CollectionData & data);
+		
+		// returns a copy of the values of a chip, see getPedNoiCalViewForChip
 		lcio::FloatVec getPedNoiCalForChip(std::string filename, std::string collectionName, unsigned int chipnum);
 		
+		// returns the values of a chip without copying them, empty if they don't exist
+		// the file is read only once per job, all the managers share the same content
+		// the reference stays valid until the end of the job, its content is updated by addToFile
+		const lcio::FloatVec & getPedNoiCalViewForChip(std::string filename, std::string collectionName, unsigned int chipnum);
+		
+		// keeps the values of a chip to be written by flush, shared by all the managers
+		void addToBuffer(std::string filename, std::string collectionName, int chipnum, lcio::FloatVec datavec);
+		
+		// writes everything buffered for this file with a single addToFile
+		void flush(std::string filename);
+		
 	private:
-		// gets data vector from an event
-		lcio::FloatVec getDataFromEventForChip(lcio::LCEvent* evt, std::string collectionName, unsigned int chipnum);
+		// the content of a file read once, shared by all the managers
+		struct CachedFile {
+			bool isRead;
+			CollectionData data;
+		};
+		
+		// returns the cached content of a file, reading it if needed
+		// the cache mutex has to be locked by the caller
+		CachedFile & getCachedFile(std::string filename);
+		
+		// reads all the collections and chips of a file
+		void readFile(std::string filename, CollectionData & data);
+		
+		// the file cache and the write buffer
+		static std::map<std::string, CachedFile> & fileCache();
+		static std::map<std::string, CollectionData> & writeBuffer();
 		
 		// returns true if the collection exists in the event
 		bool doesCollectionExist(lcio::LCEvent* evt, std::string collectionName);
@@ -20,10 +20,13 @@
 
 // ROOT includes <>
 #include "TObject.h"
+class TH1D;
+class TF1;
 
 // system includes <>
 #include <string>
 #include <list>
+#include <vector>
 
 
 namespace alibava {
@@ -187,7 +190,49 @@ namespace alibava {
 		/*! Fills the histograms
 		 */		
 		void calculatePedestalNoise();
-
+		
+		//! The histograms and fits of each channel, resolved in bookHistos()
+		AlibavaHistogramRegistry<TH1D> _chanDataHistos;
+		AlibavaHistogramRegistry<TF1> _chanDataFits;
+		
+		//! The pedestal and noise histograms of each chip, resolved in bookHistos()
+		AlibavaHistogramRegistry<TH1D> _pedestalHistos;
+		AlibavaHistogramRegistry<TH1D> _noiseHistos;
+		
+		//! The temperature histogram, resolved in bookHistos()
+		TH1D * _temperatureHisto;
+		
+		//! How pedestal and noise are extracted
+		/*! "Fit" fits a Gaussian to the histogram of each channel,
+		 *  one channel after the other. "TruncatedMean" accumulates the
+		 *  readings of each channel in flat arrays during the event loop
+		 *  and computes an iterative, 3 sigma truncated mean and RMS of
+		 *  all channels in parallel at the end.
+		 */
+		std::string _pedestalNoiseMethod;
+		
+		//! Number of threads for the TruncatedMean method, 0 for all cores
+		int _nThreads;
+		
+		//! Per channel readings for the TruncatedMean method
+		/*! Unit wide ADC bins over the channel histogram range, indexed
+		 *  by (chip * NOOFCHANNELS + channel) * number of bins + bin.
+		 *  The sums of the values and of their squares are kept per bin,
+		 *  so that only the truncation window depends on the binning.
+		 */
+		std::vector<unsigned int> _adcCounts;
+		std::vector<double> _adcSums;
+		std::vector<double> _adcSquares;
+		
+		//! Adds the readings of a chip to the TruncatedMean arrays
+		void accumulateReadings(TrackerDataImpl * trkdata);
+		
+		//! Truncated mean and RMS of the readings of a channel
+		/*! Starting from all the readings the window mean +- 3 RMS is
+		 *  iterated until it is stable. The RMS of the truncated
+		 *  readings is corrected to the sigma of a Gaussian.
+		 */
+		void calculateTruncatedMoments(int ichip, int ichan, double & pedestal, double & noise) const;
 		
 	};
 	
@@ -5,23 +5,36 @@
 #include <vector>
 #include <algorithm>
 #include <map>
+#include <string>
+#include <unordered_map>
 
 class Cluster {
   public:
+    //! Translation normalised encoding of a cluster shape
+    /*! The size of the bounding box followed by the pixel bitmask
+     *  over the bounding box, row by row. Two clusters have the same
+     *  key if and only if they have the same shape.
+     */
+    typedef std::string ShapeKey;
+    //! Shape key to shape ID
+    typedef std::unordered_map<ShapeKey,int> ShapeIndex;
+
     Cluster();
     void set_values(int,std::vector<int>,std::vector<int>);
-    Cluster mirrorX();
-    Cluster mirrorY();
-    Cluster rotate90();
-    void NeighbourPixels(int x, int y, std::vector<int> xOriginal, std::vector<int> yOriginal, std::vector<int> &xNeighbour, std::vector<int> &yNeighbour);
+    Cluster mirrorX() const;
+    Cluster mirrorY() const;
+    Cluster rotate90() const;
+    void NeighbourPixels(int x, int y, const std::vector<int> &xOriginal, const std::vector<int> &yOriginal, std::vector<int> &xNeighbour, std::vector<int> &yNeighbour);
     void FindReferenceClusters(std::vector<Cluster> &clusterVec, int sizeMax);
-    std::map<int,int> SymmetryPairs(std::vector<Cluster> clusterVec, const char* type);
-    std::vector< std::vector<int> > sameShape(std::vector<Cluster> clusterVec);
-    int WhichClusterShape(Cluster cluster, std::vector<Cluster> clusterVec);
-    std::vector<int> getX() {return x;}
-    std::vector<int> getY() {return y;}
-    int Size() {return size;}
-    bool operator==(Cluster c2); 
+    static ShapeIndex BuildShapeIndex(const std::vector<Cluster> &clusterVec);
+    std::map<int,int> SymmetryPairs(const std::vector<Cluster> &clusterVec, const char* type);
+    std::vector< std::vector<int> > sameShape(const std::vector<Cluster> &clusterVec);
+    int WhichClusterShape(const Cluster &cluster, const ShapeIndex &shapeIndex) const;
+    ShapeKey getShapeKey() const;
+    std::vector<int> getX() const {return x;}
+    std::vector<int> getY() const {return y;}
+    int Size() const {return size;}
+    bool operator==(const Cluster &c2) const;
     void getCenterOfGravity(float &xCenter, float &yCenter);
  protected:
     int size;
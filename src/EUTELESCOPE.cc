@@ -129,6 +129,8 @@ namespace eutelescope {
     else if ( type == kEUTelSimpleSparsePixel ) os << "kEUTelSimpleSparsePixel";
     else if ( type == kEUTelGenericSparsePixel ) os << "kEUTelGenericSparsePixel";
     else if ( type == kEUTelGeometricPixel ) os << "kEUTelGeometricPixel";
+    else if ( type == kEUTelMuPixel ) os << "kEUTelMuPixel";
+    else if ( type == kEUTelPackedGenericPixel ) os << "kEUTelPackedGenericPixel";
     // add here your type
     else if ( type == kUnknownPixelType ) os << "kUnknownPixelType";
     os << " (" << static_cast<int> (type ) << ")";
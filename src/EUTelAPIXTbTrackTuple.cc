@@ -5,6 +5,7 @@
 #include "EUTelExceptions.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 
 // eutelescope geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -311,18 +312,16 @@ bool EUTelAPIXTbTrackTuple::readZsHits( std::string colName, LCEvent* event)
 		SparsePixelType type = static_cast<SparsePixelType> ( static_cast<int> (cellDecoder( zsData )["sparsePixelType"]) );
     		int sensorID = cellDecoder( zsData )["sensorID"];
 
-		if (type == kEUTelGenericSparsePixel  ) 
+		if ( isGenericSparsePixelStorage( type ) ) 
 		  {
-		   auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-
-		    for( auto& apixPixel: *sparseData ) {	   
+		    forEachGenericPixel( zsData, type, [&](EUTelGenericSparsePixel const & apixPixel) {
 		       _nPixHits++;
 		       p_iden->push_back( sensorID );
 		       p_row->push_back( apixPixel.getYCoord() );
 		       p_col->push_back( apixPixel.getXCoord() );
 		       p_tot->push_back( static_cast< int >(apixPixel.getSignal()) );
 		       p_lv1->push_back( static_cast< int >(apixPixel.getTime()) );
-		     }
+		     });
 		   
 		  }
 		else if( type == kEUTelMuPixel )
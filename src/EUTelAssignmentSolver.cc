@@ -0,0 +1,185 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelAssignmentSolver.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <limits>
+#include <map>
+
+using namespace eutelescope;
+
+EUTelAssignmentSolver::EUTelAssignmentSolver():
+  _noOfRows(0),
+  _noOfColumns(0),
+  _candidates(),
+  _rowAssignment(),
+  _columnAssignment(),
+  _totalCost(0.),
+  _parent() {
+}
+
+void EUTelAssignmentSolver::reset(int noOfRows, int noOfColumns) {
+  _noOfRows = noOfRows;
+  _noOfColumns = noOfColumns;
+  _candidates.clear();
+  _rowAssignment.assign( noOfRows, -1 );
+  _columnAssignment.assign( noOfColumns, -1 );
+  _totalCost = 0.;
+}
+
+void EUTelAssignmentSolver::addCandidate(int row, int column, double cost) {
+  if( row < 0 || row >= _noOfRows || column < 0 || column >= _noOfColumns ) {
+    throw InvalidParameterException( "EUTelAssignmentSolver::addCandidate row or column out of range" );
+  }
+  if( !( cost >= 0. ) ) {
+    throw InvalidParameterException( "EUTelAssignmentSolver::addCandidate the cost must not be negative" );
+  }
+  Candidate candidate = { row, column, cost };
+  _candidates.push_back( candidate );
+}
+
+int EUTelAssignmentSolver::findRoot(int node) {
+  while( _parent[node] != node ) {
+    _parent[node] = _parent[_parent[node]];
+    node = _parent[node];
+  }
+  return node;
+}
+
+int EUTelAssignmentSolver::solve() {
+  _rowAssignment.assign( _noOfRows, -1 );
+  _columnAssignment.assign( _noOfColumns, -1 );
+  _totalCost = 0.;
+  if( _candidates.empty() ) return 0;
+
+  //group the rows and the columns sharing candidates, the groups are
+  //independent and are solved one by one
+  _parent.resize( _noOfRows + _noOfColumns );
+  for( size_t node = 0; node < _parent.size(); ++node ) _parent[node] = node;
+  for( auto const & candidate: _candidates ) {
+    int rowRoot = findRoot( candidate.row );
+    int columnRoot = findRoot( _noOfRows + candidate.column );
+    if( rowRoot != columnRoot ) _parent[columnRoot] = rowRoot;
+  }
+
+  std::map<int, std::vector<Candidate> > groups;
+  for( auto const & candidate: _candidates ) {
+    groups[findRoot( candidate.row )].push_back( candidate );
+  }
+
+  int noOfAssigned = 0;
+  for( auto const & group: groups ) {
+    solveGroup( group.second );
+  }
+  for( int row = 0; row < _noOfRows; ++row ) {
+    if( _rowAssignment[row] >= 0 ) ++noOfAssigned;
+  }
+  return noOfAssigned;
+}
+
+void EUTelAssignmentSolver::solveGroup(std::vector<Candidate> const & candidates) {
+  //local numbering of the rows and columns of the group
+  std::map<int, int> rowIndex, columnIndex;
+  for( auto const & candidate: candidates ) {
+    rowIndex.insert( std::make_pair( candidate.row, 0 ) );
+    columnIndex.insert( std::make_pair( candidate.column, 0 ) );
+  }
+  std::vector<int> rows, columns;
+  for( auto & entry: rowIndex ) {
+    entry.second = rows.size();
+    rows.push_back( entry.first );
+  }
+  for( auto & entry: columnIndex ) {
+    entry.second = columns.size();
+    columns.push_back( entry.first );
+  }
+
+  //a single candidate needs no solving
+  if( candidates.size() == 1 ) {
+    _rowAssignment[rows[0]] = columns[0];
+    _columnAssignment[columns[0]] = rows[0];
+    _totalCost += candidates[0].cost;
+    return;
+  }
+
+  //square dense matrix, the forbidden pairs and the padding get a
+  //penalty larger than the sum of all the allowed costs, so that one
+  //more allowed pair always beats any saving in distance
+  size_t const n = std::max( rows.size(), columns.size() );
+  double penalty = 1.;
+  for( auto const & candidate: candidates ) penalty += candidate.cost;
+
+  std::vector<double> cost( n * n, penalty );
+  std::vector<char> allowed( n * n, 0 );
+  for( auto const & candidate: candidates ) {
+    size_t cell = rowIndex[candidate.row] * n + columnIndex[candidate.column];
+    if( !allowed[cell] || candidate.cost < cost[cell] ) cost[cell] = candidate.cost;
+    allowed[cell] = 1;
+  }
+
+  //Hungarian algorithm with row and column potentials, indices are
+  //shifted by one, column 0 being the virtual starting column
+  double const infinity = std::numeric_limits<double>::max();
+  std::vector<double> u( n + 1, 0. ), v( n + 1, 0. ), minValue( n + 1 );
+  std::vector<size_t> rowOfColumn( n + 1, 0 ), way( n + 1, 0 );
+  std::vector<char> used( n + 1 );
+
+  for( size_t i = 1; i <= n; ++i ) {
+    rowOfColumn[0] = i;
+    size_t j0 = 0;
+    std::fill( minValue.begin(), minValue.end(), infinity );
+    std::fill( used.begin(), used.end(), 0 );
+    do {
+      used[j0] = 1;
+      size_t i0 = rowOfColumn[j0];
+      size_t j1 = 0;
+      double delta = infinity;
+      for( size_t j = 1; j <= n; ++j ) {
+        if( used[j] ) continue;
+        double reduced = cost[( i0 - 1 ) * n + j - 1] - u[i0] - v[j];
+        if( reduced < minValue[j] ) {
+          minValue[j] = reduced;
+          way[j] = j0;
+        }
+        if( minValue[j] < delta ) {
+          delta = minValue[j];
+          j1 = j;
+        }
+      }
+      for( size_t j = 0; j <= n; ++j ) {
+        if( used[j] ) {
+          u[rowOfColumn[j]] += delta;
+          v[j] -= delta;
+        } else {
+          minValue[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while( rowOfColumn[j0] != 0 );
+    do {
+      size_t j1 = way[j0];
+      rowOfColumn[j0] = rowOfColumn[j1];
+      j0 = j1;
+    } while( j0 != 0 );
+  }
+
+  for( size_t j = 1; j <= n; ++j ) {
+    size_t i = rowOfColumn[j];
+    if( i == 0 || i > rows.size() || j > columns.size() ) continue;
+    size_t cell = ( i - 1 ) * n + j - 1;
+    if( !allowed[cell] ) continue;
+    _rowAssignment[rows[i - 1]] = columns[j - 1];
+    _columnAssignment[columns[j - 1]] = rows[i - 1];
+    _totalCost += cost[cell];
+  }
+}
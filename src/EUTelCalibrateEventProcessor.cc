@@ -16,6 +16,7 @@
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
 #include "EUTelHistogramManager.h"
+#include "EUTelCalibrationKernel.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -41,6 +42,8 @@
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 using namespace lcio;
@@ -114,6 +117,10 @@ EUTelCalibrateEventProcessor::EUTelCalibrateEventProcessor () :Processor("EUTelC
 
   registerProcessorParameter("HistoInfoFileName", "This is the name of the histogram information file",
                              _histoInfoFileName, string( "histoinfo.xml" ) );
+
+  registerProcessorParameter("CalibrationKernel",
+                             "Calibration code: 0 -> scalar, 1 -> array based kernel, 2 -> scalar cross-checked against the kernel",
+                             _calibrationKernel, static_cast< int > ( 0 ) );
 }
 
 
@@ -133,6 +140,11 @@ void EUTelCalibrateEventProcessor::init () {
 
   // reset the number of consecutive missing events
   _noOfConsecutiveMissing = 0;
+
+  if ( _calibrationKernel < 0 || _calibrationKernel > 2 ) {
+    streamlog_out( WARNING2 ) << "Unknown CalibrationKernel " << _calibrationKernel << ". Using the scalar code" << endl;
+    _calibrationKernel = 0;
+  }
 }
 
 void EUTelCalibrateEventProcessor::processRunHeader (LCRunHeader * rdr) {
@@ -479,8 +491,27 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
       ShortVec::const_iterator statusIter  = status->getADCValues().begin();
 
 
+      // the array based kernel writes directly into the output
+      // collection, unless it is only run for the comparison with the
+      // scalar code
+      bool isKernelValid      = true;
+      int  kernelSkippedPixel = 0;
+      int  kernelSkippedRow   = 0;
+      if ( _calibrationKernel != 0 ) {
+        FloatVec & kernelOutput = ( _calibrationKernel == 1 ) ? corrected->chargeValues() : _kernelOutput;
+        isKernelValid = calibrateWithKernel( iDetector, sensorID, rawData->getADCValues(), pedestal->getChargeValues(),
+                                             noise->getChargeValues(), status->getADCValues(), kernelOutput,
+                                             kernelSkippedPixel, kernelSkippedRow, _calibrationKernel == 1 );
+      }
+
       bool isEventValid = true;
-      if ( _doCommonMode == 1 ) {
+      if ( _calibrationKernel == 1 ) {
+
+        isEventValid = isKernelValid;
+        skippedPixel = kernelSkippedPixel;
+        skippedRow   = kernelSkippedRow;
+
+      } else if ( _doCommonMode == 1 ) {
 
         // FULLFRAME common mode
         while ( rawIter != rawData->getADCValues().end() ) {
@@ -575,8 +606,39 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
       } // end if on _doCommonMode
 
+      if ( _calibrationKernel == 2 &&
+           ( isKernelValid != isEventValid || kernelSkippedPixel != skippedPixel || kernelSkippedRow != skippedRow ) ) {
+        streamlog_out ( WARNING2 ) << "Calibration kernel mismatch on event " << evt->getEventNumber()
+                                   << " detector " << sensorID << ": valid " << isKernelValid << " / " << isEventValid
+                                   << ", skipped pixels " << kernelSkippedPixel << " / " << skippedPixel
+                                   << ", skipped rows " << kernelSkippedRow << " / " << skippedRow << endl;
+      }
+
       if(isEventValid) {
-        if(_doCommonMode == 2) {
+        if ( _calibrationKernel == 1 ) {
+
+          // the calibrated signal is already in place, only the debug
+          // histograms are left
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+          if (_fillDebugHisto == 1) {
+            AIDA::IHistogram1D * rawHisto  = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ _rawDataDistHistoName + "_d" + to_string( sensorID ) ]);
+            AIDA::IHistogram1D * dataHisto = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ _dataDistHistoName + "_d" + to_string( sensorID ) ]);
+            if ( rawHisto && dataHisto ) {
+              const ShortVec & adcValues = rawData->getADCValues();
+              const FloatVec & correctedValues = corrected->getChargeValues();
+              for ( size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel ) {
+                rawHisto->fill( adcValues[iPixel] );
+                dataHisto->fill( correctedValues[iPixel] );
+              }
+            } else {
+              streamlog_out ( ERROR1 ) << "Not able to retrieve debug histogram pointers for detector " << sensorID
+                                       << ".\nDisabling histogramming from now on " << endl;
+              _fillDebugHisto = 0 ;
+            }
+          }
+#endif
+
+        } else if(_doCommonMode == 2) {
           ShortVec adcValues = rawData->getADCValues ();
           FloatVec _pedestal = pedestal->getChargeValues();
 
@@ -673,6 +735,22 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
 
 
+      if ( _calibrationKernel == 2 ) {
+        // the kernel reduction is not summing in the same order, so
+        // allow for rounding differences
+        const FloatVec & scalarOutput = corrected->getChargeValues();
+        size_t noOfMismatch = 0;
+        for ( size_t iPixel = 0; iPixel < scalarOutput.size(); ++iPixel ) {
+          if ( fabs( scalarOutput[iPixel] - _kernelOutput[iPixel] ) > 1e-3 * max( 1.f, fabs( scalarOutput[iPixel] ) ) ) {
+            ++noOfMismatch;
+          }
+        }
+        if ( noOfMismatch != 0 ) {
+          streamlog_out ( WARNING2 ) << "Calibration kernel mismatch on event " << evt->getEventNumber()
+                                     << " detector " << sensorID << ": " << noOfMismatch << " pixels differ" << endl;
+        }
+      }
+
       correctedDataCollection->push_back(corrected);
     }
     evt->addCollection(correctedDataCollection, _calibratedDataCollectionName);
@@ -693,6 +771,86 @@ void EUTelCalibrateEventProcessor::processEvent (LCEvent * event) {
 
 
 
+bool EUTelCalibrateEventProcessor::calibrateWithKernel( size_t iDetector, int sensorID, const ShortVec & adc, const FloatVec & pedestal,
+                                                        const FloatVec & noise, const ShortVec & status, FloatVec & output,
+                                                        int & skippedPixel, int & skippedRow, bool fillHisto ) {
+
+  size_t noOfPixel = adc.size();
+  _kernel.prepare( adc.data(), pedestal.data(), noise.data(), status.data(), noOfPixel,
+                   _hitRejectionCut, static_cast< short > ( EUTELESCOPE::GOODPIXEL ) );
+  output.resize( noOfPixel );
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+  AIDA::IHistogram1D * commonModeHisto = 0;
+  if ( fillHisto ) {
+    commonModeHisto = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ _commonModeDistHistoName + "_d" + to_string( sensorID ) ]);
+  }
+#else
+  (void) sensorID;
+  (void) fillHisto;
+#endif
+
+  bool isEventValid = true;
+  skippedPixel = 0;
+  skippedRow   = 0;
+
+  if ( _doCommonMode == 2 ) {
+
+    // ROWWISE common mode, rows are contiguous in the arrays
+    size_t rowLength = _maxX[iDetector] - _minX[iDetector] + 1;
+    for ( size_t begin = 0; begin < noOfPixel; begin += rowLength ) {
+      size_t end = min( begin + rowLength, noOfPixel );
+      EUTelCalibrationKernel::Reduction row = _kernel.reduce( begin, end );
+      skippedPixel += row.hitPixel;
+
+      double commonMode = 0.;
+      if ( ( row.hitPixel < _maxNoOfRejectedPixelPerRow ) && ( row.goodPixel != 0 ) ) {
+        commonMode = row.sum / row.goodPixel;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        if ( commonModeHisto ) commonModeHisto->fill( commonMode );
+#endif
+      } else {
+        ++skippedRow;
+      }
+      _kernel.apply( commonMode, begin, end, output.data() );
+    }
+    if ( skippedRow > _maxNoOfSkippedRow ) {
+      isEventValid = false;
+    }
+
+  } else {
+
+    double commonMode = 0.;
+    if ( _doCommonMode == 1 ) {
+
+      // FULLFRAME common mode
+      EUTelCalibrationKernel::Reduction frame = _kernel.reduce( 0, noOfPixel );
+      skippedPixel = frame.hitPixel;
+
+      if ( ( ( _maxNoOfRejectedPixels == -1 ) || ( skippedPixel < _maxNoOfRejectedPixels ) ) &&
+           ( frame.goodPixel != 0 ) ) {
+        commonMode = frame.sum / frame.goodPixel;
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        if ( commonModeHisto ) commonModeHisto->fill( commonMode );
+#endif
+      } else {
+        isEventValid = false;
+      }
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+      if ( fillHisto ) {
+        string tempHistoName = _skippedPixelDistHistoName + "_d" + to_string( sensorID ) ;
+        if ( AIDA::IHistogram1D* histo = dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[tempHistoName]) )
+          histo->fill( skippedPixel );
+      }
+#endif
+    }
+    _kernel.apply( commonMode, 0, noOfPixel, output.data() );
+  }
+
+  return isEventValid;
+}
+
 void EUTelCalibrateEventProcessor::check (LCEvent * /* evt */ ) {
   // nothing to check here - could be used to fill check plots in reconstruction processor
 }
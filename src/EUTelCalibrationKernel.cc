@@ -0,0 +1,108 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelCalibrationKernel.h"
+
+using namespace eutelescope;
+
+namespace {
+  //number of independent lanes of the blocked loops, a multiple of
+  //the vector width of the current architectures. The inner loops
+  //have this fixed trip count, so that the compiler vectorizes them
+  //also with the cheap cost model of -O2
+  size_t const kLanes = 8;
+
+  //the loops are in free functions, as the compiler only relies on
+  //__restrict for function parameters
+
+  void prepareRange(short const * __restrict adc, float const * __restrict pedestal,
+                    float const * __restrict noise, short const * __restrict status,
+                    size_t noOfPixel, float hitRejectionCut, short goodStatus,
+                    float * __restrict signal, int * __restrict hitMask, int * __restrict goodMask) {
+    size_t i = 0;
+    for( ; i + kLanes <= noOfPixel; i += kLanes ) {
+      for( size_t k = 0; k < kLanes; ++k ) {
+        float value = adc[i + k] - pedestal[i + k];
+        int isHit = value > hitRejectionCut * noise[i + k];
+        signal[i + k] = value;
+        hitMask[i + k] = isHit;
+        goodMask[i + k] = ( status[i + k] == goodStatus ) & ( isHit ^ 1 );
+      }
+    }
+    for( ; i < noOfPixel; ++i ) {
+      float value = adc[i] - pedestal[i];
+      int isHit = value > hitRejectionCut * noise[i];
+      signal[i] = value;
+      hitMask[i] = isHit;
+      goodMask[i] = ( status[i] == goodStatus ) & ( isHit ^ 1 );
+    }
+  }
+
+  EUTelCalibrationKernel::Reduction reduceRange(float const * __restrict signal, int const * __restrict hitMask,
+                                                int const * __restrict goodMask, size_t begin, size_t end) {
+    float sum[kLanes] = {};
+    int good[kLanes] = {};
+    int hit[kLanes] = {};
+
+    size_t i = begin;
+    for( ; i + kLanes <= end; i += kLanes ) {
+      for( size_t k = 0; k < kLanes; ++k ) {
+        sum[k] += goodMask[i + k] * signal[i + k];
+        good[k] += goodMask[i + k];
+        hit[k] += hitMask[i + k];
+      }
+    }
+    for( size_t k = 0; i < end; ++i, ++k ) {
+      sum[k] += goodMask[i] * signal[i];
+      good[k] += goodMask[i];
+      hit[k] += hitMask[i];
+    }
+
+    EUTelCalibrationKernel::Reduction result = { 0., 0, 0 };
+    for( size_t k = 0; k < kLanes; ++k ) {
+      result.sum += sum[k];
+      result.goodPixel += good[k];
+      result.hitPixel += hit[k];
+    }
+    return result;
+  }
+
+  void applyRange(float const * __restrict signal, double commonMode, size_t begin, size_t end,
+                  float * __restrict output) {
+    size_t i = begin;
+    for( ; i + kLanes <= end; i += kLanes ) {
+      for( size_t k = 0; k < kLanes; ++k ) {
+        output[i + k] = static_cast<float>( signal[i + k] - commonMode );
+      }
+    }
+    for( ; i < end; ++i ) {
+      output[i] = static_cast<float>( signal[i] - commonMode );
+    }
+  }
+}
+
+void EUTelCalibrationKernel::prepare(short const * adc, float const * pedestal, float const * noise,
+                                     short const * status, size_t noOfPixel, float hitRejectionCut,
+                                     short goodStatus) {
+  _signal.resize( noOfPixel );
+  _hitMask.resize( noOfPixel );
+  _goodMask.resize( noOfPixel );
+
+  prepareRange( adc, pedestal, noise, status, noOfPixel, hitRejectionCut, goodStatus,
+                _signal.data(), _hitMask.data(), _goodMask.data() );
+}
+
+EUTelCalibrationKernel::Reduction EUTelCalibrationKernel::reduce(size_t begin, size_t end) const {
+  return reduceRange( _signal.data(), _hitMask.data(), _goodMask.data(), begin, end );
+}
+
+void EUTelCalibrationKernel::apply(double commonMode, size_t begin, size_t end, float * output) const {
+  applyRange( _signal.data(), commonMode, begin, end, output );
+}
@@ -0,0 +1,121 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterChargeProfile.h"
+
+// system includes <>
+#include <algorithm>
+#include <functional>
+
+using namespace eutelescope;
+
+EUTelClusterChargeProfile::EUTelClusterChargeProfile():
+  _xCoords(),
+  _yCoords(),
+  _signals(),
+  _table(),
+  _tableValid(false),
+  _xMin(0), _yMin(0),
+  _width(0), _height(0) {
+}
+
+void EUTelClusterChargeProfile::reserve(size_t noOfPixels) {
+  _xCoords.reserve( noOfPixels );
+  _yCoords.reserve( noOfPixels );
+  _signals.reserve( noOfPixels );
+}
+
+void EUTelClusterChargeProfile::addPixel(int x, int y, float signal) {
+  _xCoords.push_back( x );
+  _yCoords.push_back( y );
+  _signals.push_back( signal );
+  _tableValid = false;
+}
+
+float EUTelClusterChargeProfile::getTotalCharge() const {
+  float charge = 0;
+  for( float signal: _signals ) charge += signal;
+  return charge;
+}
+
+std::vector<float> EUTelClusterChargeProfile::getHighestCharges(std::vector<int> const & nPixels) const {
+  std::vector<float> charges;
+  charges.reserve( nPixels.size() );
+  if( nPixels.empty() ) return charges;
+
+  //only the largest requested pixels need to be ordered
+  size_t maxN = 0;
+  for( int n: nPixels ) {
+    if( n > 0 ) maxN = std::max( maxN, static_cast<size_t>( n ) );
+  }
+  maxN = std::min( maxN, _signals.size() );
+
+  std::vector<float> sorted( _signals );
+  std::partial_sort( sorted.begin(), sorted.begin() + maxN, sorted.end(), std::greater<float>() );
+
+  std::vector<float> prefix( maxN + 1, 0. );
+  for( size_t i = 0; i < maxN; ++i ) prefix[i + 1] = prefix[i] + sorted[i];
+
+  float const total = getTotalCharge();
+  for( int n: nPixels ) {
+    if( n <= 0 ) charges.push_back( 0. );
+    else if( static_cast<size_t>( n ) >= _signals.size() ) charges.push_back( total );
+    else charges.push_back( prefix[n] );
+  }
+  return charges;
+}
+
+void EUTelClusterChargeProfile::buildTable() const {
+  if( _tableValid ) return;
+  _tableValid = true;
+  if( _signals.empty() ) {
+    _width = _height = 0;
+    _table.assign( 1, 0. );
+    return;
+  }
+
+  _xMin = *std::min_element( _xCoords.begin(), _xCoords.end() );
+  _yMin = *std::min_element( _yCoords.begin(), _yCoords.end() );
+  _width = *std::max_element( _xCoords.begin(), _xCoords.end() ) - _xMin + 1;
+  _height = *std::max_element( _yCoords.begin(), _yCoords.end() ) - _yMin + 1;
+
+  int const stride = _width + 1;
+  _table.assign( static_cast<size_t>( stride ) * ( _height + 1 ), 0. );
+  for( size_t i = 0; i < _signals.size(); ++i ) {
+    _table[( _yCoords[i] - _yMin + 1 ) * stride + ( _xCoords[i] - _xMin + 1 )] += _signals[i];
+  }
+  for( int y = 1; y <= _height; ++y ) {
+    for( int x = 1; x <= _width; ++x ) {
+      _table[y * stride + x] += _table[( y - 1 ) * stride + x] + _table[y * stride + x - 1] - _table[( y - 1 ) * stride + x - 1];
+    }
+  }
+}
+
+float EUTelClusterChargeProfile::getWindowCharge(int xCenter, int yCenter, int xSize, int ySize) const {
+  buildTable();
+  if( _width == 0 ) return 0.;
+
+  //window in table coordinates, clipped to the bounding box
+  int x0 = std::max( xCenter - xSize / 2 - _xMin, 0 );
+  int x1 = std::min( xCenter + xSize / 2 - _xMin + 1, _width );
+  int y0 = std::max( yCenter - ySize / 2 - _yMin, 0 );
+  int y1 = std::min( yCenter + ySize / 2 - _yMin + 1, _height );
+  if( x0 >= x1 || y0 >= y1 ) return 0.;
+
+  int const stride = _width + 1;
+  return static_cast<float>( _table[y1 * stride + x1] - _table[y0 * stride + x1] - _table[y1 * stride + x0] + _table[y0 * stride + x0] );
+}
+
+std::vector<float> EUTelClusterChargeProfile::getWindowCharges(int xCenter, int yCenter, std::vector<int> const & sizes) const {
+  std::vector<float> charges;
+  charges.reserve( sizes.size() );
+  for( int size: sizes ) charges.push_back( getWindowCharge( xCenter, yCenter, size, size ) );
+  return charges;
+}
@@ -22,6 +22,7 @@
 #include "EUTelExceptions.h"
 #include "EUTelROI.h"
 #include "EUTelMatrixDecoder.h"
+#include "EUTelClusterSummary.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -32,6 +33,7 @@
 #include <IMPL/TrackerDataImpl.h>
 #include <IMPL/TrackerRawDataImpl.h>
 #include <IMPL/LCCollectionVec.h>
+#include <EVENT/LCGenericObject.h>
 #include <UTIL/CellIDEncoder.h>
 
 // system includes <>
@@ -739,6 +741,9 @@ void EUTelClusterFilter::processEvent (LCEvent * event) {
         CellIDEncoder<TrackerPulseImpl> outputEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, filteredCollectionVec);
         CellIDDecoder<TrackerPulseImpl> inputDecoder(pulseCollectionVec);
 
+        // the summaries written by the clustering, if any
+        LCCollectionVec * summaryCollection = EUTelClusterSummary::getCollection(evt, _inputPulseCollectionName, pulseCollectionVec->getNumberOfElements());
+
         vector<int > acceptedClusterVec;
         vector<int > clusterNoVec(_noOfDetectors, 0);
 
@@ -751,6 +756,12 @@ void EUTelClusterFilter::processEvent (LCEvent * event) {
             EUTelVirtualCluster * cluster;
             SparsePixelType       pixelType;
 
+            EUTelClusterSummary summary;
+            if ( summaryCollection )
+            {
+                summary = EUTelClusterSummary( dynamic_cast<LCGenericObject*> (summaryCollection->getElementAt(iPulse)) );
+            }
+
             if ( type == kEUTelDFFClusterImpl )
             {
                 cluster = new EUTelDFFClusterImpl( static_cast<TrackerDataImpl*> (pulse->getTrackerData() ) );
@@ -981,13 +992,13 @@ void EUTelClusterFilter::processEvent (LCEvent * event) {
             }
             else
             {
-                isAccepted &= isAboveMinTotalCharge(cluster);
+                isAccepted &= isAboveMinTotalCharge(cluster, summary);
                 isAccepted &= isAboveMinTotalSNR(cluster);
                 isAccepted &= isAboveNMinCharge(cluster);
                 isAccepted &= isAboveNMinSNR(cluster);
-                isAccepted &= isAboveNxNMinCharge(cluster);
+                isAccepted &= isAboveNxNMinCharge(cluster, summary);
                 isAccepted &= isAboveNxNMinSNR(cluster);
-                isAccepted &= isAboveMinSeedCharge(cluster);
+                isAccepted &= isAboveMinSeedCharge(cluster, summary);
                 isAccepted &= isAboveMinSeedSNR(cluster);
                 isAccepted &= isBelowMaxClusterNoise(cluster);
             }
@@ -1173,7 +1184,7 @@ bool EUTelClusterFilter::isAboveNumberOfHitPixel(EUTelVirtualCluster * cluster)
 
 
 
-bool EUTelClusterFilter::isAboveMinTotalCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinTotalCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const {
 
   if ( !_minTotalChargeSwitch ) {
     return true;
@@ -1183,9 +1194,10 @@ bool EUTelClusterFilter::isAboveMinTotalCharge(EUTelVirtualCluster * cluster) co
   int detectorID  = cluster->getDetectorID();
   int detectorPos = _ancillaryIndexMap[ detectorID ];
 
-  if ( cluster->getTotalCharge() > _minTotalChargeVec[detectorPos] ) return true;
+  float charge = summary.isValid() ? summary.getTotalCharge() : cluster->getTotalCharge();
+  if ( charge > _minTotalChargeVec[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its charge is " << cluster->getTotalCharge()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its charge is " << charge
                               << " and the threshold is " << _minTotalChargeVec[detectorPos] << endl;
     _rejectionMap["MinTotalChargeCut"][detectorPos]++;
     return false;
@@ -1218,15 +1230,19 @@ bool EUTelClusterFilter::isAboveNMinCharge(EUTelVirtualCluster * cluster) const
 
   int detectorID = cluster->getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  vector<float >::const_iterator iter = _minNChargeVec.begin();
-  while ( iter != _minNChargeVec.end() ) {
-    int nPixel      = static_cast<int > (*iter);
-    float charge    = cluster->getClusterCharge(nPixel);
-    float threshold = (* (iter + detectorPos + 1) );
-    if ( charge > threshold ) {
-      iter += _noOfDetectors + 1;
-    } else {
-      streamlog_out ( DEBUG2 ) << "Rejected cluster because its charge over " << (*iter) << " is " << charge
+
+  // the charges for all the N are computed at once
+  vector<int > nPixels;
+  for ( size_t iPos = 0; iPos < _minNChargeVec.size(); iPos += _noOfDetectors + 1 ) {
+    nPixels.push_back( static_cast<int > ( _minNChargeVec[ iPos ] ) );
+  }
+  vector<float > charges = cluster->getClusterCharge(nPixels);
+
+  for ( size_t iN = 0; iN < nPixels.size(); ++iN ) {
+    float charge    = charges[ iN ];
+    float threshold = _minNChargeVec[ iN * ( _noOfDetectors + 1 ) + detectorPos + 1 ];
+    if ( !( charge > threshold ) ) {
+      streamlog_out ( DEBUG2 ) << "Rejected cluster because its charge over " << nPixels[ iN ] << " is " << charge
                                << " and the threshold is " << threshold << endl;
       _rejectionMap["MinNChargeCut"][detectorPos]++;
       return false;
@@ -1265,7 +1281,7 @@ bool EUTelClusterFilter::isAboveNMinSNR(EUTelVirtualCluster * cluster) const {
 
 
 
-bool EUTelClusterFilter::isAboveNxNMinCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveNxNMinCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const {
 
   if ( !_minNxNChargeSwitch ) return true;
 
@@ -1273,15 +1289,32 @@ bool EUTelClusterFilter::isAboveNxNMinCharge(EUTelVirtualCluster * cluster) cons
 
   int detectorID = cluster->getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  vector<float >::const_iterator iter = _minNxNChargeVec.begin();
-  while ( iter != _minNxNChargeVec.end() ) {
-    int nxnPixel    = static_cast<int > ( *iter ) ;
-    float charge    = cluster->getClusterCharge(nxnPixel, nxnPixel);
-    float threshold = (* ( iter + detectorPos + 1 )) ;
-    if ( ( threshold <= 0) || (charge > threshold) ) {
-      iter += _noOfDetectors + 1;
-    } else {
-      streamlog_out ( DEBUG2 ) << "Rejected cluster because its charge within a " << (*iter) << " x " << (*iter)
+
+  // the 3x3 and 5x5 charges are taken from the summary, the
+  // remaining windows are computed from the cluster all at once
+  vector<int > nxnPixels;
+  vector<int > missingPixels;
+  for ( size_t iPos = 0; iPos < _minNxNChargeVec.size(); iPos += _noOfDetectors + 1 ) {
+    int nxnPixel = static_cast<int > ( _minNxNChargeVec[ iPos ] );
+    nxnPixels.push_back( nxnPixel );
+    if ( !summary.isValid() || ( nxnPixel != 3 && nxnPixel != 5 ) ) missingPixels.push_back( nxnPixel );
+  }
+  vector<float > missingCharges;
+  if ( !missingPixels.empty() ) missingCharges = cluster->getClusterChargeNxN(missingPixels);
+
+  vector<float > charges;
+  vector<float >::const_iterator missingIter = missingCharges.begin();
+  for ( size_t iN = 0; iN < nxnPixels.size(); ++iN ) {
+    if ( summary.isValid() && nxnPixels[ iN ] == 3 )      charges.push_back( summary.getCharge3x3() );
+    else if ( summary.isValid() && nxnPixels[ iN ] == 5 ) charges.push_back( summary.getCharge5x5() );
+    else charges.push_back( *missingIter++ );
+  }
+
+  for ( size_t iN = 0; iN < nxnPixels.size(); ++iN ) {
+    float charge    = charges[ iN ];
+    float threshold = _minNxNChargeVec[ iN * ( _noOfDetectors + 1 ) + detectorPos + 1 ];
+    if ( !( ( threshold <= 0) || (charge > threshold) ) ) {
+      streamlog_out ( DEBUG2 ) << "Rejected cluster because its charge within a " << nxnPixels[ iN ] << " x " << nxnPixels[ iN ]
                                << " subcluster is " << charge << " and the threshold is " << threshold << endl;
       _rejectionMap["MinNxNChargeCut"][detectorPos]++;
       return false;
@@ -1318,7 +1351,7 @@ bool EUTelClusterFilter::isAboveNxNMinSNR(EUTelVirtualCluster * cluster) const {
 
 }
 
-bool EUTelClusterFilter::isAboveMinSeedCharge(EUTelVirtualCluster * cluster) const {
+bool EUTelClusterFilter::isAboveMinSeedCharge(EUTelVirtualCluster * cluster, EUTelClusterSummary const & summary) const {
 
   if ( !_minSeedChargeSwitch ) return true;
 
@@ -1326,9 +1359,10 @@ bool EUTelClusterFilter::isAboveMinSeedCharge(EUTelVirtualCluster * cluster) con
 
   int detectorID = cluster->getDetectorID();
   int detectorPos = _ancillaryIndexMap [ detectorID ];
-  if ( cluster->getSeedCharge() > _minSeedChargeVec[detectorPos] ) return true;
+  float seedCharge = summary.isValid() ? summary.getSeedCharge() : cluster->getSeedCharge();
+  if ( seedCharge > _minSeedChargeVec[detectorPos] ) return true;
   else {
-    streamlog_out ( DEBUG2 )  << "Rejected cluster because its seed charge is " << cluster->getSeedCharge()
+    streamlog_out ( DEBUG2 )  << "Rejected cluster because its seed charge is " << seedCharge
                               << " and the threshold is " <<  _minSeedChargeVec[detectorPos] << endl;
     _rejectionMap["MinSeedChargeCut"][detectorPos]++;
     return false;
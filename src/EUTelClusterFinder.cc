@@ -0,0 +1,196 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterFinder.h"
+#include "EUTelExceptions.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+#include <list>
+
+using namespace eutelescope;
+
+namespace {
+
+  //! Integer square root, largest r with r*r <= n
+  int isqrt(int n) {
+    if( n < 0 ) return -1;
+    int r = static_cast<int>( std::sqrt( static_cast<double>(n) ) );
+    while( r*r > n ) --r;
+    while( (r+1)*(r+1) <= n ) ++r;
+    return r;
+  }
+
+  //! Neighbour finder for hits on the pixel index grid
+  /*! Hits are sorted by (x, y, index), for a given hit the rows
+   *  x-r ... x+r are searched with binary search for the allowed
+   *  y range.
+   */
+  class SparseNeighbourFinder {
+  public:
+    SparseNeighbourFinder(std::vector<EUTelClusterFinder::SparseHit> const & hits, int minDistanceSquared):
+      _hits(hits), _minDistanceSquared(minDistanceSquared), _radius(isqrt(minDistanceSquared)), _sorted(hits.size()) {
+      for( size_t i = 0; i < _sorted.size(); ++i ) _sorted[i] = i;
+      std::sort( _sorted.begin(), _sorted.end(), [this](size_t a, size_t b) { return less(a, b); } );
+    }
+
+    template<class Visitor>
+    void forEachNeighbour(size_t i, Visitor visit) const {
+      EUTelClusterFinder::SparseHit const & hit = _hits[i];
+      for( int dX = -_radius; dX <= _radius; ++dX ) {
+        int dYMax = isqrt( _minDistanceSquared - dX*dX );
+        int x = hit.x + dX;
+        int yMin = hit.y - dYMax;
+        int yMax = hit.y + dYMax;
+        auto it = std::lower_bound( _sorted.begin(), _sorted.end(), 0,
+                                    [this, x, yMin](size_t a, int) {
+                                      return _hits[a].x < x || ( _hits[a].x == x && _hits[a].y < yMin );
+                                    } );
+        for( ; it != _sorted.end() && _hits[*it].x == x && _hits[*it].y <= yMax; ++it ) {
+          if( *it != i ) visit( *it );
+        }
+      }
+    }
+
+  private:
+    bool less(size_t a, size_t b) const {
+      if( _hits[a].x != _hits[b].x ) return _hits[a].x < _hits[b].x;
+      if( _hits[a].y != _hits[b].y ) return _hits[a].y < _hits[b].y;
+      return a < b;
+    }
+
+    std::vector<EUTelClusterFinder::SparseHit> const & _hits;
+    int _minDistanceSquared;
+    int _radius;
+    std::vector<size_t> _sorted;
+  };
+
+  //! Neighbour finder for geometric hits
+  /*! Hits are sorted along x, for a given hit all hits within the
+   *  largest possible x distance of a neighbour are tested with
+   *  the exact neighbourhood definition.
+   */
+  class GeometricNeighbourFinder {
+  public:
+    GeometricNeighbourFinder(std::vector<EUTelClusterFinder::GeometricHit> const & hits, float cutT):
+      _hits(hits), _cutT(cutT), _maxBoundX(0), _sorted(hits.size()) {
+      for( size_t i = 0; i < _sorted.size(); ++i ) {
+        _sorted[i] = i;
+        _maxBoundX = std::max( _maxBoundX, static_cast<double>(hits[i].boundX) );
+      }
+      std::sort( _sorted.begin(), _sorted.end(), [this](size_t a, size_t b) { return _hits[a].posX < _hits[b].posX; } );
+    }
+
+    template<class Visitor>
+    void forEachNeighbour(size_t i, Visitor visit) const {
+      EUTelClusterFinder::GeometricHit const & hit = _hits[i];
+      //generous window, the exact cut is applied below
+      double window = ( hit.boundX + _maxBoundX )*1.02 + 1.e-6;
+      double xMin = hit.posX - window;
+      double xMax = hit.posX + window;
+      auto it = std::lower_bound( _sorted.begin(), _sorted.end(), xMin,
+                                  [this](size_t a, double x) { return _hits[a].posX < x; } );
+      for( ; it != _sorted.end() && _hits[*it].posX <= xMax; ++it ) {
+        if( *it != i && EUTelClusterFinder::areNeighbours( hit, _hits[*it], _cutT ) ) visit( *it );
+      }
+    }
+
+  private:
+    std::vector<EUTelClusterFinder::GeometricHit> const & _hits;
+    float _cutT;
+    double _maxBoundX;
+    std::vector<size_t> _sorted;
+  };
+
+}
+
+EUTelClusterFinder::Engine EUTelClusterFinder::engineFromString(std::string const & name) {
+  if( name == "Iterative" ) return kIterative;
+  if( name == "Sweep" ) return kSweep;
+  throw InvalidParameterException("Unknown clustering engine " + name + ", available are Iterative and Sweep");
+}
+
+template<class HitType, class CutType>
+void EUTelClusterFinder::iterativeClustering(std::vector<HitType> const & hits, CutType cut, ClusterIndexVec & clusters) {
+  std::list<size_t> remaining;
+  for( size_t i = 0; i < hits.size(); ++i ) remaining.push_back( i );
+
+  std::vector<size_t> newlyAdded;
+  while( !remaining.empty() ) {
+    //First we need to take any hit, so let's take the first one
+    clusters.push_back( std::vector<size_t>( 1, remaining.front() ) );
+    std::vector<size_t> & cluster = clusters.back();
+    newlyAdded.assign( 1, remaining.front() );
+    remaining.pop_front();
+
+    //Now process all newly added hits, in the process of neighbour
+    //finding we continue to add new hits
+    for( size_t iNew = 0; iNew < newlyAdded.size(); ++iNew ) {
+      HitType const & hit = hits[ newlyAdded[iNew] ];
+      for( auto it = remaining.begin(); it != remaining.end(); ) {
+        if( areNeighbours( hit, hits[*it], cut ) ) {
+          newlyAdded.push_back( *it );
+          cluster.push_back( *it );
+          it = remaining.erase( it );
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+}
+
+template<class NeighbourFinder>
+void EUTelClusterFinder::sweepClustering(size_t nHits, NeighbourFinder & finder, ClusterIndexVec & clusters) {
+  std::vector<bool> assigned( nHits, false );
+  std::vector<size_t> neighbours;
+
+  for( size_t seed = 0; seed < nHits; ++seed ) {
+    if( assigned[seed] ) continue;
+    assigned[seed] = true;
+    clusters.push_back( std::vector<size_t>( 1, seed ) );
+    std::vector<size_t> & cluster = clusters.back();
+
+    //the cluster vector itself serves as breadth-first queue
+    for( size_t iNew = 0; iNew < cluster.size(); ++iNew ) {
+      neighbours.clear();
+      finder.forEachNeighbour( cluster[iNew], [&](size_t j) { if( !assigned[j] ) neighbours.push_back( j ); } );
+      //keep the input order of the neighbours, as the iterative engine does
+      std::sort( neighbours.begin(), neighbours.end() );
+      for( size_t j: neighbours ) {
+        assigned[j] = true;
+        cluster.push_back( j );
+      }
+    }
+  }
+}
+
+void EUTelClusterFinder::findSparseClusters(std::vector<SparseHit> const & hits, int minDistanceSquared,
+                                            Engine engine, ClusterIndexVec & clusters) {
+  clusters.clear();
+  if( engine == kIterative ) {
+    iterativeClustering( hits, minDistanceSquared, clusters );
+  } else {
+    SparseNeighbourFinder finder( hits, minDistanceSquared );
+    sweepClustering( hits.size(), finder, clusters );
+  }
+}
+
+void EUTelClusterFinder::findGeometricClusters(std::vector<GeometricHit> const & hits, float cutT,
+                                               Engine engine, ClusterIndexVec & clusters) {
+  clusters.clear();
+  if( engine == kIterative ) {
+    iterativeClustering( hits, cutT, clusters );
+  } else {
+    GeometricNeighbourFinder finder( hits, cutT );
+    sweepClustering( hits.size(), finder, clusters );
+  }
+}
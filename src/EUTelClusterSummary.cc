@@ -0,0 +1,147 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelClusterSummary.h"
+#include "EUTelExceptions.h"
+#include "EUTelPixelView.h"
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <cstdlib>
+#include <limits>
+
+using namespace lcio;
+using namespace eutelescope;
+
+namespace {
+  //layout of the LCGenericObject
+  enum IntIndex { kNoOfPixels, kXSeed, kYSeed, kXMin, kXMax, kYMin, kYMax, kNoOfInts };
+  enum FloatIndex { kTotalCharge, kSeedCharge, kCharge3x3, kCharge5x5, kXCoG, kYCoG, kXCoGShift, kYCoGShift, kNoOfFloats };
+}
+
+EUTelClusterSummary::EUTelClusterSummary():
+  _noOfPixels(0),
+  _xSeed(0), _ySeed(0),
+  _xMin(0), _xMax(0), _yMin(0), _yMax(0),
+  _totalCharge(0.),
+  _seedCharge(0.),
+  _charge3x3(0.),
+  _charge5x5(0.),
+  _xCoG(0.), _yCoG(0.),
+  _xCoGShift(0.), _yCoGShift(0.) {
+}
+
+EUTelClusterSummary::EUTelClusterSummary(IMPL::TrackerDataImpl const * data, SparsePixelType type):
+  EUTelClusterSummary() {
+
+  //first pass: seed, bounding box, total charge and centre of gravity
+  float maxSignal = -1 * std::numeric_limits<float>::max();
+  float xSum = 0., ySum = 0.;
+  _xMin = _yMin = std::numeric_limits<int>::max();
+  _xMax = _yMax = std::numeric_limits<int>::min();
+  bool knownType = forEachPixel( data, type, [&](EUTelBaseSparsePixel const & pixel) {
+      int x = pixel.getXCoord();
+      int y = pixel.getYCoord();
+      float signal = pixel.getSignal();
+      ++_noOfPixels;
+      if( signal > maxSignal ) {
+        maxSignal = signal;
+        _xSeed = x;
+        _ySeed = y;
+      }
+      if( x < _xMin ) _xMin = x;
+      if( x > _xMax ) _xMax = x;
+      if( y < _yMin ) _yMin = y;
+      if( y > _yMax ) _yMax = y;
+      _totalCharge += signal;
+      xSum += x * signal;
+      ySum += y * signal;
+    } );
+  if( !knownType ) throw UnknownDataTypeException("Unknown sparsified pixel");
+  if( _noOfPixels == 0 ) return;
+
+  _seedCharge = maxSignal;
+  _xCoG = xSum / _totalCharge;
+  _yCoG = ySum / _totalCharge;
+
+  //second pass: everything relative to the seed
+  float xShift = 0., yShift = 0.;
+  forEachPixel( data, type, [&](EUTelBaseSparsePixel const & pixel) {
+      int dx = pixel.getXCoord() - _xSeed;
+      int dy = pixel.getYCoord() - _ySeed;
+      float signal = pixel.getSignal();
+      xShift += signal * dx;
+      yShift += signal * dy;
+      if( std::abs( dx ) <= 1 && std::abs( dy ) <= 1 ) _charge3x3 += signal;
+      if( std::abs( dx ) <= 2 && std::abs( dy ) <= 2 ) _charge5x5 += signal;
+    } );
+  if( _noOfPixels > 1 && _totalCharge != 0 ) {
+    _xCoGShift = xShift / _totalCharge;
+    _yCoGShift = yShift / _totalCharge;
+  }
+}
+
+EUTelClusterSummary::EUTelClusterSummary(EVENT::LCGenericObject const * object):
+  EUTelClusterSummary() {
+  if( object->getNInt() < kNoOfInts || object->getNFloat() < kNoOfFloats ) return;
+  _noOfPixels  = object->getIntVal( kNoOfPixels );
+  _xSeed       = object->getIntVal( kXSeed );
+  _ySeed       = object->getIntVal( kYSeed );
+  _xMin        = object->getIntVal( kXMin );
+  _xMax        = object->getIntVal( kXMax );
+  _yMin        = object->getIntVal( kYMin );
+  _yMax        = object->getIntVal( kYMax );
+  _totalCharge = object->getFloatVal( kTotalCharge );
+  _seedCharge  = object->getFloatVal( kSeedCharge );
+  _charge3x3   = object->getFloatVal( kCharge3x3 );
+  _charge5x5   = object->getFloatVal( kCharge5x5 );
+  _xCoG        = object->getFloatVal( kXCoG );
+  _yCoG        = object->getFloatVal( kYCoG );
+  _xCoGShift   = object->getFloatVal( kXCoGShift );
+  _yCoGShift   = object->getFloatVal( kYCoGShift );
+}
+
+IMPL::LCGenericObjectImpl * EUTelClusterSummary::makeGenericObject() const {
+  IMPL::LCGenericObjectImpl * object = new IMPL::LCGenericObjectImpl( kNoOfInts, kNoOfFloats, 0 );
+  object->setIntVal( kNoOfPixels, _noOfPixels );
+  object->setIntVal( kXSeed, _xSeed );
+  object->setIntVal( kYSeed, _ySeed );
+  object->setIntVal( kXMin, _xMin );
+  object->setIntVal( kXMax, _xMax );
+  object->setIntVal( kYMin, _yMin );
+  object->setIntVal( kYMax, _yMax );
+  object->setFloatVal( kTotalCharge, _totalCharge );
+  object->setFloatVal( kSeedCharge, _seedCharge );
+  object->setFloatVal( kCharge3x3, _charge3x3 );
+  object->setFloatVal( kCharge5x5, _charge5x5 );
+  object->setFloatVal( kXCoG, _xCoG );
+  object->setFloatVal( kYCoG, _yCoG );
+  object->setFloatVal( kXCoGShift, _xCoGShift );
+  object->setFloatVal( kYCoGShift, _yCoGShift );
+  return object;
+}
+
+std::string EUTelClusterSummary::getCollectionName(std::string const & pulseCollectionName) {
+  return pulseCollectionName + "_summary";
+}
+
+IMPL::LCCollectionVec * EUTelClusterSummary::getCollection(EVENT::LCEvent * event, std::string const & pulseCollectionName, int noOfPulses) {
+  IMPL::LCCollectionVec * collection = 0;
+  try {
+    collection = dynamic_cast<IMPL::LCCollectionVec *>( event->getCollection( getCollectionName( pulseCollectionName ) ) );
+  } catch( lcio::DataNotAvailableException & ) {
+    return 0;
+  }
+  if( !collection || collection->getNumberOfElements() != noOfPulses ) return 0;
+  return collection;
+}
@@ -28,6 +28,7 @@
 #include "EUTelHistogramManager.h"
 #include "EUTelMatrixDecoder.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 #include "EUTelSparseClusterImpl.h"
 
 // marlin includes ".h"
@@ -91,6 +92,10 @@ EUTelClusteringProcessor::EUTelClusteringProcessor ()
       _sparseClusterCut(0.0),
       _sparseMinDistanceSquared(2),
       _sparseMinDistance(0.0),
+      _clusteringEngineName("Iterative"),
+      _clusteringEngine(EUTelClusterFinder::kIterative),
+      _nThreads(1),
+      _threadPool(),
       _iEvt(0),
       _fillHistos(false),
       _histoInfoFileName(""),
@@ -217,6 +222,12 @@ EUTelClusteringProcessor::EUTelClusteringProcessor ()
     registerProcessorParameter("SparseMinDistance","Minimum distance between sparsified pixel ( touching == sqrt(2)) ",
                                _sparseMinDistance, static_cast<float > (0.0 ) );
 
+    registerOptionalParameter("ClusteringEngine","Engine used for the sparse cluster search: Iterative (reference implementation) or Sweep (sorted neighbour search, same result)",
+                              _clusteringEngineName, string( "Iterative" ) );
+
+    registerOptionalParameter("NumberOfThreads","Number of threads running the sparse clustering of the planes of an event concurrently, 1 is serial, 0 uses all cores",
+                              _nThreads, static_cast<int>(1) );
+
 //  registerOptionalParameter("HotPixelDBFile","This is the name of the LCIO file name with the output hotpixel db (add .slcio)",
 //                             _hotPixelDBFile, static_cast< string > ( "hotpixel.slcio" ) );
 
@@ -260,6 +271,13 @@ void EUTelClusteringProcessor::init() {
 
     printParameters ();
 
+    _clusteringEngine = EUTelClusterFinder::engineFromString( _clusteringEngineName );
+
+    if ( _nThreads < 0 ) {
+        throw InvalidParameterException("NumberOfThreads has to be positive or 0 for all cores");
+    }
+    _threadPool = std::make_unique<EUTelThreadPool>( static_cast<unsigned>(_nThreads) );
+
     // in the case the FIXEDFRAME algorithm is selected, the check if
     // the _ffXClusterSize and the _ffYClusterSize are odd numbers
     if (
@@ -476,6 +494,7 @@ void EUTelClusteringProcessor::initializeStatusCollection(  )
 
         TrackerDataImpl * zsData = dynamic_cast< TrackerDataImpl * > ( zsInputDataCollectionVec->getElementAt( iDetector ) );
         int sensorID            = static_cast<int > ( cellDecoder( zsData )["sensorID"] );
+        SparsePixelType type    = static_cast<SparsePixelType> ( static_cast<int> (cellDecoder( zsData )["sparsePixelType"]) );
 
 
         //if this is an excluded sensor go to the next element
@@ -506,14 +525,10 @@ void EUTelClusteringProcessor::initializeStatusCollection(  )
         // prepare the matrix decoder
         EUTelMatrixDecoder matrixDecoder( noiseDecoder , noise );
 
-        // now prepare the EUTelescope interface to sparsified data.
-        auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-	auto& pixelVec = sparseData->getPixels();
+        streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << endl;
 
-        streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << " with "
-                                 << sparseData->size() << " pixels " << endl;
-
-	for( auto& sparsePixel: pixelVec ) {
+        // the pixels are decoded in place from the sparsified data.
+        bool knownType = forEachPixel( zsData, type, [&]( EUTelBaseSparsePixel const & sparsePixel ) {
 
             int decoded_XY_index = matrixDecoder.getIndexFromXY( sparsePixel.getXCoord(), sparsePixel.getYCoord() ); // unique pixel index !!
 
@@ -529,6 +544,9 @@ void EUTelClusteringProcessor::initializeStatusCollection(  )
             } else {
                 status->adcValues()[ _hitIndexMapVec[iDetector][ decoded_XY_index]  ] = EUTELESCOPE::HITPIXEL ;
             }
+        });
+        if ( !knownType ) {
+            throw UnknownDataTypeException("Unknown sparsified pixel");
         }
     }
     return;
@@ -864,16 +882,12 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(LCEvent * evt, LCColl
 
         //    bool firstfoundhitpixel = true;
 
-        if ( type == kEUTelGenericSparsePixel )
+        if ( isGenericSparsePixelStorage( type ) )
         {
-            // now prepare the EUTelescope interface to sparsified data.
-            auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-	    auto& pixelVec = sparseData->getPixels();
+            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << _sensorID << endl;
 
-            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << _sensorID << " with "
-                                     << sparseData->size() << " pixels " << endl;
-
-            for( auto& sparsePixel: pixelVec ) {
+            // the pixels are decoded in place from the sparsified data.
+            forEachPixel( zsData, type, [&]( EUTelBaseSparsePixel const & sparsePixel ) {
                 int index = matrixDecoder.getIndexFromXY( sparsePixel.getXCoord(), sparsePixel.getYCoord() );
 
                 if(static_cast<int>(_hitIndexMapVec.size()) > sensorID ){
@@ -884,11 +898,11 @@ void EUTelClusteringProcessor::digitalFixedFrameClustering(LCEvent * evt, LCColl
                             " unique index " << index <<
                             " at x = " << sparsePixel.getXCoord() <<
                             " y= " << sparsePixel.getYCoord() << endl;
-                        continue;
+                        return;
                     }
                 }
                 sensormatrix[sparsePixel.getXCoord()][sparsePixel.getYCoord()] = true;
-            }
+            });
         } else {
             throw UnknownDataTypeException("Unknown sparsified pixel");
         }
@@ -1337,16 +1351,12 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(LCEvent * evt, LCCollectio
         // prepare a multimap for the seed candidates
         multimap<float , int > seedCandidateMap;
 
-        if ( type == kEUTelGenericSparsePixel ) {
+        if ( isGenericSparsePixelStorage( type ) ) {
 
-            // now prepare the EUTelescope interface to sparsified data.
-            auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-	    auto& pixelVec = sparseData->getPixels();
+            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << endl;
 
-            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << " with "
-                                     << sparseData->size() << " pixels " << endl;
-
-	    for( auto& sparsePixel: pixelVec ) {
+            // the pixels are decoded in place from the sparsified data.
+            forEachPixel( zsData, type, [&]( EUTelBaseSparsePixel const & sparsePixel ) {
 	        int   index  = matrixDecoder.getIndexFromXY( sparsePixel.getXCoord(), sparsePixel.getYCoord() );
                 float signal = sparsePixel.getSignal();
                 dataVec[ index  ] = signal;
@@ -1362,7 +1372,7 @@ void EUTelClusteringProcessor::zsFixedFrameClustering(LCEvent * evt, LCCollectio
                                              << " with signal " << signal
                                              << " to the seedCandidateMap" << endl;
                 }
-            }
+            });
         } else {
             throw UnknownDataTypeException("Unknown sparsified pixel");
         }
@@ -1613,17 +1623,13 @@ void EUTelClusteringProcessor::zsBrickedClustering(LCEvent * evt, LCCollectionVe
         // prepare a multimap for the seed candidates
         multimap<float , int > seedCandidateMap;
 
-        if ( type == kEUTelGenericSparsePixel )
+        if ( isGenericSparsePixelStorage( type ) )
         {
 
-            // now prepare the EUTelescope interface to sparsified data.
-            auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-	    auto& pixelVec = sparseData->getPixels();
+            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << endl;
 
-            streamlog_out ( DEBUG1 ) << "Processing sparse data on detector " << sensorID << " with "
-                                     << sparseData->size() << " pixels " << endl;
-
-            for( auto& sparsePixel: pixelVec ) {    
+            // the pixels are decoded in place from the sparsified data.
+            forEachPixel( zsData, type, [&]( EUTelBaseSparsePixel const & sparsePixel ) {
 	        int   index  = matrixDecoder.getIndexFromXY( sparsePixel.getXCoord(), sparsePixel.getYCoord() );
                 float signal = sparsePixel.getSignal();
                 dataVec[ index ] = signal;
@@ -1653,7 +1659,7 @@ void EUTelClusteringProcessor::zsBrickedClustering(LCEvent * evt, LCCollectionVe
                     }
                 }
 
-            }
+            });
         }
         else
         {
@@ -1952,7 +1958,10 @@ void EUTelClusteringProcessor::sparseClustering(LCEvent* evt, LCCollectionVec* p
     CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
     // in the zsInputDataCollectionVec we should have one TrackerData for each
-    // detector working in ZS mode. We need to loop over all of them
+    // detector working in ZS mode. The decoders are not thread safe, so all
+    // of them are decoded here before the clustering
+    std::vector<SparsePlaneClusters> planes;
+    planes.reserve( zsInputDataCollectionVec->size() );
     for ( unsigned int idetector = 0 ; idetector < zsInputDataCollectionVec->size(); idetector++ )
     {
         // get the TrackerData and guess which kind of sparsified data it contains.
@@ -1975,149 +1984,62 @@ void EUTelClusteringProcessor::sparseClustering(LCEvent* evt, LCCollectionVec* p
             continue;
         }
 
-        // reset the cluster counter for the clusterID
-        int clusterID = 0;
-
-        if ( type == kEUTelGenericSparsePixel )
+        if ( !isGenericSparsePixelStorage( type ) )
         {
+            throw UnknownDataTypeException("Unknown sparsified pixel");
+        }
 
-            // now prepare the EUTelescope interface to sparsified data.
-            auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-
-            streamlog_out ( DEBUG2 ) << "Processing sparse data on detector " << sensorID << " with " << sparseData->size() << " pixels " << endl;
-
-            std::vector<EUTelGenericSparsePixel> hitPixelVec = sparseData->getPixels();
-
-            std::vector<EUTelGenericSparsePixel> newlyAdded;
-            //We now cluster those hits together
-            while( !hitPixelVec.empty() )
-            {
-                // prepare a TrackerData to store the cluster candidate
-                auto zsCluster = std::make_unique<TrackerDataImpl>();
-                // prepare a reimplementation of sparsified cluster
-                auto sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
-
-                std::vector<EUTelGenericSparsePixel> cluCandidate;
-
-                //First we need to take any pixel, so let's take the first one
-                //Add it to the cluster as well as the newly added pixels
-                newlyAdded.push_back( hitPixelVec.front() );
-                //sparseCluster->push_back( &(hitPixelVec.front()) );
-                cluCandidate.push_back( hitPixelVec.front() );
-                //And remove it from the original collection
-                hitPixelVec.erase( hitPixelVec.begin() );
-
-                //Now process all newly added pixels, initially this is the just previously added one
-                //but in the process of neighbour finding we continue to add new pixels
-                while( !newlyAdded.empty() )
-                {
-                    bool newlyDone = true;
-                    int  x1, x2, y1, y2, dX, dY;
-
-                    //check against all pixels in the hitPixelVec
-                    for( std::vector<EUTelGenericSparsePixel>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec )
-                    {
-                        //get the relevant infos from the newly added pixel
-                        x1 = newlyAdded.front().getXCoord();
-                        y1 = newlyAdded.front().getYCoord();
-
-                        //and the pixel we test against
-                        x2 = hitVec->getXCoord();
-                        y2 = hitVec->getYCoord();
-
-                        dX = x1 - x2;
-                        dY = y1 - y2;
-                        int distance = dX*dX+dY*dY;
-                        //if they pass the spatial and temporal cuts, we add them
-                        if( distance <= _sparseMinDistanceSquared )
-                        {
-                            //add them to the cluster as well as to the newly added ones
-                            newlyAdded.push_back( *hitVec );
-                            cluCandidate.push_back( *hitVec );
-                            //	sparseCluster->push_back( &(*hitVec) );
-                            //and remove it from the original collection
-                            hitPixelVec.erase( hitVec );
-                            //for the pixel we test there might be other neighbours, we still have to check
-                            newlyDone = false;
-                            break;
-                        }
-                    }
-
-                    //if no neighbours are found, we can delete the pixel from the newly added
-                    //we tested against _ALL_ non cluster pixels, there are no other pixels
-                    //which could be neighbours
-                    if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
-                }
+        // without hit pixels there is nothing to cluster
+        if ( zsData->getChargeValues().empty() )
+        {
+            continue;
+        }
 
-                // get the noise matrix with the right detectorID
-                TrackerDataImpl* noise  = dynamic_cast<TrackerDataImpl*>   (noiseCollectionVec->getElementAt( _ancillaryIndexMap[ sensorID ] ));
-                // prepare the matrix decoder
-                EUTelMatrixDecoder matrixDecoder( noiseDecoder , noise );
-                // prepare a vector to store the noise values
-                vector<float> noiseValueVec;
+        // get the noise matrix with the right detectorID
+        TrackerDataImpl* noise  = dynamic_cast<TrackerDataImpl*>   (noiseCollectionVec->getElementAt( _ancillaryIndexMap[ sensorID ] ));
+        // prepare the matrix decoder
+        EUTelMatrixDecoder matrixDecoder( noiseDecoder , noise );
 
-                //Hot pixel removement:
-                while(!cluCandidate.empty())
-                {
-                    EUTelGenericSparsePixel pixel = cluCandidate.front();
-                    cluCandidate.erase( cluCandidate.begin() );
+        planes.push_back( SparsePlaneClusters( zsData, type, sensorID, idetector, noise, matrixDecoder ) );
+    }
 
-                    int index = matrixDecoder.getIndexFromXY( pixel.getXCoord(), pixel.getYCoord() );
-                    if( _hitIndexMapVec[idetector].find( index ) != _hitIndexMapVec[idetector].end() )
-                    {
-                        // do nothing
-                    }
-                    else
-                    {
-                        sparseCluster->push_back( pixel );
-                        noiseValueVec.push_back(noise->getChargeValues()[ index ]);
-                    }
-                }
+    //the planes are clustered independently, possibly concurrently
+    _threadPool->run( planes.size(), [this, &planes](size_t i) { sparseClusteringPlane( planes[i] ); } );
 
-                sparseCluster->setNoiseValues( noiseValueVec );
+    //the found clusters are stored in plane order, independent of the number of threads
+    for( auto & plane: planes )
+    {
+        int sensorID = plane.sensorID;
 
-                //Now we need to process the found cluster
-                if ( (sparseCluster->size() > 0) && (sparseCluster->getSeedSNR() >= _sparseSeedCut) && (sparseCluster->getClusterSNR() >= _sparseClusterCut) )
-                {
-                    // set the ID for this zsCluster
-                    idZSClusterEncoder["sensorID"] = sensorID;
-                    idZSClusterEncoder["sparsePixelType"] = static_cast<int>( type );
-                    idZSClusterEncoder["quality"] = 0;
-                    idZSClusterEncoder.setCellID( zsCluster.get() );
-                    zsCluster->setTime(ID);
-
-                    // add it to the cluster collection
-                    sparseClusterCollectionVec->push_back( zsCluster.get() );
-
-                    // prepare a pulse for this cluster
-                    auto zsPulse = std::make_unique<TrackerPulseImpl>();
-                    idZSPulseEncoder["sensorID"] = sensorID;
-                    idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
-                    idZSPulseEncoder.setCellID( zsPulse.get() );
-
-                    zsPulse->setTime(ID);
-                    ID++;
-                    //zsPulse->setCharge( sparseCluster->getTotalCharge() );
-                    zsPulse->setTrackerData( zsCluster.release() );
-                    pulseCollection->push_back( zsPulse.release() );
-
-                    // last but not least increment the totClusterMap
-                    ++clusterID;
-                    _totClusterMap[ sensorID ] += 1;
-                } //cluster processing if
-
-                else
-                {
-                    //in the case the cluster candidate is not passing the threshold ...
-                    //forget about them, the memory should be automatically cleaned by  smart ptr's
-                }
-            } //loop over all found clusters
+        streamlog_out ( DEBUG2 ) << "Processing sparse data on detector " << sensorID << " with " << plane.nPixels << " pixels " << endl;
 
-        }
-        else
+        for( auto & zsCluster: plane.clusters )
         {
-            throw UnknownDataTypeException("Unknown sparsified pixel");
-        }
+            // set the ID for this zsCluster
+            idZSClusterEncoder["sensorID"] = sensorID;
+            idZSClusterEncoder["sparsePixelType"] = static_cast<int>( kEUTelGenericSparsePixel );
+            idZSClusterEncoder["quality"] = 0;
+            idZSClusterEncoder.setCellID( zsCluster.get() );
+            zsCluster->setTime(ID);
+
+            // add it to the cluster collection
+            sparseClusterCollectionVec->push_back( zsCluster.get() );
+
+            // prepare a pulse for this cluster
+            auto zsPulse = std::make_unique<TrackerPulseImpl>();
+            idZSPulseEncoder["sensorID"] = sensorID;
+            idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
+            idZSPulseEncoder.setCellID( zsPulse.get() );
+
+            zsPulse->setTime(ID);
+            ID++;
+            //zsPulse->setCharge( sparseCluster->getTotalCharge() );
+            zsPulse->setTrackerData( zsCluster.release() );
+            pulseCollection->push_back( zsPulse.release() );
+
+            // last but not least increment the totClusterMap
+            _totClusterMap[ sensorID ] += 1;
+        } //loop over all found clusters
     } // this is the end of the loop over all ZS detectors
 
     // if the sparseClusterCollectionVec isn't empty add it to the
@@ -2135,6 +2057,69 @@ void EUTelClusteringProcessor::sparseClustering(LCEvent* evt, LCCollectionVec* p
     }
 }
 
+void EUTelClusteringProcessor::sparseClusteringPlane(SparsePlaneClusters & plane) const
+{
+    // now prepare the EUTelescope interface to sparsified data.
+    auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(plane.zsData, plane.type);
+    plane.nPixels = sparseData->size();
+
+    std::vector<EUTelGenericSparsePixel> hitPixelVec = sparseData->getPixels();
+
+    //We now cluster those hits together
+    std::vector<EUTelClusterFinder::SparseHit> hits;
+    hits.reserve( hitPixelVec.size() );
+    for( auto const & pixel: hitPixelVec )
+    {
+        EUTelClusterFinder::SparseHit hit = { pixel.getXCoord(), pixel.getYCoord() };
+        hits.push_back( hit );
+    }
+    EUTelClusterFinder::ClusterIndexVec clusterIndices;
+    EUTelClusterFinder::findSparseClusters( hits, _sparseMinDistanceSquared, _clusteringEngine, clusterIndices );
+
+    std::map< int, int > const & hitIndexMap = _hitIndexMapVec[plane.idetector];
+
+    for( auto const & clusterIndex: clusterIndices )
+    {
+        // prepare a TrackerData to store the cluster candidate
+        auto zsCluster = std::make_unique<TrackerDataImpl>();
+        // prepare a reimplementation of sparsified cluster
+        auto sparseCluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
+
+        // prepare a vector to store the noise values
+        vector<float> noiseValueVec;
+
+        //Hot pixel removement:
+        for( size_t hitIndex: clusterIndex )
+        {
+            EUTelGenericSparsePixel const & pixel = hitPixelVec[hitIndex];
+
+            int index = plane.matrixDecoder.getIndexFromXY( pixel.getXCoord(), pixel.getYCoord() );
+            if( hitIndexMap.find( index ) != hitIndexMap.end() )
+            {
+                // do nothing
+            }
+            else
+            {
+                sparseCluster->push_back( pixel );
+                noiseValueVec.push_back(plane.noise->getChargeValues()[ index ]);
+            }
+        }
+
+        sparseCluster->setNoiseValues( noiseValueVec );
+
+        //Now we need to process the found cluster
+        if ( (sparseCluster->size() > 0) && (sparseCluster->getSeedSNR() >= _sparseSeedCut) && (sparseCluster->getClusterSNR() >= _sparseClusterCut) )
+        {
+            plane.clusters.push_back( std::move(zsCluster) );
+        }
+        else
+        {
+            //in the case the cluster candidate is not passing the threshold ...
+            //forget about them, the memory should be automatically cleaned by  smart ptr's
+        }
+    } //loop over all found clusters
+}
+
 
 void EUTelClusteringProcessor::fixedFrameClustering(LCEvent * evt, LCCollectionVec * pulseCollection) {
 
@@ -2922,11 +2907,10 @@ void EUTelClusteringProcessor::fillHistos (LCEvent * evt) {
                     ->fill(charges[i]);
             }
 
-            vector<int >::iterator iter = _clusterSpectraNxNVector.begin();
-            while ( iter != _clusterSpectraNxNVector.end() ) {
-                (dynamic_cast<AIDA::IHistogram1D*> (_clusterSignal_NxNHistos[*iter][detectorID]))
-                    ->fill(cluster->getClusterCharge((*iter), (*iter)));
-                ++iter;
+            vector<float > nxnCharges = cluster->getClusterChargeNxN(_clusterSpectraNxNVector);
+            for ( unsigned int i = 0; i < nxnCharges.size() ; i++ ) {
+                (dynamic_cast<AIDA::IHistogram1D*> (_clusterSignal_NxNHistos[_clusterSpectraNxNVector[i]][detectorID]))
+                    ->fill(nxnCharges[i]);
             }
 
             int xSeed, ySeed;
@@ -67,6 +67,7 @@
 #include <UTIL/CellIDDecoder.h>
 
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cmath>
@@ -96,6 +97,8 @@ EUTelDUTHistograms::EUTelDUTHistograms()
   _nRun(0),
   _zDUT(0.0),
   _distMax(0.0),
+  _optimalMatching(false),
+  _assignmentSolver(),
   _pitchX(0.0),
   _pitchY(0.0),
   _clusterSizeX(),
@@ -197,6 +200,10 @@ _PixelChargeSharingHisto ()
                               "Maximum allowed distance between fit and matched DUT hit in [mm]",
                               _distMax,  static_cast < double > (0.1));
 
+  registerOptionalParameter ("OptimalMatching",
+                             "Match DUT hits to tracks with the optimal assignment (largest number of matches, then smallest total distance) instead of track by track",
+                             _optimalMatching,  static_cast < bool > (false));
+
 
   registerProcessorParameter ("DUTpitchX",
                               "DUT sensor pitch in X",
@@ -380,10 +387,55 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
 
 
   // Match measured and fitted positions
+  // Matched hits are flagged instead of being removed, so that the hit
+  // indices stay valid for the cluster size and submatrix vectors
 
   int nMatch=0;
   double distmin;
 
+  std::vector<bool> hitMatched(_measuredX.size(), false);
+
+  // Optimal matching: one hit per track, largest number of matches and
+  // smallest total distance, using the best fitted position of each
+  // track for each hit
+  std::vector<int> optimalFit, optimalHit;
+  if( _optimalMatching )
+  {
+    int nHit = static_cast<int>(_measuredX.size());
+    std::vector<int> pairFit(_maptrackid*nHit, -1);
+    _assignmentSolver.reset(_maptrackid, nHit);
+    for(int itrack=0; itrack< _maptrackid; itrack++)
+    {
+      for(int ihit=0; ihit< nHit; ihit++)
+      {
+        double pairmin = _distMax*_distMax;
+        for(int ifit=0;ifit<static_cast<int>(_fittedX[itrack].size()); ifit++)
+        {
+          double dist2rd=
+            (_measuredX[ihit]-_fittedX[itrack][ifit])*(_measuredX[ihit]-_fittedX[itrack][ifit])
+            + (_measuredY[ihit]-_fittedY[itrack][ifit])*(_measuredY[ihit]-_fittedY[itrack][ifit]);
+          if(dist2rd<pairmin)
+          {
+            pairmin = dist2rd;
+            pairFit[itrack*nHit+ihit] = ifit;
+          }
+        }
+        if( pairFit[itrack*nHit+ihit] >= 0 ) _assignmentSolver.addCandidate(itrack, ihit, TMath::Sqrt(pairmin));
+      }
+    }
+    _assignmentSolver.solve();
+
+    optimalFit.assign(_maptrackid, -1);
+    optimalHit.assign(_maptrackid, -1);
+    for(int itrack=0; itrack< _maptrackid; itrack++)
+    {
+      int ihit = _assignmentSolver.getColumn(itrack);
+      if( ihit < 0 ) continue;
+      optimalHit[itrack] = ihit;
+      optimalFit[itrack] = pairFit[itrack*nHit+ihit];
+    }
+  }
+
   for(int itrack=0; itrack< _maptrackid; itrack++)
   {
     int bestfit=-1;
@@ -392,33 +444,48 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
     distmin = _distMax*_distMax + 10. ;
  
     if( static_cast<int>(_fittedX[itrack].size()) < 1 ) continue;
- 
-    for(int ifit=0;ifit<static_cast<int>(_fittedX[itrack].size()); ifit++)
+
+    if( _optimalMatching )
     {
-      if( _measuredX.empty() ) continue;
+      if( optimalHit[itrack] >= 0 )
+      {
+        besthit = optimalHit[itrack];
+        bestfit = optimalFit[itrack];
+        distmin =
+          (_measuredX[besthit]-_fittedX[itrack][bestfit])*(_measuredX[besthit]-_fittedX[itrack][bestfit])
+          + (_measuredY[besthit]-_fittedY[itrack][bestfit])*(_measuredY[besthit]-_fittedY[itrack][bestfit]);
+      }
+    }
+    else
+    {
+      for(int ifit=0;ifit<static_cast<int>(_fittedX[itrack].size()); ifit++)
+      {
+        if( _measuredX.empty() ) continue;
 
-      for(int ihit=0; ihit< static_cast<int>(_measuredX.size()) ; ihit++)
-        {
+        for(int ihit=0; ihit< static_cast<int>(_measuredX.size()) ; ihit++)
+          {
+            if( hitMatched[ihit] ) continue;
 
-          double dist2rd=
-            (_measuredX[ihit]-_fittedX[itrack][ifit])*(_measuredX[ihit]-_fittedX[itrack][ifit])
-            + (_measuredY[ihit]-_fittedY[itrack][ifit])*(_measuredY[ihit]-_fittedY[itrack][ifit]);
+            double dist2rd=
+              (_measuredX[ihit]-_fittedX[itrack][ifit])*(_measuredX[ihit]-_fittedX[itrack][ifit])
+              + (_measuredY[ihit]-_fittedY[itrack][ifit])*(_measuredY[ihit]-_fittedY[itrack][ifit]);
 
-	  if(streamlog_level(DEBUG5)){
-	    message<DEBUG5> ( log() << "Fit ["<< itrack << ":" << _maptrackid <<"], ifit= " << ifit << " ["<< _fittedX[itrack][ifit] << ":" << _fittedY[itrack][ifit] << "]" << endl) ;
-	    message<DEBUG5> ( log() << "rec " << ihit << " ["<< _measuredX[ihit] << ":" << _measuredY[ihit] << "]" << endl) ;
-	    message<DEBUG5> ( log() << "distance : " << TMath::Sqrt( dist2rd )  << endl) ;
-	  }
-          if(dist2rd<distmin)
-            {
-              distmin = dist2rd;
-              besthit = ihit;
-              bestfit = ifit;
-            }
-        }
+	    if(streamlog_level(DEBUG5)){
+	      message<DEBUG5> ( log() << "Fit ["<< itrack << ":" << _maptrackid <<"], ifit= " << ifit << " ["<< _fittedX[itrack][ifit] << ":" << _fittedY[itrack][ifit] << "]" << endl) ;
+	      message<DEBUG5> ( log() << "rec " << ihit << " ["<< _measuredX[ihit] << ":" << _measuredY[ihit] << "]" << endl) ;
+	      message<DEBUG5> ( log() << "distance : " << TMath::Sqrt( dist2rd )  << endl) ;
+	    }
+            if(dist2rd<distmin)
+              {
+                distmin = dist2rd;
+                besthit = ihit;
+                bestfit = ifit;
+              }
+          }
  
+      }
     }
- 
+
     // Match found:
 
     if( distmin < _distMax*_distMax  )
@@ -553,8 +620,7 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
         _fittedX[itrack].erase(_fittedX[itrack].begin()+bestfit);
         _fittedY[itrack].erase(_fittedY[itrack].begin()+bestfit);
 
-        _measuredX.erase(_measuredX.begin()+besthit);
-        _measuredY.erase(_measuredY.begin()+besthit);
+        hitMatched[besthit] = true;
 
         _localX[itrack].erase(_localX[itrack].begin()+bestfit);
         _localY[itrack].erase(_localY[itrack].begin()+bestfit);
@@ -566,7 +632,7 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
 
     if(streamlog_level(DEBUG5)){
       message<DEBUG5> ( log() << nMatch << " DUT hits matched to fitted tracks ");
-      message<DEBUG5> ( log() << _measuredX.size() << " DUT hits not matched to any track ");
+      message<DEBUG5> ( log() << std::count(hitMatched.begin(), hitMatched.end(), false) << " DUT hits not matched to any track ");
       message<DEBUG5> ( log() << "track "<<itrack<<" has " << _fittedX[itrack].size() << " _fittedX[itrack].size() not matched to any DUT hit ");
     }
 
@@ -594,6 +660,8 @@ void EUTelDUTHistograms::processEvent( LCEvent * event ) {
   // Noise plots - unmatched hits
 
   for(int ihit=0;ihit<static_cast<int>(_measuredX.size()); ihit++){
+      if( hitMatched[ihit] ) continue;
+
       (dynamic_cast<AIDA::IProfile1D*> ( _NoiseHistos.at(projX)))->fill(_measuredX[ihit],1.);
       (dynamic_cast<AIDA::IProfile1D*> ( _NoiseHistos.at(projY)))->fill(_measuredY[ihit],1.);
       (dynamic_cast<AIDA::IProfile2D*> ( _NoiseHistos.at(projXY)))->fill(_measuredX[ihit],_measuredY[ihit],1.);
@@ -15,6 +15,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
+#include "EUTelMappedFile.h"
 
 // marlin includes
 #include "marlin/Processor.h"
@@ -30,7 +31,7 @@
 // #include <UTIL/LCTOOLS.h>
 
 // system includes 
-#include <fstream>
+#include <cstdlib>
 
 using namespace std;
 using namespace marlin;
@@ -71,31 +72,28 @@ void EUTelEUDRBReader::init () {
 
 void EUTelEUDRBReader::readDataSource (int numEvents) {
 
-  ifstream inputFile;
-  inputFile.exceptions (ifstream::failbit | ifstream::badbit );
+  // the input file is mapped into memory and the events are decoded
+  // directly from there
+  EUTelMappedFile inputFile;
   
   // try to open the input file....
-  try {
-    inputFile.open (_fileName.c_str (), ios::in | ios::binary);
-  } catch (exception & e) {
+  if ( ! inputFile.open( _fileName ) ) {
     message<ERROR5> ( log() << "Problem opening file " << _fileName << ". Exiting." );
     exit (-1);
   }
   
   // read the file header
-  _fileHeader = new EUDRBFileHeader;
-
-  try {
-    inputFile.read(reinterpret_cast<char*>(_fileHeader), sizeof(EUDRBFileHeader));
-  } catch (exception & e) {
+  if ( inputFile.size() < sizeof(EUDRBFileHeader) ) {
     message<ERROR5> ( log() << "Problem reading the file header" );
     exit(-1);
   }
+  _fileHeader = new EUDRBFileHeader;
+  *_fileHeader = EUTelMappedFile::read< EUDRBFileHeader >( inputFile.data() );
 
   if (isFirstEvent() ) {
 
-    IMPL::LCRunHeaderImpl rdr      = new IMPL::LCRunHeaderImpl;
-    EUTelRunHeaderImpl * runHeader = new EUTelRunHeaderImpl(rdr)
+    IMPL::LCRunHeaderImpl * rdr    = new IMPL::LCRunHeaderImpl;
+    EUTelRunHeaderImpl * runHeader = new EUTelRunHeaderImpl(rdr);
     runHeader->setDAQHWName( "EUDRB" );
     runHeader->setNoOfEvent( _fileHeader->numberOfEvent + 1);
     runHeader->setNoOfDetector( _fileHeader->numberOfDetector * 4);
@@ -118,13 +116,53 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     delete runHeader;
     delete rdr;
 
-    _buffer = new int[ _fileHeader->dataSize / sizeof(int) ];
+  }
 
+  // this is made between frame 3 and frame 2
+  int frameRecordSize = _fileHeader->nXPixel * _fileHeader->nYPixel * 4 /*frame*/ / 2 /*pixel per record*/;
+
+  int firstFrame = -1;
+  int secondFrame = -1;
+  if ( ( _algo == "CDS32" ) || ( _algo == "LF2") ) {
+    firstFrame  = 1;
+    secondFrame = 2;
+  } else if ( ( _algo == "CDS21" ) || ( _algo == "LF1" ) ) {
+    firstFrame  = 0;
+    secondFrame = 1;
+  } else if ( _algo == "LF3" ) {
+    firstFrame = 2;
+    secondFrame = 3;
+  } 
+
+  // the CDS also reads the frame following the second one, all of
+  // them have to fit into the data block
+  int lastFrame = ( _algo.compare(0, 3, "CDS") == 0 ) ? secondFrame + 1 : secondFrame;
+  if ( frameRecordSize < 0 || _fileHeader->dataSize < 0 ||
+       static_cast< size_t >( _fileHeader->dataSize ) < static_cast< size_t >( lastFrame > 0 ? lastFrame : 0 ) * frameRecordSize * sizeof(int) ) {
+    message<ERROR5> ( log() << "The data block size " << _fileHeader->dataSize << " is too small for the "
+		      << _algo << " calculation. Exiting." );
+    exit(-1);
   }
 
+  // each event is made by the header, the data block and the trailer
+  const size_t dataOffset    = sizeof(EUDRBEventHeader);
+  const size_t trailerOffset = dataOffset + _fileHeader->dataSize;
+  const size_t recordSize    = trailerOffset + sizeof(EUDRBTrailer);
+  size_t recordOffset        = sizeof(EUDRBFileHeader);
+
   int iEvent;
   for ( iEvent = 0; iEvent < _fileHeader->numberOfEvent; iEvent++ ) {
 
+    if ( inputFile.size() - recordOffset < recordSize ) {
+      message<ERROR5> ( log() << "Problem reading the data block for event " << iEvent );
+      exit(-1);
+    }
+
+    // let the kernel read the next event while this one is decoded
+    inputFile.prefetch( recordOffset + recordSize, recordSize );
+    const char * record = inputFile.data() + recordOffset;
+    recordOffset += recordSize;
+
     EUTelEventImpl     * event = new EUTelEventImpl;
     event->setDetectorName("debug_detector");
     event->setRunNumber(0);
@@ -139,13 +177,7 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     CellIDEncoder < TrackerRawDataImpl > idEncoder (EUTELESCOPE::MATRIXDEFAULTENCODING, rawData);
     
     
-    EUDRBEventHeader eventHeader;
-    try {
-      inputFile.read(reinterpret_cast<char*>(&eventHeader), sizeof(eventHeader));
-    } catch (exception & e) {
-      message<ERROR5> ( log() << "Problem reading the event header for event " );
-      exit(-1);
-    }
+    EUDRBEventHeader eventHeader = EUTelMappedFile::read< EUDRBEventHeader >( record );
     
     // check the event number consistency
     if ( iEvent != eventHeader.eventNumber ) {
@@ -155,17 +187,11 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     event->setEventNumber(iEvent);
     
     
-    try {
-      inputFile.read(reinterpret_cast<char*>(_buffer), _fileHeader->dataSize );
-    } catch (exception& e) {
-      message<ERROR5> ( log() << "Problem reading the data block for event " << iEvent );
-      exit(-1);
-    }
+    // the data block is used in place, one record is a 32 bit word
+    const char * dataBlock = record + dataOffset;
+    auto dataWord = [dataBlock]( int iRecord ) { return EUTelMappedFile::read< int >( dataBlock + iRecord * sizeof(int) ); };
     
       
-    // this is made between frame 3 and frame 2
-    int frameRecordSize = _fileHeader->nXPixel * _fileHeader->nYPixel * 4 /*frame*/ / 2 /*pixel per record*/;
-    
     TrackerRawDataImpl * channelA = new TrackerRawDataImpl;
     idEncoder["sensorID"] = 0;
     idEncoder["xMin"]     = 0;
@@ -198,27 +224,14 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     idEncoder["yMax"]     = _fileHeader->nYPixel - 1;
     idEncoder.setCellID( channelD );
     
-    int firstFrame = -1;
-    int secondFrame = -1;
-    if ( ( _algo == "CDS32" ) || ( _algo == "LF2") ) {
-      firstFrame  = 1;
-      secondFrame = 2;
-    } else if ( ( _algo == "CDS21" ) || ( _algo == "LF1" ) ) {
-      firstFrame  = 0;
-      secondFrame = 1;
-    } else if ( _algo == "LF3" ) {
-      firstFrame = 2;
-      secondFrame = 3;
-    } 
-    
     for (int iRecord = firstFrame * frameRecordSize; iRecord < secondFrame * frameRecordSize; iRecord++ ) {
       
-      short pixelA1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
-      short pixelB1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
+      short pixelA1 = static_cast< short > ( ( dataWord( iRecord ) & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
+      short pixelB1 = static_cast< short > ( ( dataWord( iRecord ) & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
       if ( _algo.compare(0, 3, "CDS") == 0 ) {
-	short pixelA2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask ) >> 
+	short pixelA2 = static_cast< short > ( ( dataWord( iRecord + frameRecordSize ) & _fileHeader->chACBitMask ) >> 
 					       _fileHeader->chACRightShift  );
-	short pixelB2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask ) >> 
+	short pixelB2 = static_cast< short > ( ( dataWord( iRecord + frameRecordSize ) & _fileHeader->chBDBitMask ) >> 
 					       _fileHeader->chBDRightShift  );
 	channelA->adcValues().push_back( pixelA2 - pixelA1 );
 	channelB->adcValues().push_back( pixelB2 - pixelB1 );
@@ -229,12 +242,12 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
 
 
       ++iRecord;      
-      short pixelC1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
-      short pixelD1 = static_cast< short > ( ( _buffer[iRecord] & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
+      short pixelC1 = static_cast< short > ( ( dataWord( iRecord ) & _fileHeader->chACBitMask ) >> _fileHeader->chACRightShift ) ;
+      short pixelD1 = static_cast< short > ( ( dataWord( iRecord ) & _fileHeader->chBDBitMask ) >> _fileHeader->chBDRightShift ) ;
       if ( _algo.compare(0, 3, "CDS") == 0 ) {
-	short pixelC2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chACBitMask ) >> 
+	short pixelC2 = static_cast< short > ( ( dataWord( iRecord + frameRecordSize ) & _fileHeader->chACBitMask ) >> 
 					       _fileHeader->chACRightShift  );
-	short pixelD2 = static_cast< short > ( ( _buffer[iRecord + frameRecordSize] & _fileHeader->chBDBitMask ) >> 
+	short pixelD2 = static_cast< short > ( ( dataWord( iRecord + frameRecordSize ) & _fileHeader->chBDBitMask ) >> 
 					       _fileHeader->chBDRightShift  );
 	channelC->adcValues().push_back( pixelC2 - pixelC1 );
 	channelD->adcValues().push_back( pixelD2 - pixelD1 );
@@ -250,13 +263,7 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     rawData->push_back(channelC);
     rawData->push_back(channelD);
     
-    EUDRBTrailer eventTrailer;
-    try {
-      inputFile.read(reinterpret_cast<char*>(&eventTrailer), sizeof(eventTrailer));
-    } catch (exception & e) {
-      message<ERROR5> ( log() << "Problem reading the event trailer on event " << iEvent );
-      exit(-1);
-    }
+    EUDRBTrailer eventTrailer = EUTelMappedFile::read< EUDRBTrailer >( record + trailerOffset );
     // crosscheck the trailer
     if (eventTrailer.trailer != 0x89abcdef ) {
       message<WARNING> ( log() << "The trailer is not correct on event " << iEvent ) ;
@@ -267,7 +274,7 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
     ProcessorMgr::instance()->processEvent(static_cast<LCEventImpl*> (event) );
     delete event;
 
-    if ( inputFile.eof() ) break;
+    if ( recordOffset == inputFile.size() ) break;
   }
 
   // add the EORE event
@@ -291,7 +298,6 @@ void EUTelEUDRBReader::readDataSource (int numEvents) {
 
 void EUTelEUDRBReader::end () {
 
-  delete [] _buffer;
   message<MESSAGE5> ( "Successfully finished" );
 
 }
@@ -234,51 +234,46 @@ float EUTelFFClusterImpl::getSeedCharge() const {
 
 float EUTelFFClusterImpl::getClusterCharge(int nPixel) const {
 
-  vector<float > vectorCopy(_trackerData->getChargeValues());
+  if ( static_cast< size_t >(nPixel) >= _trackerData->getChargeValues().size() ) return getTotalCharge() ;
 
-  if ( static_cast< size_t >(nPixel) >= vectorCopy.size() ) return getTotalCharge() ;
-
-  sort(vectorCopy.begin(), vectorCopy.end(), greater<float>());
-
-  vector<float >::iterator iter = vectorCopy.begin();
-  float charge = 0;
-  while ( iter != vectorCopy.begin() + nPixel ) {
-    charge += *(iter);
-    ++iter;
-  }
-  return charge;
+  return getClusterCharge( vector<int >( 1, nPixel ) ).front();
 
 }
 
 std::vector<float> EUTelFFClusterImpl::getClusterCharge(std::vector<int > nPixels) const {
 
-  vector< float > clusterSignal;
+  EUTelClusterChargeProfile profile;
+  fillChargeProfile( profile );
+  return profile.getHighestCharges( nPixels );
 
-  vector<float> vectorCopy(_trackerData->getChargeValues());
-  sort(vectorCopy.begin(), vectorCopy.end(), greater<float>());
-  vector<float >::iterator iter;
+}
 
-  for (unsigned int i = 0; i < nPixels.size(); i++) {
-    iter = vectorCopy.begin();
-    float charge = 0;
+std::vector<float> EUTelFFClusterImpl::getClusterChargeNxN(std::vector<int > nxnSizes) const {
 
-    if ( static_cast< size_t >(nPixels[i]) >= vectorCopy.size() ) {
+  // the frame is centred on the seed pixel
+  EUTelClusterChargeProfile profile;
+  fillChargeProfile( profile );
+  return profile.getWindowCharges( 0, 0, nxnSizes );
 
-      clusterSignal.push_back( getTotalCharge() );
+}
 
-    } else {
+void EUTelFFClusterImpl::fillChargeProfile(EUTelClusterChargeProfile & profile) const {
 
-      while ( iter != vectorCopy.begin() + nPixels[i] ) {
-        charge += (*iter);
-        ++iter;
-      }
-      clusterSignal.push_back(charge);
+  int xCluSize, yCluSize;
+  getClusterSize(xCluSize, yCluSize);
 
+  // same pixel order as in getClusterCharge(int, int)
+  const FloatVec & charges = _trackerData->getChargeValues();
+  profile.reserve( charges.size() );
+  size_t iPixel = 0;
+  for (int yPixel = -1 * (yCluSize / 2); yPixel <= (yCluSize / 2); yPixel++) {
+    for (int xPixel = -1 * (xCluSize / 2); xPixel <= (xCluSize / 2); xPixel++) {
+      if ( iPixel >= charges.size() ) return;
+      profile.addPixel( xPixel, yPixel, charges[iPixel] );
+      ++iPixel;
     }
   }
 
-  return clusterSignal;
-
 }
 
 void EUTelFFClusterImpl::setNoiseValues(std::vector<float > noiseValues ) {
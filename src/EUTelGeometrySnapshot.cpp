@@ -0,0 +1,173 @@
+/*
+ * File:   EUTelGeometrySnapshot.cpp
+ *
+ */
+#include "EUTelGeometrySnapshot.h"
+
+// C++
+#include <cmath>
+#include <sstream>
+
+// EUTELESCOPE
+#include "EUTelExceptions.h"
+#include "EUTelPlaneTransform.h"
+
+// ROOT
+#include "TGeoNavigator.h"
+#include "TGeoNode.h"
+#include "TGeoVolume.h"
+#include "TGeoMedium.h"
+#include "TGeoMaterial.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelGeometrySnapshot::EUTelGeometrySnapshot(std::shared_ptr<TGeoManager> geoManager, std::shared_ptr<std::mutex> navigationMutex,
+                                             std::vector<int> const & sensorIDVec):
+_geoManager(geoManager),
+_multiThreadNavigation(false),
+_navigationMutex(navigationMutex),
+_sensorIDVec(sensorIDVec),
+_planes(),
+_materialBudgetMap()
+{}
+
+bool EUTelGeometrySnapshot::hasPlane(int sensorID) const {
+	size_t index = static_cast<size_t>(sensorID);
+	return sensorID >= 0 && index < _planes.size() && _planes[index].valid;
+}
+
+EUTelGeometrySnapshot::Plane const & EUTelGeometrySnapshot::plane(int sensorID) const {
+	if( !hasPlane(sensorID) ) {
+		std::stringstream ss;
+		ss << sensorID;
+		throw InvalidGeometryException("EUTelGeometrySnapshot: Could not find planeID: " + ss.str());
+	}
+	return _planes[sensorID];
+}
+
+void EUTelGeometrySnapshot::local2Master( int sensorID, const double localPos[], double globalPos[], size_t nPoints ) const {
+	planetransform::local2Master(plane(sensorID).transform, localPos, globalPos, nPoints);
+}
+
+void EUTelGeometrySnapshot::master2Local( int sensorID, const double globalPos[], double localPos[], size_t nPoints ) const {
+	planetransform::master2Local(plane(sensorID).transform, globalPos, localPos, nPoints);
+}
+
+void EUTelGeometrySnapshot::local2MasterVec( int sensorID, const double localVec[], double globalVec[], size_t nPoints ) const {
+	planetransform::local2MasterVec(plane(sensorID).transform, localVec, globalVec, nPoints);
+}
+
+void EUTelGeometrySnapshot::master2LocalVec( int sensorID, const double globalVec[], double localVec[], size_t nPoints ) const {
+	planetransform::master2LocalVec(plane(sensorID).transform, globalVec, localVec, nPoints);
+}
+
+Eigen::Vector3d EUTelGeometrySnapshot::siPlanePosition(int sensorID) const {
+	std::array<double,12> const & m = plane(sensorID).transform;
+	return Eigen::Vector3d(m[9], m[10], m[11]);
+}
+
+//the columns of the rotation matrix are the local axes expressed in the global frame
+Eigen::Vector3d EUTelGeometrySnapshot::siPlaneXAxis(int sensorID) const {
+	std::array<double,12> const & m = plane(sensorID).transform;
+	return Eigen::Vector3d(m[0], m[3], m[6]);
+}
+
+Eigen::Vector3d EUTelGeometrySnapshot::siPlaneYAxis(int sensorID) const {
+	std::array<double,12> const & m = plane(sensorID).transform;
+	return Eigen::Vector3d(m[1], m[4], m[7]);
+}
+
+Eigen::Vector3d EUTelGeometrySnapshot::siPlaneNormal(int sensorID) const {
+	std::array<double,12> const & m = plane(sensorID).transform;
+	return Eigen::Vector3d(m[2], m[5], m[8]);
+}
+
+double EUTelGeometrySnapshot::planeRadLengthGlobalIncidence(int sensorID, Eigen::Vector3d incidenceDir) const {
+	incidenceDir.normalize();
+	if( _materialBudgetMap && _materialBudgetMap->hasPlane(sensorID) ) {
+		Eigen::Vector3d localDir;
+		master2LocalVec(sensorID, incidenceDir.data(), localDir.data());
+		return _materialBudgetMap->planeRadLength(sensorID, 0, 0, localDir);
+	}
+	double scale = std::abs(incidenceDir.dot(siPlaneNormal(sensorID)));
+	return plane(sensorID).normRad/scale;
+}
+
+double EUTelGeometrySnapshot::planeRadLengthLocalIncidence(int sensorID, Eigen::Vector3d incidenceDir) const {
+	incidenceDir.normalize();
+	if( _materialBudgetMap && _materialBudgetMap->hasPlane(sensorID) ) {
+		return _materialBudgetMap->planeRadLength(sensorID, 0, 0, incidenceDir);
+	}
+	double scale = std::abs(incidenceDir(2));
+	return plane(sensorID).normRad/scale;
+}
+
+/**
+ * Same algorithm as EUTelGeometryTelescopeGeoDescription::FindRad. In TGeo
+ * multi-threaded mode all navigation is done with the navigator of the calling
+ * thread, if the thread does not own a navigator yet, one is created. Otherwise
+ * the single navigator of TGeo is shared by all threads and must not be used
+ * concurrently.
+ */
+double EUTelGeometrySnapshot::findRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) const {
+
+	std::unique_lock<std::mutex> lock(*_navigationMutex, std::defer_lock);
+	if( !_multiThreadNavigation ) lock.lock();
+
+	TGeoNavigator* nav = _geoManager->GetCurrentNavigator();
+	if( !nav ) nav = _geoManager->AddNavigator();
+
+	Eigen::Vector3d track = endPt-startPt;
+	double length = track.norm();
+	track.normalize();
+
+	double snext;
+	Eigen::Vector3d point;
+	Eigen::Vector3d direction;
+	double epsil = 0.00001;
+	double rad    = 0.;
+	double propagatedDistance = 0;
+	bool reachedEnd = false;
+
+	TGeoMedium* med;
+	nav->InitTrack(startPt(0), startPt(1), startPt(2), track(0), track(1), track(2));
+	TGeoNode* nextnode = nav->GetCurrentNode();
+
+	while(nextnode && !reachedEnd) {
+		med = nullptr;
+		if (nextnode) med = nextnode->GetVolume()->GetMedium();
+
+		nextnode = nav->FindNextBoundaryAndStep(length);
+		snext  = nav->GetStep();
+
+		if( propagatedDistance+snext >= length ) {
+			snext = length - propagatedDistance;
+			reachedEnd = true;
+		}
+		//snext gets very small at a transition into a next node, in this case we need to manually propagate a small (epsil)
+		//step into the direction of propagation.
+		if(snext < 1.e-8) {
+			const double * currDir = nav->GetCurrentDirection();
+			const double * currPt = nav->GetCurrentPoint();
+
+			direction(0) = currDir[0]; direction(1) = currDir[1]; direction(2) = currDir[2];
+			point(0) = currPt[0]; point(1) = currPt[1]; point(2) = currPt[2];
+
+			point = point + epsil*direction;
+
+			nav->CdTop();
+			nextnode = nav->FindNode(point(0),point(1),point(2));
+			snext = epsil;
+		}
+		if(med) {
+			//ROOT returns the rad length in cm while we use mm, therefore factor of 10
+			double radlen = med->GetMaterial()->GetRadLen();
+			if (radlen > 1.e-5 && radlen < 1.e10) {
+				rad += snext/(radlen*10);
+			}
+		}
+		propagatedDistance += snext;
+	}
+	return rad;
+}
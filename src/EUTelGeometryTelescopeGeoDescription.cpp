@@ -10,6 +10,7 @@
 #include <cstring>
 #include <cmath>
 #include <sstream>
+#include <limits>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -22,6 +23,7 @@
 // EUTELESCOPE
 #include "EUTelExceptions.h"
 #include "EUTelGenericPixGeoMgr.h"
+#include "EUTelPlaneTransform.h"
 
 // ROOT
 #include "TGeoManager.h"
@@ -40,6 +42,16 @@ using namespace geo;
 
 unsigned EUTelGeometryTelescopeGeoDescription::_counter = 0;
 
+namespace {
+	//The current geometry is registered as gGeoManager and cleaned up by ROOT,
+	//replaced ones are deleted when the last snapshot using them is gone
+	struct TGeoManagerDeleter {
+		void operator()(TGeoManager* geoManager) const {
+			if( geoManager != gGeoManager ) delete geoManager;
+		}
+	};
+}
+
 /**TODO: Replace me: NOP*/
 EUTelGeometryTelescopeGeoDescription& EUTelGeometryTelescopeGeoDescription::getInstance( gear::GearMgr* _g ) {
 	static  EUTelGeometryTelescopeGeoDescription instance;
@@ -267,7 +279,11 @@ _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _nPlanes(0),
 _isGeoInitialized(false),
-_geoManager(nullptr)
+_geoManager(nullptr),
+_planeTransforms(),
+_planeTransformValid(),
+_materialBudgetMap(),
+_navigationMutex(std::make_shared<std::mutex>())
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
 	gErrorIgnoreLevel =  kError;  
@@ -306,7 +322,6 @@ void EUTelGeometryTelescopeGeoDescription::readGear() {
 }
 
 EUTelGeometryTelescopeGeoDescription::~EUTelGeometryTelescopeGeoDescription() {
-	_geoManager.release();
 	delete _pixGeoMgr;
 	_pixGeoMgr = nullptr;
 }
@@ -317,13 +332,16 @@ EUTelGeometryTelescopeGeoDescription::~EUTelGeometryTelescopeGeoDescription() {
  */
 void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::string  tgeofilename ) {
     
-    _geoManager = std::unique_ptr<TGeoManager>(TGeoManager::Import(tgeofilename.c_str()));
-    _geoManager->SetBit(kCanDelete);
+    std::lock_guard<std::mutex> lock(*_navigationMutex);
+    _geoManager = std::shared_ptr<TGeoManager>(TGeoManager::Import(tgeofilename.c_str()), TGeoManagerDeleter());
 	if( !_geoManager ) {
         streamlog_out( WARNING ) << "Can't read file " << tgeofilename << std::endl;
+        return;
     }
+    _geoManager->SetBit(kCanDelete);
 
     _geoManager->CloseGeometry();
+    clearMemoizedValues();
 }
 
 /**
@@ -470,7 +488,7 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
 		streamlog_out( WARNING3 ) << "EUTelGeometryTelescopeGeoDescription: Geometry already initialized, using old initialization" << std::endl;
 		return;
 	} else {
-    		_geoManager = std::make_unique<TGeoManager>("Telescope", "v0.1");
+    		_geoManager = std::shared_ptr<TGeoManager>(new TGeoManager("Telescope", "v0.1"), TGeoManagerDeleter());
 			_geoManager->SetBit(kCanDelete);
 	}
 
@@ -517,6 +535,7 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
    }
     _geoManager->CloseGeometry();
     _isGeoInitialized = true;
+    clearMemoizedValues();
     // Dump ROOT TGeo object into file
     if ( dumpRoot ) _geoManager->Export( geomName.c_str() );
     return;
@@ -586,6 +605,47 @@ Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
 	return flipMat;
 }
 
+/**
+ * Returns the local to master transformation of the plane with given sensorID.
+ * The transformation is read once from the TGeo node of the plane and cached
+ * in a flat array indexed by the sensorID until clearMemoizedValues() is called.
+ * 
+ * @param sensorID Id of the sensor
+ * @return rotation matrix (row-major, 9 elements) followed by the translation (3 elements)
+ */
+std::array<double,12> const & EUTelGeometryTelescopeGeoDescription::planeTransform(int sensorID) {
+	size_t index = static_cast<size_t>(sensorID);
+	if( sensorID >= 0 && index < _planeTransformValid.size() && _planeTransformValid[index] ) {
+		return _planeTransforms[index];
+	}
+
+	std::map<int, std::string>::iterator pathIt = _planePath.find(sensorID);
+	if( sensorID < 0 || pathIt == _planePath.end() ) {
+		std::stringstream ss;
+		ss << sensorID;
+		throw InvalidGeometryException("EUTelGeometryTelescopeGeoDescription::planeTransform: Could not find planeID: " + ss.str());
+	}
+
+	if( index >= _planeTransformValid.size() ) {
+		_planeTransformValid.resize(index+1, false);
+	}
+	if( index >= _planeTransforms.size() ) {
+		_planeTransforms.resize(index+1);
+	}
+
+	std::lock_guard<std::mutex> lock(*_navigationMutex);
+	_geoManager->cd( pathIt->second.c_str() );
+	TGeoMatrix const * matrix = _geoManager->GetCurrentNode()->GetMatrix();
+	Double_t const * rotation = matrix->GetRotationMatrix();
+	Double_t const * translation = matrix->GetTranslation();
+
+	std::array<double,12>& transform = _planeTransforms[index];
+	std::copy(rotation, rotation+9, transform.begin());
+	std::copy(translation, translation+3, transform.begin()+9);
+	_planeTransformValid[index] = true;
+	return transform;
+}
+
 /**
  * Coordinate transformation from local reference frame of sensor with a given sensorID
  * to the global coordinate system
@@ -595,8 +655,7 @@ Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
  * @param globalPos (x,y,z) in global coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMaster( localPos, globalPos );
+	this->local2Master(sensorID, localPos, globalPos, 1);
 }
 
 /**
@@ -608,8 +667,7 @@ void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const dou
  * @param localPos (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocal( globalPos, localPos );
+	this->master2Local(sensorID, globalPos, localPos, 1);
 }
 
 /**
@@ -620,8 +678,7 @@ void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const doub
  * @param localVec (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->LocalToMasterVect( localVec, globalVec );
+	this->local2MasterVec(sensorID, localVec, globalVec, 1);
 }
 
 /**
@@ -632,8 +689,56 @@ void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const
  * @param localVec (x,y,z) in local coordinate system
  */
 void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) {
-    _geoManager->cd( _planePath[sensorID].c_str() );
-    _geoManager->GetCurrentNode()->MasterToLocalVect( globalVec, localVec );
+	this->master2LocalVec(sensorID, globalVec, localVec, 1);
+}
+
+/**
+ * Batched coordinate transformation from local reference frame of sensor with a
+ * given sensorID to the global coordinate system
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param localPos nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param globalPos nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param nPoints number of points to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[], size_t nPoints ) {
+	planetransform::local2Master(planeTransform(sensorID), localPos, globalPos, nPoints);
+}
+
+/**
+ * Batched coordinate transformation from global reference frame to local reference frame.
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param globalPos nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param localPos nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param nPoints number of points to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::master2Local( int sensorID, const double globalPos[], double localPos[], size_t nPoints ) {
+	planetransform::master2Local(planeTransform(sensorID), globalPos, localPos, nPoints);
+}
+
+/**
+ * Batched vector transformation from local reference frame to global reference frame.
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param localVec nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param globalVec nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param nPoints number of vectors to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[], size_t nPoints ) {
+	planetransform::local2MasterVec(planeTransform(sensorID), localVec, globalVec, nPoints);
+}
+
+/**
+ * Batched vector transformation from global reference frame to local reference frame.
+ * 
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param globalVec nPoints consecutive (x,y,z) triplets in global coordinate system
+ * @param localVec nPoints consecutive (x,y,z) triplets in local coordinate system
+ * @param nPoints number of vectors to transform
+ */
+void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[], size_t nPoints ) {
+	planetransform::master2LocalVec(planeTransform(sensorID), globalVec, localVec, nPoints);
 }
 
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) {
@@ -651,6 +756,8 @@ void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, std::a
 
 double EUTelGeometryTelescopeGeoDescription::FindRad(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) {
 
+	std::lock_guard<std::mutex> lock(*_navigationMutex);
+
 	Eigen::Vector3d track = endPt-startPt;
 	double length = track.norm();
 	track.normalize();
@@ -705,10 +812,50 @@ double EUTelGeometryTelescopeGeoDescription::FindRad(Eigen::Vector3d const & sta
 	return rad;   
 }
 
+std::shared_ptr<EUTelGeometrySnapshot const> EUTelGeometryTelescopeGeoDescription::createSnapshot(int maxThreads) {
+	if( !_geoManager ) {
+		throw InvalidGeometryException("EUTelGeometryTelescopeGeoDescription::createSnapshot: TGeo geometry is not initialised");
+	}
+
+	//all planes are filled below, this is the last time the shared TGeo state is touched
+	std::shared_ptr<EUTelGeometrySnapshot> snapshot( new EUTelGeometrySnapshot(_geoManager, _navigationMutex, _sensorIDVec) );
+	for( int sensorID: _sensorIDVec ) {
+		if( sensorID < 0 ) {
+			throw InvalidGeometryException("EUTelGeometryTelescopeGeoDescription::createSnapshot: negative sensorIDs are not supported");
+		}
+		size_t index = static_cast<size_t>(sensorID);
+		if( index >= snapshot->_planes.size() ) {
+			EUTelGeometrySnapshot::Plane empty;
+			empty.valid = false;
+			snapshot->_planes.resize(index+1, empty);
+		}
+		EUTelGeometrySnapshot::Plane& plane = snapshot->_planes[index];
+		plane.transform = planeTransform(sensorID);
+		plane.zSize = siPlaneZSize(sensorID);
+		plane.normRad = planeRadLengthLocalIncidence(sensorID, Eigen::Vector3d(0,0,1));
+		plane.valid = true;
+	}
+	snapshot->_materialBudgetMap = _materialBudgetMap;
+
+	std::lock_guard<std::mutex> lock(*_navigationMutex);
+	if( maxThreads > 1 && !_geoManager->IsMultiThread() ) {
+		streamlog_out( MESSAGE4 ) << "Switching TGeo into multi-threaded mode for " << maxThreads << " threads" << std::endl;
+		_geoManager->SetMaxThreads(maxThreads);
+	}
+	snapshot->_multiThreadNavigation = _geoManager->IsMultiThread();
+	return snapshot;
+}
+
 double EUTelGeometryTelescopeGeoDescription::planeRadLengthGlobalIncidence(int planeID, Eigen::Vector3d incidenceDir) {
 	
 	incidenceDir.normalize();
 	double normRad;
+
+	if( _materialBudgetMap && _materialBudgetMap->hasPlane(planeID) ) {
+		Eigen::Vector3d localDir;
+		master2LocalVec(planeID, incidenceDir.data(), localDir.data());
+		return _materialBudgetMap->planeRadLength(planeID, 0, 0, localDir);
+	}
 	
 	TVector3 planeNormalT = siPlaneNormal(planeID);
 	Eigen::Vector3d planeNormal(planeNormalT(0), planeNormalT(1), planeNormalT(2));
@@ -735,6 +882,10 @@ double EUTelGeometryTelescopeGeoDescription::planeRadLengthLocalIncidence(int pl
 	incidenceDir.normalize();
 	double normRad;
 
+	if( _materialBudgetMap && _materialBudgetMap->hasPlane(planeID) ) {
+		return _materialBudgetMap->planeRadLength(planeID, 0, 0, incidenceDir);
+	}
+
 	std::map<int, double>::iterator mapIt = _planeRadMap.find(planeID);
 	if( mapIt != _planeRadMap.end() ) {
 		normRad = mapIt->second;
@@ -755,6 +906,92 @@ double EUTelGeometryTelescopeGeoDescription::planeRadLengthLocalIncidence(int pl
 	return normRad/scale;
 }
 
+void EUTelGeometryTelescopeGeoDescription::initializeMaterialBudgetMap(EUTelMaterialBudgetMap::Binning const & binning) {
+	if( !_geoManager ) {
+		throw InvalidGeometryException("EUTelGeometryTelescopeGeoDescription::initializeMaterialBudgetMap: TGeo geometry is not initialised");
+	}
+
+	EUTelMaterialBudgetMap::RadSampler sampler = [this](Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) {
+		return this->FindRad(startPt, endPt);
+	};
+
+	std::shared_ptr<EUTelMaterialBudgetMap> materialBudgetMap = std::make_shared<EUTelMaterialBudgetMap>(binning);
+	for( int sensorID: _sensorIDVec ) {
+		std::array<double,12> const transform = planeTransform(sensorID);
+		double xSize = siPlaneXSize(sensorID);
+		double ySize = siPlaneYSize(sensorID);
+
+		//Same boundaries as for the normal incidence radiation length
+		double halfThickness = 0.51*siPlaneZSize(sensorID);
+		materialBudgetMap->addPlane(sensorID, transform, xSize, ySize, -halfThickness, halfThickness, sampler);
+		streamlog_out( MESSAGE4 ) << "Material budget map of plane " << sensorID
+		                          << ", largest deviation from ray tracing: " << materialBudgetMap->getMaxAbsoluteError(sensorID)
+		                          << " (" << 100*materialBudgetMap->getMaxRelativeError(sensorID) << "%)" << std::endl;
+
+		double zBegin, zEnd;
+		if( gapBoundaries(sensorID, zBegin, zEnd) ) {
+			materialBudgetMap->addGap(sensorID, transform, xSize, ySize, zBegin, zEnd, sampler);
+			streamlog_out( MESSAGE4 ) << "Material budget map of the gap behind plane " << sensorID
+			                          << ", largest deviation from ray tracing: " << materialBudgetMap->getMaxAbsoluteError(sensorID, true)
+			                          << " (" << 100*materialBudgetMap->getMaxRelativeError(sensorID, true) << "%)" << std::endl;
+		}
+	}
+	_materialBudgetMap = materialBudgetMap;
+}
+
+double EUTelGeometryTelescopeGeoDescription::planeRadLength(int planeID, double localX, double localY, Eigen::Vector3d const & localDir) {
+	if( _materialBudgetMap && _materialBudgetMap->hasPlane(planeID) ) {
+		return _materialBudgetMap->planeRadLength(planeID, localX, localY, localDir);
+	}
+	double halfThickness = 0.51*siPlaneZSize(planeID);
+	return traceLayerRadLength(planeID, localX, localY, localDir, -halfThickness, halfThickness);
+}
+
+double EUTelGeometryTelescopeGeoDescription::gapRadLength(int planeID, double localX, double localY, Eigen::Vector3d const & localDir) {
+	if( _materialBudgetMap && _materialBudgetMap->hasGap(planeID) ) {
+		return _materialBudgetMap->gapRadLength(planeID, localX, localY, localDir);
+	}
+	double zBegin, zEnd;
+	if( !gapBoundaries(planeID, zBegin, zEnd) ) return 0;
+	return traceLayerRadLength(planeID, localX, localY, localDir, zBegin, zEnd);
+}
+
+/**
+ * The gap starts where the plane layer ends and ends where the layer of the
+ * next plane starts, the distance between the two is taken along the normal
+ * of this plane. If the normal points upstream, the gap is at negative local z.
+ */
+bool EUTelGeometryTelescopeGeoDescription::gapBoundaries(int sensorID, double& zBegin, double& zEnd) {
+	std::vector<int>::const_iterator it = std::find(_sensorIDVec.begin(), _sensorIDVec.end(), sensorID);
+	if( it == _sensorIDVec.end() || it+1 == _sensorIDVec.end() ) return false;
+	int nextID = *(it+1);
+
+	TVector3 normal = siPlaneNormal(sensorID);
+	TVector3 distance( siPlaneXPosition(nextID) - siPlaneXPosition(sensorID),
+	                   siPlaneYPosition(nextID) - siPlaneYPosition(sensorID),
+	                   siPlaneZPosition(nextID) - siPlaneZPosition(sensorID) );
+	double dz = normal.Dot(distance);
+	double sign = dz < 0 ? -1 : 1;
+
+	zBegin = sign*0.51*siPlaneZSize(sensorID);
+	zEnd = dz - sign*0.51*siPlaneZSize(nextID);
+	return sign*(zEnd-zBegin) > 0;
+}
+
+double EUTelGeometryTelescopeGeoDescription::traceLayerRadLength(int sensorID, double localX, double localY, Eigen::Vector3d const & localDir, double zBegin, double zEnd) {
+	if( localDir(2) == 0 ) {
+		return std::numeric_limits<double>::infinity();
+	}
+	//The sign of the direction does not matter, the ray always goes from zBegin to zEnd
+	Eigen::Vector3d localStart(localX, localY, zBegin);
+	Eigen::Vector3d localEnd = localStart + (zEnd-zBegin)/localDir(2)*localDir;
+
+	Eigen::Vector3d globalStart, globalEnd;
+	local2Master(sensorID, localStart.data(), globalStart.data());
+	local2Master(sensorID, localEnd.data(), globalEnd.data());
+	return FindRad(globalStart, globalEnd);
+}
+
 
 
 void EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() {
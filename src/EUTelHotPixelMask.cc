@@ -0,0 +1,152 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelHotPixelMask.h"
+#include "EUTELESCOPE.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelPixelView.h"
+
+// lcio includes <.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDDecoder.h>
+
+// system includes <>
+#include <algorithm>
+#include <bitset>
+#include <map>
+
+using namespace lcio;
+using namespace eutelescope;
+
+EUTelHotPixelMask::EUTelHotPixelMask():
+  _sensorMasks(),
+  _noOfHotPixels(0) {
+}
+
+bool EUTelHotPixelMask::load(EVENT::LCEvent * event, std::string const & collectionName) {
+  clear();
+
+  LCCollectionVec * hotPixelCollectionVec = nullptr;
+  try {
+    hotPixelCollectionVec = dynamic_cast<LCCollectionVec *>( event->getCollection( collectionName ) );
+  } catch( lcio::DataNotAvailableException & ) {
+    return false;
+  }
+  if( !hotPixelCollectionVec ) return false;
+
+  CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
+  std::vector<HotPixel> pixels;
+
+  for( int i = 0; i < hotPixelCollectionVec->getNumberOfElements(); ++i ) {
+    TrackerDataImpl * hotPixelData = dynamic_cast<TrackerDataImpl *>( hotPixelCollectionVec->getElementAt( i ) );
+    int sensorID = cellDecoder( hotPixelData )["sensorID"];
+    int pixelType = cellDecoder( hotPixelData )["sparsePixelType"];
+
+    if( !isGenericSparsePixelStorage( pixelType ) ) {
+      streamlog_out( ERROR5 ) << "The hot pixel collection " << collectionName << " contains pixels of type " << pixelType
+                              << " on sensor " << sensorID << ", only EUTelGenericSparsePixel is supported" << std::endl;
+      continue;
+    }
+
+    forEachPixel( hotPixelData, static_cast<SparsePixelType>( pixelType ), [&](EUTelBaseSparsePixel const & pixel) {
+      HotPixel hotPixel = { sensorID, pixel.getXCoord(), pixel.getYCoord() };
+      pixels.push_back( hotPixel );
+    });
+  }
+
+  build( pixels );
+  return true;
+}
+
+void EUTelHotPixelMask::build(std::vector<HotPixel> const & pixels) {
+  clear();
+
+  //first pass: the bounding box of each sensor
+  struct BoundingBox {
+    int xMin, yMin, xMax, yMax;
+  };
+  std::map<int, BoundingBox> boxes;
+  for( auto const & pixel: pixels ) {
+    if( pixel.sensorID < 0 ) continue;
+    auto it = boxes.find( pixel.sensorID );
+    if( it == boxes.end() ) {
+      BoundingBox box = { pixel.x, pixel.y, pixel.x, pixel.y };
+      boxes.insert( std::make_pair( pixel.sensorID, box ) );
+    } else {
+      BoundingBox & box = it->second;
+      box.xMin = std::min( box.xMin, pixel.x );
+      box.yMin = std::min( box.yMin, pixel.y );
+      box.xMax = std::max( box.xMax, pixel.x );
+      box.yMax = std::max( box.yMax, pixel.y );
+    }
+  }
+  if( boxes.empty() ) return;
+
+  _sensorMasks.resize( boxes.rbegin()->first + 1 );
+  for( auto const & entry: boxes ) {
+    SensorMask & mask = _sensorMasks[entry.first];
+    mask.xMin = entry.second.xMin;
+    mask.yMin = entry.second.yMin;
+    mask.width = entry.second.xMax - entry.second.xMin + 1;
+    mask.height = entry.second.yMax - entry.second.yMin + 1;
+    size_t noOfBits = static_cast<size_t>( mask.width ) * mask.height;
+    mask.bits.assign( ( noOfBits + 63 ) / 64, 0 );
+  }
+
+  //second pass: set the bits, duplicated pixels are counted once
+  for( auto const & pixel: pixels ) {
+    if( pixel.sensorID < 0 ) continue;
+    SensorMask & mask = _sensorMasks[pixel.sensorID];
+    size_t bit = static_cast<size_t>( pixel.y - mask.yMin ) * mask.width + ( pixel.x - mask.xMin );
+    std::uint64_t flag = std::uint64_t( 1 ) << ( bit & 63 );
+    if( !( mask.bits[bit >> 6] & flag ) ) {
+      mask.bits[bit >> 6] |= flag;
+      ++_noOfHotPixels;
+    }
+  }
+
+  for( auto const & entry: boxes ) {
+    size_t noOfSensorPixels = 0;
+    for( auto word: _sensorMasks[entry.first].bits ) noOfSensorPixels += std::bitset<64>( word ).count();
+    streamlog_out( MESSAGE4 ) << "Read in " << noOfSensorPixels << " hot pixels on plane " << entry.first << std::endl;
+  }
+}
+
+void EUTelHotPixelMask::clear() {
+  _sensorMasks.clear();
+  _noOfHotPixels = 0;
+}
+
+bool EUTelHotPixelMask::hitContainsHotPixels(IMPL::TrackerHitImpl const * hit) const {
+  if( empty() || hit->getType() != kEUTelSparseClusterImpl ) return false;
+
+  EVENT::LCObjectVec const & clusterVector = hit->getRawHits();
+  if( clusterVector.empty() ) return false;
+
+  TrackerDataImpl const * clusterFrame = dynamic_cast<TrackerDataImpl const *>( clusterVector[0] );
+  if( !clusterFrame ) return false;
+
+  CellIDDecoder<TrackerDataImpl> cellDecoder( EUTELESCOPE::ZSCLUSTERDEFAULTENCODING );
+  int sensorID = cellDecoder( clusterFrame )["sensorID"];
+  SparsePixelType pixelType = static_cast<SparsePixelType>( static_cast<int>( cellDecoder( clusterFrame )["sparsePixelType"] ) );
+
+  //the pixels are decoded in place, up to the first hot one
+  bool containsHotPixel = false;
+  forEachPixel( clusterFrame, pixelType, [&](EUTelBaseSparsePixel const & pixel) {
+    containsHotPixel = isHot( sensorID, pixel.getXCoord(), pixel.getYCoord() );
+    return !containsHotPixel;
+  });
+
+  if( containsHotPixel ) {
+    streamlog_out( DEBUG3 ) << "Skipping hit as it was found in the hot pixel map." << std::endl;
+  }
+  return containsHotPixel;
+}
@@ -0,0 +1,76 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
+// system includes <>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+EUTelMappedFile::EUTelMappedFile():
+  _data(NULL),
+  _size(0),
+  _isOpen(false) {
+}
+
+EUTelMappedFile::~EUTelMappedFile() {
+  close();
+}
+
+bool EUTelMappedFile::open(std::string const & fileName) {
+  close();
+
+  int fd = ::open( fileName.c_str(), O_RDONLY );
+  if( fd < 0 ) return false;
+
+  struct stat fileStat;
+  if( fstat( fd, &fileStat ) != 0 || !S_ISREG( fileStat.st_mode ) ) {
+    ::close( fd );
+    return false;
+  }
+
+  size_t size = static_cast<size_t>( fileStat.st_size );
+  if( size != 0 ) {
+    void * address = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( address == MAP_FAILED ) {
+      ::close( fd );
+      return false;
+    }
+    madvise( address, size, MADV_SEQUENTIAL );
+    _data = static_cast<char *>( address );
+  }
+
+  //the mapping stays valid after closing the descriptor
+  ::close( fd );
+  _size = size;
+  _isOpen = true;
+  return true;
+}
+
+void EUTelMappedFile::close() {
+  if( _data ) munmap( _data, _size );
+  _data = NULL;
+  _size = 0;
+  _isOpen = false;
+}
+
+void EUTelMappedFile::prefetch(size_t offset, size_t length) const {
+  if( !_data || offset >= _size ) return;
+  if( length > _size - offset ) length = _size - offset;
+
+  //madvise wants a page aligned address
+  static const size_t pageSize = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+  size_t begin = offset - offset % pageSize;
+  madvise( _data + begin, length + ( offset - begin ), MADV_WILLNEED );
+}
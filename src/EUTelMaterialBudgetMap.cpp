@@ -0,0 +1,178 @@
+/*
+ * File:   EUTelMaterialBudgetMap.cpp
+ *
+ */
+#include "EUTelMaterialBudgetMap.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// EUTELESCOPE
+#include "EUTelExceptions.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelMaterialBudgetMap::EUTelMaterialBudgetMap(Binning const & binning):
+_binning(binning),
+_angleStep(0),
+_planes(),
+_gaps()
+{
+	if( _binning.nX < 2 || _binning.nY < 2 || _binning.nAngle < 2 || _binning.nAzimuth < 1 ) {
+		throw InvalidParameterException("EUTelMaterialBudgetMap: at least two grid points per axis and one azimuth are required");
+	}
+	if( _binning.maxAngle <= 0 || _binning.maxAngle >= M_PI/2 ) {
+		throw InvalidParameterException("EUTelMaterialBudgetMap: the largest angle has to be in ]0,pi/2[");
+	}
+	_angleStep = _binning.maxAngle/(_binning.nAngle-1);
+}
+
+void EUTelMaterialBudgetMap::addPlane( int sensorID, std::array<double,12> const & transform, double xSize, double ySize,
+                                       double zBegin, double zEnd, RadSampler const & sampler ) {
+	_planes[sensorID] = sampleLayer(transform, xSize, ySize, zBegin, zEnd, sampler);
+}
+
+void EUTelMaterialBudgetMap::addGap( int sensorID, std::array<double,12> const & transform, double xSize, double ySize,
+                                     double zBegin, double zEnd, RadSampler const & sampler ) {
+	_gaps[sensorID] = sampleLayer(transform, xSize, ySize, zBegin, zEnd, sampler);
+}
+
+double EUTelMaterialBudgetMap::planeRadLength( int sensorID, double localX, double localY, Eigen::Vector3d const & localDir ) const {
+	return interpolate(layer(_planes, sensorID), localX, localY, localDir);
+}
+
+double EUTelMaterialBudgetMap::gapRadLength( int sensorID, double localX, double localY, Eigen::Vector3d const & localDir ) const {
+	return interpolate(layer(_gaps, sensorID), localX, localY, localDir);
+}
+
+double EUTelMaterialBudgetMap::getMaxAbsoluteError( int sensorID, bool gap ) const {
+	return layer(gap ? _gaps : _planes, sensorID).maxAbsoluteError;
+}
+
+double EUTelMaterialBudgetMap::getMaxRelativeError( int sensorID, bool gap ) const {
+	return layer(gap ? _gaps : _planes, sensorID).maxRelativeError;
+}
+
+EUTelMaterialBudgetMap::Layer const & EUTelMaterialBudgetMap::layer( std::map<int, Layer> const & layers, int sensorID ) const {
+	std::map<int, Layer>::const_iterator it = layers.find(sensorID);
+	if( it == layers.end() ) {
+		std::stringstream ss;
+		ss << sensorID;
+		throw InvalidGeometryException("EUTelMaterialBudgetMap: no material budget sampled for planeID: " + ss.str());
+	}
+	return it->second;
+}
+
+EUTelMaterialBudgetMap::Layer EUTelMaterialBudgetMap::sampleLayer( std::array<double,12> const & transform, double xSize, double ySize,
+                                                                   double zBegin, double zEnd, RadSampler const & sampler ) const {
+	int const nX = _binning.nX;
+	int const nY = _binning.nY;
+	int const nAngle = _binning.nAngle;
+
+	Layer layer;
+	layer.xMin = -0.5*xSize;
+	layer.yMin = -0.5*ySize;
+	layer.xStep = xSize/(nX-1);
+	layer.yStep = ySize/(nY-1);
+	layer.values.resize(nAngle*nY*nX);
+
+	for( int iAngle = 0; iAngle < nAngle; ++iAngle ) {
+		double theta = iAngle*_angleStep;
+		for( int iY = 0; iY < nY; ++iY ) {
+			double y = layer.yMin + iY*layer.yStep;
+			for( int iX = 0; iX < nX; ++iX ) {
+				double x = layer.xMin + iX*layer.xStep;
+				layer.values[(iAngle*nY + iY)*nX + iX] = sampleNormalised(transform, x, y, theta, zBegin, zEnd, sampler);
+			}
+		}
+	}
+
+	//The largest interpolation error is expected in the middle of the cells, furthest
+	//away from all the samples, and for an azimuth which has not been averaged
+	double phi = M_PI/_binning.nAzimuth;
+	layer.maxAbsoluteError = 0;
+	layer.maxRelativeError = 0;
+	for( int iAngle = 0; iAngle < nAngle-1; ++iAngle ) {
+		double theta = (iAngle+0.5)*_angleStep;
+		Eigen::Vector3d dir(std::sin(theta)*std::cos(phi), std::sin(theta)*std::sin(phi), std::cos(theta));
+		for( int iY = 0; iY < nY-1; ++iY ) {
+			double y = layer.yMin + (iY+0.5)*layer.yStep;
+			for( int iX = 0; iX < nX-1; ++iX ) {
+				double x = layer.xMin + (iX+0.5)*layer.xStep;
+				double traced = traceRadLength(transform, x, y, theta, phi, zBegin, zEnd, sampler);
+				double error = std::abs(interpolate(layer, x, y, dir) - traced);
+				layer.maxAbsoluteError = std::max(layer.maxAbsoluteError, error);
+				if( traced > 0 ) layer.maxRelativeError = std::max(layer.maxRelativeError, error/traced);
+			}
+		}
+	}
+	return layer;
+}
+
+double EUTelMaterialBudgetMap::sampleNormalised( std::array<double,12> const & transform, double x, double y, double theta,
+                                                 double zBegin, double zEnd, RadSampler const & sampler ) const {
+	//At normal incidence all azimuths are the same ray
+	int nAzimuth = theta > 0 ? _binning.nAzimuth : 1;
+	double sum = 0;
+	for( int iPhi = 0; iPhi < nAzimuth; ++iPhi ) {
+		double phi = 2*M_PI*iPhi/nAzimuth;
+		sum += traceRadLength(transform, x, y, theta, phi, zBegin, zEnd, sampler);
+	}
+	return sum/nAzimuth*std::cos(theta);
+}
+
+double EUTelMaterialBudgetMap::traceRadLength( std::array<double,12> const & transform, double x, double y, double theta, double phi,
+                                               double zBegin, double zEnd, RadSampler const & sampler ) const {
+	double pathLength = (zEnd-zBegin)/std::cos(theta);
+	double localStart[3] = { x, y, zBegin };
+	double localEnd[3] = { x + pathLength*std::sin(theta)*std::cos(phi),
+	                       y + pathLength*std::sin(theta)*std::sin(phi),
+	                       zEnd };
+
+	Eigen::Vector3d globalStart, globalEnd;
+	for( int i = 0; i < 3; ++i ) {
+		globalStart(i) = transform[9+i];
+		globalEnd(i) = transform[9+i];
+		for( int j = 0; j < 3; ++j ) {
+			globalStart(i) += transform[3*i+j]*localStart[j];
+			globalEnd(i) += transform[3*i+j]*localEnd[j];
+		}
+	}
+	return sampler(globalStart, globalEnd);
+}
+
+double EUTelMaterialBudgetMap::interpolate( Layer const & layer, double localX, double localY, Eigen::Vector3d const & localDir ) const {
+	int const nX = _binning.nX;
+	int const nY = _binning.nY;
+	int const nAngle = _binning.nAngle;
+
+	//Position of the query in units of grid cells, clamped to the sampled range
+	double cosTheta = std::abs(localDir(2))/localDir.norm();
+	double u = std::min(std::max((localX - layer.xMin)/layer.xStep, 0.), nX-1.);
+	double v = std::min(std::max((localY - layer.yMin)/layer.yStep, 0.), nY-1.);
+	double w = std::min(std::acos(std::min(cosTheta, 1.))/_angleStep, nAngle-1.);
+
+	int iX = std::min(static_cast<int>(u), nX-2);
+	int iY = std::min(static_cast<int>(v), nY-2);
+	int iAngle = std::min(static_cast<int>(w), nAngle-2);
+	double fX = u-iX;
+	double fY = v-iY;
+	double fAngle = w-iAngle;
+
+	float const * c = &layer.values[(iAngle*nY + iY)*nX + iX];
+	int const yStride = nX;
+	int const angleStride = nX*nY;
+
+	double c00 = c[0]*(1-fX) + c[1]*fX;
+	double c10 = c[yStride]*(1-fX) + c[yStride+1]*fX;
+	double c01 = c[angleStride]*(1-fX) + c[angleStride+1]*fX;
+	double c11 = c[angleStride+yStride]*(1-fX) + c[angleStride+yStride+1]*fX;
+
+	double c0 = c00*(1-fY) + c10*fY;
+	double c1 = c01*(1-fY) + c11*fY;
+
+	return (c0*(1-fAngle) + c1*fAngle)/cosTheta;
+}
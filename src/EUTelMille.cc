@@ -65,7 +65,6 @@
 // ROOT includes
 #if defined(USE_ROOT) || defined(MARLIN_USE_ROOT)
 #include <TRandom.h>
-#include <TMinuit.h>
 #include <TSystem.h>
 #include <TMath.h>
 #include <TVector3.h>
@@ -88,14 +87,135 @@ using namespace lcio;
 using namespace marlin;
 using namespace eutelescope;
 
-//evil global variables ...
-//std::vector<EUTelMille::hit> hitsarray;
-EUTelMille::hit *hitsarray;
-unsigned int number_of_datapoints;
-void fcn_wrapper(int& /*npar*/, double* /*gin*/, double &f, double *par, int /*iflag*/)
+bool EUTelMille::trackfitter::minimise(double *x, double &chi2) const
 {
-  EUTelMille::trackfitter fobj(hitsarray,number_of_datapoints);
-  f = fobj.fit(par);
+  const int nPar = 4;
+  const int maxIterations = 100;
+
+  double par[nPar] = {x[0], x[1], x[2], x[3]};
+  chi2 = fit(par);
+
+  for(int iteration = 0; iteration < maxIterations; iteration++)
+    {
+      const double b0 = par[0];
+      const double b1 = par[1];
+      const double cosDelta = TMath::Cos(par[2]);
+      const double sinDelta = TMath::Sin(par[2]);
+      const double cosPsi = TMath::Cos(par[3]);
+      const double sinPsi = TMath::Sin(par[3]);
+
+      // the track direction and its derivatives w.r.t. delta and psi
+      const double c[3]      = {sinPsi, -1.0*cosPsi*sinDelta, cosDelta*cosPsi};
+      const double dcDelta[3] = {0.0, -1.0*cosPsi*cosDelta, -1.0*sinDelta*cosPsi};
+      const double dcPsi[3]   = {cosPsi, sinPsi*sinDelta, -1.0*cosDelta*sinPsi};
+
+      // normal equations of the linearised weighted least squares
+      double matrix[nPar][nPar] = {{0.0}};
+      double vector[nPar] = {0.0};
+
+      for(size_t i = 0; i < n; i++)
+        {
+          const double p[3] = {hitsarray[i].x, hitsarray[i].y, hitsarray[i].z};
+          const double weight[3] = {
+            1.0 / (hitsarray[i].resolution_x * hitsarray[i].resolution_x),
+            1.0 / (hitsarray[i].resolution_y * hitsarray[i].resolution_y),
+            1.0 / (hitsarray[i].resolution_z * hitsarray[i].resolution_z)
+          };
+          const double pmb[3] = {p[0]-b0, p[1]-b1, p[2]}; //p - b
+          const double la = dot(c, pmb);
+          const double laDelta = dot(dcDelta, pmb);
+          const double laPsi = dot(dcPsi, pmb);
+
+          for(int k = 0; k < 3; k++)
+            {
+              // residual b + c*lambda - p and its derivatives, with
+              // lambda = c.(p - b) depending on all the parameters
+              const double b = (k == 0) ? b0 : ( (k == 1) ? b1 : 0.0 );
+              const double residual = b + c[k]*la - p[k];
+              const double derivative[nPar] = {
+                ( (k == 0) ? 1.0 : 0.0 ) - c[k]*c[0],
+                ( (k == 1) ? 1.0 : 0.0 ) - c[k]*c[1],
+                dcDelta[k]*la + c[k]*laDelta,
+                dcPsi[k]*la + c[k]*laPsi
+              };
+              for(int row = 0; row < nPar; row++)
+                {
+                  vector[row] -= weight[k] * derivative[row] * residual;
+                  for(int col = 0; col < nPar; col++)
+                    {
+                      matrix[row][col] += weight[k] * derivative[row] * derivative[col];
+                    }
+                }
+            }
+        }
+
+      // solve for the step, Gauss elimination with partial pivoting
+      for(int col = 0; col < nPar; col++)
+        {
+          int pivot = col;
+          for(int row = col + 1; row < nPar; row++)
+            {
+              if(std::abs(matrix[row][col]) > std::abs(matrix[pivot][col])) pivot = row;
+            }
+          if(!(std::abs(matrix[pivot][col]) > 0.0)) return false;
+          if(pivot != col)
+            {
+              for(int k = 0; k < nPar; k++) std::swap(matrix[col][k], matrix[pivot][k]);
+              std::swap(vector[col], vector[pivot]);
+            }
+          for(int row = col + 1; row < nPar; row++)
+            {
+              const double factor = matrix[row][col] / matrix[col][col];
+              for(int k = col; k < nPar; k++) matrix[row][k] -= factor * matrix[col][k];
+              vector[row] -= factor * vector[col];
+            }
+        }
+      double step[nPar];
+      for(int row = nPar - 1; row >= 0; row--)
+        {
+          double sum = vector[row];
+          for(int k = row + 1; k < nPar; k++) sum -= matrix[row][k] * step[k];
+          step[row] = sum / matrix[row][row];
+        }
+
+      // take the step, halved until the chi2 does not increase
+      double trial[nPar];
+      double trialChi2 = chi2;
+      double scale = 1.0;
+      bool improved = false;
+      for(int halving = 0; halving < 20 && !improved; halving++, scale *= 0.5)
+        {
+          for(int k = 0; k < nPar; k++) trial[k] = par[k] + scale * step[k];
+          trialChi2 = fit(trial);
+          improved = (trialChi2 <= chi2);
+        }
+      if(!improved || !std::isfinite(trialChi2))
+        {
+          // no descent left, the minimum is reached
+          break;
+        }
+
+      const double chi2Change = chi2 - trialChi2;
+      for(int k = 0; k < nPar; k++) par[k] = trial[k];
+      chi2 = trialChi2;
+
+      if(chi2Change <= 1e-12 * (1.0 + chi2))
+        {
+          break;
+        }
+      if(iteration == maxIterations - 1)
+        {
+          return false;
+        }
+    }
+
+  // same ranges of the angles as for the former Minuit fit
+  if(std::abs(par[2]) > TMath::Pi() || std::abs(par[3]) > TMath::Pi())
+    {
+      return false;
+    }
+  for(int k = 0; k < nPar; k++) x[k] = par[k];
+  return std::isfinite(chi2);
 }
 
 
@@ -528,13 +648,6 @@ void EUTelMille::init() {
         }
     }
 
-  if(_alignMode == 3)
-    {
-//       number_of_datapoints = _nPlanes -_nExcludePlanes;
-      number_of_datapoints = _nPlanes;
-      hitsarray = new hit[number_of_datapoints];
-    }
-
   // booking histograms
   bookHistos();
 
@@ -606,10 +719,34 @@ void EUTelMille::processRunHeader (LCRunHeader * rdr) {
 
 
 
+void EUTelMille::findTrackCandidates(
+                            std::vector<IntVec > &indexarray,
+                            std::vector<std::vector<EUTelMille::HitsInPlane> > &_allHitsArray
+                            )
+{
+  if( _allHitsArray.empty() ) return;
+
+  // sort the hits of each plane in x once per event
+  _hitsSortedInX.resize( _allHitsArray.size() );
+  _hitsInWindow.resize( _allHitsArray.size() );
+  for(size_t i = 0; i < _allHitsArray.size(); i++)
+    {
+      _hitsSortedInX[i].clear();
+      for(size_t j = 0; j < _allHitsArray[i].size(); j++)
+        {
+          _hitsSortedInX[i].push_back( std::make_pair( _allHitsArray[i][j].measuredX, static_cast< int >(j) ) );
+        }
+      std::sort( _hitsSortedInX[i].begin(), _hitsSortedInX[i].end() );
+    }
+
+  IntVec path( _allHitsArray.size(), -1 );
+  findtracks2(0, indexarray, path, _allHitsArray, 0, 0);
+}
+
 void EUTelMille::findtracks2(
                             int missinghits,
                             std::vector<IntVec > &indexarray,
-                            IntVec vec,
+                            IntVec &path,
                             std::vector<std::vector<EUTelMille::HitsInPlane> > &_allHitsArray,
                             unsigned int i,
                             int y
@@ -625,140 +762,117 @@ void EUTelMille::findtracks2(
    return;
  }
 
+ const bool lastPlane = ( i >= _allHitsArray.size()-1 );
+
+ // once the candidate limit is reached only the candidates without a
+ // hit in the last plane are still taken, nothing else can be found
+ if( !_allHitsArray.back().empty() && static_cast< int >(indexarray.size()) >= _maxTrackCandidates )
+ {
+   return;
+ }
+
  if(i>0)
  { 
-    vec.push_back(y); // recall hit id from the plane (i-1)
+    path[i-1] = y; // recall hit id from the plane (i-1)
  }
 
-
- if( (_allHitsArray[i].size() == 0) && (i <_allHitsArray.size()-1) )
+ if( _allHitsArray[i].size() == 0 )
  {
-    findtracks2(missinghits,indexarray,vec, _allHitsArray, i+1, -1 ); 
- } 
-
- for(size_t j =0; j < _allHitsArray[i].size(); j++)
-    {
-      int ihit = static_cast< int >(j);
-      streamlog_out(DEBUG5) << "ihit:" << ihit << std::endl;
-
-      //if we are not in the last plane, call this method again
-      if(i < _allHitsArray.size()-1)
-        {
-          vec.push_back( ihit); //index of the cluster in the last plane
-         
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              double residualZ  = -999999.;
-
-              // ACTIVE
-              // stop on the last non-zero hit
-
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                  //     <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-		  streamlog_out(DEBUG9) << "residuals:" << std::endl;
-		  streamlog_out(DEBUG9) << residualX << std::endl;
-		  streamlog_out(DEBUG9) << residualY << std::endl;
-		  streamlog_out(DEBUG9) << residualZ << std::endl;
-
-                  break; 
-                }   
-              }
-           
-             if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
-
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
-          vec.pop_back(); 
-
-          if(taketrack)
-          { 
-              findtracks2(missinghits, indexarray, vec, _allHitsArray, i+1, ihit );
-          }
-        }
-      else
-        {
-          //we are in the last plane
-          vec.push_back( ihit ); //index of the cluster in the last plane
-
-          //track candidate requirements
-          bool taketrack = true;
-          const int e = vec.size()-2;
-          if(e >= 0)
-            {
-              double residualX  = -999999.;
-              double residualY  = -999999.;
-              //double residualZ  = -999999.;
+   if( !lastPlane )
+   {
+     findtracks2(missinghits, indexarray, path, _allHitsArray, i+1, -1 ); 
+   }
+   else
+   {
+     indexarray.push_back( IntVec( path.begin(), path.begin() + i ) );
+   }
+   return;
+ }
 
-              // now loop through all hits on a track candidate "vec"
-              // start at the end, stop on the first non-zero hit
-              for(int ivec=e; ivec>=e; --ivec)                        //   <-> OFF
-              {
-                if(vec[ivec]>=0) // non zero hit has id vec[ivec]>=0 {otherwise -1}
-                {
-                  double x = _allHitsArray[ivec][vec[ivec]].measuredX;
-                  double y = _allHitsArray[ivec][vec[ivec]].measuredY;
-                  //double z = _allHitsArray[ivec][vec[ivec]].measuredZ;
-                  residualX  = abs(x - _allHitsArray[e+1][vec[e+1]].measuredX);
-                  residualY  = abs(y - _allHitsArray[e+1][vec[e+1]].measuredY);
-                  //residualZ  = abs(z - _allHitsArray[e+1][vec[e+1]].measuredZ);
-                  break; 
-                }   
-              }
-           
-              if ( 
-                   residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
-                   residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
-                 )
-                 taketrack = false;
- 
-              if( taketrack == false )
-              {
-                taketrack = true; 
-                ihit=-1;
-              } 
-            }
+ if( lastPlane )
+ {
+   // every hit in the last plane makes a candidate
+   for(size_t j =0; j < _allHitsArray[i].size(); j++)
+   {
+     if(static_cast< int >(indexarray.size()) >= _maxTrackCandidates) break;
+     path[i] = static_cast< int >(j);
+     indexarray.push_back( IntVec( path.begin(), path.begin() + i + 1 ) );
+     streamlog_out(DEBUG9) << "indexarray size at last plane:" << indexarray.size() << std::endl;
+   }
+   return;
+ }
 
-          if(static_cast< int >(indexarray.size()) >= _maxTrackCandidates)
-            taketrack = false;
- 
-          if(taketrack)
-            {
-               indexarray.push_back(vec);
-	       streamlog_out(DEBUG9) << "indexarray size at last plane:" << indexarray.size() << std::endl;
-            }
-          vec.pop_back(); //last element must be removed because the
-                          //vector is still used -> we are in a last plane hit loop!
+ if( i == 0 )
+ {
+   // no residual window on the first plane
+   for(size_t j =0; j < _allHitsArray[i].size(); j++)
+   {
+     findtracks2(missinghits, indexarray, path, _allHitsArray, i+1, static_cast< int >(j) );
+   }
+   return;
+ }
 
-        }
-    }
+ // hits of this plane within the residual window of the hit in the
+ // previous plane: a range query in x, then the exact cuts
+ const unsigned int e = i-1;
+ IntVec & inWindow = _hitsInWindow[i];
+ inWindow.clear();
+ if( y >= 0 )
+ {
+   const double xPrevious = _allHitsArray[e][y].measuredX;
+   const double yPrevious = _allHitsArray[e][y].measuredY;
+   // slack for the rounding of the differences, the cuts are exact
+   const double slack = 1e-9 * ( 1.0 + abs(xPrevious) + abs(_residualsXMax[e]) );
+   std::vector<std::pair<double, int > > const & sorted = _hitsSortedInX[i];
+   std::vector<std::pair<double, int > >::const_iterator first =
+     std::lower_bound( sorted.begin(), sorted.end(), std::make_pair( xPrevious - _residualsXMax[e] - slack, -1 ) );
+   for( ; first != sorted.end() && first->first <= xPrevious + _residualsXMax[e] + slack; ++first )
+   {
+     const int ihit = first->second;
+     const double residualX = abs(xPrevious - _allHitsArray[i][ihit].measuredX);
+     const double residualY = abs(yPrevious - _allHitsArray[i][ihit].measuredY);
+     if ( 
+          residualX < _residualsXMin[e] || residualX > _residualsXMax[e] ||
+          residualY < _residualsYMin[e] || residualY > _residualsYMax[e] 
+        )
+       continue;
+     inWindow.push_back( ihit );
+   }
+   std::sort( inWindow.begin(), inWindow.end() );
+ }
 
-  if( (_allHitsArray[i].size() == 0) && (i >= _allHitsArray.size()-1) )
-  {
-               indexarray.push_back(vec);
-  } 
+ // the hits are taken in their order: a hit in the window continues the
+ // candidate, any other hit continues it with this plane missing. The
+ // candidates with this plane missing are the same for all these hits,
+ // they are searched once and copied for the next ones.
+ size_t missingBegin = 0;
+ size_t missingEnd = 0;
+ bool missingDone = false;
+ size_t nextInWindow = 0;
+ for(size_t j =0; j < _allHitsArray[i].size(); j++)
+ {
+   if( nextInWindow < inWindow.size() && inWindow[nextInWindow] == static_cast< int >(j) )
+   {
+     ++nextInWindow;
+     findtracks2(missinghits, indexarray, path, _allHitsArray, i+1, static_cast< int >(j) );
+   }
+   else if( !missingDone )
+   {
+     missingBegin = indexarray.size();
+     findtracks2(missinghits, indexarray, path, _allHitsArray, i+1, -1 );
+     missingEnd = indexarray.size();
+     missingDone = true;
+   }
+   else
+   {
+     for(size_t k = missingBegin; k < missingEnd; k++)
+     {
+       if( !_allHitsArray.back().empty() && static_cast< int >(indexarray.size()) >= _maxTrackCandidates ) break;
+       IntVec candidate( indexarray[k] );
+       indexarray.push_back( candidate );
+     }
+   }
+ }
 }
 
 
@@ -999,49 +1113,10 @@ double residYFit[], double angleFit[2]) {
 
 void  EUTelMille::FillHotPixelMap(LCEvent *event)
 {
-    LCCollectionVec *hotPixelCollectionVec = 0;
-    try 
-    {
-      hotPixelCollectionVec = static_cast< LCCollectionVec* > ( event->getCollection( _hotPixelCollectionName  ) );
-    }
-    catch (...)
+    if ( !_hotPixelMask.load( event, _hotPixelCollectionName ) && !_hotPixelCollectionName.empty() )
     {
-      if (!_hotPixelCollectionName.empty())
-	streamlog_out ( WARNING ) << "_hotPixelCollectionName " << _hotPixelCollectionName.c_str() << " not found" << endl; 
-      return;
+      streamlog_out ( WARNING ) << "_hotPixelCollectionName " << _hotPixelCollectionName.c_str() << " not found" << endl; 
     }
-
-        CellIDDecoder<TrackerDataImpl> cellDecoder( hotPixelCollectionVec );
-	
-        for(int i=0; i<  hotPixelCollectionVec->getNumberOfElements(); i++)
-        {
-           TrackerDataImpl* hotPixelData = dynamic_cast< TrackerDataImpl *> ( hotPixelCollectionVec->getElementAt( i ) );
-	   SparsePixelType  type         = static_cast<SparsePixelType> (static_cast<int> (cellDecoder( hotPixelData )["sparsePixelType"]));
-
-	   int sensorID              = static_cast<int > ( cellDecoder( hotPixelData )["sensorID"] );
-
-           if( type  ==  kEUTelGenericSparsePixel ) {  
-		
-   		auto m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-		auto& pixelVec = m26Data->getPixels();
-
-	for( auto& m26Pixel: pixelVec ) {
-              streamlog_out ( DEBUG3 ) << "Size: " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << endl;
-              try
-              {
-                 char ix[100];
-                 sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord() ); 
-                 _hotPixelMap[ix] = true;             
-              }
-              catch(...)
-              {
-                 std::cout << "can not add pixel " << std::endl;
-                 std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;   
-              }
-             }
-           }
-       }
-
 }
 
 void  EUTelMille::findMatchedHits(int& _ntrack, Track* TrackHere) {
@@ -1280,7 +1355,7 @@ void EUTelMille::processEvent (LCEvent * event) {
     std::vector<IntVec > indexarray;
 
     streamlog_out( DEBUG5 ) << "Event #" << _iEvt << std::endl;
-    findtracks2(0, indexarray, IntVec(), _allHitsArray, 0, 0);
+    findTrackCandidates(indexarray, _allHitsArray);
     for(size_t i = 0; i < indexarray.size(); i++)
       {
         for(size_t j = 0; j <  _nPlanes; j++)
@@ -1524,12 +1599,13 @@ void EUTelMille::processEvent (LCEvent * event) {
         {
           streamlog_out(MESSAGE1) << " AlignMode = " << _alignMode << " _inputMode = " << _inputMode << std::endl;
 
-          //use minuit to find tracks
+          //fit the tracks with rotations
+          std::vector<hit> hits;
+          hits.reserve(_nPlanes);
           size_t mean_n = 0  ;
           double mean_x = 0.0;
           double mean_y = 0.0;
           double mean_z = 0.0;
-          int index_hitsarray=0;
           double x0 = -1.;
           double y0 = -1.;
           //double z0 = -1.;
@@ -1590,13 +1666,11 @@ void EUTelMille::processEvent (LCEvent * event) {
                   sigmaz = 1000000.;
                 }
 
-                hitsarray[index_hitsarray] = (hit(
-                                                  x, y, z,
-                                                  sigmax, sigmay, sigmaz,
-                                                  help
-                                                  ));
-                
-                index_hitsarray++;
+                hits.push_back(hit(
+                                   x, y, z,
+                                   sigmax, sigmay, sigmaz,
+                                   help
+                                   ));
               }
           }
           mean_z = mean_z / static_cast< double >(mean_n);
@@ -1606,37 +1680,11 @@ void EUTelMille::processEvent (LCEvent * event) {
           int diff_mean = _nPlanes - mean_n;
           streamlog_out( MESSAGE0 ) << " diff_mean: " << diff_mean << " _nPlanes = " << _nPlanes << " mean_n = " << mean_n << std::endl;
 
-          if( diff_mean > getAllowedMissingHits() ) 
+          if( diff_mean > getAllowedMissingHits() || mean_n < 2 ) 
           {
              continue;
           }
 
-          static bool firstminuitcall = true;
-          
-          if(firstminuitcall)
-          {
-              gSystem->Load("libMinuit");//is this really needed?
-              firstminuitcall = false;
-          }          
-          TMinuit *gMinuit = new TMinuit(4);  //initialize TMinuit with a maximum of 4 params
-          
-          //  set print level (-1 = quiet, 0 = normal, 1 = verbose)
-          gMinuit->SetPrintLevel(-1);
-  
-          gMinuit->SetFCN(fcn_wrapper);
-          
-          double arglist[10];
-          int ierflg = 0;
-
-   
-          // minimization strategy (1 = standard, 2 = slower)
-          arglist[0] = 2;
-          gMinuit->mnexcm("SET STR",arglist,2,ierflg);
-          
-          // set error definition (1 = for chi square)
-          arglist[0] = 1;
-          gMinuit->mnexcm("SET ERR",arglist,1,ierflg);
-          
           //analytic track fit to guess the starting parameters
           double sxx = 0.0;
           double syy = 0.0;
@@ -1645,11 +1693,11 @@ void EUTelMille::processEvent (LCEvent * event) {
           double szx = 0.0;
           double szy = 0.0;
             
-          for(size_t i = 0; i< number_of_datapoints; i++)
+          for(size_t i = 0; i< hits.size(); i++)
           {
-            const double x = hitsarray[i].x;
-            const double y = hitsarray[i].y;
-            const double z = hitsarray[i].z;
+            const double x = hits[i].x;
+            const double y = hits[i].y;
+            const double z = hits[i].z;
             if( !(abs(x)<1e-06 && abs(y)<1e-06) )
             {
               sxx += pow(x-mean_x,2);
@@ -1670,43 +1718,17 @@ void EUTelMille::processEvent (LCEvent * event) {
           double ps = atan(linfit_x_a1/sqrt(1.0+linfit_y_a1*linfit_y_a1));//guess
                                                                           //of psi
             
-          //  Set starting values and step sizes for parameters
-          Double_t vstart[4] = {linfit_x_a0, linfit_y_a0, del, ps};
-          //duble vstart[4] = {0.0, 0.0, 0.0, 0.0};
-          double step[4] = {0.01, 0.01, 0.01, 0.01};
-            
-          gMinuit->mnparm(0, "b0", vstart[0], step[0], 0,0,ierflg);
-          gMinuit->mnparm(1, "b1", vstart[1], step[1], 0,0,ierflg);
-          gMinuit->mnparm(2, "delta", vstart[2], step[2], -1.0*TMath::Pi(), 1.0*TMath::Pi(),ierflg);
-          gMinuit->mnparm(3, "psi", vstart[3], step[3], -1.0*TMath::Pi(), 1.0*TMath::Pi(),ierflg);
-            
-
-          //  Now ready for minimization step
-          arglist[0] = 2000;
-          arglist[1] = 0.01;
-          gMinuit->mnexcm("MIGRAD", arglist ,1,ierflg);
-           
-          bool ok = true;
-            
-          if(ierflg != 0)
-          {
-            ok = false;            
-          }
-                    
-          //   get results from migrad
-          double b0 = 0.0;
-          double b1 = 0.0;
-          double delta = 0.0;
-          double psi = 0.0;
-          double b0_error = 0.0;
-          double b1_error = 0.0;
-          double delta_error = 0.0;
-          double psi_error = 0.0;
-          
-          gMinuit->GetParameter(0,b0,b0_error);
-          gMinuit->GetParameter(1,b1,b1_error);
-          gMinuit->GetParameter(2,delta,delta_error);
-          gMinuit->GetParameter(3,psi,psi_error);
+          // Gauss-Newton fit starting from the analytic estimate
+          double par[4] = {linfit_x_a0, linfit_y_a0, del, ps};
+          double chi2 = 0.0;
+          trackfitter fitter(&hits[0], hits.size());
+          bool ok = fitter.minimise(par, chi2);
+          validminuittrack = ok;
+
+          const double b0 = par[0];
+          const double b1 = par[1];
+          const double delta = par[2];
+          const double psi = par[3];
           
           double c0 = 1.0;
           double c1 = 1.0;
@@ -1761,7 +1783,6 @@ void EUTelMille::processEvent (LCEvent * event) {
 		*/
                 }
             }
-          delete gMinuit;
         }
       else
         {
@@ -2401,70 +2422,8 @@ TVector3 EUTelMille::Line2Plane(int iplane, const TVector3& lpoint, const TVecto
       
 bool EUTelMille::hitContainsHotPixels( TrackerHitImpl   * hit) 
 {
-  try
-    {
-      try{
-	LCObjectVec clusterVector = hit->getRawHits();
-
-	if ( hit->getType() == kEUTelSparseClusterImpl ) 
-	  {
-      
-	    TrackerDataImpl * clusterFrame = dynamic_cast<TrackerDataImpl*> ( clusterVector[0] );
-	    if (clusterFrame == 0){
-	      // found invalid result from cast
-	      throw UnknownDataTypeException("Invalid hit found in method hitContainsHotPixels()");
-	    }
-		
-	    auto cluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(clusterFrame);
-	    auto& pixelVec = cluster->getPixels();
-	    int sensorID = cluster->getDetectorID();
- 
-	    for( auto& m26Pixel: pixelVec ) {
-                int pixelX, pixelY;
-                pixelX = m26Pixel.getXCoord();
-                pixelY = m26Pixel.getYCoord();
-		{                       
-		    char ix[100];
-		    sprintf(ix, "%d,%d,%d", sensorID, pixelX, pixelY ); 
-		    std::map<std::string, bool >::const_iterator z = _hotPixelMap.find(ix);
-		    if(z!=_hotPixelMap.end() && _hotPixelMap[ix] == true  )
-		      { 
-			streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << endl;
-			return true; // if TRUE  this hit will be skipped
-		      }
-		} 
-	      }
-
-	  } else if ( hit->getType() == kEUTelBrickedClusterImpl ) {
-
-	  // fixed cluster implementation. Remember it
-	  //  can come from
-	  //  both RAW and ZS data
-                   
-	} else if ( hit->getType() == kEUTelDFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} else if ( hit->getType() == kEUTelFFClusterImpl ) {
-              
-	  // fixed cluster implementation. Remember it can come from
-	  // both RAW and ZS data
-	} 
-      }
-      catch(lcio::Exception e){
-	// catch specific exceptions
-          streamlog_out ( ERROR5 ) << "Exception occured in hitContainsHotPixels(): " << e.what() << endl;
-      }
-    }
-  catch(...)
-    { 
-      // if anything went wrong in the above return FALSE, meaning do not skip this hit
-      return 0;
-    }
-
-  // if none of the above worked return FALSE, meaning do not skip this hit
-  return 0;
-
+  // if TRUE this hit will be skipped
+  return _hotPixelMask.hitContainsHotPixels( hit );
 }
 
 
@@ -2479,11 +2438,6 @@ void EUTelMille::end() {
   delete [] _waferResidX;
   delete [] _waferResidZ;
 
-  if(_alignMode == 3)
-    {
-      delete []  hitsarray;
-    }
-
   // close the output file
   delete _mille;
 
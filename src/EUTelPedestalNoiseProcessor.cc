@@ -160,6 +160,12 @@ EUTelPedestalNoiseProcessor::EUTelPedestalNoiseProcessor () :Processor("EUTelPed
   registerOptionalParameter ("HitRejectionPreLoop",
                              "Perform a fast first loop to improve the efficiency of hit rejection",
                              _preLoopSwitch, static_cast< bool > ( true ) ) ;
+  registerOptionalParameter ("SinglePassEstimation",
+                             "Calculate pedestal, noise, common mode and bad pixels in one pass without rewinding the input files",
+                             _singlePassEstimation, static_cast< bool > ( false ) );
+  registerOptionalParameter ("SinglePassWarmUpEvents",
+                             "Number of events buffered for the robust starting values of the single pass estimation",
+                             _singlePassWarmUpEvents, static_cast< int > ( 100 ) );
 
 
   registerProcessorParameter ("FirstEvent",
@@ -208,6 +214,25 @@ void EUTelPedestalNoiseProcessor::init () {
   // set the geometry ready switch to false
   _isGeometryReady = false;
 
+  if ( _singlePassEstimation ) {
+    // the pre-loop is replaced by the robust warm up and everything
+    // is done during the first loop
+    _preLoopSwitch = false;
+    if ( _singlePassWarmUpEvents < 10 ) {
+      throw InvalidParameterException("SinglePassWarmUpEvents has to be at least 10");
+    }
+    if ( _pedestalAlgo != EUTELESCOPE::MEANRMS ) {
+      streamlog_out ( WARNING2 ) << "The single pass estimation is only available for the " << EUTELESCOPE::MEANRMS << " algorithm" << endl
+                                 << " Algorithm changed to " << EUTELESCOPE::MEANRMS << endl;
+      _pedestalAlgo = EUTELESCOPE::MEANRMS;
+    }
+    _runningMean.clear();
+    _runningM2.clear();
+    _runningEntries.clear();
+    _warmUpFrames.clear();
+    _isWarmUpDone = false;
+  }
+
   // set the loop counter
   if ( _preLoopSwitch ) _iLoop = -1;
   else _iLoop = 0;
@@ -296,6 +321,10 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
 
+  // the single pass estimation reads the data only once
+  int noOfPasses = _noOfCMIterations + 1 + additionalLoop;
+  if ( _singlePassEstimation ) noOfPasses = 1;
+
   if ( _lastEvent == -1 ) {
     // the user didn't select an upper limit for the event range, so
     // we don't know on how many events the calculation should be done
@@ -307,7 +336,7 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
       streamlog_out ( WARNING2 )  << "The MaxRecordNumber in the Global section of the steering file has been set to "
                                   << maxRecordNumber << ".\n"
                                   << "This means that in order to properly perform the pedestal calculation the maximum allowed number of events is "
-                                  << maxRecordNumber / ( _noOfCMIterations + 1 + additionalLoop ) << ".\n"
+                                  << maxRecordNumber / noOfPasses << ".\n"
                                   << "Let's hope it is correct and try to continue." << endl;
     }
   } else {
@@ -315,10 +344,10 @@ void EUTelPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
     // we can compare this number with the maxRecordNumber if
     // different from 0
     if ( maxRecordNumber != 0 ) {
-      if ( (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) > maxRecordNumber ) {
+      if ( (_lastEvent - _firstEvent) * noOfPasses > maxRecordNumber ) {
         streamlog_out ( ERROR4 ) << "The pedestal calculation should be done on " << _lastEvent - _firstEvent
-                                 << " times " <<  _noOfCMIterations + 1 << " iterations = "
-                                 << (_lastEvent - _firstEvent) * ( _noOfCMIterations + 1 + additionalLoop ) << " records.\n"
+                                 << " times " <<  noOfPasses << " iterations = "
+                                 << (_lastEvent - _firstEvent) * noOfPasses << " records.\n"
                                  << "The global variable MarRecordNumber is limited to " << maxRecordNumber << endl;
         throw InvalidParameterException("MaxRecordNumber");
       }
@@ -425,7 +454,8 @@ void EUTelPedestalNoiseProcessor::processEvent (LCEvent * evt) {
                                << " is of unknown type. Continue considering it as a normal Data Event." << endl;
   }
 
-  if ( _iLoop == -1 ) preLoop( evt );
+  if ( _singlePassEstimation ) singlePassLoop( evt );
+  else if ( _iLoop == -1 ) preLoop( evt );
   else if ( _iLoop == 0 ) firstLoop(evt);
   else if ( _additionalMaskingLoop ) {
     if ( _iLoop == _noOfCMIterations + 1 ) {
@@ -451,7 +481,9 @@ void EUTelPedestalNoiseProcessor::end() {
 
   int additionalLoop = 0;
   if ( _additionalMaskingLoop ) additionalLoop = 1;
-  if ( _iLoop == _noOfCMIterations + 1 + additionalLoop )  {
+  int noOfLoops = _noOfCMIterations + 1 + additionalLoop;
+  if ( _singlePassEstimation ) noOfLoops = 1;
+  if ( _iLoop == noOfLoops )  {
     streamlog_out ( MESSAGE4 ) << "Successfully finished" << endl;
   }  else {
     streamlog_out ( ERROR4 ) << "Not all the iterations have been done because of a too MaxRecordNumber.\n"
@@ -688,37 +720,44 @@ void EUTelPedestalNoiseProcessor::maskBadPixel() {
 
   if ( (  _additionalMaskingLoop ) &&
        ( _iLoop == _noOfCMIterations + 1 )) {
-    // now masking relying on the additional loop
-    for ( size_t iDetector = 0 ; iDetector < _noOfDetector; iDetector++ ) {
+    maskFiringPixel( _iEvt );
+  }
+}
 
-      for (unsigned int iPixel = 0; iPixel < _status[iDetector].size(); iPixel++) {
+void EUTelPedestalNoiseProcessor::maskFiringPixel(int noOfEvents) {
+
+  vector<int >  badPixelCounterVec( _noOfDetector, 0 );
+
+  // compare the firing frequency of each pixel with the allowed maximum
+  for ( size_t iDetector = 0 ; iDetector < _noOfDetector; iDetector++ ) {
+
+    for (unsigned int iPixel = 0; iPixel < _status[iDetector].size(); iPixel++) {
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-        if ( _histogramSwitch ) {
-          string tempHistoName;
-          tempHistoName = _fireFreqHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
-          if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[ tempHistoName ] ))
-            histo->fill( (static_cast<double> ( _hitCounter[ iDetector ][ iPixel ] )) / _iEvt * 100. );
-        }
+      if ( _histogramSwitch ) {
+        string tempHistoName;
+        tempHistoName = _fireFreqHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) ) + "_l" + to_string( _iLoop );
+        if ( AIDA::IHistogram1D * histo = dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[ tempHistoName ] ))
+          histo->fill( (static_cast<double> ( _hitCounter[ iDetector ][ iPixel ] )) / noOfEvents * 100. );
+      }
 #endif
-        if ( static_cast< double > ( _hitCounter[ iDetector ][ iPixel ] ) / _iEvt * 100. > _maxFiringFreq  ) {
-          _status[ iDetector ][ iPixel ] = EUTELESCOPE::BADPIXEL;
-          badPixelCounterVec[iDetector]++;
-        }
+      if ( static_cast< double > ( _hitCounter[ iDetector ][ iPixel ] ) / noOfEvents * 100. > _maxFiringFreq  ) {
+        _status[ iDetector ][ iPixel ] = EUTELESCOPE::BADPIXEL;
+        badPixelCounterVec[iDetector]++;
       }
-
-    } // end loop on detector
-    streamlog_out ( MESSAGE4 )  << "Masking summary after loop " << _iLoop << ": " << endl;
-    int totalBad = 0;
-    int total    = 0;
-    for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
-      streamlog_out ( MESSAGE4 ) << "Detector ID " << setw(4) << _orderedSensorIDVec[ iDetector ] << " has "
-                                 << setw(8) << badPixelCounterVec[iDetector] << " bad pixels (" << 100 * (1.0 * badPixelCounterVec[iDetector] )/ _status[iDetector].size()
-                                 << "%). " << endl;
-      totalBad += badPixelCounterVec[iDetector];
-      total    += _status[iDetector].size();
     }
-    streamlog_out ( MESSAGE4 ) << "Total masked pixels = " << totalBad << " (" << 100 * (1.0 * totalBad) / total << "%). " << endl;
+
+  } // end loop on detector
+  streamlog_out ( MESSAGE4 )  << "Masking summary after loop " << _iLoop << ": " << endl;
+  int totalBad = 0;
+  int total    = 0;
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; ++iDetector ) {
+    streamlog_out ( MESSAGE4 ) << "Detector ID " << setw(4) << _orderedSensorIDVec[ iDetector ] << " has "
+                               << setw(8) << badPixelCounterVec[iDetector] << " bad pixels (" << 100 * (1.0 * badPixelCounterVec[iDetector] )/ _status[iDetector].size()
+                               << "%). " << endl;
+    totalBad += badPixelCounterVec[iDetector];
+    total    += _status[iDetector].size();
   }
+  streamlog_out ( MESSAGE4 ) << "Total masked pixels = " << totalBad << " (" << 100 * (1.0 * totalBad) / total << "%). " << endl;
 }
 
 
@@ -1077,127 +1116,12 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
         // common mode per matrix, we will have a vector of floats
         // containing the common mode correction for each pixel
         vector< float > commonModeCorVec;
-        commonModeCorVec.clear();
-
-        bool isEventValid = true;
         int    skippedPixel = 0;
         int    skippedRow   = 0;
 
         size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
 
-        if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
-
-          double pixelSum     = 0.;
-          double commonMode   = 0.;
-          int    goodPixel    = 0;
-          int    iPixel       = 0;
-
-          // start looping on all pixels for hit rejection
-          for (int yPixel = _minY[iDetector + detectorOffset ]; yPixel <= _maxY[iDetector + detectorOffset ]; yPixel++) {
-            for (int xPixel = _minX[iDetector + detectorOffset ]; xPixel <= _maxX[iDetector + detectorOffset ]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset ][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset ][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-          }
-
-          if ( ( skippedPixel < _maxNoOfRejectedPixels ) &&
-               ( goodPixel != 0 ) ) {
-
-            commonMode = pixelSum / goodPixel;
-            commonModeCorVec.insert( commonModeCorVec.begin(), iPixel + 1 , commonMode );
-            isEventValid = true;
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
-
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
-
-          int    iPixel       = 0;
-          int    colCounter   = 0;
-          int    rowLength    = _maxX[iDetector + detectorOffset] -  _minX[iDetector + detectorOffset] + 1;
-
-          for (int yPixel = _minY[iDetector + detectorOffset]; yPixel <= _maxY[iDetector + detectorOffset]; yPixel++) {
-
-            double pixelSum           = 0.;
-            double commonMode         = 0.;
-            int    goodPixel          = 0;
-            int    skippedPixelPerRow = 0;
-
-            for ( int xPixel = _minX[iDetector + detectorOffset]; xPixel <= _maxX[iDetector + detectorOffset]; xPixel++) {
-              bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel] ) > _hitRejectionCut * _noise[iDetector + detectorOffset][iPixel] );
-              bool isGood = ( _status[iDetector + detectorOffset][iPixel] == EUTELESCOPE::GOODPIXEL );
-              if ( !isHit && isGood ) {
-                pixelSum += adcValues[iPixel] - _pedestal[iDetector + detectorOffset][iPixel];
-                ++goodPixel;
-              } else if ( isHit ) {
-                ++skippedPixelPerRow;
-                ++skippedPixel;
-              }
-              ++iPixel;
-            }
-
-            // we are now at the end of the row, so let's calculate the
-            // common mode
-            if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
-                 ( goodPixel != 0 ) ) {
-              commonMode = pixelSum / goodPixel ;
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-              string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector + detectorOffset ) )
-                + "_l" + to_string( _iLoop );
-              AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
-              if ( histo ) {
-                histo->fill(commonMode);
-              }
-#endif
-
-            } else {
-              commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
-              ++skippedRow;
-            }
-
-            ++colCounter;
-          }
-
-
-          if ( skippedRow < _maxNoOfSkippedRow ) {
-
-            isEventValid = true;
-
-          } else {
-
-            isEventValid = false;
-
-          }
-
-        } else {
-          streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
-          commonModeCorVec.insert( commonModeCorVec.begin(),
-                                   ( _maxY[iDetector + detectorOffset] - _minY[iDetector + detectorOffset] + 1 ) *
-                                   ( _maxX[iDetector + detectorOffset] - _minX[iDetector + detectorOffset] + 1 ),
-                                   0. );
-          isEventValid = true;
-        }
+        bool isEventValid = commonModeCorrection( adcValues, iDetector + detectorOffset, commonModeCorVec, skippedPixel, skippedRow );
 
 
         if ( isEventValid ) {
@@ -1267,6 +1191,132 @@ void EUTelPedestalNoiseProcessor::otherLoop(LCEvent * event) {
 
 }
 
+bool EUTelPedestalNoiseProcessor::commonModeCorrection(const ShortVec & adcValues, size_t iDetector, vector< float > & commonModeCorVec,
+                                                       int & skippedPixel, int & skippedRow) {
+
+  commonModeCorVec.clear();
+  skippedPixel = 0;
+  skippedRow   = 0;
+
+  bool isEventValid = true;
+
+  if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
+
+    double pixelSum     = 0.;
+    double commonMode   = 0.;
+    int    goodPixel    = 0;
+    int    iPixel       = 0;
+
+    // start looping on all pixels for hit rejection
+    for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+      for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+        bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector][iPixel] ) > _hitRejectionCut * _noise[iDetector][iPixel] );
+        bool isGood = ( _status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL );
+        if ( !isHit && isGood ) {
+          pixelSum += adcValues[iPixel] - _pedestal[iDetector][iPixel];
+          ++goodPixel;
+        } else if ( isHit ) {
+          ++skippedPixel;
+        }
+        ++iPixel;
+      }
+    }
+
+    if ( ( skippedPixel < _maxNoOfRejectedPixels ) &&
+         ( goodPixel != 0 ) ) {
+
+      commonMode = pixelSum / goodPixel;
+      commonModeCorVec.insert( commonModeCorVec.begin(), iPixel + 1 , commonMode );
+      isEventValid = true;
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) )
+          + "_l" + to_string( _iLoop );
+        AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
+        if ( histo ) {
+          histo->fill(commonMode);
+        }
+#endif
+
+    } else {
+
+      isEventValid = false;
+
+    }
+
+  } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
+
+    int    iPixel       = 0;
+    int    colCounter   = 0;
+    int    rowLength    = _maxX[iDetector] -  _minX[iDetector] + 1;
+
+    for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+
+      double pixelSum           = 0.;
+      double commonMode         = 0.;
+      int    goodPixel          = 0;
+      int    skippedPixelPerRow = 0;
+
+      for ( int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+        bool isHit  = ( ( adcValues[iPixel] - _pedestal[iDetector][iPixel] ) > _hitRejectionCut * _noise[iDetector][iPixel] );
+        bool isGood = ( _status[iDetector][iPixel] == EUTELESCOPE::GOODPIXEL );
+        if ( !isHit && isGood ) {
+          pixelSum += adcValues[iPixel] - _pedestal[iDetector][iPixel];
+          ++goodPixel;
+        } else if ( isHit ) {
+          ++skippedPixelPerRow;
+          ++skippedPixel;
+        }
+        ++iPixel;
+      }
+
+      // we are now at the end of the row, so let's calculate the
+      // common mode
+      if ( ( skippedPixelPerRow < _maxNoOfRejectedPixelPerRow ) &&
+           ( goodPixel != 0 ) ) {
+        commonMode = pixelSum / goodPixel ;
+        commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, commonMode );
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+        string histoname = _commonModeHistoName + "_d" + to_string( _orderedSensorIDVec.at( iDetector ) )
+          + "_l" + to_string( _iLoop );
+        AIDA::IHistogram1D * histo = (dynamic_cast<AIDA::IHistogram1D*>(_aidaHistoMap[ histoname ]));
+        if ( histo ) {
+          histo->fill(commonMode);
+        }
+#endif
+
+      } else {
+        commonModeCorVec.insert( commonModeCorVec.begin() + colCounter * rowLength, rowLength, 0. );
+        ++skippedRow;
+      }
+
+      ++colCounter;
+    }
+
+
+    if ( skippedRow < _maxNoOfSkippedRow ) {
+
+      isEventValid = true;
+
+    } else {
+
+      isEventValid = false;
+
+    }
+
+  } else {
+    streamlog_out ( ERROR4 ) << "Unknown common mode algorithm. Using flat null correction" << endl;
+    commonModeCorVec.insert( commonModeCorVec.begin(),
+                             ( _maxY[iDetector] - _minY[iDetector] + 1 ) *
+                             ( _maxX[iDetector] - _minX[iDetector] + 1 ),
+                             0. );
+    isEventValid = true;
+  }
+
+  return isEventValid;
+}
+
 void EUTelPedestalNoiseProcessor::bookHistos() {
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
@@ -1661,111 +1711,7 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
     // ok this was last loop whatever kind of loop (first, other or
     // additional) it was.
 
-    streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
-
-    LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
-
-    try {
-      lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
-    } catch (IOException& e) {
-      cerr << e.what() << endl;
-      return;
-    }
-
-    LCEventImpl * event = new LCEventImpl();
-    event->setDetectorName(_detectorName);
-    event->setRunNumber(_iRun);
-
-    LCTime * now = new LCTime;
-    event->setTimeStamp(now->timeStamp());
-    delete now;
-
-
-    LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
-    LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
-
-    for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
-
-      TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
-      TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
-      TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
-
-      CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
-      CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
-      CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
-
-      idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
-      idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
-      idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
-      idPedestalEncoder["xMin"]     = _minX[iDetector];
-      idNoiseEncoder["xMin"]        = _minX[iDetector];
-      idStatusEncoder["xMin"]       = _minX[iDetector];
-      idPedestalEncoder["xMax"]     = _maxX[iDetector];
-      idNoiseEncoder["xMax"]        = _maxX[iDetector];
-      idStatusEncoder["xMax"]       = _maxX[iDetector];
-      idPedestalEncoder["yMin"]     = _minY[iDetector];
-      idNoiseEncoder["yMin"]        = _minY[iDetector];
-      idStatusEncoder["yMin"]       = _minY[iDetector];
-      idPedestalEncoder["yMax"]     = _maxY[iDetector];
-      idNoiseEncoder["yMax"]        = _maxY[iDetector];
-      idStatusEncoder["yMax"]       = _maxY[iDetector];
-      idPedestalEncoder.setCellID(pedestalMatrix);
-      idNoiseEncoder.setCellID(noiseMatrix);
-      idStatusEncoder.setCellID(statusMatrix);
-
-      pedestalMatrix->setChargeValues(_pedestal[iDetector]);
-      noiseMatrix->setChargeValues(_noise[iDetector]);
-      statusMatrix->setADCValues(_status[iDetector]);
-
-      pedestalCollection->push_back(pedestalMatrix);
-      noiseCollection->push_back(noiseMatrix);
-      statusCollection->push_back(statusMatrix);
-
-      if ( _asciiOutputSwitch ) {
-        if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
-        stringstream ss;
-        ss << _outputPedeFileName << "-b" << iDetector << ".dat";
-        ofstream asciiPedeFile(ss.str().c_str());
-        asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
-                      << "# calculated from run " << _outputPedeFileName << endl;
-
-        const int subMatrixWidth = 3;
-        const int xPixelWidth    = 4;
-        const int yPixelWidth    = 4;
-        const int pedeWidth      = 15;
-        const int noiseWidth     = 15;
-        const int statusWidth    = 3;
-        const int precision      = 8;
-
-        int iPixel = 0;
-        for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
-          for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
-            asciiPedeFile << setiosflags(ios::left)
-                          << setw(subMatrixWidth) << iDetector
-                          << setw(xPixelWidth)    << xPixel
-                          << setw(yPixelWidth)    << yPixel
-                          << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
-                          << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
-                          << setw(noiseWidth)     << _noise[iDetector][iPixel]
-                          << resetiosflags(ios::fixed)
-                          << setw(statusWidth)    << _status[iDetector][iPixel]
-                          << endl;
-            ++iPixel;
-          }
-        }
-        asciiPedeFile.close();
-      }
-    }
-
-    event->addCollection(pedestalCollection, _pedestalCollectionName);
-    event->addCollection(noiseCollection, _noiseCollectionName);
-    event->addCollection(statusCollection, _statusCollectionName);
-
-    lcWriter->writeEvent(event);
-    delete event;
-
-    lcWriter->close();
+    if ( ! writeConditionFile() ) return;
 
     throw StopProcessingException(this);
     setReturnValue("IsPedestalFinished", true);
@@ -1821,6 +1767,117 @@ void EUTelPedestalNoiseProcessor::finalizeProcessor(bool fromMaskingLoop) {
   }
 }
 
+bool EUTelPedestalNoiseProcessor::writeConditionFile() {
+
+  streamlog_out ( MESSAGE4 ) << "Writing the output condition file" << endl;
+
+  LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
+
+  try {
+    lcWriter->open(_outputPedeFileName,LCIO::WRITE_APPEND);
+  } catch (IOException& e) {
+    cerr << e.what() << endl;
+    return false;
+  }
+
+  LCEventImpl * event = new LCEventImpl();
+  event->setDetectorName(_detectorName);
+  event->setRunNumber(_iRun);
+
+  LCTime * now = new LCTime;
+  event->setTimeStamp(now->timeStamp());
+  delete now;
+
+
+  LCCollectionVec * pedestalCollection = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * noiseCollection    = new LCCollectionVec(LCIO::TRACKERDATA);
+  LCCollectionVec * statusCollection   = new LCCollectionVec(LCIO::TRACKERRAWDATA);
+
+  for ( size_t iDetector = 0; iDetector < _noOfDetector; iDetector++) {
+
+    TrackerDataImpl    * pedestalMatrix = new TrackerDataImpl;
+    TrackerDataImpl    * noiseMatrix    = new TrackerDataImpl;
+    TrackerRawDataImpl * statusMatrix   = new TrackerRawDataImpl;
+
+    CellIDEncoder<TrackerDataImpl>    idPedestalEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, pedestalCollection);
+    CellIDEncoder<TrackerDataImpl>    idNoiseEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, noiseCollection);
+    CellIDEncoder<TrackerRawDataImpl> idStatusEncoder(EUTELESCOPE::MATRIXDEFAULTENCODING, statusCollection);
+
+    idPedestalEncoder["sensorID"] = _orderedSensorIDVec.at( iDetector );
+    idNoiseEncoder["sensorID"]    = _orderedSensorIDVec.at( iDetector );
+    idStatusEncoder["sensorID"]   = _orderedSensorIDVec.at( iDetector );
+    idPedestalEncoder["xMin"]     = _minX[iDetector];
+    idNoiseEncoder["xMin"]        = _minX[iDetector];
+    idStatusEncoder["xMin"]       = _minX[iDetector];
+    idPedestalEncoder["xMax"]     = _maxX[iDetector];
+    idNoiseEncoder["xMax"]        = _maxX[iDetector];
+    idStatusEncoder["xMax"]       = _maxX[iDetector];
+    idPedestalEncoder["yMin"]     = _minY[iDetector];
+    idNoiseEncoder["yMin"]        = _minY[iDetector];
+    idStatusEncoder["yMin"]       = _minY[iDetector];
+    idPedestalEncoder["yMax"]     = _maxY[iDetector];
+    idNoiseEncoder["yMax"]        = _maxY[iDetector];
+    idStatusEncoder["yMax"]       = _maxY[iDetector];
+    idPedestalEncoder.setCellID(pedestalMatrix);
+    idNoiseEncoder.setCellID(noiseMatrix);
+    idStatusEncoder.setCellID(statusMatrix);
+
+    pedestalMatrix->setChargeValues(_pedestal[iDetector]);
+    noiseMatrix->setChargeValues(_noise[iDetector]);
+    statusMatrix->setADCValues(_status[iDetector]);
+
+    pedestalCollection->push_back(pedestalMatrix);
+    noiseCollection->push_back(noiseMatrix);
+    statusCollection->push_back(statusMatrix);
+
+    if ( _asciiOutputSwitch ) {
+      if ( iDetector == 0 ) streamlog_out ( MESSAGE4 ) << "Writing the ASCII pedestal files" << endl;
+      stringstream ss;
+      ss << _outputPedeFileName << "-b" << iDetector << ".dat";
+      ofstream asciiPedeFile(ss.str().c_str());
+      asciiPedeFile << "# Pedestal and noise for board number " << iDetector << endl
+                    << "# calculated from run " << _outputPedeFileName << endl;
+
+      const int subMatrixWidth = 3;
+      const int xPixelWidth    = 4;
+      const int yPixelWidth    = 4;
+      const int pedeWidth      = 15;
+      const int noiseWidth     = 15;
+      const int statusWidth    = 3;
+      const int precision      = 8;
+
+      int iPixel = 0;
+      for (int yPixel = _minY[iDetector]; yPixel <= _maxY[iDetector]; yPixel++) {
+        for (int xPixel = _minX[iDetector]; xPixel <= _maxX[iDetector]; xPixel++) {
+          asciiPedeFile << setiosflags(ios::left)
+                        << setw(subMatrixWidth) << iDetector
+                        << setw(xPixelWidth)    << xPixel
+                        << setw(yPixelWidth)    << yPixel
+                        << resetiosflags(ios::left) << setiosflags(ios::fixed) << setprecision(precision)
+                        << setw(pedeWidth)      << _pedestal[iDetector][iPixel]
+                        << setw(noiseWidth)     << _noise[iDetector][iPixel]
+                        << resetiosflags(ios::fixed)
+                        << setw(statusWidth)    << _status[iDetector][iPixel]
+                        << endl;
+          ++iPixel;
+        }
+      }
+      asciiPedeFile.close();
+    }
+  }
+
+  event->addCollection(pedestalCollection, _pedestalCollectionName);
+  event->addCollection(noiseCollection, _noiseCollectionName);
+  event->addCollection(statusCollection, _statusCollectionName);
+
+  lcWriter->writeEvent(event);
+  delete event;
+
+  lcWriter->close();
+
+  return true;
+}
+
 void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent * event) {
 
   EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
@@ -1881,6 +1938,254 @@ void EUTelPedestalNoiseProcessor::additionalMaskingLoop(LCEvent * event) {
 }
 
 
+void EUTelPedestalNoiseProcessor::singlePassLoop(LCEvent * event) {
+
+  EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
+
+  // same checks as in the first loop, but instead of rewinding the
+  // data the calculation is finished directly
+
+  if ( evt->getEventType() == kEORE ) {
+    streamlog_out ( DEBUG4 ) << "EORE found: calling finalizeSinglePass()." << endl;
+    finalizeSinglePass();
+  }
+
+  if ( ( _lastEvent != -1 ) && ( _iEvt >= _lastEvent ) ) {
+    streamlog_out ( DEBUG4 ) << "Looping limited by _lastEvent: calling finalizeSinglePass()." << endl;
+    finalizeSinglePass();
+  }
+
+  if ( _iEvt < _firstEvent ) {
+    ++_iEvt;
+    throw SkipEventException(this);
+  }
+
+  if ( isFirstEvent() ) {
+
+    for ( size_t iCol = 0; iCol < _rawDataCollectionNameVec.size() ; ++iCol ) {
+
+      try {
+
+        LCCollectionVec * collectionVec = dynamic_cast < LCCollectionVec * >(evt->getCollection (_rawDataCollectionNameVec.at( iCol ) ));
+
+        for ( size_t iDetector = 0 ; iDetector < collectionVec->size() ; ++iDetector ) {
+
+          TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
+          size_t noOfPixel = trackerRawData->getADCValues().size();
+
+          _runningMean.push_back( vector< double >( noOfPixel, 0. ) );
+          _runningM2.push_back( vector< double >( noOfPixel, 0. ) );
+          _runningEntries.push_back( IntVec( noOfPixel, 0 ) );
+          _warmUpFrames.push_back( vector< ShortVec >() );
+
+          // pedestal and noise are set at the end of the warm up
+          _pedestal.push_back( FloatVec( noOfPixel, 0. ) );
+          _noise.push_back( FloatVec( noOfPixel, 0. ) );
+          _status.push_back( ShortVec( noOfPixel, EUTELESCOPE::GOODPIXEL ) );
+
+          if ( _additionalMaskingLoop ) _hitCounter.push_back( ShortVec( noOfPixel, 0 ) );
+
+        } // end of detector loop
+
+      } catch (DataNotAvailableException& e) {
+        streamlog_out ( WARNING2 ) << "No input collection " << _rawDataCollectionNameVec.at( iCol ) << " is not available in the current event" << endl;
+      }
+
+    }
+
+    bookHistos();
+
+    _isFirstEvent = false;
+
+  }
+
+  for ( size_t iCol = 0 ; iCol < _rawDataCollectionNameVec.size() ; ++iCol ) {
+
+    try {
+      LCCollectionVec *collectionVec = dynamic_cast < LCCollectionVec * >(evt->getCollection (_rawDataCollectionNameVec.at( iCol ) ));
+
+      size_t detectorOffset = ( iCol == 0 ) ? 0 : _noOfDetectorVec.at( iCol - 1 );
+
+      for ( size_t iDetector = 0; iDetector < collectionVec->size() ; iDetector++) {
+
+        TrackerRawData *trackerRawData = dynamic_cast < TrackerRawData * >(collectionVec->getElementAt (iDetector));
+
+        if ( _isWarmUpDone ) {
+          singlePassUpdate( iDetector + detectorOffset, trackerRawData->getADCValues() );
+        } else {
+          _warmUpFrames[ iDetector + detectorOffset ].push_back( trackerRawData->getADCValues() );
+        }
+
+      }
+
+    } catch (DataNotAvailableException& e) {
+      streamlog_out ( WARNING2 ) << "No input collection " << _rawDataCollectionNameVec.at( iCol ) << " is not available in the current event" << endl;
+    }
+
+  }
+
+  ++_iEvt;
+
+  if ( ( ! _isWarmUpDone ) && ( _iEvt - _firstEvent >= _singlePassWarmUpEvents ) ) endWarmUp();
+
+}
+
+void EUTelPedestalNoiseProcessor::endWarmUp() {
+
+  streamlog_out ( MESSAGE4 ) << "Calculating the single pass starting values from " << _iEvt - _firstEvent << " events" << endl;
+
+  // the median and the median absolute deviation of the buffered
+  // signals. The MAD is scaled to the sigma of a Gaussian, for pixels
+  // with a noise well below one ADC count it can be zero and the RMS
+  // around the median is used instead.
+  const double madToSigma = 1.4826;
+
+  ShortVec values;
+  vector< float > deviations;
+
+  for ( size_t iDetector = 0; iDetector < _warmUpFrames.size(); ++iDetector ) {
+
+    vector< ShortVec > & frames = _warmUpFrames[iDetector];
+    if ( frames.empty() ) continue;
+
+    for ( size_t iPixel = 0; iPixel < _pedestal[iDetector].size(); ++iPixel ) {
+
+      values.clear();
+      for ( size_t iFrame = 0; iFrame < frames.size(); ++iFrame ) values.push_back( frames[iFrame][iPixel] );
+
+      ShortVec::iterator middle = values.begin() + values.size() / 2;
+      nth_element( values.begin(), middle, values.end() );
+      double median = *middle;
+
+      double sumDev2 = 0.;
+      deviations.clear();
+      for ( size_t iValue = 0; iValue < values.size(); ++iValue ) {
+        double deviation = values[iValue] - median;
+        deviations.push_back( std::abs( deviation ) );
+        sumDev2 += deviation * deviation;
+      }
+
+      vector< float >::iterator middleDev = deviations.begin() + deviations.size() / 2;
+      nth_element( deviations.begin(), middleDev, deviations.end() );
+      double sigma = madToSigma * ( *middleDev );
+      if ( sigma == 0. ) sigma = sqrt( sumDev2 / values.size() );
+
+      _pedestal[iDetector][iPixel] = median;
+      _noise[iDetector][iPixel]    = sigma;
+    }
+  }
+
+  // as after the first loop of the iterative method, bad pixels are
+  // excluded from the common mode calculation
+  maskBadPixel();
+
+  _isWarmUpDone = true;
+
+  // now the buffered events can go through the normal procedure
+  for ( size_t iDetector = 0; iDetector < _warmUpFrames.size(); ++iDetector ) {
+    for ( size_t iFrame = 0; iFrame < _warmUpFrames[iDetector].size(); ++iFrame ) {
+      singlePassUpdate( iDetector, _warmUpFrames[iDetector][iFrame] );
+    }
+    vector< ShortVec >().swap( _warmUpFrames[iDetector] );
+  }
+
+}
+
+void EUTelPedestalNoiseProcessor::singlePassUpdate(size_t iDetector, const ShortVec & adcValues) {
+
+  vector< float > commonModeCorVec;
+  int    skippedPixel = 0;
+  int    skippedRow   = 0;
+
+  if ( _noOfCMIterations == 0 ) {
+    // the user doesn't want any common mode suppression
+    commonModeCorVec.assign( adcValues.size(), 0. );
+  } else if ( ! commonModeCorrection( adcValues, iDetector, commonModeCorVec, skippedPixel, skippedRow ) ) {
+    if ( _commonModeAlgo == EUTELESCOPE::FULLFRAME ) {
+      streamlog_out ( WARNING2 ) <<  "Skipping a frame because of max number of rejected pixels exceeded. ("
+                                 << skippedPixel << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
+    } else if ( _commonModeAlgo == EUTELESCOPE::ROWWISE ) {
+      streamlog_out ( WARNING2 ) <<  "Skipping a frame because of max number of skipped rows is reached. ("
+                                 << skippedRow << ") on detector " << _orderedSensorIDVec.at( iDetector ) << endl;
+    }
+    return;
+  }
+
+  FloatVec & pedestal = _pedestal[iDetector];
+  FloatVec & noise    = _noise[iDetector];
+  vector< double > & mean = _runningMean[iDetector];
+  vector< double > & m2   = _runningM2[iDetector];
+  IntVec & entries        = _runningEntries[iDetector];
+
+  for ( size_t iPixel = 0; iPixel < adcValues.size(); ++iPixel ) {
+
+    if ( _status[iDetector][iPixel] != EUTELESCOPE::GOODPIXEL ) continue;
+
+    // the same firing condition used in the additional masking loop
+    if ( _additionalMaskingLoop && ( adcValues[iPixel] - pedestal[iPixel] > noise[iPixel] * 3.0 ) ) {
+      _hitCounter[iDetector][iPixel]++;
+    }
+
+    double pedeCorrected = adcValues[iPixel] - commonModeCorVec[iPixel];
+    if ( std::abs( pedeCorrected - pedestal[iPixel] ) < _hitRejectionCut * noise[iPixel] ) {
+
+      // Welford's update of mean and sum of squared deviations
+      ++entries[iPixel];
+      double delta = pedeCorrected - mean[iPixel];
+      mean[iPixel] += delta / entries[iPixel];
+      m2[iPixel]   += delta * ( pedeCorrected - mean[iPixel] );
+
+      if ( entries[iPixel] >= _singlePassWarmUpEvents ) {
+        pedestal[iPixel] = mean[iPixel];
+        noise[iPixel]    = sqrt( m2[iPixel] / entries[iPixel] );
+      }
+    }
+  }
+
+}
+
+void EUTelPedestalNoiseProcessor::finalizeSinglePass() {
+
+  // the run was shorter than the warm up
+  if ( ! _isWarmUpDone ) endWarmUp();
+
+  // pixels without enough entries keep their starting values
+  for ( size_t iDetector = 0; iDetector < _runningEntries.size(); ++iDetector ) {
+    for ( size_t iPixel = 0; iPixel < _runningEntries[iDetector].size(); ++iPixel ) {
+      int entries = _runningEntries[iDetector][iPixel];
+      if ( entries > 1 ) {
+        _pedestal[iDetector][iPixel] = _runningMean[iDetector][iPixel];
+        _noise[iDetector][iPixel]    = sqrt( _runningM2[iDetector][iPixel] / entries );
+      }
+    }
+  }
+
+  _runningMean.clear();
+  _runningM2.clear();
+  _runningEntries.clear();
+
+  maskBadPixel();
+  if ( _additionalMaskingLoop && ( _iEvt > _firstEvent ) ) maskFiringPixel( _iEvt - _firstEvent );
+
+  fillHistos();
+
+  // this was the one and only loop
+  ++_iLoop;
+
+  // the running sums are gone, there is no way to go on with the
+  // following events: stop also when the condition file could not be
+  // written, but without flagging the pedestal as finished
+  if ( ! writeConditionFile() ) {
+    streamlog_out ( ERROR5 ) << "The output condition file " << _outputPedeFileName << " could not be written" << endl;
+    throw StopProcessingException(this);
+  }
+
+  setReturnValue("IsPedestalFinished", true);
+  throw StopProcessingException(this);
+
+}
+
+
 void EUTelPedestalNoiseProcessor::setBadPixelAlgoSwitches() {
 
   if ( find( _badPixelAlgoVec.begin(), _badPixelAlgoVec.end(), EUTELESCOPE::NOISEDISTRIBUTION ) != _badPixelAlgoVec.end() ) {
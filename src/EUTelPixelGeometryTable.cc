@@ -0,0 +1,71 @@
+#include "EUTelPixelGeometryTable.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+#include "EUTelExceptions.h"
+
+// MARLIN
+#include "marlin/VerbosityLevels.h"
+
+//ROOT includes
+#include "TGeoShape.h"
+#include "TGeoBBox.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelPixelGeometryTable::EUTelPixelGeometryTable(EUTelGenericPixGeoDescr* geoDescr, std::string const & planePath):
+				_minX(0),
+				_maxX(0),
+				_minY(0),
+				_maxY(0),
+				_noOfPixelsY(0),
+				_table()
+{
+	geoDescr->getPixelIndexRange( _minX, _maxX, _minY, _maxY );
+	_noOfPixelsY = _maxY - _minY + 1;
+	_table.resize( static_cast<size_t>(_maxX - _minX + 1)*_noOfPixelsY );
+
+	TGeoManager* geoManager = gGeometry()._geoManager.get();
+
+	streamlog_out( MESSAGE3 ) << "Building pixel geometry table for " << planePath << " with " << _table.size() << " pixels" << std::endl;
+
+	for( int x = _minX; x <= _maxX; ++x ) {
+		for( int y = _minY; y <= _maxY; ++y ) {
+			std::string pixelPath = planePath + geoDescr->getPixName(x, y);
+			if( !geoManager->cd( pixelPath.c_str() ) ) {
+				throw InvalidGeometryException( "Could not navigate to pixel: " + pixelPath );
+			}
+
+			//get the imbedding box
+			TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( geoManager->GetCurrentVolume()->GetShape() );
+			if( !bbox ) {
+				throw InvalidGeometryException( "Pixel shape is not a TGeoBBox: " + pixelPath );
+			}
+
+			//the top volume (world) and the plane are the two levels we do not have to transform into
+			int recursionDepth = geoManager->GetLevel() - 2;
+
+			Double_t origin_pt[3] = {0,0,0};
+			Double_t transformed1_pt[3];
+			Double_t transformed2_pt[3];
+			geoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
+
+			transformed2_pt[0] = transformed1_pt[0];
+			transformed2_pt[1] = transformed1_pt[1];
+			transformed2_pt[2] = transformed1_pt[2];
+
+			//transform into local plane coordinate system
+			for( int i = 1; i < recursionDepth; ++i ) {
+				geoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
+				transformed1_pt[0] = transformed2_pt[0];
+				transformed1_pt[1] = transformed2_pt[1];
+				transformed1_pt[2] = transformed2_pt[2];
+			}
+
+			PixelGeometry& pixel = _table[ (x-_minX)*_noOfPixelsY + (y-_minY) ];
+			pixel.posX = transformed2_pt[0];
+			pixel.posY = transformed2_pt[1];
+			pixel.boundX = bbox->GetDX();
+			pixel.boundY = bbox->GetDY();
+		}
+	}
+}
@@ -231,6 +231,11 @@ void EUTelProcessorAnalysisPALPIDEfs::init() {
   xPairs = cluster.SymmetryPairs(clusterVec,"x");
   yPairs = cluster.SymmetryPairs(clusterVec,"y");
   symmetryGroups = cluster.sameShape(clusterVec);
+  clusterShapeIndex = Cluster::BuildShapeIndex(clusterVec);
+  clusterShapeGroup.assign(clusterVec.size(),-1);
+  for (size_t iGroup=0; iGroup<symmetryGroups.size(); iGroup++)
+    for (size_t iMember=0; iMember<symmetryGroups[iGroup].size(); iMember++)
+      clusterShapeGroup[symmetryGroups[iGroup][iMember]] = iGroup;
   for (int iSector=0; iSector<_nSectors; iSector++)
   {
     nTracks[iSector] = 0;
@@ -735,16 +740,14 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
                         nClusterVsYHisto[index]->Fill(fmod(yposfit,yPitch));
                         nClusterSizeHisto[index]->Fill(fmod(xposfit,xPitch),fmod(yposfit,yPitch));
                         nClusterSize2by2Histo[index]->Fill(fmod(xposfit,2*xPitch),fmod(yposfit,2*yPitch));
-                        int clusterShape = cluster.WhichClusterShape(cluster, clusterVec);
+                        int clusterShape = cluster.WhichClusterShape(cluster, clusterShapeIndex);
                         if (clusterShape>=0)
                         {
                           clusterShapeHisto->Fill(clusterShape);
                           clusterShapeX[clusterShape]->Fill(xMin);
                           clusterShapeY[clusterShape]->Fill(yMin);
                           clusterShape2D2by2[clusterShape]->Fill(fmod(xposfit,2*xPitch),fmod(yposfit,2*yPitch));
-                          for (size_t iGroup=0; iGroup<symmetryGroups.size(); iGroup++)
-                            for (size_t iMember=0; iMember<symmetryGroups[iGroup].size(); iMember++)
-                              if (symmetryGroups[iGroup][iMember] == clusterShape) clusterShape2DGrouped2by2[iGroup]->Fill(fmod(xposfit,2*xPitch),fmod(yposfit,2*yPitch));
+                          clusterShape2DGrouped2by2[clusterShapeGroup[clusterShape]]->Fill(fmod(xposfit,2*xPitch),fmod(yposfit,2*yPitch));
                         }
                         else clusterShapeHisto->Fill(clusterVec.size());
                       }
@@ -1141,75 +1144,32 @@ void EUTelProcessorAnalysisPALPIDEfs::processEvent(LCEvent *evt)
         }
       }
     } 
-    std::vector<int> aTFinal(nT); 
-    std::vector<int> aHFinal(nH); 
-    std::vector<int> order;   
+    // The tracks left with several candidates are resolved together: the
+    // assignment maximizes the number of associations and then minimizes
+    // the total distance, without trying all the track orderings
+    std::vector<int> aTFinal(aT);
+    _assignmentSolver.reset(nT, nH);
+    bool ambiguous = false;
     for(int iT=0; iT<nT; iT++)
     {
-      if(aT[iT]==-1) order.push_back(iT); 
-    }     
-    if(order.size() > 0 )
-    {
-      unsigned int maxAssociations = 0;
-      double minDistance = 1e10;             
-      bool run1 = true;
-      do
+      if(aT[iT] != -1) continue;
+      ambiguous = true;
+      for(int iH=0; iH<nH; iH++)
       {
-        double totaldistance = 0;
-        unsigned int associations = 0;
-        std::vector<int> aTTemp(nT); 
-        std::vector<int> aHTemp(nH);   
-        for(int iT=0; iT<nT; iT++) aTTemp[iT] = aT[iT];
-        for(int iH=0; iH<nH; iH++) aHTemp[iH] = aH[iH];
-        bool run2 = true;
-        for(unsigned int i=0; i<order.size() && run2; i++)
+        if(aH[iH] == -1 && abs(pH.at(iH).at(0)-pT.at(iT).at(0))<limit && abs(pH.at(iH).at(1)-pT.at(iT).at(1))<limit)
         {
-          int iT = order[i];
-          double min = 1e10;
-          bool associated = false;
-          for(int iH=0; iH<nH; iH++)
-          {
-            if(aHTemp[iH]== -1)
-            {
-              if(abs(pH.at(iH).at(0)-pT.at(iT).at(0))<limit && abs(pH.at(iH).at(1)-pT.at(iT).at(1))<limit)
-              {
-                double dist = sqrt(pow(abs(pH.at(iH).at(0)-pT.at(iT).at(0)),2)+pow(abs(pH.at(iH).at(1)-pT.at(iT).at(1)),2));
-                if(dist<min)
-                {
-                  min=dist;
-                  temp = iH;
-                  associated = true;
-                }
-              }
-            }
-          }
-          if(associated)
-          {
-            associations++;
-            aHTemp[temp] = iT;
-            aTTemp[iT] = temp;
-            totaldistance += min;
-          }
-          if(totaldistance > minDistance) run2 = false;
-          if( ( i - associations + 1 ) > ( order.size() - maxAssociations ) ) run2 = false;
-        }
-        if(associations == order.size()) run1 = false;    
-        if(associations >= maxAssociations)
-        {
-          if(totaldistance < minDistance)
-          {
-            for(int iT=0; iT<nT; iT++) aTFinal[iT] = aTTemp[iT];
-            for(int iH=0; iH<nH; iH++) aHFinal[iH] = aHTemp[iH];
-            maxAssociations = associations;
-            minDistance = totaldistance;
-          }
+          double dist = sqrt(pow(pH.at(iH).at(0)-pT.at(iT).at(0),2)+pow(pH.at(iH).at(1)-pT.at(iT).at(1),2));
+          _assignmentSolver.addCandidate(iT, iH, dist);
         }
-      } while ( std::next_permutation(order.begin(),order.end()) && run1 );
+      }
     }
-    else
+    if(ambiguous)
     {
-      for(int iT=0; iT<nT; iT++) aTFinal[iT] = aT[iT];
-      for(int iH=0; iH<nH; iH++) aHFinal[iH] = aH[iH]; 
+      _assignmentSolver.solve();
+      for(int iT=0; iT<nT; iT++)
+      {
+        if(aT[iT] == -1) aTFinal[iT] = _assignmentSolver.getColumn(iT);
+      }
     }
     for(int iT=0; iT<nT; iT++)
     {
@@ -1,11 +1,13 @@
 #include "EUTelProcessorAnalysisPALPIDEfsNoise.h"
 #include "EUTELESCOPE.h"
-#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 #include "EUTelGenericSparsePixel.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
 #include "marlin/Global.h"
 
+#include <UTIL/CellIDDecoder.h>
+
 using namespace lcio;
 using namespace marlin;
 using namespace std;
@@ -104,13 +106,12 @@ void EUTelProcessorAnalysisPALPIDEfsNoise::processEvent(LCEvent *evt)
     return;
   }
   _nEvent++;
+  CellIDDecoder<TrackerDataImpl> cellDecoder( zsInputDataCollectionVec );
   for ( unsigned int iDetector = 0 ; iDetector < zsInputDataCollectionVec->size(); iDetector++ )
   {
     TrackerDataImpl * zsData = dynamic_cast< TrackerDataImpl * > ( zsInputDataCollectionVec->getElementAt( iDetector ) );
-    auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-    auto& pixelVec = sparseData->getPixels();
-
-    for( auto& sparsePixel: pixelVec ) {
+    SparsePixelType type = static_cast<SparsePixelType> ( static_cast<int> ( cellDecoder( zsData )["sparsePixelType"] ) );
+    forEachPixel( zsData, type, [&](EUTelBaseSparsePixel const & sparsePixel) {
       noiseMap[iDetector]->Fill(sparsePixel.getXCoord(),sparsePixel.getYCoord());
       for (int iSector=0; iSector<4; iSector++)
 //      {
@@ -119,7 +120,7 @@ void EUTelProcessorAnalysisPALPIDEfsNoise::processEvent(LCEvent *evt)
           _nFiredPixel[iDetector][iSector]++;
 //      }
 //      cerr << evt->getEventNumber() << "\t" << iDetector << "\t" << sparsePixel->getXCoord() << "\t" << sparsePixel->getYCoord() << endl;
-    }
+    });
   }
 }
 
@@ -1,11 +1,14 @@
 #include "EUTelProcessorDeadColumnFinder.h"
 #include "EUTELESCOPE.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 #include "EUTelGenericSparsePixel.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 
 #include "marlin/Global.h"
 
+#include <UTIL/CellIDDecoder.h>
+
 using namespace lcio;
 using namespace marlin;
 using namespace std;
@@ -68,26 +71,31 @@ void EUTelProcessorDeadColumnFinder::processEvent(LCEvent *evt)
 //    cerr << "_zsDataCollectionName " << _zsDataCollectionName.c_str() << " not found " << endl;
     return;
   }
+  CellIDDecoder<TrackerDataImpl> cellDecoder( zsInputDataCollectionVec );
   for ( size_t iDetector = 0 ; iDetector < zsInputDataCollectionVec->size(); iDetector++ )
   {
     TrackerDataImpl* zsData = dynamic_cast<TrackerDataImpl*>(zsInputDataCollectionVec->getElementAt(iDetector));
-    auto sparseData = EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(zsData);
-    for( size_t iPixel = 0; iPixel < sparseData.size(); iPixel++ )
+    SparsePixelType type = static_cast<SparsePixelType> ( static_cast<int> ( cellDecoder( zsData )["sparsePixelType"] ) );
+    //a pixel appearing twice in a row marks a dead double column
+    bool firstPixel = true;
+    short previousX = 0, previousY = 0;
+    forEachPixel( zsData, type, [&](EUTelBaseSparsePixel const & sparsePixel)
     {
-      auto& sparsePixel = sparseData.at(iPixel);
       hitMap[iDetector]->Fill(sparsePixel.getXCoord(), sparsePixel.getYCoord());
-      if (iPixel != sparseData.size()-1)
+      if (!firstPixel)
       {
-        auto& sparsePixel2 = sparseData.at( iPixel+1 );
-        if (sparsePixel.getXCoord() == sparsePixel2.getXCoord() && sparsePixel.getYCoord() == sparsePixel2.getYCoord())
+        if (sparsePixel.getXCoord() == previousX && sparsePixel.getYCoord() == previousY)
         {
-          isDead[iDetector][sparsePixel.getXCoord()] = true;
-          if (sparsePixel.getXCoord()%2 == 0) isDead[iDetector][sparsePixel.getXCoord()+1] = true;
-          else isDead[iDetector][sparsePixel.getXCoord()-1] = true;
+          isDead[iDetector][previousX] = true;
+          if (previousX%2 == 0) isDead[iDetector][previousX+1] = true;
+          else isDead[iDetector][previousX-1] = true;
         }
 //          cerr << "Same pixel (" << sparsePixel->getXCoord() << ", " << sparsePixel->getYCoord() << ") appearing twice in event " << evt->getEventNumber() << endl;
       }
-    }
+      firstPixel = false;
+      previousX = sparsePixel.getXCoord();
+      previousY = sparsePixel.getYCoord();
+    });
   }
 }
 
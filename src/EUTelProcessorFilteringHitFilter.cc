@@ -97,7 +97,10 @@ void EUTelProcessorFilteringHitFilter::processEvent( LCEvent * event ) {
 
      if ( isFirstEvent() )
     {
-      _hotPixelMap = Utility::FillHotPixelMap(event, _hotpixelCollectionName );
+      if( !_hotPixelMask.load( event, _hotpixelCollectionName ) )
+      {
+        streamlog_out( MESSAGE4 ) << "hotPixelCollectionName " << _hotpixelCollectionName.c_str() << " not found" << std::endl;
+      }
     }
 
 //cout << " processEvent continue: " << endl;
@@ -138,7 +141,7 @@ void EUTelProcessorFilteringHitFilter::processEvent( LCEvent * event ) {
           {
             TrackerHitImpl * hit = static_cast<TrackerHitImpl*> ( hitInputCollection->getElementAt(iHit) );
              
-            if( Utility::HitContainsHotPixels(  hit,  _hotPixelMap )  ) 
+            if( _hotPixelMask.hitContainsHotPixels( hit ) ) 
             {
               streamlog_out ( MESSAGE5 ) << "Hit " << iHit << " contains hot pixels; skip this one. " << std::endl;
               continue;
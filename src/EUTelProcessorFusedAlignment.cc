@@ -0,0 +1,353 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifdef USE_GEAR
+// eutelescope includes ".h"
+#include "EUTelProcessorFusedAlignment.h"
+#include "EUTelRunHeaderImpl.h"
+#include "EUTelEventImpl.h"
+#include "EUTelAlignmentConstant.h"
+#include "EUTelReferenceHit.h"
+#include "EUTelExceptions.h"
+#include "EUTELESCOPE.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerHitImpl.h>
+#include <IMPL/LCCollectionVec.h>
+#include <UTIL/CellIDDecoder.h>
+
+// gear includes <.h>
+#include <gear/GearMgr.h>
+#include <gear/SiPlanesParameters.h>
+
+// ROOT includes
+#include "TMath.h"
+
+// system includes <>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+using namespace lcio;
+using namespace marlin;
+using namespace eutelescope;
+using namespace gear;
+
+namespace {
+  // the sensor ID takes 7 bits in the hit encoding
+  const size_t kNoOfSensorIDs = 1 << 7;
+
+  // the name of the step using the GEAR plane rotations
+  const string kGearStepName = "gear";
+}
+
+EUTelProcessorFusedAlignment::EUTelProcessorFusedAlignment () : Processor("EUTelProcessorFusedAlignment"),
+_inputHitCollectionName("hit"),
+_outputHitCollectionName("alignedHit"),
+_alignmentCollectionNames(),
+_referenceHitCollectionName("referenceHit"),
+_intermediateHitCollectionNames(),
+_correctionMethod(1),
+_applyAlignmentDirection(0),
+_stageTransforms(),
+_isFirstEvent(true),
+_iRun(0),
+_iEvt(0)
+{
+  _description = "Apply a chain of alignment collections to the input hits in a single pass";
+
+  registerInputCollection (LCIO::TRACKERHIT, "InputHitCollectionName",
+                           "The name of the input hit collection",
+                           _inputHitCollectionName, string ("hit"));
+
+  registerOutputCollection (LCIO::TRACKERHIT, "OutputHitCollectionName",
+                            "The name of the output hit collection",
+                            _outputHitCollectionName, string("alignedHit"));
+
+  EVENT::StringVec alignmentCollectionNameExamples;
+  alignmentCollectionNameExamples.push_back("prealign");
+  alignmentCollectionNameExamples.push_back("alignment");
+
+  registerProcessorParameter ("AlignmentCollectionNames",
+                              "The alignment collections in the order they are applied, gear for the GEAR plane rotations",
+                              _alignmentCollectionNames, alignmentCollectionNameExamples);
+
+  registerOptionalParameter("ReferenceCollection","The name of the reference hit collection giving the sensor centres",
+                            _referenceHitCollectionName, static_cast< string > ( "referenceHit" ) );
+
+  registerProcessorParameter ("CorrectionMethod",
+                              "Available methods are:\n"
+                              " 0 -> shift only \n"
+                              " 1 -> rotation first ",
+                              _correctionMethod, static_cast<int > (1));
+
+  registerProcessorParameter ("ApplyAlignmentDirection",
+                              "Available directions are:\n"
+                              " 0 -> direct  \n"
+                              " 1 -> reverse ",
+                              _applyAlignmentDirection, static_cast<int > (0));
+
+  registerOptionalParameter("IntermediateHitCollectionNames",
+                            "For debugging only: the hit collections written after each step but the last one",
+                            _intermediateHitCollectionNames, EVENT::StringVec() );
+}
+
+void EUTelProcessorFusedAlignment::init () {
+  // this method is called only once even when the rewind is active
+  printParameters ();
+
+  // set to zero the run and event counters
+  _iRun = 0;
+  _iEvt = 0;
+
+  if ( _alignmentCollectionNames.empty() ) {
+    throw InvalidParameterException("EUTelProcessorFusedAlignment: at least one alignment collection is needed");
+  }
+
+  if ( _correctionMethod != 0 && _correctionMethod != 1 ) {
+    throw InvalidParameterException("EUTelProcessorFusedAlignment: the correction method has to be 0 or 1");
+  }
+
+  if ( _applyAlignmentDirection != 0 && _applyAlignmentDirection != 1 ) {
+    throw InvalidParameterException("EUTelProcessorFusedAlignment: the alignment direction has to be 0 or 1");
+  }
+
+  if ( !_intermediateHitCollectionNames.empty() && _intermediateHitCollectionNames.size() + 1 != _alignmentCollectionNames.size() ) {
+    throw InvalidParameterException("EUTelProcessorFusedAlignment: one intermediate hit collection is needed for each alignment collection but the last one");
+  }
+
+  if ( find( _alignmentCollectionNames.begin(), _alignmentCollectionNames.end(), kGearStepName ) != _alignmentCollectionNames.end() && Global::GEAR == NULL ) {
+    streamlog_out ( ERROR4 ) <<  "The GearMgr is not available, for an unknown reason." << endl;
+    exit(-1);
+  }
+
+  _isFirstEvent = true;
+}
+
+void EUTelProcessorFusedAlignment::processRunHeader (LCRunHeader * rdr) {
+  std::unique_ptr<EUTelRunHeaderImpl> runHeader = std::make_unique<EUTelRunHeaderImpl>(rdr);
+  runHeader->addProcessor( type() );
+  ++_iRun;
+
+  // the constants may be different for this run
+  _isFirstEvent = true;
+}
+
+void EUTelProcessorFusedAlignment::processEvent (LCEvent * event) {
+  ++_iEvt;
+
+  EUTelEventImpl * evt = static_cast<EUTelEventImpl*> (event);
+
+  if ( evt->getEventType() == kEORE ) {
+    streamlog_out ( DEBUG4 ) << "EORE found: nothing else to do." << endl;
+    return;
+  } else if ( evt->getEventType() == kUNKNOWN ) {
+    streamlog_out ( WARNING2 ) << "Event number " << evt->getEventNumber() << " in run " << evt->getRunNumber()
+                               << " is of unknown type. Continue considering it as a normal Data Event." << endl;
+  }
+
+  if ( _isFirstEvent ) {
+    try {
+      composeTransforms( event );
+    } catch (DataNotAvailableException& e) {
+      streamlog_out ( ERROR5 ) << "Alignment collection not available in event " << event->getEventNumber()
+                               << " of run " << event->getRunNumber() << ": " << e.what() << endl;
+      throw StopProcessingException(this);
+    }
+    _isFirstEvent = false;
+  }
+
+  LCCollectionVec * inputCollectionVec = NULL;
+  try {
+    inputCollectionVec = dynamic_cast < LCCollectionVec * > (evt->getCollection(_inputHitCollectionName));
+  } catch (DataNotAvailableException& e) {
+    streamlog_out ( DEBUG3 ) <<  "No input collection " << _inputHitCollectionName << " found on event " << event->getEventNumber()
+                             << " in run " << event->getRunNumber() << endl;
+    return;
+  }
+
+  for ( size_t iStage = 0; iStage < _intermediateHitCollectionNames.size(); ++iStage ) {
+    evt->addCollection( transformHits( inputCollectionVec, _stageTransforms[ iStage ] ), _intermediateHitCollectionNames[ iStage ] );
+  }
+  evt->addCollection( transformHits( inputCollectionVec, _stageTransforms.back() ), _outputHitCollectionName );
+}
+
+void EUTelProcessorFusedAlignment::end() {
+  streamlog_out ( MESSAGE2 ) <<  "Successfully finished" << endl;
+}
+
+void EUTelProcessorFusedAlignment::composeTransforms(LCEvent * event) {
+
+  // the sensor centres, updated by each step
+  vector<TVector3 > referencePositions( kNoOfSensorIDs, TVector3( 0., 0., 0. ) );
+  try {
+    LCCollectionVec * referenceHitVec = dynamic_cast < LCCollectionVec * > (event->getCollection(_referenceHitCollectionName));
+    for ( size_t iRef = 0; iRef < referenceHitVec->size(); ++iRef ) {
+      EUTelReferenceHit * refhit = static_cast< EUTelReferenceHit * > ( referenceHitVec->getElementAt( iRef ) );
+      if ( static_cast< size_t >( refhit->getSensorID() ) < kNoOfSensorIDs ) {
+        referencePositions[ refhit->getSensorID() ].SetXYZ( refhit->getXOffset(), refhit->getYOffset(), refhit->getZOffset() );
+      }
+    }
+  } catch (DataNotAvailableException& e) {
+    streamlog_out ( WARNING2 ) << "Reference hit collection " << _referenceHitCollectionName
+                               << " not found, the rotations are done around the origin" << endl;
+  }
+
+  // the transforms applying the first steps, up to the full chain
+  vector<SensorTransforms > prefixTransforms;
+  SensorTransforms cumulative( kNoOfSensorIDs );
+  for ( size_t iStep = 0; iStep < _alignmentCollectionNames.size(); ++iStep ) {
+    SensorTransforms step = ( _alignmentCollectionNames[ iStep ] == kGearStepName ) ?
+      getGearTransforms() : getStepTransforms( event, _alignmentCollectionNames[ iStep ], referencePositions );
+    for ( size_t iSensor = 0; iSensor < kNoOfSensorIDs; ++iSensor ) {
+      cumulative[ iSensor ] = step[ iSensor ].after( cumulative[ iSensor ] );
+    }
+    prefixTransforms.push_back( cumulative );
+  }
+
+  _stageTransforms.clear();
+  if ( _applyAlignmentDirection == 0 ) {
+    if ( !_intermediateHitCollectionNames.empty() ) {
+      _stageTransforms = prefixTransforms;
+    } else {
+      _stageTransforms.push_back( cumulative );
+    }
+  } else {
+    SensorTransforms inverse( kNoOfSensorIDs );
+    for ( size_t iSensor = 0; iSensor < kNoOfSensorIDs; ++iSensor ) {
+      inverse[ iSensor ] = cumulative[ iSensor ].inverse();
+    }
+    // undoing the steps from the last one: the hits after the undo of
+    // the last n steps are the input hits with the first N - n steps
+    for ( size_t iStage = 0; iStage < _intermediateHitCollectionNames.size(); ++iStage ) {
+      SensorTransforms const & remaining = prefixTransforms[ prefixTransforms.size() - 2 - iStage ];
+      SensorTransforms stage( kNoOfSensorIDs );
+      for ( size_t iSensor = 0; iSensor < kNoOfSensorIDs; ++iSensor ) {
+        stage[ iSensor ] = remaining[ iSensor ].after( inverse[ iSensor ] );
+      }
+      _stageTransforms.push_back( stage );
+    }
+    _stageTransforms.push_back( inverse );
+  }
+
+  for ( size_t iSensor = 0; iSensor < kNoOfSensorIDs; ++iSensor ) {
+    AffineTransform const & transform = _stageTransforms.back()[ iSensor ];
+    if ( !transform.rotation.IsIdentity() || transform.translation.Mag2() > 0. ) {
+      streamlog_out ( MESSAGE4 ) << "Sensor ID " << iSensor << ": translation ( " << transform.translation.X() << ", "
+                                 << transform.translation.Y() << ", " << transform.translation.Z() << " )" << endl;
+    }
+  }
+}
+
+EUTelProcessorFusedAlignment::SensorTransforms EUTelProcessorFusedAlignment::getStepTransforms(LCEvent * event, string const & alignmentCollectionName,
+                                                                                               vector<TVector3 > & referencePositions) const {
+
+  LCCollectionVec * alignmentCollectionVec = dynamic_cast < LCCollectionVec * > (event->getCollection(alignmentCollectionName));
+  streamlog_out ( MESSAGE4 ) << "The alignment collection " << alignmentCollectionName << " contains: "
+                             << alignmentCollectionVec->size() << " planes " << endl;
+
+  SensorTransforms transforms( kNoOfSensorIDs );
+  for ( size_t iPos = 0; iPos < alignmentCollectionVec->size(); ++iPos ) {
+    EUTelAlignmentConstant * alignment = static_cast< EUTelAlignmentConstant * > ( alignmentCollectionVec->getElementAt( iPos ) );
+    size_t sensorID = alignment->getSensorID();
+    if ( sensorID >= kNoOfSensorIDs ) {
+      streamlog_out ( WARNING2 ) << "Sensor ID " << sensorID << " of " << alignmentCollectionName << " out of range, skipped" << endl;
+      continue;
+    }
+
+    TVector3 offset( alignment->getXOffset(), alignment->getYOffset(), alignment->getZOffset() );
+    AffineTransform & transform = transforms[ sensorID ];
+    if ( _correctionMethod == 0 ) {
+      // this is the shift only case
+      transform.translation = -offset;
+    } else {
+      // rotation around the sensor centre first, then the shift
+      transform.rotation.RotateX( -alignment->getAlpha() );
+      transform.rotation.RotateY( -alignment->getBeta() );
+      transform.rotation.RotateZ( -alignment->getGamma() );
+      TVector3 center = referencePositions[ sensorID ] + offset;
+      transform.translation = center - transform.rotation * center - offset;
+    }
+    referencePositions[ sensorID ] -= offset;
+  }
+  return transforms;
+}
+
+EUTelProcessorFusedAlignment::SensorTransforms EUTelProcessorFusedAlignment::getGearTransforms() const {
+
+  SiPlanesLayerLayout const & layerLayout = Global::GEAR->getSiPlanesParameters().getSiPlanesLayerLayout();
+
+  SensorTransforms transforms( kNoOfSensorIDs );
+  for ( int iLayer = 0; iLayer < layerLayout.getNLayers(); ++iLayer ) {
+    size_t sensorID = layerLayout.getID( iLayer );
+    if ( sensorID >= kNoOfSensorIDs ) continue;
+
+    // rotation around the sensor plane centre on the beam axis
+    AffineTransform & transform = transforms[ sensorID ];
+    transform.rotation.RotateX( layerLayout.getLayerRotationZY( iLayer ) * TMath::DegToRad() );
+    transform.rotation.RotateY( layerLayout.getLayerRotationZX( iLayer ) * TMath::DegToRad() );
+    transform.rotation.RotateZ( layerLayout.getLayerRotationXY( iLayer ) * TMath::DegToRad() );
+    TVector3 center( 0., 0., layerLayout.getSensitivePositionZ( iLayer ) + 0.5 * layerLayout.getSensitiveThickness( iLayer ) );
+    transform.translation = center - transform.rotation * center;
+  }
+  return transforms;
+}
+
+LCCollectionVec * EUTelProcessorFusedAlignment::transformHits(LCCollectionVec * inputCollection, SensorTransforms const & transforms) const {
+
+  LCCollectionVec * outputCollection = new LCCollectionVec(LCIO::TRACKERHIT);
+  UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder( EUTELESCOPE::HITENCODING );
+
+  for ( size_t iHit = 0; iHit < inputCollection->size(); ++iHit ) {
+    TrackerHitImpl * inputHit = dynamic_cast< TrackerHitImpl * > ( inputCollection->getElementAt( iHit ) );
+    size_t sensorID = hitDecoder(inputHit)["sensorID"];
+
+    // copy the input to the output, at least for the common part
+    TrackerHitImpl * outputHit = new TrackerHitImpl;
+    outputHit->setType( inputHit->getType() );
+    outputHit->rawHits() = inputHit->getRawHits();
+    outputHit->setCovMatrix( inputHit->getCovMatrix() );
+    outputHit->setCellID0( inputHit->getCellID0() );
+    outputHit->setCellID1( inputHit->getCellID1() );
+    outputHit->setTime( inputHit->getTime() );
+
+    const double * inputPosition = inputHit->getPosition();
+    TVector3 position( inputPosition[0], inputPosition[1], inputPosition[2] );
+    if ( sensorID < transforms.size() ) {
+      AffineTransform const & transform = transforms[ sensorID ];
+      position = transform.rotation * position + transform.translation;
+    }
+    double outputPosition[3] = { position.X(), position.Y(), position.Z() };
+    outputHit->setPosition( outputPosition );
+    outputCollection->push_back( outputHit );
+  }
+  return outputCollection;
+}
+
+EUTelProcessorFusedAlignment::AffineTransform EUTelProcessorFusedAlignment::AffineTransform::after(AffineTransform const & other) const {
+  AffineTransform composed;
+  composed.rotation = rotation * other.rotation;
+  composed.translation = rotation * other.translation + translation;
+  return composed;
+}
+
+EUTelProcessorFusedAlignment::AffineTransform EUTelProcessorFusedAlignment::AffineTransform::inverse() const {
+  AffineTransform inverted;
+  inverted.rotation = rotation.Inverse();
+  inverted.translation = -( inverted.rotation * translation );
+  return inverted;
+}
+
+#endif
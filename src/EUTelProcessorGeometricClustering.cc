@@ -22,6 +22,7 @@
 
 //eutel data specific
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 #include "EUTelGenericSparseClusterImpl.h"
 #include "EUTelGeometricClusterImpl.h"
 
@@ -29,10 +30,6 @@
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelGenericPixGeoDescr.h"
 
-//ROOT includes
-#include "TGeoShape.h"
-#include "TGeoBBox.h"
-
 //marlin includes
 #include "marlin/Processor.h"
 #include "marlin/AIDAProcessor.h"
@@ -59,6 +56,7 @@
 #include <memory>
 //#include <iostream>
 #include <cmath>
+#include <algorithm>
 
 using namespace lcio;
 using namespace marlin;
@@ -77,6 +75,11 @@ EUTelProcessorGeometricClustering::EUTelProcessorGeometricClustering():
   _totClusterMap(),
   _noOfDetector(0),
   _ExcludedPlanes(),
+  _pixelGeometryTables(),
+  _clusteringEngineName(""),
+  _clusteringEngine(EUTelClusterFinder::kIterative),
+  _nThreads(1),
+  _threadPool(),
   _clusterSignalHistos(),
   _clusterSizeXHistos(),
   _clusterSizeYHistos(),
@@ -112,6 +115,12 @@ EUTelProcessorGeometricClustering::EUTelProcessorGeometricClustering():
   registerOptionalParameter("ExcludedPlanes", "The list of sensor ids that have to be excluded from the clustering.",
                              _ExcludedPlanes, std::vector<int> () );
 
+  registerOptionalParameter("ClusteringEngine","Engine used to group the hits: Iterative (scan over all hits) or Sweep (sorted neighbour search), both yield identical clusters",
+                             _clusteringEngineName, std::string("Iterative") );
+
+  registerOptionalParameter("NumberOfThreads","Number of threads clustering the planes of an event concurrently, 1 is serial, 0 uses all cores",
+                             _nThreads, static_cast<int>(1) );
+
   		_isFirstEvent = true;
 }
 
@@ -122,6 +131,29 @@ void EUTelProcessorGeometricClustering::init() {
 	//init new geometry
     geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME, EUTELESCOPE::DUMPGEOROOT);
 
+	_clusteringEngine = EUTelClusterFinder::engineFromString( _clusteringEngineName );
+
+	if( _nThreads < 0 ) {
+		throw InvalidParameterException("NumberOfThreads has to be positive or 0 for all cores");
+	}
+	_threadPool = std::make_unique<EUTelThreadPool>( static_cast<unsigned>(_nThreads) );
+	streamlog_out ( MESSAGE4 ) << "Clustering the planes with " << _threadPool->size() << " thread(s)" << std::endl;
+
+	//build the pixel geometry tables once, planes sharing a pixel geometry description share the table
+	_pixelGeometryTables.clear();
+	std::map<geo::EUTelGenericPixGeoDescr*, std::shared_ptr<geo::EUTelPixelGeometryTable const> > tablesByDescr;
+	for( int sensorID: geo::gGeometry().sensorIDsVec() ) {
+		if( std::find(_ExcludedPlanes.begin(), _ExcludedPlanes.end(), sensorID) != _ExcludedPlanes.end() ) {
+			continue;
+		}
+		geo::EUTelGenericPixGeoDescr* geoDescr = geo::gGeometry().getPixGeoDescr( sensorID );
+		auto& table = tablesByDescr[geoDescr];
+		if( !table ) {
+			table = std::make_shared<geo::EUTelPixelGeometryTable const>( geoDescr, geo::gGeometry().getPlanePath(sensorID) );
+		}
+		_pixelGeometryTables[sensorID] = table;
+	}
+
 	//set to zero the run and event counters
 	_iRun = 0;
 	_iEvt = 0;
@@ -255,17 +287,16 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 	CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
 	// in the _zsInputDataCollectionVec we should have one TrackerData for each 
-	// detector working in ZS mode. We need to loop over all of them
+	// detector working in ZS mode. The decoder is not thread safe, so all
+	// of them are decoded here before the clustering
+	std::vector<PlaneClusters> planes;
+	planes.reserve( _zsInputDataCollectionVec->size() );
 	for ( unsigned int idetector = 0 ; idetector < _zsInputDataCollectionVec->size(); idetector++ ) {
 		// get the TrackerData and guess which kind of sparsified data it contains.
 		TrackerDataImpl * zsData = dynamic_cast< TrackerDataImpl * > ( _zsInputDataCollectionVec->getElementAt( idetector ) );
 		SparsePixelType   type   = static_cast<SparsePixelType> ( static_cast<int> (cellDecoder( zsData )["sparsePixelType"]) );
 		int sensorID             = static_cast<int > ( cellDecoder( zsData )["sensorID"] );
 
-		//get alle the plane relevant geo information, that is the plane name and the plane pix geometry
-		std::string planePath = geo::gGeometry().getPlanePath( sensorID );
-		geo::EUTelGenericPixGeoDescr* geoDescr =  ( geo::gGeometry().getPixGeoDescr( sensorID ) );
-
 		//if this is an excluded sensor go to the next element
 		bool foundexcludedsensor = false;
 		for(size_t iexclude = 0; iexclude < _ExcludedPlanes.size(); ++iexclude) {
@@ -278,137 +309,36 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 			continue;
 		}
 
-		//now that we know which is the sensorID, we can ask which are the minX, minY, maxX and maxY.
-		int minX, minY, maxX, maxY;
-		minX = minY = maxX = maxY = 0;
-		geoDescr->getPixelIndexRange( minX, maxX, minY, maxY );
+		//get the precomputed pixel geometry of this plane
+		auto tableIt = _pixelGeometryTables.find( sensorID );
+		if( tableIt == _pixelGeometryTables.end() ) {
+			streamlog_out ( ERROR4 ) << "No pixel geometry table for sensor " << sensorID << ", is it in the GEAR file?" << std::endl;
+			throw InvalidGeometryException("Missing pixel geometry table");
+		}
 
-		// now prepare the EUTelescope interface to sparsified data.  
-		auto sparseData = Utility::getSparseData(zsData, type);
+		planes.push_back( PlaneClusters() );
+		planes.back().zsData = zsData;
+		planes.back().sensorID = sensorID;
+		planes.back().type = type;
+		planes.back().pixelGeometry = tableIt->second.get();
+		planes.back().nPixels = 0;
+	}
+
+	//the planes are clustered independently, possibly concurrently
+	_threadPool->run( planes.size(), [this, &planes](size_t i) { findPlaneClusters( planes[i] ); } );
+
+	//the found clusters are stored in plane order, independent of the number of threads
+	for( auto & plane: planes ) {
+		int sensorID = plane.sensorID;
+
+		streamlog_out ( DEBUG2 ) << "Processing sparse data on detector " << sensorID << " with " << plane.nPixels << " pixels " << std::endl;
+		for( auto const & pixel: plane.skippedPixels ) {
+			streamlog_out ( WARNING2 ) << "Pixel (" << pixel.first << "," << pixel.second << ") on detector " << sensorID << " is outside of the pixel matrix, skipping it" << std::endl;
+		}
+
+		for( size_t iCluster = 0; iCluster < plane.clusters.size(); ++iCluster ) {
+			std::unique_ptr<TrackerDataImpl> & zsCluster = plane.clusters[iCluster];
 
-		streamlog_out ( DEBUG2 ) << "Processing sparse data on detector " << sensorID << " with " << sparseData->size() << " pixels " << std::endl;
-		std::vector<EUTelGeometricPixel> hitPixelVec;
-			
-		//This for-loop loads all the hits of the given event and detector plane and stores them as GeometricPixels
-		  
-		for(auto& pixelRef: *sparseData) {
-			auto& pixel = pixelRef.get();
-		    EUTelGeometricPixel hitPixel( dynamic_cast<EUTelGenericSparsePixel const &>(pixel) );
-		    
-		    //And get the path to the given pixel
-		    std::string pixelPath = geoDescr->getPixName(hitPixel.getXCoord(), hitPixel.getYCoord());
-		    
-		    //Then navigate to this pixel with the TGeo manager
-		    geo::gGeometry()._geoManager->cd( (planePath+pixelPath).c_str() );
-		    
-		    //get the imbedding box
-		    TGeoShape* currentShape =  geo::gGeometry()._geoManager->GetCurrentVolume()->GetShape();
-		    TGeoBBox* bbox = dynamic_cast<TGeoBBox*>( currentShape );
-		    //store the dimensions of this box in the GeometricPixel
-		    hitPixel.setBoundaryX( bbox->GetDX() );
-		    hitPixel.setBoundaryY( bbox->GetDY() );
-		    
-		    //Get how deep the node description goes (this is how often we have to transform to get coordinates in the local plane coordinate system)
-		    std::vector<std::string> split = Utility::stringSplit( planePath+pixelPath , "/", false);
-		    
-		    //Three recursions for the telescope/plane
-		    int recursionDepth = split.size() - 3;
-		    
-		    //The do the transformation
-		    Double_t origin_pt[3] = {0,0,0};
-		    Double_t transformed1_pt[3];
-		    Double_t transformed2_pt[3];
-		    gGeoManager->GetCurrentNode()->LocalToMaster(origin_pt, transformed1_pt);
-		    
-		    transformed2_pt[0] = transformed1_pt[0];
-		    transformed2_pt[1] = transformed1_pt[1];
-		    transformed2_pt[2] = transformed1_pt[2];
-
-		    //transform into local plane coordinate system
-		    for(int i = 1 ; i < recursionDepth; ++i)
-		      {
-			gGeoManager->GetMother(i)->LocalToMaster(transformed1_pt, transformed2_pt);
-			transformed1_pt[0] = transformed2_pt[0];
-			transformed1_pt[1] = transformed2_pt[1];
-			transformed1_pt[2] = transformed2_pt[2];
-		      }
-		    
-		    //store all the position information in the GeometricPixel
-		    hitPixel.setPosX( transformed2_pt[0] );
-		    hitPixel.setPosY( transformed2_pt[1] );
-		    //and push this pixel back
-		    hitPixelVec.push_back( hitPixel );
-		  }		
-		
-		std::vector<EUTelGeometricPixel> newlyAdded;
-		//We now cluster those hits together
-		while( !hitPixelVec.empty() )
-		  {
-		    // prepare a TrackerData to store the cluster candidate
-		    std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
-		    // prepare a reimplementation of sparsified cluster
-		    std::unique_ptr<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>> sparseCluster = std::make_unique<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>>(zsCluster.get());
-		    
-		    //First we need to take any pixel, so let's take the first one
-		    //Add it to the cluster as well as the newly added pixels
-		    newlyAdded.push_back( hitPixelVec.front() );
-		    sparseCluster->push_back( hitPixelVec.front() );
-		    //And remove it from the original collection
-		    hitPixelVec.erase( hitPixelVec.begin() );
-		    
-		    //Now process all newly added pixels, initially this is the just previously added one
-		    //but in the process of neighbour finding we continue to add new pixels
-		    while( !newlyAdded.empty() )
-		      {
-			bool newlyDone = true;
-			float x1, x2, y1, y2, dX, dY, cx1, cy1, cx2, cy2, cutX, cutY, t1 , t2, dT;
-			
-			//check against all pixels in the hitPixelVec
-			for( std::vector<EUTelGeometricPixel>::iterator hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec )
-			  {
-			    //get the relevant infos from the newly added pixel
-			    x1 = newlyAdded.front().getPosX();
-			    y1 = newlyAdded.front().getPosY();
-			    t1 =  newlyAdded.front().getTime();
-			    cx1 = newlyAdded.front().getBoundaryX();
-			    cy1 = newlyAdded.front().getBoundaryY();
-			    
-			    //and the pixel we test against
-			    x2 = hitVec->getPosX();
-			    y2 = hitVec->getPosY();
-			    t2 = hitVec->getTime();
-			    cx2 = hitVec->getBoundaryX();
-			    cy2 = hitVec->getBoundaryY();
-			    
-			    dX = x1 - x2;
-			    dY = y1 - y2;
-			    dT = t1 - t2;
-			    cutX = (cx1+cx2)*1.01; //this additional 1% is accounting for precision
-			    cutY = (cy1+cy2)*1.01; //uncertainty with the geo framework
-			    
-			    //if they pass the spatial and temporal cuts, we add them	
-			    if(	(dX*dX <= cutX*cutX) && (dY*dY <= cutY*cutY) && (dT*dT <= _cutT*_cutT) )
-			      {
-				//add them to the cluster as well as to the newly added ones
-				newlyAdded.push_back( *hitVec );
-				sparseCluster->push_back( *hitVec );
-				//and remove it from the original collection
-				hitPixelVec.erase( hitVec );
-				//for the pixel we test there might be other neighbours, we still have to check
-				newlyDone = false;
-				break;
-			      }
-			  }
-			
-			//if no neighbours are found, we can delete the pixel from the newly added
-			//we tested against _ALL_ non cluster pixels, there are no other pixels
-			//which could be neighbours
-			if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
-		      }	
-		    
-		    //Now we need to process the found cluster
-		    if ( sparseCluster->size() > 0 ) 
-		      {
 			// set the ID for this zsCluster
 			idZSClusterEncoder["sensorID"]  = sensorID;
 			idZSClusterEncoder["sparsePixelType"] = static_cast<int>( kEUTelGeometricPixel );
@@ -429,22 +359,14 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 			idZSPulseEncoder["type"]      = static_cast<int>(kEUTelGenericSparseClusterImpl);
 			idZSPulseEncoder.setCellID( zsPulse.get() );
 			
-			zsPulse->setCharge( sparseCluster->getTotalCharge() );
+			zsPulse->setCharge( plane.charges[iCluster] );
 			//zsPulse->setQuality( static_cast<int > (sparseCluster->getClusterQuality()) );
 			zsPulse->setTrackerData( zsCluster.release() );
 			pulseCollection->push_back( zsPulse.release() );
 			
 			// last but not least increment the totClusterMap
 			_totClusterMap[ sensorID ] += 1;
-			
-		      } //cluster processing if
-		    
-		    else 
-		      {
-			//in the case the cluster candidate is not passing the threshold ...
-			//forget about them, the memory should be automatically cleaned by smart ptr's
-		      }
-		  } //loop over all found clusters
+		} //loop over all found clusters
 	} // this is the end of the loop over all ZS detectors
 	
 	// if the sparseClusterCollectionVec isn't empty add it to the
@@ -462,6 +384,58 @@ void EUTelProcessorGeometricClustering::geometricClustering(LCEvent * evt, LCCol
 	}
 }
 
+void EUTelProcessorGeometricClustering::findPlaneClusters(PlaneClusters & plane) const {
+	std::vector<EUTelGeometricPixel> hitPixelVec;
+	plane.nPixels = 0;
+
+	//This loop reads all the hits of the given event and detector plane in place and stores them as GeometricPixels
+	bool knownType = forEachPixel(plane.zsData, plane.type, [&](EUTelBaseSparsePixel const & pixel) {
+		++plane.nPixels;
+		EUTelGeometricPixel hitPixel( dynamic_cast<EUTelGenericSparsePixel const &>(pixel) );
+
+		if( !plane.pixelGeometry->contains(hitPixel.getXCoord(), hitPixel.getYCoord()) ) {
+			plane.skippedPixels.push_back( std::make_pair(hitPixel.getXCoord(), hitPixel.getYCoord()) );
+			return;
+		}
+
+		//get the position and the dimensions of the imbedding box from the table
+		geo::EUTelPixelGeometryTable::PixelGeometry const & geometry = plane.pixelGeometry->at( hitPixel.getXCoord(), hitPixel.getYCoord() );
+		hitPixel.setBoundaryX( geometry.boundX );
+		hitPixel.setBoundaryY( geometry.boundY );
+		hitPixel.setPosX( geometry.posX );
+		hitPixel.setPosY( geometry.posY );
+		//and push this pixel back
+		hitPixelVec.push_back( hitPixel );
+	});
+	if( !knownType ) throw UnknownDataTypeException("Unknown sparsified pixel");
+
+	//We now cluster those hits together
+	std::vector<EUTelClusterFinder::GeometricHit> hits;
+	hits.reserve( hitPixelVec.size() );
+	for( auto const & hitPixel: hitPixelVec ) {
+		hits.push_back( { hitPixel.getPosX(), hitPixel.getPosY(), hitPixel.getBoundaryX(), hitPixel.getBoundaryY(), hitPixel.getTime() } );
+	}
+	EUTelClusterFinder::ClusterIndexVec clusterIndices;
+	EUTelClusterFinder::findGeometricClusters( hits, _cutT, _clusteringEngine, clusterIndices );
+
+	for( auto const & clusterIndex: clusterIndices ) {
+		// prepare a TrackerData to store the cluster candidate
+		std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+		// prepare a reimplementation of sparsified cluster
+		std::unique_ptr<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>> sparseCluster = std::make_unique<EUTelGenericSparseClusterImpl<EUTelGeometricPixel>>(zsCluster.get());
+
+		for( size_t index: clusterIndex ) {
+			sparseCluster->push_back( hitPixelVec[index] );
+		}
+
+		//Now we need to process the found cluster
+		if ( sparseCluster->size() > 0 ) {
+			plane.charges.push_back( sparseCluster->getTotalCharge() );
+			plane.clusters.push_back( std::move(zsCluster) );
+		}
+	}
+}
+
 void EUTelProcessorGeometricClustering::check (LCEvent * /* evt */) {
   // nothing to check here - could be used to fill check plots in reconstruction processor
 }
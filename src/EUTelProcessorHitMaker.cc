@@ -26,6 +26,7 @@
 #include "EUTelDFFClusterImpl.h"
 #include "EUTelBrickedClusterImpl.h"
 #include "EUTelSparseClusterImpl.h"
+#include "EUTelClusterSummary.h"
 
 #include "EUTelExceptions.h"
 #include "EUTelAlignmentConstant.h"
@@ -265,6 +266,9 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
     CellIDDecoder<TrackerPulseImpl> clusterCellDecoder(pulseCollection);
     CellIDDecoder<TrackerDataImpl> cellDecoder(EUTELESCOPE::ZSDATADEFAULTENCODING);
 
+    // the cluster summaries of the clustering, only if they match the pulses
+    LCCollectionVec * summaryCollection = EUTelClusterSummary::getCollection( event, _pulseCollectionName, pulseCollection->getNumberOfElements() );
+
     int oldDetectorID = -100;
 
     double xSize = 0., ySize = 0.;
@@ -307,6 +311,13 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
 			}
 
 
+			// the summary written by the clustering, if any
+			EUTelClusterSummary summary;
+			if( summaryCollection )
+			{
+					summary = EUTelClusterSummary( dynamic_cast<EVENT::LCGenericObject*>(summaryCollection->getElementAt(iCluster)) );
+			}
+
 			// LOCAL coordinate system !!!!!!
 			double telPos[3];
 			
@@ -347,6 +358,17 @@ void EUTelProcessorHitMaker::processEvent (LCEvent * event) {
 				telPos[2] = 0;
 			}
 
+			else if( clusterType == kEUTelSparseClusterImpl && summary.isValid() )
+			{
+				//the centre of gravity was already computed by the clustering
+				float xCoG(0.0f), yCoG(0.0f);
+				summary.getCenterOfGravity(xCoG, yCoG);
+
+				telPos[0] = (xCoG + 0.5) * xPitch - xSize/2.;
+				telPos[1] = (yCoG + 0.5) * yPitch - ySize/2.;
+				telPos[2] = 0.;
+			}
+
 			else
 			{
 					EUTelSparseClusterImpl<EUTelGenericSparsePixel>* cluster = new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(trackerData);
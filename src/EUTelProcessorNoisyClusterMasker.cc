@@ -15,6 +15,8 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
+#include "EUTelExceptions.h"
 #include "CellIDReencoder.h"
 #include "EUTelUtility.h"
 
@@ -82,7 +84,10 @@ void EUTelProcessorNoisyClusterMasker::processEvent(LCEvent * event) {
 	if(_firstEvent) {
 		//The noisy pixel collection stores all thot pixels in event #1
 		//Thus we have to read it in in that case
-		_noisyPixelMap = Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+		if( !_noisyPixelMask.load(event, _noisyPixelCollectionName) && !_noisyPixelCollectionName.empty() ) {
+			streamlog_out ( WARNING1 ) << "noisyPixelCollectionName " << _noisyPixelCollectionName.c_str() << " not found" << std::endl;
+			streamlog_out ( WARNING1 ) << "READ CAREFULLY: This means that no noisy clusters will be masked, despite the processor successfully running!" << std::endl;
+		}
 		_firstEvent = false;
 	}
 
@@ -109,27 +114,20 @@ void EUTelProcessorNoisyClusterMasker::processEvent(LCEvent * event) {
         	TrackerPulseImpl* pulseData = dynamic_cast<TrackerPulseImpl*> ( pulseInputCollectionVec->getElementAt( iPulse ) );
 		int sensorID = cellDecoder(pulseData)["sensorID"];		
 	
-	        //get the noise vector for the given plane
-		std::vector<int>* noiseVector = &(_noisyPixelMap[sensorID]);
-		
 		//each pulse has the tracker data attached to it
 		TrackerDataImpl* trackerData = dynamic_cast<TrackerDataImpl*>( pulseData->getTrackerData() );
 		//decoder for tracker data
 		CellIDDecoder<TrackerDataImpl> trackerDecoder ( EUTELESCOPE::ZSCLUSTERDEFAULTENCODING );
-		int pixelType = trackerDecoder(trackerData)["sparsePixelType"];
+		SparsePixelType pixelType = static_cast<SparsePixelType>(static_cast<int>(trackerDecoder(trackerData)["sparsePixelType"]));
 
-		//interface to sparsified data
-        auto sparseData = Utility::getSparseData(trackerData, pixelType);
 		bool noisy = false;
 		
-		//Loop over all hits!
-		for(auto& pixelRef: *sparseData) {
-			auto& pixel = pixelRef.get();
-			if(std::binary_search( noiseVector->begin(), noiseVector->end(), Utility::cantorEncode(pixel.getXCoord(), pixel.getYCoord()) )) {
-				noisy = true;
-				break;
-			}
-		}
+		//Loop over the hits, up to the first noisy one
+		bool knownType = forEachPixel(trackerData, pixelType, [&](EUTelBaseSparsePixel const & pixel) {
+			noisy = _noisyPixelMask.isHot(sensorID, pixel.getXCoord(), pixel.getYCoord());
+			return !noisy;
+		});
+		if(!knownType) throw UnknownDataTypeException("Unknown sparsified pixel");
 
 		if(noisy) {
 			int quality = cellDecoder(pulseData)["quality"];
@@ -12,6 +12,8 @@
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
+#include "EUTelExceptions.h"
 
 // eutelescope geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -187,13 +189,10 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 			if(foundexcludedsensor) continue;
 
 			// now prepare the EUTelescope interface to sparsified data.  
-			int pixelType = cellDecoder(zsData)["sparsePixelType"];
-			auto sparseData = Utility::getSparseData(zsData, pixelType);
+			SparsePixelType pixelType = static_cast<SparsePixelType>(static_cast<int>(cellDecoder(zsData)["sparsePixelType"]));
 
 			// loop over all pixels in the sparseData object, these are the hit pixels!
-			for(auto& pixelRef: *sparseData) {
-				auto& pixel = pixelRef.get();
-
+			bool knownType = forEachPixel(zsData, pixelType, [&](EUTelBaseSparsePixel const & pixel) {
 				//compute the address in the array-like-structure, any offset
 				//has to be substracted (array index starts at 0)
 				int indexX = pixel.getXCoord() - currentSensor->offX;
@@ -206,7 +205,8 @@ void EUTelProcessorNoisyPixelFinder::noisyPixelFinder(EUTelEventImpl* evt) {
 					streamlog_out ( ERROR5 )  << "Pixel: " << pixel.getXCoord() << "|" <<  pixel.getYCoord() << " on plane: " << sensorID << " fired." << std::endl 
 						<< "This pixel is out of the range defined by the geometry. Either your data is corrupted or your pixel geometry not specified correctly!" << std::endl;
 				}
-			}
+			});
+			if(!knownType) throw UnknownDataTypeException("Unknown sparsified pixel");
 		}    
 	} catch (lcio::DataNotAvailableException& e ) {
 		streamlog_out ( WARNING2 )  << "Input collection not found in the current event. Skipping..." << e.what() << std::endl;
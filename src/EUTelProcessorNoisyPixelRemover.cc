@@ -14,6 +14,7 @@
 #include "EUTELESCOPE.h"
 #include "EUTelProcessorNoisyPixelRemover.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
 #include "EUTelUtility.h"
 
 // marlin includes ".h"
@@ -67,7 +68,10 @@ void EUTelProcessorNoisyPixelRemover::processEvent(LCEvent* event) {
 	if(_firstEvent) {
 		//The noisy pixel collection stores all thot pixels in event #1
 		//Thus we have to read it in in that case
-		_noisyPixelMap = Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+		if( !_noisyPixelMask.load(event, _noisyPixelCollectionName) && !_noisyPixelCollectionName.empty() ) {
+			streamlog_out ( WARNING1 ) << "noisyPixelCollectionName " << _noisyPixelCollectionName.c_str() << " not found" << std::endl;
+			streamlog_out ( WARNING1 ) << "READ CAREFULLY: This means that no noisy pixels will be removed, despite the processor successfully running!" << std::endl;
+		}
 		_firstEvent = false;
 	}
 
@@ -119,19 +123,14 @@ void EUTelProcessorNoisyPixelRemover::processEvent(LCEvent* event) {
 		trackerData->setCellID1( inputData->getCellID1() );
 		trackerData->setTime( inputData->getTime() );
 				
-		//get the noise vector for the given plane
-		std::vector<int>* noiseVector = &(_noisyPixelMap[sensorID]);
-		
-		//interface to sparsified data
-		auto sparseDataInterface = Utility::getSparseData(inputData, pixelType);
+		//the input is only read, the interface is needed for the output
 		auto sparseOutputData = Utility::getSparseData(trackerData.get(), pixelType);
 
-		for(auto& pixelRef: *sparseDataInterface) {
-			auto& pixel = pixelRef.get();
-			if(!std::binary_search( noiseVector->begin(), noiseVector->end(), Utility::cantorEncode(pixel.getXCoord(), pixel.getYCoord()) )) {
+		forEachPixel(inputData, pixelType, [&](EUTelBaseSparsePixel const & pixel) {
+			if(!_noisyPixelMask.isHot(sensorID, pixel.getXCoord(), pixel.getYCoord())) {
 					sparseOutputData->push_back(pixel);
 			}
-		}
+		});
 	}	
 	outputCollection->push_back( trackerData.release() );
 	
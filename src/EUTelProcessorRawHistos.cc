@@ -11,7 +11,8 @@
 #include "EUTelProcessorRawHistos.h"
 #include "EUTELESCOPE.h"
 #include "EUTelRunHeaderImpl.h"
-#include "EUTelTrackerDataInterfacerImpl.h"
+#include "EUTelPixelView.h"
+#include "EUTelExceptions.h"
 
 // eutelescope geometry
 #include "EUTelGeometryTelescopeGeoDescription.h"
@@ -106,13 +107,11 @@ void EUTelProcessorRawHistos::initialiseNoisyPixels( LCCollectionVec* const nois
 		//And get the corresponding noise vector for that plane
 		std::vector<int>* noiseSensorVector = &(_noisyPixelVecMap[sensorID]);
 
-		if( pixelType == kEUTelGenericSparsePixel ) {
-			auto noisyPixelData =  std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(noisyTrackerData);
-			auto& pixelVec = noisyPixelData->getPixels();
+		if( isGenericSparsePixelStorage( pixelType ) ) {
 			//Store all the noisy pixels in the noise vector, use the provided encoding to map two int's to an unique int
-			for( auto& pixel: pixelVec ) {	
+			forEachPixel( noisyTrackerData, static_cast<SparsePixelType>(pixelType), [&](EUTelBaseSparsePixel const & pixel) {
 				noiseSensorVector->push_back( cantorEncode(pixel.getXCoord(), pixel.getYCoord()) );
-			}
+			});
 		} else { /*PANIC*/ }
 	}
 
@@ -177,12 +176,10 @@ void EUTelProcessorRawHistos::processEvent (LCEvent* event) {
 			// get the TrackerData and guess which kind of sparsified data it contains.
 			TrackerDataImpl* zsData = dynamic_cast< TrackerDataImpl* > ( zsInputCollectionVec->getElementAt( iDetector ) );
 			int sensorID            = static_cast<int > ( cellDecoder( zsData )["sensorID"] );
+			SparsePixelType type    = static_cast<SparsePixelType> ( static_cast<int> ( cellDecoder( zsData )["sparsePixelType"] ) );
 
-			// now prepare the EUTelescope interface to sparsified data.  
-			auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>( zsData );
-			auto& pixelVec = sparseData->getPixels();
-
-			for( auto& genericPixel: pixelVec ) {
+			// the pixels are decoded in place from the sparsified data.
+			bool isGeneric = forEachGenericPixel( zsData, type, [&](EUTelGenericSparsePixel const & genericPixel) {
 				bool isNoisy = false;
 				
 				int xCo = genericPixel.getXCoord(); 
@@ -201,6 +198,9 @@ void EUTelProcessorRawHistos::processEvent (LCEvent* event) {
 					_chargeHistoNoNoise.at(sensorID)->fill(genericPixel.getSignal());
 					_timeHistoNoNoise.at(sensorID)->fill(genericPixel.getTime());		
 				}
+			});
+			if( !isGeneric ) {
+				throw UnknownDataTypeException("Unknown sparsified pixel");
 			}
 		}
 
@@ -85,7 +85,11 @@ EUTelProcessorSparseClustering::EUTelProcessorSparseClustering():
   _sensorIDVec(),
   _zsInputDataCollectionVec(NULL),
   _pulseCollectionVec(NULL),
-  _sparseMinDistanceSquared(2)
+  _sparseMinDistanceSquared(2),
+  _clusteringEngineName(""),
+  _clusteringEngine(EUTelClusterFinder::kIterative),
+  _nThreads(1),
+  _threadPool()
  {
   
   // modify processor description
@@ -113,7 +117,12 @@ EUTelProcessorSparseClustering::EUTelProcessorSparseClustering():
 
   registerProcessorParameter("SparseMinDistanceSquared","Minimum distance squared between sparsified pixel ( touching == 2) ",
                              _sparseMinDistanceSquared, static_cast<int>(2) );
-  
+
+  registerOptionalParameter("ClusteringEngine","Engine used to group the hits: Iterative (scan over all hits) or Sweep (sorted neighbour search), both yield identical clusters",
+                             _clusteringEngineName, std::string("Iterative") );
+
+  registerOptionalParameter("NumberOfThreads","Number of threads clustering the planes of an event concurrently, 1 is serial, 0 uses all cores",
+                             _nThreads, static_cast<int>(1) );
 
   		_isFirstEvent = true;
 }
@@ -125,6 +134,14 @@ void EUTelProcessorSparseClustering::init() {
 	//init new geometry
 	geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME, EUTELESCOPE::DUMPGEOROOT);
 
+	_clusteringEngine = EUTelClusterFinder::engineFromString( _clusteringEngineName );
+
+	if( _nThreads < 0 ) {
+		throw InvalidParameterException("NumberOfThreads has to be positive or 0 for all cores");
+	}
+	_threadPool = std::make_unique<EUTelThreadPool>( static_cast<unsigned>(_nThreads) );
+	streamlog_out ( MESSAGE4 ) << "Clustering the planes with " << _threadPool->size() << " thread(s)" << std::endl;
+
 	//set to zero the run and event counters
 	_iRun = 0;
 	_iEvt = 0;
@@ -298,7 +315,10 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 	CellIDEncoder<TrackerPulseImpl> idZSPulseEncoder(EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
 	// in the zsInputDataCollectionVec we should have one TrackerData for each
-	// detector working in ZS mode. We need to loop over all of them
+	// detector working in ZS mode. The decoder is not thread safe, so all
+	// of them are decoded here before the clustering
+	std::vector<PlaneClusters> planes;
+	planes.reserve( _zsInputDataCollectionVec->size() );
 	for ( unsigned int idetector = 0 ; idetector < _zsInputDataCollectionVec->size(); idetector++ )
 	{
 		// get the TrackerData and guess which kind of sparsified data it contains.
@@ -321,96 +341,72 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 			continue;
 		}
 
+		planes.push_back( PlaneClusters() );
+		planes.back().zsData = zsData;
+		planes.back().sensorID = sensorID;
+		planes.back().type = type;
+		planes.back().clusterType = isGenericSparsePixelStorage( type ) ? kEUTelGenericSparsePixel : type;
+	}
 
+	//the planes are clustered independently, possibly concurrently
+	_threadPool->run( planes.size(), [this, &planes](size_t i) { findPlaneClusters( planes[i] ); } );
 
-		// now prepare the EUTelescope interface to sparsified data.
-		//auto sparseData = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(zsData);
-
-		auto sparseData = Utility::getSparseData(zsData, type);
-		auto hitPixelVec = sparseData->getPixels();
-		std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> newlyAdded;
-		
-		//We now cluster those hits together
-		while( !hitPixelVec.empty() ) {
-            // prepare a TrackerData to store the cluster candidate
-			std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
-			// prepare a reimplementation of sparsified cluster
-			auto sparseCluster = Utility::getClusterData(zsCluster.get(), type); //std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(zsCluster.get());
-
-			//First we need to take any pixel, so let's take the first one
-			//Add it to the cluster as well as the newly added pixels
-			newlyAdded.push_back( hitPixelVec.front() );
-			sparseCluster->push_back( hitPixelVec.front().get() );
-			//And remove it from the original collection
-			hitPixelVec.erase( hitPixelVec.begin() );
-
-			//Now process all newly added pixels, initially this is the just previously added one
-			//but in the process of neighbour finding we continue to add new pixels
-			while( !newlyAdded.empty() ) {
-				bool newlyDone = true;
-				//check against all pixels in the hitPixelVec
-				for( auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec ) {
-					//get the relevant infos from the newly added pixel
-					auto x1 = newlyAdded.front().get().getXCoord();
-					auto y1 = newlyAdded.front().get().getYCoord();
-
-					//and the pixel we test against
-					auto x2 = (hitVec->get()).getXCoord();
-					auto y2 = (hitVec->get()).getYCoord();
-
-					auto dX = x1 - x2;
-					auto dY = y1 - y2;
-					int distance = dX*dX+dY*dY;
-					//if they pass the spatial and temporal cuts, we add them
-					if( distance <= _sparseMinDistanceSquared ) {
-						//add them to the cluster as well as to the newly added ones
-						newlyAdded.push_back( *hitVec );
-						sparseCluster->push_back( *hitVec );
-						//and remove it from the original collection
-						hitPixelVec.erase( hitVec );
-						//for the pixel we test there might be other neighbours, we still have to check
-						newlyDone = false;
-						break;
-					}
-				}
-
-				//if no neighbours are found, we can delete the pixel from the newly added
-				//we tested against _ALL_ non cluster pixels, there are no other pixels
-				//which could be neighbours
-				if(newlyDone) newlyAdded.erase( newlyAdded.begin() );
-			}
-			
-			//Now we need to process the found cluster
-			if( sparseCluster->size()>0 ) {
-				// set the ID for this zsCluster
-				idZSClusterEncoder["sensorID"] = sensorID;
-				idZSClusterEncoder["sparsePixelType"] = static_cast<int>( type );
-				idZSClusterEncoder["quality"] = 0;
-				idZSClusterEncoder.setCellID( zsCluster.get() );
-
-				// add it to the cluster collection
-				sparseClusterCollectionVec->push_back( zsCluster.get() );
-
-				// prepare a pulse for this cluster
-				std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
-				idZSPulseEncoder["sensorID"] = sensorID;
-				idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
-				idZSPulseEncoder.setCellID( zsPulse.get() );
-
-				//zsPulse->setCharge( sparseCluster->getTotalCharge() );
-				zsPulse->setTrackerData( zsCluster.release() );
-				pulseCollection->push_back( zsPulse.release() );
-
-				// last but not least increment the totClusterMap
-				_totClusterMap[ sensorID ] += 1;
-			} //cluster processing if
-			else {
-				//in the case the cluster candidate is not passing the threshold ...
-				//forget about them, the memory should be automatically cleaned by smart ptr's
-			}
+	//the summaries are stored next to the pulses, the pulses already in the
+	//collection (from other clustering processors) get empty placeholders
+	size_t const noOfPreviousPulses = pulseCollection->size();
+	LCCollectionVec* summaryCollection = NULL;
+	bool summaryCollectionExists = false;
+	try
+	{
+		summaryCollection = dynamic_cast< LCCollectionVec* > ( evt->getCollection( EUTelClusterSummary::getCollectionName(_pulseCollectionName) ) );
+		summaryCollectionExists = true;
+	}
+	catch (lcio::DataNotAvailableException& e)
+	{
+		summaryCollection = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+		summaryCollection->setTransient( true );
+	}
+	while( summaryCollection->size() < noOfPreviousPulses ) {
+		summaryCollection->push_back( EUTelClusterSummary().makeGenericObject() );
+	}
+
+	//the found clusters are stored in plane order, independent of the number of threads
+	for( auto & plane: planes ) {
+		for( size_t iCluster = 0; iCluster < plane.clusters.size(); ++iCluster ) {
+			auto & zsCluster = plane.clusters[iCluster];
+			// set the ID for this zsCluster
+			idZSClusterEncoder["sensorID"] = plane.sensorID;
+			idZSClusterEncoder["sparsePixelType"] = static_cast<int>( plane.clusterType );
+			idZSClusterEncoder["quality"] = 0;
+			idZSClusterEncoder.setCellID( zsCluster.get() );
+
+			// add it to the cluster collection
+			sparseClusterCollectionVec->push_back( zsCluster.get() );
+
+			// prepare a pulse for this cluster
+			std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
+			idZSPulseEncoder["sensorID"] = plane.sensorID;
+			idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
+			idZSPulseEncoder.setCellID( zsPulse.get() );
+
+			//zsPulse->setCharge( sparseCluster->getTotalCharge() );
+			zsPulse->setTrackerData( zsCluster.release() );
+			pulseCollection->push_back( zsPulse.release() );
+			summaryCollection->push_back( plane.summaries[iCluster].makeGenericObject() );
+
+			// last but not least increment the totClusterMap
+			_totClusterMap[ plane.sensorID ] += 1;
 		} //loop over all found clusters
 	} // this is the end of the loop over all ZS detectors
 
+	if( !summaryCollectionExists ) {
+		if( summaryCollection->size() != noOfPreviousPulses ) {
+			evt->addCollection( summaryCollection, EUTelClusterSummary::getCollectionName(_pulseCollectionName) );
+		} else {
+			delete summaryCollection;
+		}
+	}
+
 	// if the sparseClusterCollectionVec isn't empty add it to the
 	// current event. The pulse collection will be added afterwards
 	if ( ! isDummyAlreadyExisting )
@@ -427,6 +423,39 @@ void EUTelProcessorSparseClustering::sparseClustering(LCEvent* evt, LCCollection
 }
 
 
+void EUTelProcessorSparseClustering::findPlaneClusters(PlaneClusters & plane) const
+{
+	// now prepare the EUTelescope interface to sparsified data.
+	auto sparseData = Utility::getSparseData(plane.zsData, plane.type);
+	auto const & hitPixelVec = sparseData->getPixels();
+
+	//We now cluster those hits together
+	std::vector<EUTelClusterFinder::SparseHit> hits;
+	hits.reserve( hitPixelVec.size() );
+	for( auto& pixelRef: hitPixelVec ) {
+		hits.push_back( { pixelRef.get().getXCoord(), pixelRef.get().getYCoord() } );
+	}
+	EUTelClusterFinder::ClusterIndexVec clusterIndices;
+	EUTelClusterFinder::findSparseClusters( hits, _sparseMinDistanceSquared, _clusteringEngine, clusterIndices );
+
+	for( auto const & clusterIndex: clusterIndices ) {
+		// prepare a TrackerData to store the cluster candidate
+		std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+		// prepare a reimplementation of sparsified cluster
+		auto sparseCluster = Utility::getClusterData(zsCluster.get(), plane.clusterType);
+
+		for( size_t index: clusterIndex ) {
+			sparseCluster->push_back( hitPixelVec[index].get() );
+		}
+
+		//Now we need to process the found cluster
+		if( sparseCluster->size()>0 ) {
+			plane.summaries.push_back( EUTelClusterSummary(zsCluster.get(), plane.clusterType) );
+			plane.clusters.push_back( std::move(zsCluster) );
+		}
+	}
+}
+
 
 void EUTelProcessorSparseClustering::check (LCEvent * /* evt */) {
   // nothing to check here - could be used to fill check plots in reconstruction processor
@@ -200,9 +200,9 @@ void EUTelRawDataSparsifier::processEvent (LCEvent * event) {
       // instead of
       float sigmaCut = _sigmaCutVec[ iDetector ];
 
-      if ( _pixelType == kEUTelGenericSparsePixel ) {
+      if ( _pixelType == kEUTelGenericSparsePixel || _pixelType == kEUTelPackedGenericPixel ) {
 
-        EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>  sparseData( sparsified ) ;
+        EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>  sparseData( sparsified, static_cast<SparsePixelType>( _pixelType ) ) ;
         while ( rawIter != rawData->getADCValues().end() ) {
           if (  (*statusIter) == EUTELESCOPE::GOODPIXEL ) {
             float data      = (*rawIter) - (*pedIter);
@@ -14,6 +14,7 @@
 #include "EUTelStrasMimoTelReader.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelEventImpl.h"
+#include "EUTelMappedFile.h"
 #include "EUTELESCOPE.h"
 
 // marlin includes
@@ -143,8 +144,23 @@ void EUTelStrasMimoTelReader::readDataSource (int numEvents) {
   }
   
   int nFile = _runHeader.TotEvNb / _runHeader.FileEvNb;
-  _dataBuffer   = new int[_runHeader.DataSz / sizeof(int) ];
   int matrixSize   = _noOfXPixel * _noOfYPixel;
+
+  // the data block has to hold the rubbish matrix and one matrix per
+  // plane, otherwise the decoding would read past the record
+  const size_t requiredDataSize = static_cast< size_t >( _runHeader.VFasPresentNb + 2 ) * matrixSize * sizeof(int);
+  if ( _runHeader.VFasPresentNb < 0 || _runHeader.DataSz < 0 || static_cast< size_t >( _runHeader.DataSz ) < requiredDataSize ) {
+    message<ERROR5> ( log() << "The data block size " << _runHeader.DataSz << " is too small for " << _runHeader.VFasPresentNb + 1
+		      << " planes of " << matrixSize << " pixels (" << requiredDataSize << " bytes). Exiting." );
+    addEORE();
+    exit(-1);
+  }
+
+  // each record is made by the event header, the data block and the
+  // event trailer
+  const size_t dataOffset    = sizeof(StrasEventHeader);
+  const size_t trailerOffset = dataOffset + _runHeader.DataSz;
+  const size_t recordSize    = trailerOffset + sizeof(StrasEventTrailer);
   
   for ( int iFile = 0; iFile < nFile; iFile++  ) {
     
@@ -155,150 +171,152 @@ void EUTelStrasMimoTelReader::readDataSource (int numEvents) {
       dataFileName = ss.str();
     }
     
-    ifstream dataFile;
-    dataFile.exceptions (ifstream::failbit | ifstream::badbit );
-    
-    // try to open the data file
-    try {
-      
-      message<DEBUG5> ( log() << "Opening file " << dataFileName );
-      dataFile.open( dataFileName.c_str(), ios::in | ios::binary );
+    // the data file is mapped into memory and the records are
+    // decoded directly from there
+    EUTelMappedFile dataFile;
+    message<DEBUG5> ( log() << "Opening file " << dataFileName );
+    if ( ! dataFile.open( dataFileName ) ) {
+      message<ERROR5> ( log() << "Unable to open file " << dataFileName << ". Exiting." );
+      addEORE();
+      exit(-1);
+    }
       
-      while ( !dataFile.eof() ) {
-	if ( (eventCounter % 10 == 0 ) )
-	  message<MESSAGE5> ( log() << "Converting event " << eventCounter << " (File = " << iFile << ")" );
+    // an incomplete record at the end of the file is ignored
+    for ( size_t recordOffset = 0; recordOffset + recordSize <= dataFile.size(); recordOffset += recordSize ) {
+
+      // let the kernel read the next record while this one is decoded
+      dataFile.prefetch( recordOffset + recordSize, recordSize );
+      const char * record = dataFile.data() + recordOffset;
+
+      if ( (eventCounter % 10 == 0 ) )
+	message<MESSAGE5> ( log() << "Converting event " << eventCounter << " (File = " << iFile << ")" );
 	    
-	// get the full record
-	dataFile.read( reinterpret_cast<char *> (&_eventHeader), sizeof(StrasEventHeader) );
-	dataFile.read( reinterpret_cast<char *> (_dataBuffer), _runHeader.DataSz  );
-	dataFile.read( reinterpret_cast<char *> (&_eventTrailer), sizeof(StrasEventTrailer) );
+      // get the header and the trailer, the data block is used in place
+      _eventHeader  = EUTelMappedFile::read< StrasEventHeader >( record );
+      _eventTrailer = EUTelMappedFile::read< StrasEventTrailer >( record + trailerOffset );
+      const char * dataBlock = record + dataOffset;
 	
-	// make some checks
-	if ( static_cast< unsigned >(_eventTrailer.Eor) != 0x89ABCDEF ) {
-	  message<ERROR5> ( log() << "Event trailer not found on event " << _eventHeader.EvNo << ". Exiting ");
-	  exit(-1);
-	}
+      // make some checks
+      if ( static_cast< unsigned >(_eventTrailer.Eor) != 0x89ABCDEF ) {
+	message<ERROR5> ( log() << "Event trailer not found on event " << _eventHeader.EvNo << ". Exiting ");
+	exit(-1);
+      }
 	
-	if ( _eventHeader.EvNo != static_cast< unsigned >(eventCounter) ) {
-	  message<WARNING> ( log() << "Event number mismatch: expected " << eventCounter << " read " << _eventHeader.EvNo );
-	}
+      if ( _eventHeader.EvNo != static_cast< unsigned >(eventCounter) ) {
+	message<WARNING> ( log() << "Event number mismatch: expected " << eventCounter << " read " << _eventHeader.EvNo );
+      }
 
-	if ( _eventHeader.VFasCnt < 0 ) {
-	  // the trigger is not accepted. Skip the event
-	  message<WARNING> ( log() << "Trigger not accepted on event " << eventCounter ) ;
+      if ( _eventHeader.VFasCnt < 0 ) {
+	// the trigger is not accepted. Skip the event
+	message<WARNING> ( log() << "Trigger not accepted on event " << eventCounter ) ;
 	  
-	} else {
-
-	  EUTelEventImpl * event = new EUTelEventImpl;
-	  event->setRunNumber( _runNumber );
-	  event->setEventNumber( _eventHeader.EvNo );
-	  LCTime * now = new LCTime;
-	  event->setTimeStamp(now->timeStamp());
-	  delete now;
-	  event->setEventType( kDE );
+      } else {
+
+	EUTelEventImpl * event = new EUTelEventImpl;
+	event->setRunNumber( _runNumber );
+	event->setEventNumber( _eventHeader.EvNo );
+	LCTime * now = new LCTime;
+	event->setTimeStamp(now->timeStamp());
+	delete now;
+	event->setEventType( kDE );
 	  
-	  LCCollectionVec * cdsColl    = new LCCollectionVec( LCIO::TRACKERRAWDATA );
-	  LCCollectionVec * frame0Coll = new LCCollectionVec( LCIO::TRACKERRAWDATA );
-	  LCCollectionVec * frame1Coll = new LCCollectionVec( LCIO::TRACKERRAWDATA );
-	  CellIDEncoder< TrackerRawDataImpl > idEncoderCDS( EUTELESCOPE::MATRIXDEFAULTENCODING, cdsColl );
-	  idEncoderCDS["xMin"] = 0;
-	  idEncoderCDS["xMax"] = _noOfXPixel - 1;
-	  idEncoderCDS["yMin"] = 0;
-	  idEncoderCDS["yMax"] = _noOfYPixel - 1;
-	  CellIDEncoder< TrackerRawDataImpl > idEncoderFrame0( EUTELESCOPE::MATRIXDEFAULTENCODING, frame0Coll );
-	  idEncoderFrame0["xMin"] = 0;
-	  idEncoderFrame0["xMax"] = _noOfXPixel - 1;
-	  idEncoderFrame0["yMin"] = 0;
-	  idEncoderFrame0["yMax"] = _noOfYPixel - 1;
-	  CellIDEncoder< TrackerRawDataImpl > idEncoderFrame1( EUTELESCOPE::MATRIXDEFAULTENCODING, frame1Coll );
-	  idEncoderFrame1["xMin"] = 0;
-	  idEncoderFrame1["xMax"] = _noOfXPixel - 1;
-	  idEncoderFrame1["yMin"] = 0;
-	  idEncoderFrame1["yMax"] = _noOfYPixel - 1;
+	LCCollectionVec * cdsColl    = new LCCollectionVec( LCIO::TRACKERRAWDATA );
+	LCCollectionVec * frame0Coll = new LCCollectionVec( LCIO::TRACKERRAWDATA );
+	LCCollectionVec * frame1Coll = new LCCollectionVec( LCIO::TRACKERRAWDATA );
+	CellIDEncoder< TrackerRawDataImpl > idEncoderCDS( EUTELESCOPE::MATRIXDEFAULTENCODING, cdsColl );
+	idEncoderCDS["xMin"] = 0;
+	idEncoderCDS["xMax"] = _noOfXPixel - 1;
+	idEncoderCDS["yMin"] = 0;
+	idEncoderCDS["yMax"] = _noOfYPixel - 1;
+	CellIDEncoder< TrackerRawDataImpl > idEncoderFrame0( EUTELESCOPE::MATRIXDEFAULTENCODING, frame0Coll );
+	idEncoderFrame0["xMin"] = 0;
+	idEncoderFrame0["xMax"] = _noOfXPixel - 1;
+	idEncoderFrame0["yMin"] = 0;
+	idEncoderFrame0["yMax"] = _noOfYPixel - 1;
+	CellIDEncoder< TrackerRawDataImpl > idEncoderFrame1( EUTELESCOPE::MATRIXDEFAULTENCODING, frame1Coll );
+	idEncoderFrame1["xMin"] = 0;
+	idEncoderFrame1["xMax"] = _noOfXPixel - 1;
+	idEncoderFrame1["yMin"] = 0;
+	idEncoderFrame1["yMax"] = _noOfYPixel - 1;
 	  
-	  // this is  because the first matrix contains only rubbish! 
-	  int offset = matrixSize ;
-	  unsigned int frame0Mask  = 0xFFF;
-	  unsigned int frame0Shift = 0;
-	  unsigned int frame1Mask  = 0xFFF000;
-	  unsigned int frame1Shift = 12;
-
-	  for ( int iDetector = 0; iDetector < _runHeader.VFasPresentNb + 1; iDetector++ ) {
+	// this is  because the first matrix contains only rubbish! 
+	int offset = matrixSize ;
+	unsigned int frame0Mask  = 0xFFF;
+	unsigned int frame0Shift = 0;
+	unsigned int frame1Mask  = 0xFFF000;
+	unsigned int frame1Shift = 12;
+
+	for ( int iDetector = 0; iDetector < _runHeader.VFasPresentNb + 1; iDetector++ ) {
 	    	    
-	    TrackerRawDataImpl * frame1 = new TrackerRawDataImpl;
-	    TrackerRawDataImpl * frame0 = new TrackerRawDataImpl;
-	    idEncoderFrame1["sensorID"] = iDetector;
-	    idEncoderFrame1.setCellID(frame1);
-	    idEncoderFrame0["sensorID"] = iDetector;
-	    idEncoderFrame0.setCellID(frame0);
-	    TrackerRawDataImpl * cds    = new TrackerRawDataImpl;
-	    idEncoderCDS["sensorID"] = iDetector;
-	    idEncoderCDS.setCellID(cds);
+	  TrackerRawDataImpl * frame1 = new TrackerRawDataImpl;
+	  TrackerRawDataImpl * frame0 = new TrackerRawDataImpl;
+	  idEncoderFrame1["sensorID"] = iDetector;
+	  idEncoderFrame1.setCellID(frame1);
+	  idEncoderFrame0["sensorID"] = iDetector;
+	  idEncoderFrame0.setCellID(frame0);
+	  TrackerRawDataImpl * cds    = new TrackerRawDataImpl;
+	  idEncoderCDS["sensorID"] = iDetector;
+	  idEncoderCDS.setCellID(cds);
+
+	  // the ADC vectors are filled in one go
+	  ShortVec & frame0Values = frame0->adcValues();
+	  ShortVec & frame1Values = frame1->adcValues();
+	  ShortVec & cdsValues    = cds->adcValues();
+	  frame0Values.resize( matrixSize );
+	  frame1Values.resize( matrixSize );
+	  cdsValues.resize( matrixSize );
 	    
-	    int iPixel =  offset + iDetector * matrixSize;
-	    for ( int y = 0; y < _noOfYPixel; y++ ) {  
-	      for ( int x = 0; x < _noOfXPixel; x++ ) {
-		short f0 = static_cast<short>(( _dataBuffer[iPixel] & frame0Mask ) >> frame0Shift);
-		short f1 = static_cast<short>(( _dataBuffer[iPixel] & frame1Mask ) >> frame1Shift);
-		frame0->adcValues().push_back( f0 );
-		frame1->adcValues().push_back( f1 );
-		cds->adcValues().push_back( f1 - f0 );
-		++iPixel;
-	      }
-	    }
- 	    vector<short > cdsVec = cds->adcValues();
-	    vector<short >::iterator begin, end;
-
-	    //	    cout << iDetector << " before min = " << (*min_element(cdsVec.begin(), cdsVec.end())) 
-	    //		 << " max = " << (*max_element(cdsVec.begin(), cdsVec.end())) << endl;
-
- 	    // correct for the CDS sign
-	    if ( _eventHeader.VFasCnt < matrixSize ) {
-	      begin = cdsVec.begin() + _eventHeader.VFasCnt ;
-	      end   = cdsVec.end();
-	    } else { 
-	      begin = cdsVec.begin();
-	      end   = cdsVec.begin() + _eventHeader.VFasCnt %  matrixSize;
-	    }
-	    transform( begin, end, begin, negate<int>() );
-	    // 	    cout << iDetector << " after min = " << (*min_element(cdsVec.begin(), cdsVec.end())) 
-	    //		 << " max = " << (*max_element(cdsVec.begin(), cdsVec.end())) << endl;
-
-	    frame0Coll->push_back( frame0 ) ;
-	    frame1Coll->push_back( frame1 ) ;
-	    cdsColl->push_back( cds );
-	      
+	  const char * word = dataBlock + ( offset + iDetector * matrixSize ) * sizeof(int);
+	  for ( int iPixel = 0; iPixel < matrixSize; iPixel++ ) {
+	    int value = EUTelMappedFile::read< int >( word );
+	    short f0 = static_cast<short>(( value & frame0Mask ) >> frame0Shift);
+	    short f1 = static_cast<short>(( value & frame1Mask ) >> frame1Shift);
+	    frame0Values[iPixel] = f0;
+	    frame1Values[iPixel] = f1;
+	    cdsValues[iPixel]    = f1 - f0;
+	    word += sizeof(int);
 	  }
+	  vector<short > cdsVec = cds->adcValues();
+	  vector<short >::iterator begin, end;
+
+	  //      cout << iDetector << " before min = " << (*min_element(cdsVec.begin(), cdsVec.end())) 
+	  //           << " max = " << (*max_element(cdsVec.begin(), cdsVec.end())) << endl;
+
+	  // correct for the CDS sign
+	  if ( _eventHeader.VFasCnt < matrixSize ) {
+	    begin = cdsVec.begin() + _eventHeader.VFasCnt ;
+	    end   = cdsVec.end();
+	  } else { 
+	    begin = cdsVec.begin();
+	    end   = cdsVec.begin() + _eventHeader.VFasCnt %  matrixSize;
+	  }
+	  transform( begin, end, begin, negate<int>() );
+	  //      cout << iDetector << " after min = " << (*min_element(cdsVec.begin(), cdsVec.end())) 
+	  //           << " max = " << (*max_element(cdsVec.begin(), cdsVec.end())) << endl;
+
+	  frame0Coll->push_back( frame0 ) ;
+	  frame1Coll->push_back( frame1 ) ;
+	  cdsColl->push_back( cds );
+	      
+	}
 	  
-	  event->addCollection( frame0Coll, _frame0CollectionName );
-	  event->addCollection( frame1Coll, _frame1CollectionName );
-	  event->addCollection( cdsColl,    _cdsCollectionName    );
+	event->addCollection( frame0Coll, _frame0CollectionName );
+	event->addCollection( frame1Coll, _frame1CollectionName );
+	event->addCollection( cdsColl,    _cdsCollectionName    );
 	  
-	  ProcessorMgr::instance()->processEvent( event ) ;
-	  delete event;
+	ProcessorMgr::instance()->processEvent( event ) ;
+	delete event;
 	  
-	}  
-	++eventCounter;
-	if ( eventCounter > numEvents ) {
-	  dataFile.close();
-	  break;
-	}
-	
-      }
-    } catch (ifstream::failure e) {
-      if ( !dataFile.eof() ) {
-	message<ERROR5> ( log() << "Unable to open file " << dataFileName << ". Exiting." );
-	addEORE();
-	exit(-1);
-      } else {
-	dataFile.close();
-	message<DEBUG5> ( log() << "Closing file " << dataFileName ) ;
+      }  
+      ++eventCounter;
+      if ( eventCounter > numEvents ) {
+	break;
       }
-    } 
+	
+    }
+    message<DEBUG5> ( log() << "Closing file " << dataFileName ) ;
   }
   
-  delete [] _dataBuffer;
-  
   addEORE();
    
 }
@@ -54,6 +54,7 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 #include <sstream>
 #include <memory>
 #include <string>
@@ -77,6 +78,92 @@ using namespace lcio ;
 using namespace marlin ;
 using namespace eutelescope;
 
+namespace {
+
+  // Chi2 of the track fit restricted to the first planes, minimised
+  // over all positions but the ones in the last two planes u, v:
+  //
+  //   chi2(u,v) = a u^2 + 2b uv + c v^2 + 2d u + 2e v + f
+  //
+  // Used by the branch-and-bound search: the form is updated plane by
+  // plane, its minimum is the chi2 of the selected hits. Adding more
+  // planes can not decrease it.
+
+  struct PartialChi2Form
+  {
+    double a, b, c, d, e, f;
+
+    PartialChi2Form() : a(0.), b(0.), c(0.), d(0.), e(0.), f(0.) {}
+
+    // Measurement in the last plane with weight w = 1/error^2
+    void addMeasurement(double pos, double w)
+    {
+      c += w;
+      e -= w*pos;
+      f += w*pos*pos;
+    }
+
+    // Add the next plane position w with the term
+    //   scat * (alpha u + beta v + gamma w + offset)^2
+    // and minimise over u, which leaves a form in v, w
+    void step(double scat, double alpha, double beta, double gamma, double offset)
+    {
+      double m[4][4] = { { a,  b,  0., d },
+                         { b,  c,  0., e },
+                         { 0., 0., 0., 0.},
+                         { d,  e,  0., f } };
+      double q[4] = { alpha, beta, gamma, offset };
+
+      for(int i=0; i<4; i++)
+        for(int j=0; j<4; j++)
+          m[i][j] += scat*q[i]*q[j];
+
+      if(m[0][0] > 0.)
+        for(int i=1; i<4; i++)
+          for(int j=i; j<4; j++)
+            m[i][j] -= m[i][0]*m[0][j]/m[0][0];
+
+      a = m[1][1];
+      b = m[1][2];
+      c = m[2][2];
+      d = m[1][3];
+      e = m[2][3];
+      f = m[3][3];
+    }
+
+    // Minimum over u and v
+    double minimum() const
+    {
+      double cc = c, ee = e, ff = f;
+      if(a > 0.)
+      {
+        cc -= b*b/a;
+        ee -= b*d/a;
+        ff -= d*d/a;
+      }
+      if(cc > 0.) ff -= ee*ee/cc;
+      return ff;
+    }
+  };
+
+  // State of the branch-and-bound search after deciding on a plane
+
+  struct TrackSearchNode
+  {
+    PartialChi2Form formX, formY;
+    int nFired;     // planes with a hit selected
+    int nMissing;   // active planes without a hit selected
+    int nSkipped;   // planes with hits, but none selected
+    int ifirst;     // first plane with a hit selected
+    int ilast;      // last plane with a hit selected
+    double lastSlopeX, lastSlopeY;
+
+    TrackSearchNode() : formX(), formY(), nFired(0), nMissing(0), nSkipped(0),
+                        ifirst(-1), ilast(0), lastSlopeX(0.), lastSlopeY(0.) {}
+  };
+
+}
+
 // definition of static members mainly used to name histograms
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
 std::string EUTelTestFitter::_linChi2HistoName   = "linChi2";
@@ -131,6 +218,8 @@ EUTelTestFitter::EUTelTestFitter()
   _allowMissingHits(0),
   _allowSkipHits(0),
   _maxPlaneHits(0),
+  _branchAndBoundSearch(false),
+  _branchAndBoundCheck(false),
   _searchMultipleTracks(false),
   _allowAmbiguousHits(false),
   _maximumAmbiguousHits(false),
@@ -183,6 +272,7 @@ EUTelTestFitter::EUTelTestFitter()
   _nominalErrorY(NULL),
   _noOfEventWOInputHit(0),
   _noOfEventWOTrack(0),
+  _noOfBranchAndBoundMismatch(0),
   _noOfTracks(0),
   _aidaHistoMap(),
   _aidaHistoMap1D(),
@@ -304,6 +394,10 @@ EUTelTestFitter::EUTelTestFitter()
   registerOptionalParameter("SlopeDistanceMax","Maximum hit distance from the expected position, used for hit preselection in [mm]", _SlopeDistanceMax, static_cast <float> (1.));
   // -------------------------------------------------------------------------------------------------
 
+  registerOptionalParameter("BranchAndBoundSearch","Reject hit combinations as soon as the chi2 of the hits selected so far fails the cuts (branch-and-bound track search)", _branchAndBoundSearch, static_cast <bool> (false));
+
+  registerOptionalParameter("BranchAndBoundCheck","Run also the exhaustive track search and report events where the branch-and-bound search finds different tracks", _branchAndBoundCheck, static_cast <bool> (false));
+
   std::vector<int > initLayerIDs;
   std::vector<float > initLayerShift;
 
@@ -411,6 +505,7 @@ EUTelTestFitter::EUTelTestFitter()
   // initialize all the counters
   _noOfEventWOInputHit   = 0;
   _noOfEventWOTrack = 0;
+  _noOfBranchAndBoundMismatch = 0;
   _noOfTracks        = 0;
 
 }
@@ -1392,307 +1487,636 @@ void EUTelTestFitter::processEvent( LCEvent * event ) {
 
     double chi2min  = numeric_limits<double >::max();
 
-    // Loop over fit possibilities
-    // Start from one-hit track to allow for "smart" skipping of wrong matches
-
-    int istart=0;
-    int nmiss=_allowMissingHits;
+    // Fit of the current hit selection (filled in _planeX, _planeY...)
+    // Select fit method
+    // "Nominal" fit only if all active planes used
 
-    while(nmiss>0 || !_isActive[istart])  
+    auto fitChoice = [this](int nChoiceFired) -> double
     {
-      if(_isActive[istart]) 
+      if(_useNominalResolution && (nChoiceFired == _nActivePlanes)) 
       {
-        nmiss--;
+        return NominalFit();
       }
-      istart++;
-    }
+      if(_useNominalResolution && _beamSlopeX==_beamSlopeY) return SingleFit();
+      return MatrixFit();
+    };
 
-    
-    for(type_fitcount ichoice = nChoice-_planeMod[istart]-1; ichoice >= 0; ichoice--)  
-    {        
-      int    nChoiceFired =  0 ;
-      double choiceChi2   = -1.;
-      double trackChi2    = -1.;
-      int    ifirst       = -1 ;
-      int    ilast        =  0 ;
-      int    nleft        =  0 ;
-     
-      // New variables for preselection based on slope
-      // will be set to plane number if
-      //   - hit too far from the expected position (based on first
-      //             plane + beam slope): hit missed
-      //   - angle between track segments (slope change) too large:
-      //                  track slope
-      //
-      // Value >0 gives first layer which failed the cut
-      // 0 value means that preselection cuts were passed by all hits
+    // Store fit results of the current hit selection, hit IDs given
+    // for all planes (-1 if no hit selected)
 
-      int firstHitMissed = 0;
-      int firstTrackSlope = 0;
-     
-      // If beam constraint used: assume the track should go along
-      // beam direction, otherwise beam is assumed to be perpendicular
-      // to the sensor plane
+    // Tracks found by each search, only filled for the cross-check
+    // of the branch-and-bound search
+
+    std::vector<std::pair<double, std::vector<int> > > branchAndBoundTracks;
+    std::vector<std::pair<double, std::vector<int> > > exhaustiveTracks;
+    std::vector<std::pair<double, std::vector<int> > > * checkedTracks = 0;
+    bool storeTracks = true;
+
+    auto storeFittedTrack = [&](double trackChi2, double penalty, int nChoiceFired, std::vector<int> const & choiceHits)
+    {
+        if(checkedTracks) checkedTracks->push_back( make_pair( trackChi2, choiceHits ));
+        if(!storeTracks) return;
+
+        fittedChi2.insert( make_pair( trackChi2, nFittedTracks ));
+
+        fittedPenalty.push_back(penalty); 
+        fittedFired.push_back(nChoiceFired);
+
+        for(int ipl=0;ipl<_nTelPlanes;ipl++)  
+        {
+            int jhit=choiceHits[ipl];
+
+            fittedHits.push_back(jhit);
+
+            fittedX.push_back(_fitX[ipl]);
+            fittedY.push_back(_fitY[ipl]);
+            fittedEx.push_back(_fitEx[ipl]);
+            fittedEy.push_back(_fitEy[ipl]);
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    stringstream iden;
+    iden << "pl" << _planeID[ipl] << "_";
+    string bname = iden.str();
+if(jhit>=0){
+      _aidaHistoMap1D[bname + "fitX"]->fill( _fitX[ipl]  );
+      _aidaHistoMap1D[bname + "fitY"]->fill( _fitY[ipl]  );
+      _aidaHistoMap1D[bname + "hitX"]->fill(  hitX[jhit] );
+      _aidaHistoMap1D[bname + "hitY"]->fill(  hitY[jhit] );
+      _aidaHistoMap1D[bname + "residualX"]->fill( _fitX[ipl] - hitX[jhit] );
+      _aidaHistoMap1D[bname + "residualY"]->fill( _fitY[ipl] - hitY[jhit] );
+      //Resids 
+      _aidaHistoMap2D[bname + "residualXdX"]->fill( _fitX[ipl]  , _fitX[ipl]    - hitX[jhit]  );
+      _aidaHistoMap2D[bname + "residualYdX"]->fill( _fitX[ipl]  , _fitY[ipl]    - hitY[jhit]  );
+      _aidaHistoMap2D[bname + "residualXdY"]->fill( _fitY[ipl]  , _fitX[ipl]    - hitX[jhit]  );
+      _aidaHistoMap2D[bname + "residualYdY"]->fill( _fitY[ipl]  , _fitY[ipl]    - hitY[jhit]  );
+ }
+ 
+#endif
+
+  
+        }
+
+        nFittedTracks++;
+    };
+
+    auto branchAndBoundSearch = [&]()
+    {
+      // Branch-and-bound search: hit selections are built plane by
+      // plane, in the same order as in the loop below (no hit first,
+      // then hits in reverse order). The chi2 of the hits selected so
+      // far is updated incrementally and is a lower limit for all
+      // selections starting with these hits. If it fails the chi2
+      // cuts, all of them are rejected at once. Full fits are only
+      // done when the selection could be accepted, so the fitted
+      // tracks are the same as for the exhaustive search.
 
       double expTrackSlopeX=0.;
       double expTrackSlopeY=0.;
- 
+
       if(_useBeamConstraint)
-	{
-	  expTrackSlopeX=_beamSlopeX;
-	  expTrackSlopeY=_beamSlopeY;
-	}
+      {
+        expTrackSlopeX=_beamSlopeX;
+        expTrackSlopeY=_beamSlopeY;
+      }
 
-      double lastSlopeX=0.;
-      double lastSlopeY=0.;
- 
-      // Fill position and error arrays for this hit configuration
+      // SingleFit neglects the beam slope in Y, its chi2 can then
+      // differ from the incremental one
 
-      for(int ipl=0;ipl<_nTelPlanes;ipl++)  
+      bool exactBound = !(_useNominalResolution && _useBeamConstraint && _beamSlopeY!=0.);
+
+      std::vector<TrackSearchNode> node(_nTelPlanes+1);
+      std::vector<PartialChi2Form> entryX(_nTelPlanes), entryY(_nTelPlanes);
+      std::vector<int> option(_nTelPlanes,-1);
+      std::vector<int> choiceHits(_nTelPlanes,-1);
+
+      int ipl=0;
+
+      while(ipl>=0)
       {
-         _planeX[ipl] = _planeY[ipl] = _planeEx[ipl] = _planeEy[ipl] = 0.;
+        // Next option for this plane, go back if all were checked
 
-        if(_isActive[ipl])  
+        if(++option[ipl] >= _planeChoice[ipl])
         {
-          int ihit   = (ichoice/_planeMod[ipl])%_planeChoice[ipl];
-        
+          option[ipl]=-1;
+          choiceHits[ipl]=-1;
+          ipl--;
+          continue;
+        }
+
+        TrackSearchNode & current = node[ipl+1];
+
+        // Scattering terms connecting this plane to the previous
+        // ones, same for all options
 
-          if(ihit<_planeHits[ipl])    
+        if(option[ipl]==0)
+        {
+          entryX[ipl]=node[ipl].formX;
+          entryY[ipl]=node[ipl].formY;
+
+          if(ipl>1)
           {
-            int jhit      = planeHitID[ipl].at(ihit);
-            
-            _planeX[ipl]  = hitX[jhit];
-            _planeY[ipl]  = hitY[jhit];
-            _planeEx[ipl] = (_useNominalResolution)?_planeResolution[ipl]:hitEx[jhit];
-            _planeEy[ipl] = (_useNominalResolution)?_planeResolution[ipl]:hitEy[jhit];
- 
- 
-	    // Calculate distance from expected position
-	    // starting from the second hit (when ifirst already set)
+            entryX[ipl].step(_planeScat[ipl-1], _planeDist[ipl-2], -(_planeDist[ipl-1]+_planeDist[ipl-2]), _planeDist[ipl-1], 0.);
+            entryY[ipl].step(_planeScat[ipl-1], _planeDist[ipl-2], -(_planeDist[ipl-1]+_planeDist[ipl-2]), _planeDist[ipl-1], 0.);
+          }
+          else if(ipl==1 && _useBeamConstraint)
+          {
+            entryX[ipl].step(_planeScat[0], 0., -_planeDist[0], _planeDist[0], -_beamSlopeX);
+            entryY[ipl].step(_planeScat[0], 0., -_planeDist[0], _planeDist[0], -_beamSlopeY);
+          }
+          else if(ipl==1)
+          {
+            entryX[ipl].step(0., 0., 0., 0., 0.);
+            entryY[ipl].step(0., 0., 0., 0., 0.);
+          }
+        }
 
-            if(_UseSlope && ifirst>=0 && firstHitMissed == 0)
-	      {
-              double expX = _planeX[ifirst] + expTrackSlopeX *(_planePosition[ipl]-_planePosition[ifirst]);
-              double expY = _planeY[ifirst] + expTrackSlopeY *(_planePosition[ipl]-_planePosition[ifirst]);
-              if(   abs( _planeX[ipl] - expX ) >  _SlopeDistanceMax/1000. 
-                 || abs( _planeY[ipl] - expY ) >  _SlopeDistanceMax/1000.  
-                   )  firstHitMissed = ipl;
+        current = node[ipl];
+        current.formX = entryX[ipl];
+        current.formY = entryY[ipl];
 
-	      }
+        if(option[ipl]==0)
+        {
+          // No hit selected in this plane
 
-	    // Calculate slope and check slope change w.r.t. previous slope
+          choiceHits[ipl]=-1;
 
-            if(_UseSlope && ifirst>=0 && firstTrackSlope==0  )
-	      {
-              double slopeX = (_planeX[ipl]-_planeX[ifirst])/
-                               (_planePosition[ipl]-_planePosition[ifirst]);
+          if(_isActive[ipl]) current.nMissing++;
+          if(_planeHits[ipl]>0) current.nSkipped++;
 
-              double slopeY = (_planeY[ipl]-_planeY[ifirst])/
-                               (_planePosition[ipl]-_planePosition[ifirst]);
+          if(current.nMissing > _allowMissingHits || current.nSkipped > _allowSkipHits) continue;
+        }
+        else
+        {
+          int jhit = planeHitID[ipl].at(_planeHits[ipl]-option[ipl]);
+          choiceHits[ipl]=jhit;
 
-              if(ilast>ifirst && 
-		 ( abs(slopeX - lastSlopeX) > _SlopeXLimit ||
-                   abs(slopeY - lastSlopeY) > _SlopeYLimit )
-		 ) firstTrackSlope=ipl;
+          // Preselection based on slope, as in the loop below
 
-              lastSlopeX=slopeX;
-              lastSlopeY=slopeY;
-	      }
+          if(_UseSlope && current.ifirst>=0)
+          {
+            int ifirst = current.ifirst;
+            double firstX = hitX[choiceHits[ifirst]];
+            double firstY = hitY[choiceHits[ifirst]];
 
-         
-            if(ifirst<0) 
-            {            
-              ifirst    = ipl;
-            }
-              
-            ilast = ipl;
-            nleft = 0;
-            nChoiceFired++;
-          } 
-          else 
+            double expX = firstX + expTrackSlopeX *(_planePosition[ipl]-_planePosition[ifirst]);
+            double expY = firstY + expTrackSlopeY *(_planePosition[ipl]-_planePosition[ifirst]);
+            if(   abs( hitX[jhit] - expX ) >  _SlopeDistanceMax/1000. 
+               || abs( hitY[jhit] - expY ) >  _SlopeDistanceMax/1000.  
+                 )  continue;
+
+            double slopeX = (hitX[jhit]-firstX)/
+                             (_planePosition[ipl]-_planePosition[ifirst]);
+
+            double slopeY = (hitY[jhit]-firstY)/
+                             (_planePosition[ipl]-_planePosition[ifirst]);
+
+            if(current.ilast>ifirst && 
+               ( abs(slopeX - current.lastSlopeX) > _SlopeXLimit ||
+                 abs(slopeY - current.lastSlopeY) > _SlopeYLimit )
+               ) continue;
+
+            current.lastSlopeX=slopeX;
+            current.lastSlopeY=slopeY;
+          }
+
+          if(current.ifirst<0) current.ifirst = ipl;
+          current.ilast = ipl;
+          current.nFired++;
+
+          // Positions are taken relative to the first selected hit,
+          // to avoid rounding errors in the quadratic form
+
+          double ex = (_useNominalResolution)?_planeResolution[ipl]:hitEx[jhit];
+          double ey = (_useNominalResolution)?_planeResolution[ipl]:hitEy[jhit];
+
+          if(ex>0.) current.formX.addMeasurement(hitX[jhit]-hitX[choiceHits[current.ifirst]], 1./ex/ex);
+          if(ey>0.) current.formY.addMeasurement(hitY[jhit]-hitY[choiceHits[current.ifirst]], 1./ey/ey);
+
+          int nChoiceFired = current.nFired;
+
+          // Same conditions for fitting the selection as below
+
+          bool checkChi2 = nChoiceFired>=2 &&
+            !( nChoiceFired==2 && !_useBeamConstraint && nChoiceFired + _allowMissingHits < _nActivePlanes );
+
+          if(checkChi2)
           {
-            nleft++;        // Counts number of planes with missing
-			    // hits after the last hit
+            bool accepted =
+              nChoiceFired + _allowMissingHits >= _nActivePlanes 
+              &&
+              nChoiceFired + _allowSkipHits    >= nFiredPlanes ;
+
+            double penalty = 
+              (_nActivePlanes-nFiredPlanes)*_missingHitPenalty
+              +   
+              (nFiredPlanes-nChoiceFired)*_skipHitPenalty ;
+
+            // The incremental chi2 agrees with the full fit only up to
+            // rounding, selections close to the cuts are fitted
+
+            double boundChi2 = current.formX.minimum() + current.formY.minimum();
+            double tolMax = 1.e-6*(1.+fabs(_chi2Max));
+            double tolMin = 1.e-6*(1.+fabs(_chi2Min));
+
+            bool aboveMax  = boundChi2 > _chi2Max + tolMax;
+            bool belowMin  = boundChi2 < _chi2Min - tolMin;
+            bool insideCut = boundChi2 < _chi2Max - tolMax && boundChi2 >= _chi2Min + tolMin;
+
+            bool doFit;
+
+            if(!exactBound)
+            {
+              // The incremental chi2 is not the one of the fit, only
+              // the fit can reject the selection, as in the exhaustive
+              // search
+              doFit = true;
+            }
+            else if(accepted)
+            {
+              doFit = !aboveMax || boundChi2+penalty < chi2min + 1.e-6*(1.+fabs(chi2min));
+            }
+            else
+            {
+              doFit = !(aboveMax || belowMin || insideCut);
+            }
+
+            bool reject = aboveMax || belowMin;
+
+            if(doFit)
+            {
+              reject = false;
+
+              for(int jpl=0;jpl<_nTelPlanes;jpl++)  
+              {
+                _planeX[jpl] = _planeY[jpl] = _planeEx[jpl] = _planeEy[jpl] = 0.;
+
+                if(choiceHits[jpl]>=0)
+                {
+                  int khit = choiceHits[jpl];
+
+                  _planeX[jpl]  = hitX[khit];
+                  _planeY[jpl]  = hitY[khit];
+                  _planeEx[jpl] = (_useNominalResolution)?_planeResolution[jpl]:hitEx[khit];
+                  _planeEy[jpl] = (_useNominalResolution)?_planeResolution[jpl]:hitEy[khit];
+                }
+              }
+
+              double choiceChi2 = fitChoice(nChoiceFired);
+
+              if(choiceChi2 < 0.)   {
+                streamlog_out ( WARNING2 ) << "Fit to " << nChoiceFired
+                                           << " planes failed for event " << event->getEventNumber()
+                                           << " in run " << event->getRunNumber()  << endl;
+              }
+              else
+              {
+                double trackChi2 = choiceChi2+penalty;
+
+                if(accepted && trackChi2 < chi2min) chi2min=trackChi2;
+
+                if( choiceChi2 >= _chi2Max  || choiceChi2 < _chi2Min ) 
+                {
+                  reject = true;
+                }
+                else if(accepted && trackChi2 < _chi2Max && trackChi2 > _chi2Min) 
+                {
+                  storeFittedTrack(trackChi2, penalty, nChoiceFired, choiceHits);
+                }
+              }
+            }
+
+            if(reject) continue;
           }
         }
-      }
-      // End of plane loop (decoding fit hypothesis)
 
+        // Continue with the next plane
 
-      // Check number of selected hits
-      // =============================
+        if(ipl+1<_nTelPlanes) ipl++;
+      }
+      // End of branch-and-bound search
+    };
 
-      // No fit to 1 hit :-)
+    auto exhaustiveSearch = [&]()
+    {
+      // Loop over fit possibilities
+      // Start from one-hit track to allow for "smart" skipping of wrong matches
 
-      if(nChoiceFired < 2) 
+      int istart=0;
+      int nmiss=_allowMissingHits;
+
+      while(nmiss>0 || !_isActive[istart])  
+      {
+        if(_isActive[istart]) 
         {
-           continue;
+          nmiss--;
         }
-      // Fit with 2 hits make sense only with beam constraint, or
-      // when 2 point fit is allowed
+        istart++;
+      }
+
+    
+      for(type_fitcount ichoice = nChoice-_planeMod[istart]-1; ichoice >= 0; ichoice--)  
+      {        
+        int    nChoiceFired =  0 ;
+        double choiceChi2   = -1.;
+        double trackChi2    = -1.;
+        int    ifirst       = -1 ;
+        int    ilast        =  0 ;
+        int    nleft        =  0 ;
+     
+        // New variables for preselection based on slope
+        // will be set to plane number if
+        //   - hit too far from the expected position (based on first
+        //             plane + beam slope): hit missed
+        //   - angle between track segments (slope change) too large:
+        //                  track slope
+        //
+        // Value >0 gives first layer which failed the cut
+        // 0 value means that preselection cuts were passed by all hits
+
+        int firstHitMissed = 0;
+        int firstTrackSlope = 0;
+     
+        // If beam constraint used: assume the track should go along
+        // beam direction, otherwise beam is assumed to be perpendicular
+        // to the sensor plane
+
+        double expTrackSlopeX=0.;
+        double expTrackSlopeY=0.;
+ 
+        if(_useBeamConstraint)
+  	{
+  	  expTrackSlopeX=_beamSlopeX;
+  	  expTrackSlopeY=_beamSlopeY;
+  	}
+
+        double lastSlopeX=0.;
+        double lastSlopeY=0.;
+ 
+        // Fill position and error arrays for this hit configuration
 
-      if(       nChoiceFired==2 
-                && !_useBeamConstraint
-                && nChoiceFired + _allowMissingHits < _nActivePlanes     ) 
+        for(int ipl=0;ipl<_nTelPlanes;ipl++)  
         {
-           continue;
+           _planeX[ipl] = _planeY[ipl] = _planeEx[ipl] = _planeEy[ipl] = 0.;
+
+          if(_isActive[ipl])  
+          {
+            int ihit   = (ichoice/_planeMod[ipl])%_planeChoice[ipl];
+        
+
+            if(ihit<_planeHits[ipl])    
+            {
+              int jhit      = planeHitID[ipl].at(ihit);
+            
+              _planeX[ipl]  = hitX[jhit];
+              _planeY[ipl]  = hitY[jhit];
+              _planeEx[ipl] = (_useNominalResolution)?_planeResolution[ipl]:hitEx[jhit];
+              _planeEy[ipl] = (_useNominalResolution)?_planeResolution[ipl]:hitEy[jhit];
+ 
+ 
+  	    // Calculate distance from expected position
+  	    // starting from the second hit (when ifirst already set)
+
+              if(_UseSlope && ifirst>=0 && firstHitMissed == 0)
+  	      {
+                double expX = _planeX[ifirst] + expTrackSlopeX *(_planePosition[ipl]-_planePosition[ifirst]);
+                double expY = _planeY[ifirst] + expTrackSlopeY *(_planePosition[ipl]-_planePosition[ifirst]);
+                if(   abs( _planeX[ipl] - expX ) >  _SlopeDistanceMax/1000. 
+                   || abs( _planeY[ipl] - expY ) >  _SlopeDistanceMax/1000.  
+                     )  firstHitMissed = ipl;
+
+  	      }
+
+  	    // Calculate slope and check slope change w.r.t. previous slope
+
+              if(_UseSlope && ifirst>=0 && firstTrackSlope==0  )
+  	      {
+                double slopeX = (_planeX[ipl]-_planeX[ifirst])/
+                                 (_planePosition[ipl]-_planePosition[ifirst]);
+
+                double slopeY = (_planeY[ipl]-_planeY[ifirst])/
+                                 (_planePosition[ipl]-_planePosition[ifirst]);
+
+                if(ilast>ifirst && 
+  		 ( abs(slopeX - lastSlopeX) > _SlopeXLimit ||
+                     abs(slopeY - lastSlopeY) > _SlopeYLimit )
+  		 ) firstTrackSlope=ipl;
+
+                lastSlopeX=slopeX;
+                lastSlopeY=slopeY;
+  	      }
+
+         
+              if(ifirst<0) 
+              {            
+                ifirst    = ipl;
+              }
+              
+              ilast = ipl;
+              nleft = 0;
+              nChoiceFired++;
+            } 
+            else 
+            {
+              nleft++;        // Counts number of planes with missing
+  			    // hits after the last hit
+            }
+          }
         }
+        // End of plane loop (decoding fit hypothesis)
+
+
+        // Check number of selected hits
+        // =============================
+
+        // No fit to 1 hit :-)
+
+        if(nChoiceFired < 2) 
+          {
+             continue;
+          }
+        // Fit with 2 hits make sense only with beam constraint, or
+        // when 2 point fit is allowed
+
+        if(       nChoiceFired==2 
+                  && !_useBeamConstraint
+                  && nChoiceFired + _allowMissingHits < _nActivePlanes     ) 
+          {
+             continue;
+          }
       
-      // Skip also if the fit can not be extended to proper number
-      // of planes; no need to check remaining planes !!!
+        // Skip also if the fit can not be extended to proper number
+        // of planes; no need to check remaining planes !!!
 
-        if(nChoiceFired + nleft < _nActivePlanes - _allowMissingHits ) {
-          ichoice-=_planeMod[ilast]-1;
-         continue;
-        }
+          if(nChoiceFired + nleft < _nActivePlanes - _allowMissingHits ) {
+            ichoice-=_planeMod[ilast]-1;
+           continue;
+          }
      
 
-      // Preselection added before full Chi2 calculation
-      //
-      // Cut on distance from expected position
+        // Preselection added before full Chi2 calculation
+        //
+        // Cut on distance from expected position
 
-	if(firstHitMissed>0){
-          ichoice-=_planeMod[firstHitMissed]-1;
-         continue;
-        }
+  	if(firstHitMissed>0){
+            ichoice-=_planeMod[firstHitMissed]-1;
+           continue;
+          }
      
-      // Cut on track slope changes
+        // Cut on track slope changes
 
-	if(firstTrackSlope>0){
-          ichoice-=_planeMod[firstTrackSlope]-1;
-         continue;
-        }
+  	if(firstTrackSlope>0){
+            ichoice-=_planeMod[firstTrackSlope]-1;
+           continue;
+          }
      
 
  
-      // Select fit method
-      // "Nominal" fit only if all active planes used
+        // Select fit method
+        // "Nominal" fit only if all active planes used
 
       
-      if(_useNominalResolution && (nChoiceFired == _nActivePlanes)) 
-      {
-        choiceChi2 = NominalFit();
-      } else {
-        if(_useNominalResolution && _beamSlopeX==_beamSlopeY) choiceChi2 = SingleFit();
-        else choiceChi2 = MatrixFit();
-      }
+        choiceChi2 = fitChoice(nChoiceFired);
 
 
-      // Fit failed ?
+        // Fit failed ?
 
-      if(choiceChi2 < 0.)   {
-        streamlog_out ( WARNING2 ) << "Fit to " << nChoiceFired
-                                   << " planes failed for event " << event->getEventNumber()
-                                   << " in run " << event->getRunNumber()  << endl;
+        if(choiceChi2 < 0.)   {
+          streamlog_out ( WARNING2 ) << "Fit to " << nChoiceFired
+                                     << " planes failed for event " << event->getEventNumber()
+                                     << " in run " << event->getRunNumber()  << endl;
 
-        continue ;
-      }
+          continue ;
+        }
 
-      // Penalty for missing or skiped hits
-      double penalty = 
-          (_nActivePlanes-nFiredPlanes)*_missingHitPenalty
-          +   
-          (nFiredPlanes-nChoiceFired)*_skipHitPenalty ;
+        // Penalty for missing or skiped hits
+        double penalty = 
+            (_nActivePlanes-nFiredPlanes)*_missingHitPenalty
+            +   
+            (nFiredPlanes-nChoiceFired)*_skipHitPenalty ;
 
 
-      trackChi2 = choiceChi2+penalty;
+        trackChi2 = choiceChi2+penalty;
 
-      if(
-              nChoiceFired + _allowMissingHits >= _nActivePlanes 
-              &&
-              nChoiceFired + _allowSkipHits    >= nFiredPlanes  
-              &&
-              trackChi2 < chi2min
-              ) 
-      {
-        chi2min=trackChi2;
-      }
+        if(
+                nChoiceFired + _allowMissingHits >= _nActivePlanes 
+                &&
+                nChoiceFired + _allowSkipHits    >= nFiredPlanes  
+                &&
+                trackChi2 < chi2min
+                ) 
+        {
+          chi2min=trackChi2;
+        }
 
-      // Check if better than chi2Max
-      // If not: skip also all track possibilities which include
-      // this hit selection !!!
+        // Check if better than chi2Max
+        // If not: skip also all track possibilities which include
+        // this hit selection !!!
 
-      if( choiceChi2 >= _chi2Max  || choiceChi2 < _chi2Min ) 
-      {        
-        ichoice-=_planeMod[ilast]-1;
-        continue;
-      } 
+        if( choiceChi2 >= _chi2Max  || choiceChi2 < _chi2Min ) 
+        {        
+          ichoice-=_planeMod[ilast]-1;
+          continue;
+        } 
+
+        //
+        // Skip fit if could not be accepted (too few planes fired)
+        //
+
+        if(
+                nChoiceFired + _allowMissingHits < _nActivePlanes 
+                ||
+                nChoiceFired + _allowSkipHits    < nFiredPlanes 
+                ) 
+        {
+          continue;
+        }
 
-      //
-      // Skip fit if could not be accepted (too few planes fired)
-      //
 
-      if(
-              nChoiceFired + _allowMissingHits < _nActivePlanes 
-              ||
-              nChoiceFired + _allowSkipHits    < nFiredPlanes 
-              ) 
-      {
-        continue;
-      }
+        // Fill all tracks passing chi2 cut
 
+        if( trackChi2 < _chi2Max && trackChi2 > _chi2Min ) 
+        {
 
-      // Fill all tracks passing chi2 cut
+          std::vector<int> choiceHits(_nTelPlanes,-1);
 
-      if( trackChi2 < _chi2Max && trackChi2 > _chi2Min ) 
-      {
+          for(int ipl=0;ipl<_nTelPlanes;ipl++)  
+          {
+              if(_isActive[ipl])  
+              {
+                  int ihit = (ichoice/_planeMod[ipl])%_planeChoice[ipl];
+                
+                  if(ihit<_planeHits[ipl])
+                  {
+                      choiceHits[ipl] = planeHitID[ipl].at(ihit);
+                  }
+              }
+          }
 
-        fittedChi2.insert( make_pair( trackChi2, nFittedTracks ));
+          storeFittedTrack(trackChi2, penalty, nChoiceFired, choiceHits);
 
-        fittedPenalty.push_back(penalty); 
-        fittedFired.push_back(nChoiceFired);
+        }  // end of track filling 
 
-        for(int ipl=0;ipl<_nTelPlanes;ipl++)  
-        {
-            int jhit=-1;
 
-            if(_isActive[ipl])  
-            {
-                int ihit = (ichoice/_planeMod[ipl])%_planeChoice[ipl];
-                
-                if(ihit<_planeHits[ipl])
-                {
-                    jhit = planeHitID[ipl].at(ihit);
-                }
-            }
 
-            fittedHits.push_back(jhit);
+      }
+      // End of loop over track possibilities
+    };
 
-            fittedX.push_back(_fitX[ipl]);
-            fittedY.push_back(_fitY[ipl]);
-            fittedEx.push_back(_fitEx[ipl]);
-            fittedEy.push_back(_fitEy[ipl]);
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-    stringstream iden;
-    iden << "pl" << _planeID[ipl] << "_";
-    string bname = iden.str();
-if(jhit>=0){
-      _aidaHistoMap1D[bname + "fitX"]->fill( _fitX[ipl]  );
-      _aidaHistoMap1D[bname + "fitY"]->fill( _fitY[ipl]  );
-      _aidaHistoMap1D[bname + "hitX"]->fill(  hitX[jhit] );
-      _aidaHistoMap1D[bname + "hitY"]->fill(  hitY[jhit] );
-      _aidaHistoMap1D[bname + "residualX"]->fill( _fitX[ipl] - hitX[jhit] );
-      _aidaHistoMap1D[bname + "residualY"]->fill( _fitY[ipl] - hitY[jhit] );
-      //Resids 
-      _aidaHistoMap2D[bname + "residualXdX"]->fill( _fitX[ipl]  , _fitX[ipl]    - hitX[jhit]  );
-      _aidaHistoMap2D[bname + "residualYdX"]->fill( _fitX[ipl]  , _fitY[ipl]    - hitY[jhit]  );
-      _aidaHistoMap2D[bname + "residualXdY"]->fill( _fitY[ipl]  , _fitX[ipl]    - hitX[jhit]  );
-      _aidaHistoMap2D[bname + "residualYdY"]->fill( _fitY[ipl]  , _fitY[ipl]    - hitY[jhit]  );
- }
- 
-#endif
+    if(_branchAndBoundSearch && _branchAndBoundCheck)
+    {
+      // Both searches on the same hits, only the tracks of the
+      // branch-and-bound search are stored
 
-  
-        }
+      double chi2minStart = chi2min;
 
-        nFittedTracks++;
+      checkedTracks = &branchAndBoundTracks;
+      branchAndBoundSearch();
+
+      double chi2minFound = chi2min;
+      chi2min = chi2minStart;
+      checkedTracks = &exhaustiveTracks;
+      storeTracks = false;
+      exhaustiveSearch();
+
+      checkedTracks = 0;
+      storeTracks = true;
 
-      }  // end of track filling 
+      // Compare the accepted tracks, independent of the order in
+      // which the hypotheses were visited. The smallest chi2 is not
+      // compared, the branch-and-bound search does not fit hypotheses
+      // which can not be accepted.
 
+      auto byHits = [](std::pair<double, std::vector<int> > const & a,
+                       std::pair<double, std::vector<int> > const & b) { return a.second < b.second; };
+      std::sort(branchAndBoundTracks.begin(), branchAndBoundTracks.end(), byHits);
+      std::sort(exhaustiveTracks.begin(), exhaustiveTracks.end(), byHits);
 
+      bool same = branchAndBoundTracks.size() == exhaustiveTracks.size();
 
+      for(size_t itrack = 0; same && itrack < exhaustiveTracks.size(); itrack++)
+      {
+        double chi2 = exhaustiveTracks[itrack].first;
+        same = branchAndBoundTracks[itrack].second == exhaustiveTracks[itrack].second
+          && fabs(branchAndBoundTracks[itrack].first - chi2) <= 1.e-6*(1.+fabs(chi2));
+      }
+
+      if(!same)
+      {
+        streamlog_out ( ERROR4 ) << "Branch-and-bound search found " << branchAndBoundTracks.size()
+                                 << " track(s), the exhaustive search " << exhaustiveTracks.size()
+                                 << " in event " << event->getEventNumber()
+                                 << " in run " << event->getRunNumber() << endl;
+        ++_noOfBranchAndBoundMismatch;
+      }
+      chi2min = chi2minFound;
+    }
+    else if(_branchAndBoundSearch)
+    {
+      branchAndBoundSearch();
+    }
+    else
+    {
+      exhaustiveSearch();
     }
-    // End of loop over track possibilities
 
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     (dynamic_cast<AIDA::IHistogram1D*> ( _aidaHistoMap[_firstChi2HistoName]))->fill(log10(chi2min));
@@ -2102,6 +2526,12 @@ void EUTelTestFitter::end(){
                            << "Total number of reconstructed tracks  " << setw(10) << setiosflags(ios::right) << _noOfTracks << resetiosflags(ios::right)
                            << endl;
 
+  if(_branchAndBoundSearch && _branchAndBoundCheck)
+  {
+    streamlog_out( MESSAGE5 ) << "Events with different branch-and-bound tracks: " << setw(10) << setiosflags(ios::right) << _noOfBranchAndBoundMismatch
+                              << resetiosflags(ios::right) << endl;
+  }
+
 
   // Clean memory
 
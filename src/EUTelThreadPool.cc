@@ -0,0 +1,106 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelThreadPool.h"
+
+using namespace eutelescope;
+
+EUTelThreadPool::EUTelThreadPool(unsigned nThreads):
+  _workers(),
+  _mutex(),
+  _wakeUp(),
+  _done(),
+  _task(nullptr),
+  _nTasks(0),
+  _nextTask(0),
+  _nActive(0),
+  _batch(0),
+  _stop(false),
+  _errors() {
+
+  if( nThreads == 0 ) nThreads = std::thread::hardware_concurrency();
+  //the calling thread is the first one
+  for( unsigned i = 1; i < nThreads; ++i ) {
+    _workers.push_back( std::thread( &EUTelThreadPool::workerLoop, this ) );
+  }
+}
+
+EUTelThreadPool::~EUTelThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _stop = true;
+  }
+  _wakeUp.notify_all();
+  for( auto & worker: _workers ) worker.join();
+}
+
+void EUTelThreadPool::run(size_t nTasks, std::function<void(size_t)> const & task) {
+  //nothing to share, avoid the synchronisation
+  if( _workers.empty() || nTasks < 2 ) {
+    for( size_t i = 0; i < nTasks; ++i ) task( i );
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _task = &task;
+    _nTasks = nTasks;
+    _nextTask = 0;
+    _errors.assign( nTasks, std::exception_ptr() );
+    ++_batch;
+  }
+  _wakeUp.notify_all();
+
+  work();
+
+  //all tasks are grabbed, wait for the workers still executing one
+  {
+    std::unique_lock<std::mutex> lock( _mutex );
+    _done.wait( lock, [this]() { return _nActive == 0; } );
+    _task = nullptr;
+  }
+
+  for( auto const & error: _errors ) {
+    if( error ) std::rethrow_exception( error );
+  }
+}
+
+void EUTelThreadPool::workerLoop() {
+  unsigned long lastBatch = 0;
+  for(;;) {
+    {
+      std::unique_lock<std::mutex> lock( _mutex );
+      _wakeUp.wait( lock, [this, lastBatch]() { return _stop || ( _task && _batch != lastBatch ); } );
+      if( _stop ) return;
+      lastBatch = _batch;
+      ++_nActive;
+    }
+
+    work();
+
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      --_nActive;
+    }
+    _done.notify_one();
+  }
+}
+
+void EUTelThreadPool::work() {
+  for(;;) {
+    size_t i = _nextTask++;
+    if( i >= _nTasks ) return;
+    try {
+      (*_task)( i );
+    } catch(...) {
+      _errors[i] = std::current_exception();
+    }
+  }
+}
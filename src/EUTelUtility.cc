@@ -33,58 +33,6 @@ namespace eutelescope {
 	} 
 
 
-	std::map<int, std::vector<int>> readNoisyPixelList(LCEvent* event, std::string const & noisyPixelCollectionName) {
-	
-		//Preapare pointer to hot pixel collection
-		LCCollectionVec* noisyPixelCollectionVec = nullptr;
-
-		//Try to obtain the collection
-		try {
-			noisyPixelCollectionVec = static_cast<LCCollectionVec*>( event->getCollection(noisyPixelCollectionName) );
-		} catch (...) {
-			if (!noisyPixelCollectionName.empty()) {
-				streamlog_out ( WARNING1 ) << "noisyPixelCollectionName " << noisyPixelCollectionName.c_str() << " not found" << std::endl;
-				streamlog_out ( WARNING1 ) << "READ CAREFULLY: This means that no noisy pixels will be removed, despite the processor successfully running!" << std::endl;
-			}
-			return std::map<int, std::vector<int>>();
-		}
-
-		//Decoder to get sensor ID
-		CellIDDecoder<TrackerDataImpl> cellDecoder( noisyPixelCollectionVec );
-		auto pixel = std::unique_ptr<EUTelBaseSparsePixel>(nullptr);
-		std::map<int, std::vector<int>> noisyPixelMap;
-		
-		//Loop over all hot pixels
-		for(int i=0; i<  noisyPixelCollectionVec->getNumberOfElements(); i++) {
-			//Get the TrackerData for the sensor ID
-			TrackerDataImpl* noisyPixelData = dynamic_cast< TrackerDataImpl *> ( noisyPixelCollectionVec->getElementAt( i ) );
-			int sensorID = cellDecoder( noisyPixelData )["sensorID"];
-			int pixelType = cellDecoder( noisyPixelData )["sparsePixelType"];
-			
-
-			//And get the corresponding noise vector for that plane
-			std::vector<int>* noiseSensorVector = &(noisyPixelMap[sensorID]);
-			std::unique_ptr<EUTelTrackerDataInterfacer> noisyPixelDataInterface;
-
-			if( pixelType == kEUTelGenericSparsePixel ) {
-				auto noisyPixelDataInterface = std::make_unique<EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>>(noisyPixelData);
-				auto& pixelVec = noisyPixelDataInterface->getPixels();
-
-				for( auto& pixel: pixelVec ) {
-					noiseSensorVector->push_back( cantorEncode(pixel.getXCoord(), pixel.getYCoord()) );
-				}
-			} else {
-				streamlog_out( ERROR5 ) << "The noisy pixel collection is corrupted, it does not contain the right pixel type. Something is wrong!" << std::endl;
-			}
-		}
-		for( std::map<int, std::vector<int> >::iterator it = noisyPixelMap.begin(); it != noisyPixelMap.end(); ++it) {
-			//Sort the noisy pixel maps
-			std::sort( (it->second).begin(), (it->second).end() );
-			streamlog_out( MESSAGE4) << "Read in " << (it->second).size() << " noisy pixels on plane " << (it->first) << std::endl;
-		}
-		return noisyPixelMap;
-	}
-
 	std::unique_ptr<EUTelTrackerDataInterfacer> getSparseData(IMPL::TrackerDataImpl* const data, int type) {
 		return getSparseData(data, static_cast<SparsePixelType>(type));
 	}
@@ -126,6 +74,9 @@ namespace eutelescope {
 			case kEUTelMuPixel:
 				return	std::unique_ptr<EUTelTrackerDataInterfacer>
 					( new EUTelTrackerDataInterfacerImpl<EUTelMuPixel>(data) );
+			case kEUTelPackedGenericPixel:
+				return	std::unique_ptr<EUTelTrackerDataInterfacer>
+					( new EUTelTrackerDataInterfacerImpl<EUTelGenericSparsePixel>(data, kEUTelPackedGenericPixel) );
 			default:
 				throw UnknownDataTypeException("Unknown sparsified pixel");
 		}
@@ -193,79 +144,6 @@ namespace eutelescope {
             streamlog_out( DEBUG ) << "FillNotExcludedPlanesIndices" << std::endl;
         }
         
-        bool HitContainsHotPixels( const IMPL::TrackerHitImpl* hit, const std::map<std::string, bool >& hotPixelMap ) {
-            bool skipHit = false;
-
-            try {
-                try {
-                    LCObjectVec clusterVector = hit->getRawHits();
-
-                    EUTelVirtualCluster * cluster = NULL;
-
-                    if (hit->getType() == kEUTelSparseClusterImpl) {
-
-                        TrackerDataImpl * clusterFrame = dynamic_cast<TrackerDataImpl*> (clusterVector[0]);
-                        if (clusterFrame == 0) {
-                            // found invalid result from cast
-                            throw UnknownDataTypeException("Invalid hit found in method hitContainsHotPixels()");
-                        }
-
-                        auto cluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(clusterFrame);
-                        int sensorID = cluster->getDetectorID();
-			auto& pixelVec = cluster->getPixels();
-
-			for( auto& m26Pixel: pixelVec ) {
-                                char ix[100];
-                                sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord());
-                                std::map < std::string, bool >::const_iterator z = hotPixelMap.find(ix);
-                                if (z != hotPixelMap.end() && hotPixelMap.at(ix) == true) {
-                                    skipHit = true;
-                                    streamlog_out(DEBUG3) << "Skipping hit as it was found in the hot pixel map." << std::endl;
-                                    break;
-//                                    delete cluster;
-//                                    return true; // if TRUE  this hit will be skipped
-                                } else {
-                                    skipHit = false;
-                                }
-                        }
-                    } else if (hit->getType() == kEUTelBrickedClusterImpl) {
-
-                        // fixed cluster implementation. Remember it
-                        //  can come from
-                        //  both RAW and ZS data
-
-                        cluster = new EUTelBrickedClusterImpl(static_cast<TrackerDataImpl *> (clusterVector[0]));
-                        delete cluster;
-                    } else if (hit->getType() == kEUTelDFFClusterImpl) {
-
-                        // fixed cluster implementation. Remember it can come from
-                        // both RAW and ZS data
-                        cluster = new EUTelDFFClusterImpl(static_cast<TrackerDataImpl *> (clusterVector[0]));
-                        delete cluster;
-                    } else if (hit->getType() == kEUTelFFClusterImpl) {
-
-                        // fixed cluster implementation. Remember it can come from
-                        // both RAW and ZS data
-                        cluster = new EUTelFFClusterImpl(static_cast<TrackerDataImpl *> (clusterVector[0]));
-                        delete cluster;
-                    }
-                    
-//                if ( cluster != 0 ) delete cluster;
-                    
-                } catch (lcio::Exception e) {
-                    // catch specific exceptions
-                    streamlog_out(ERROR) << "Exception occured in hitContainsHotPixels(): " << e.what() << std::endl;
-                }
-            } catch (...) {
-                // if anything went wrong in the above return FALSE, meaning do not skip this hit
-                return 0;
-            }
-
-            // if none of the above worked return FALSE, meaning do not skip this hit
-            return skipHit;
-
-        }
-        
         /**
          * Provides access to raw cluster information for given hit
          * Constructed object is owned by caller. Cluster must be destroyed by caller.
@@ -316,47 +194,6 @@ namespace eutelescope {
             return -1;
         }     
  
-        std::map<std::string, bool > FillHotPixelMap( EVENT::LCEvent *event, const std::string& hotPixelCollectionName ) {
-            
-            std::map < std::string, bool > hotPixelMap;
-            
-            LCCollectionVec *hotPixelCollectionVec = 0;
-            try {
-                hotPixelCollectionVec = static_cast<LCCollectionVec*> (event->getCollection(hotPixelCollectionName));
-            } catch (...) {
-                streamlog_out( MESSAGE4 ) << "hotPixelCollectionName " << hotPixelCollectionName.c_str() << " not found" << std::endl;
-                return hotPixelMap;
-            }
-
-            CellIDDecoder<TrackerDataImpl> cellDecoder(hotPixelCollectionVec);
-
-            for (int i = 0; i < hotPixelCollectionVec -> getNumberOfElements(); i++) {
-                TrackerDataImpl* hotPixelData = dynamic_cast<TrackerDataImpl*> (hotPixelCollectionVec->getElementAt(i));
-                SparsePixelType type = static_cast<SparsePixelType> (static_cast<int> (cellDecoder(hotPixelData)["sparsePixelType"]));
-
-                int sensorID = static_cast<int> (cellDecoder(hotPixelData)["sensorID"]);
-
-                if (type == kEUTelGenericSparsePixel) {
-                    auto m26Data = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(hotPixelData);
-                    auto& pixelVec = m26Data->getPixels();
-
-		    for( auto& m26Pixel: pixelVec ) {
-                        std::vector<int> m26ColVec();
-                        streamlog_out(DEBUG0) << "Size: " << m26Data->size() << " HotPixelInfo:  " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << m26Pixel.getSignal() << std::endl;
-                        try {
-                            char ix[100];
-                            sprintf(ix, "%d,%d,%d", sensorID, m26Pixel.getXCoord(), m26Pixel.getYCoord());
-                            hotPixelMap[ix] = true;
-                        } catch (...) {
-                            std::cout << "can not add pixel " << std::endl;
-                            std::cout << sensorID << " " << m26Pixel.getXCoord() << " " << m26Pixel.getYCoord() << " " << std::endl;
-                        }
-                    }
-                }
-            }
-            return hotPixelMap;
-        }
-
         /** Highland's formula for multiple scattering 
          * @param p momentum of the particle [GeV/c]
          * @param x thickness of the material in units of radiation lenght
@@ -21,6 +21,31 @@ Date: 2008-11-07
 using namespace TDS;
 using namespace std;
 
+namespace
+{
+  // Number of independent lanes of the blocked loop. The inner loop has this
+  // fixed trip count, so that it is vectorised also with the cheap cost model
+  // of -O2; __restrict is only relied on for function parameters
+  const unsigned long int kLanes = 4;
+
+  // bufferRow[k] += tableRow[k] * charge for k < rowLength
+  void addTableRow(double * __restrict bufferRow, const double * __restrict tableRow, const unsigned long int rowLength, const double charge)
+  {
+    unsigned long int k = 0;
+    for ( ; k + kLanes <= rowLength; k += kLanes )
+      {
+        for (unsigned long int lane = 0; lane < kLanes; lane++ )
+          {
+            bufferRow[k + lane] += tableRow[k + lane] * charge;
+          }
+      }
+    for ( ; k < rowLength; k++ )
+      {
+        bufferRow[k] += tableRow[k] * charge;
+      }
+  }
+}
+
 // Constructor
 TDSPixelsChargeMap::TDSPixelsChargeMap(const double length, const double width, const double height, const double firstPixelCornerCoordL, const double firstPixelCornerCoordW) :
   length(length), width(width), height(height), firstPixelCornerCoordL(firstPixelCornerCoordL), firstPixelCornerCoordW(firstPixelCornerCoordW)
@@ -42,6 +67,9 @@ TDSPixelsChargeMap::TDSPixelsChargeMap(const double length, const double width,
   // By default no integration storage is used
   useIntegrationStorage = false;
 
+  // By default charge sharing is integrated for each step
+  useChargeSharingTable = false;
+
   // Integration should be initialized by user
   isIntegrationInitialized = false;
 
@@ -156,6 +184,105 @@ void TDSPixelsChargeMap::setPointerToIntegrationStorage(TDSIntegrationStorage *
     }
 }
 
+// Table-driven charge sharing
+void TDSPixelsChargeMap::initializeChargeSharingTable(const unsigned int segmentsAlongL, const unsigned int segmentsAlongW, const unsigned int segmentsAlongH)
+{
+  if ( ( ! isPixelLengthSet ) || ( ! isPixelWidthSet ) )
+    {
+      cout << "Error: Pixels' dimensions are not set!" << endl;
+      exit (1);
+    }
+  if ( ! isIntegrationInitialized )
+    {
+      cout << "Error: Integration is not initialized!" << endl;
+      exit(1);
+    }
+  if ( segmentsAlongL == 0 || segmentsAlongW == 0 || segmentsAlongH == 0 )
+    {
+      cout << "Error: Number of pixel segments for the charge sharing table should be > 0!" << endl;
+      exit(1);
+    }
+  if ( segmentsAlongL > 2000 || segmentsAlongW > 2000 || segmentsAlongH > 1000 )
+    {
+      cout << "Too many pixel segments for the charge sharing table!" << endl;
+      exit(1);
+    }
+
+  tableSegmentsAlongL = segmentsAlongL;
+  tableSegmentsAlongW = segmentsAlongW;
+  tableSegmentsAlongH = segmentsAlongH;
+  buildChargeSharingTable();
+  useChargeSharingTable = true;
+}
+
+
+void TDSPixelsChargeMap::buildChargeSharingTable()
+{
+  const unsigned int nL = integMaxNumberPixelsAlongL;
+  const unsigned int nW = integMaxNumberPixelsAlongW;
+
+  chargeSharingTable.resize(tableSegmentsAlongL*tableSegmentsAlongW*tableSegmentsAlongH*nL*nW);
+  vector<double>::iterator entry = chargeSharingTable.begin();
+
+  // Result of integration and its error
+  double gsl_res, gsl_err;
+  double limitsLow[2];
+  double limitsUp[2];
+
+  for (unsigned int segmentL = 0; segmentL < tableSegmentsAlongL; segmentL++ )
+    {
+      // Point in the centre of the segment, relative to the corner of the core pixel
+      double pointL = (segmentL + 0.5) / tableSegmentsAlongL * pixelLength;
+      for (unsigned int segmentW = 0; segmentW < tableSegmentsAlongW; segmentW++ )
+        {
+          double pointW = (segmentW + 0.5) / tableSegmentsAlongW * pixelWidth;
+          for (unsigned int segmentH = 0; segmentH < tableSegmentsAlongH; segmentH++ )
+            {
+              theParamsOfFunChargeDistribution.H = - (segmentH + 0.5) / tableSegmentsAlongH * abs(height);
+              for (unsigned int pixelL = 0; pixelL < nL; pixelL++ )
+                {
+                  limitsLow[0] = (static_cast< double >(pixelL) - nL/2)*pixelLength - pointL;
+                  limitsUp[0]  = limitsLow[0] + pixelLength;
+                  for (unsigned int pixelW = 0; pixelW < nW; pixelW++ )
+                    {
+                      limitsLow[1] = (static_cast< double >(pixelW) - nW/2)*pixelWidth - pointW;
+                      limitsUp[1]  = limitsLow[1] + pixelWidth;
+                      gsl_monte_miser_integrate (&gsl_funToIntegrate, limitsLow, limitsUp, 2, gsl_calls, gsl_r, gsl_s, &gsl_res, &gsl_err);
+                      *entry++ = gsl_res;
+                    }
+                }
+            }
+        }
+    }
+
+  tableHeight = theParamsOfFunChargeDistribution.height;
+  tableGslCalls = gsl_calls;
+  tableLambda = theParamsOfFunChargeDistribution.lambda;
+  tableReflectedContribution = theParamsOfFunChargeDistribution.reflectedContribution;
+  tableAddReflectedContribution = theParamsOfFunChargeDistribution.addReflectedContribution;
+  tableDetectorType = theParamsOfFunChargeDistribution.detectorType;
+  tablePixelLength = pixelLength;
+  tablePixelWidth = pixelWidth;
+  tableMaxNumberPixelsAlongL = nL;
+  tableMaxNumberPixelsAlongW = nW;
+}
+
+
+bool TDSPixelsChargeMap::isChargeSharingTableValid() const
+{
+  return tableHeight == theParamsOfFunChargeDistribution.height
+    && tableGslCalls == gsl_calls
+    && tableLambda == theParamsOfFunChargeDistribution.lambda
+    && tableReflectedContribution == theParamsOfFunChargeDistribution.reflectedContribution
+    && tableAddReflectedContribution == theParamsOfFunChargeDistribution.addReflectedContribution
+    && tableDetectorType == theParamsOfFunChargeDistribution.detectorType
+    && tablePixelLength == pixelLength
+    && tablePixelWidth == pixelWidth
+    && tableMaxNumberPixelsAlongL == integMaxNumberPixelsAlongL
+    && tableMaxNumberPixelsAlongW == integMaxNumberPixelsAlongW;
+}
+
+
 // Maximal range of considered pixels during integration (integMaxNumberPixelsAlongL/2 down, the same up, integMaxNumberPixelsAlongW/2 left, the same right from the pixel under which there is the current point considered). Range can be smaller if the 'core' pixel is near to the layer border.
 void TDSPixelsChargeMap::setIntegMaxNumberPixelsAlongL(const unsigned int val)
 {
@@ -221,6 +348,12 @@ void TDSPixelsChargeMap::update(const TDSStep & step)
   double integChargePerStep = step.charge / integStepsNumber;
   if(debug>1) cout << "integChargePerStep= " << integChargePerStep << ";  integStep= " << integStep << endl;
 
+  if (useChargeSharingTable)
+    {
+      updateFromTable(step, integStepsNumber, integStep, integChargePerStep);
+      return;
+    }
+
 
   // Initialize position before integration loop (one integration point back)
   double currentPoint[3];
@@ -406,6 +539,115 @@ void TDSPixelsChargeMap::update(const TDSStep & step)
 }
 
 
+// Same as update, but the integrals are taken from the charge sharing table and
+// the contributions are summed in a dense buffer covering the pixels reachable
+// by the step, which is added to the map once
+void TDSPixelsChargeMap::updateFromTable(const TDSStep & step, const unsigned int integStepsNumber, const double integStep, const double integChargePerStep)
+{
+  if ( ! isChargeSharingTableValid() )
+    {
+      cout << "Charge distribution parameters changed, rebuilding charge sharing table" << endl;
+      buildChargeSharingTable();
+    }
+
+  const long int halfL = integMaxNumberPixelsAlongL / 2;
+  const long int halfW = integMaxNumberPixelsAlongW / 2;
+
+  // Pixels reachable from the first and the last integration points, one more on each side for rounding
+  double firstL = step.midL - step.dirL*(step.geomLength - integStep)/2.;
+  double lastL  = step.midL + step.dirL*(step.geomLength - integStep)/2.;
+  double firstW = step.midW - step.dirW*(step.geomLength - integStep)/2.;
+  double lastW  = step.midW + step.dirW*(step.geomLength - integStep)/2.;
+  double lowL  = floor((min(firstL,lastL)-firstPixelCornerCoordL)/pixelLength) - halfL - 1;
+  double highL = floor((max(firstL,lastL)-firstPixelCornerCoordL)/pixelLength) + halfL + 1;
+  double lowW  = floor((min(firstW,lastW)-firstPixelCornerCoordW)/pixelWidth) - halfW - 1;
+  double highW = floor((max(firstW,lastW)-firstPixelCornerCoordW)/pixelWidth) + halfW + 1;
+  long int bufLmin = static_cast< long int >( max(lowL, 0.) );
+  long int bufLmax = static_cast< long int >( min(highL, static_cast< double >(numberPixelsAlongL) - 1.) );
+  long int bufWmin = static_cast< long int >( max(lowW, 0.) );
+  long int bufWmax = static_cast< long int >( min(highW, static_cast< double >(numberPixelsAlongW) - 1.) );
+  unsigned long int bufLength = bufLmax >= bufLmin ? bufLmax - bufLmin + 1 : 0;
+  unsigned long int bufWidth  = bufWmax >= bufWmin ? bufWmax - bufWmin + 1 : 0;
+
+  stepBuffer.assign(bufLength*bufWidth, 0.);
+  stepBufferTouched.assign(bufLength*bufWidth, 0);
+
+  // Initialize position before integration loop (one integration point back)
+  double currentPoint[3];
+  currentPoint[0] = step.midL - step.dirL*(step.geomLength + integStep)/2.;
+  currentPoint[1] = step.midW - step.dirW*(step.geomLength + integStep)/2.;
+  currentPoint[2] = step.midH - step.dirH*(step.geomLength + integStep)/2.;
+
+  for (unsigned int is = 0; is < integStepsNumber ; is++ )
+    {
+      currentPoint[0] += step.dirL*integStep;
+      currentPoint[1] += step.dirW*integStep;
+      currentPoint[2] += step.dirH*integStep;
+
+      unsigned long int iL, iW;
+      iL = static_cast< unsigned long int >((currentPoint[0]-firstPixelCornerCoordL)/pixelLength);
+      iW = static_cast< unsigned long int >((currentPoint[1]-firstPixelCornerCoordW)/pixelWidth);
+      if ( iL >= numberPixelsAlongL  || iW >= numberPixelsAlongW )
+        {
+          cout << "Error: Core pixel (and step) outside the boundary of Length-Width plane!" << endl;
+          break;
+        }
+
+      if (currentPoint[2] > 0.)
+        {
+          cout << "Error: Point outside sensitive volume (Height > 0)!" << endl;
+          streamlog_out(ERROR4) << 
+                                  " currentPoint[0] " << currentPoint[0] <<
+                                  " currentPoint[1] " << currentPoint[1] <<
+                                  " currentPoint[2] " << currentPoint[2] <<
+                                    endl;
+          break;
+        }
+
+      // Pixel segment of the point, as for the integration storage
+      unsigned int segmentL = static_cast< unsigned int >( tableSegmentsAlongL * ((currentPoint[0]-firstPixelCornerCoordL-pixelLength*iL ) / pixelLength) );
+      unsigned int segmentW = static_cast< unsigned int >( tableSegmentsAlongW * ((currentPoint[1]-firstPixelCornerCoordW-pixelWidth *iW ) / pixelWidth ) );
+      unsigned int segmentH = static_cast< unsigned int >( tableSegmentsAlongH * (abs(currentPoint[2]) / abs(height) ) );
+      segmentL = min(segmentL, tableSegmentsAlongL - 1);
+      segmentW = min(segmentW, tableSegmentsAlongW - 1);
+      segmentH = min(segmentH, tableSegmentsAlongH - 1);
+
+      // Range of pixels, limited by the borders of the layer
+      long int imin = max(static_cast< long int >(iL) - halfL, 0L);
+      long int imax = min(static_cast< long int >(iL) + halfL, static_cast< long int >(numberPixelsAlongL) - 1);
+      long int jmin = max(static_cast< long int >(iW) - halfW, 0L);
+      long int jmax = min(static_cast< long int >(iW) + halfW, static_cast< long int >(numberPixelsAlongW) - 1);
+      const unsigned long int rowLength = jmax - jmin + 1;
+
+      const double * table = &chargeSharingTable[((segmentL*tableSegmentsAlongW + segmentW)*tableSegmentsAlongH + segmentH)*integMaxNumberPixelsAlongL*integMaxNumberPixelsAlongW];
+
+      for (long int i = imin ; i <= imax ; i++ )
+        {
+          const double * tableRow = table + (i - static_cast< long int >(iL) + halfL)*integMaxNumberPixelsAlongW + (jmin - static_cast< long int >(iW) + halfW);
+          double * bufferRow = &stepBuffer[(i - bufLmin)*bufWidth + (jmin - bufWmin)];
+
+          // Contiguous along W, the buffer and the table do not overlap
+          addTableRow(bufferRow, tableRow, rowLength, integChargePerStep);
+          std::fill_n(stepBufferTouched.begin() + (i - bufLmin)*bufWidth + (jmin - bufWmin), rowLength, 1);
+        }
+    }
+
+  // Add contribution to pixelsChargeMap, once per pixel of the step
+  for (unsigned long int l = 0; l < bufLength; l++ )
+    {
+      for (unsigned long int w = 0; w < bufWidth; w++ )
+        {
+          unsigned long int index = l*bufWidth + w;
+          if ( stepBufferTouched[index] )
+            {
+              type_PixelID pixID = getPixelID(bufLmin + l, bufWmin + w);
+              pixelsChargeMap[ pixID ] += stepBuffer[index];
+            }
+        }
+    }
+}
+
+
 void TDSPixelsChargeMap::print(string filename)
 {
   ofstream fout(filename.c_str());
@@ -794,7 +1036,7 @@ TDSPrecluster TDSPixelsChargeMap::getPrecluster(unsigned long int seedIndexAlong
   temp = thePrecluster.pixelW-rectWidth/2;
   temp < 0 ? wmin = 0 : wmin = temp;
   temp = thePrecluster.pixelW+rectWidth/2;
-  temp >= static_cast< long int >(numberPixelsAlongW) ? wmax = numberPixelsAlongL - 1 : wmax = temp;
+  temp >= static_cast< long int >(numberPixelsAlongW) ? wmax = numberPixelsAlongW - 1 : wmax = temp;
 
   thePrecluster.rectLmin = lmin;
   thePrecluster.rectLmax = lmax;
@@ -810,21 +1052,25 @@ TDSPrecluster TDSPixelsChargeMap::getPrecluster(unsigned long int seedIndexAlong
       
   for (l=lmin; l<=lmax; l++)
     {
-      for (w=wmin; w<=wmax; w++)
+      // Stored pixels of one row are consecutive in the map, sorted in w
+      type_PixelsChargeMap::iterator i = pixelsChargeMap.lower_bound(getPixelID(l,wmin));
+      type_PixelsChargeMap::iterator iEnd = pixelsChargeMap.upper_bound(getPixelID(l,wmax));
+      double coordL = getPixelCoordL(l);
+      while ( i != iEnd )
 	{
-	  if ( isPixelStored(l,w) )
-	    {
-	      tempCharge = getPixelCharge(l,w);
-	      preclusterCharge += tempCharge;
-	      tempL += tempCharge * getPixelCoordL(l);
-	      tempW += tempCharge * getPixelCoordW(w);
-	      
-	      // Fill vector of pixels
-	      thePrecluster.vectorOfPixels.push_back( TDSPixel( l, w, getPixelCoordL(l), getPixelCoordW(w), getPixelCharge(l,w) ) );
-
-	      if ( removePixels ) erasePixel(l,w);
-	      
-	    }
+	  w = i->first%tenTo10;
+	  tempCharge = i->second;
+	  preclusterCharge += tempCharge;
+	  tempL += tempCharge * coordL;
+	  tempW += tempCharge * getPixelCoordW(w);
+
+	  // Fill vector of pixels
+	  thePrecluster.vectorOfPixels.push_back( TDSPixel( l, w, coordL, getPixelCoordW(w), tempCharge ) );
+
+	  if ( removePixels )
+	    pixelsChargeMap.erase(i++);
+	  else
+	    ++i;
 	} // for w
     } // for l
 
@@ -314,7 +314,7 @@ void AlibavaBaseHistogramMaker::plotPedestalAndNoise(){
 			sp<< "Pedestal (chip "<<ichip<<");Channel Number;Pedestal (ADCs)";
 			pedestalHisto->SetTitle((sp.str()).c_str());
 			
-			FloatVec pedVec = getPedestalOfChip(ichip);
+			const FloatVec & pedVec = getPedestalOfChip(ichip);
 			
 			for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
 				// if channel is masked, do not fill histo
@@ -333,7 +333,7 @@ void AlibavaBaseHistogramMaker::plotPedestalAndNoise(){
 			sn<< "Noise (chip "<<ichip<<");Channel Number;Pedestal (ADCs)";
 			noiseHisto->SetTitle((sn.str()).c_str());
 			
-			FloatVec noiVec = getNoiseOfChip(ichip);
+			const FloatVec & noiVec = getNoiseOfChip(ichip);
 			for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
 				// if channel is masked, do not fill histo
 				if (isMasked(ichip,ichan)) continue;
@@ -116,7 +116,6 @@ void AlibavaBaseProcessor::setPedestals(){
 		streamlog_out(ERROR5)<< "No selected chips found! Couldn't set the pedestal, noise values!"<<endl;
 	
 	AlibavaPedNoiCalIOManager man;
-	EVENT::FloatVec vec_float;
 	
 	// for each selected chip get and save pedestal and noise values
 	for (unsigned int ichip=0; ichip<selectedchips.size(); ichip++) {
@@ -125,9 +124,7 @@ void AlibavaBaseProcessor::setPedestals(){
 		// if pedestalCollectionName set
 		if (getPedestalCollectionName()!= string(ALIBAVA::NOTSET)) {
 			// get pedestal for this chip
-			vec_float.clear();
-			vec_float = man.getPedNoiCalForChip(_pedestalFile,_pedestalCollectionName, chipnum);
-			_pedestalMap.insert(make_pair(chipnum, vec_float));
+			_pedestalMap[chipnum] = &man.getPedNoiCalViewForChip(_pedestalFile,_pedestalCollectionName, chipnum);
 		}else{
 			streamlog_out(DEBUG5)<< "The pedestal values for chip "<<chipnum<<" is not set, since pedestalCollectionName is not set!"<<endl;
 		}
@@ -135,9 +132,7 @@ void AlibavaBaseProcessor::setPedestals(){
 		// if noiseCollectionName set
 		if(getNoiseCollectionName()!= string(ALIBAVA::NOTSET)){
 			// get noise for this chip
-			vec_float.clear();
-			vec_float = man.getPedNoiCalForChip(_pedestalFile,_noiseCollectionName, chipnum);
-			_noiseMap.insert(make_pair(chipnum, vec_float));
+			_noiseMap[chipnum] = &man.getPedNoiCalViewForChip(_pedestalFile,_noiseCollectionName, chipnum);
 		}else{
 			streamlog_out(DEBUG5)<< "The noise values for chip "<<chipnum<<" is not set, since noiseCollectionName is not set!"<<endl;
 		}
@@ -155,7 +150,6 @@ void AlibavaBaseProcessor::checkPedestals(){
 	if(selectedchips.size()==0){
 		streamlog_out(ERROR5)<< "No selected chips found! Couldn't set the pedestal, noise values!"<<endl;
 	}
-	EVENT::FloatVec vec_float;
 	
 	// for each selected chip get and save pedestal and noise values
 	for (unsigned int ichip=0; ichip<selectedchips.size(); ichip++) {
@@ -163,9 +157,7 @@ void AlibavaBaseProcessor::checkPedestals(){
 		
 		if (getPedestalCollectionName()!= string(ALIBAVA::NOTSET)) {
 			// check pedestal values for this chip
-			vec_float.clear();
-			vec_float = _pedestalMap[chipnum];
-			if( int(vec_float.size()) != ALIBAVA::NOOFCHANNELS){
+			if( int(getPedestalOfChip(chipnum).size()) != ALIBAVA::NOOFCHANNELS){
 				streamlog_out(ERROR5)<< "The pedestal values for chip "<<chipnum<<" is not set properly!"<<endl;
 			}
 			else
@@ -173,9 +165,7 @@ void AlibavaBaseProcessor::checkPedestals(){
 		}
 		if(getNoiseCollectionName()!= string(ALIBAVA::NOTSET)){
 			// check noise values for this chip
-			vec_float.clear();
-			vec_float = _noiseMap[chipnum];
-			if( int(vec_float.size()) != ALIBAVA::NOOFCHANNELS){
+			if( int(getNoiseOfChip(chipnum).size()) != ALIBAVA::NOOFCHANNELS){
 				streamlog_out(ERROR5)<< "The noise values for chip "<<chipnum<<" is not set properly!"<<endl;
 			}
 			else
@@ -215,15 +205,14 @@ std::string AlibavaBaseProcessor::getPedestalCollectionName(){
 
 
 // to access the pedestal values of a chip
-EVENT::FloatVec AlibavaBaseProcessor::getPedestalOfChip(int chipnum){
-	return _pedestalMap[chipnum];
+const EVENT::FloatVec & AlibavaBaseProcessor::getPedestalOfChip(int chipnum){
+	return getValuesOfChip(_pedestalMap, chipnum);
 }
 
 // to access the pedestal value of a channel
 float AlibavaBaseProcessor::getPedestalAtChannel(int chipnum, int channum){
 	if (isPedestalValid()){
-		EVENT::FloatVec vec_float = getPedestalOfChip(chipnum);
-		return vec_float[channum];
+		return getPedestalOfChip(chipnum)[channum];
 	}
 	else {
 		streamlog_out(ERROR5)<< "The pedestal values for chip "<<chipnum<<" is not set properly!"<<endl;
@@ -247,14 +236,13 @@ std::string AlibavaBaseProcessor::getNoiseCollectionName(){
 }
 
 // to access the noise values of a chip
-EVENT::FloatVec AlibavaBaseProcessor::getNoiseOfChip(int chipnum){
-	return _noiseMap[chipnum];
+const EVENT::FloatVec & AlibavaBaseProcessor::getNoiseOfChip(int chipnum){
+	return getValuesOfChip(_noiseMap, chipnum);
 }
 // to access the noise value of a channel
 float AlibavaBaseProcessor::getNoiseAtChannel(int chipnum, int channum){
 	if (isNoiseValid()){
-		EVENT::FloatVec vec_float = getNoiseOfChip(chipnum);
-		return vec_float[channum];
+		return getNoiseOfChip(chipnum)[channum];
 	}
 	else {
 		//streamlog_out(ERROR5)<< "The noise values for chip "<<chipnum<<" is not set properly!"<<endl;
@@ -281,16 +269,13 @@ void AlibavaBaseProcessor::setCalibration(){
 		streamlog_out(ERROR5)<< "No selected chips found! Couldn't set calibration values!"<<endl;
 	
 	AlibavaPedNoiCalIOManager man;
-	EVENT::FloatVec vec_float;
 	
 	// for each selected chip get and save pedestal and noise values
 	for (unsigned int ichip=0; ichip<selectedchips.size(); ichip++) {
 		int chipnum = selectedchips[ichip];
 		
 		// get charge calibration for this chip
-		vec_float.clear();
-		vec_float = man.getPedNoiCalForChip(_calibrationFile,_chargeCalCollectionName, chipnum);
-		_chargeCalMap.insert(make_pair(chipnum, vec_float));
+		_chargeCalMap[chipnum] = &man.getPedNoiCalViewForChip(_calibrationFile,_chargeCalCollectionName, chipnum);
 		
 	}
 	checkCalibration();
@@ -306,16 +291,13 @@ void AlibavaBaseProcessor::checkCalibration(){
 		streamlog_out(ERROR5)<< "No selected chips found! Couldn't set calibration values!"<<endl;
 		_isCalibrationValid = false;
 	}
-	EVENT::FloatVec vec_float;
 	
 	// for each selected chip get and save pedestal and noise values
 	for (unsigned int ichip=0; ichip<selectedchips.size(); ichip++) {
 		int chipnum = selectedchips[ichip];
 		
 		// check pedestal values for this chip
-		vec_float.clear();
-		vec_float = _chargeCalMap[chipnum];
-		if( int(vec_float.size()) != ALIBAVA::NOOFCHANNELS){
+		if( int(getChargeCalOfChip(chipnum).size()) != ALIBAVA::NOOFCHANNELS){
 			streamlog_out(ERROR5)<< "The charge calibration values for chip "<<chipnum<<" is not set properly!"<<endl;
 			_isCalibrationValid = false;
 		}
@@ -335,14 +317,13 @@ std::string AlibavaBaseProcessor::getChargeCalCollectionName(){
 	return _chargeCalCollectionName;
 }
 // to access the charge calibration values of a chip
-EVENT::FloatVec AlibavaBaseProcessor::getChargeCalOfChip(int chipnum){
-	return _chargeCalMap[chipnum];
+const EVENT::FloatVec & AlibavaBaseProcessor::getChargeCalOfChip(int chipnum){
+	return getValuesOfChip(_chargeCalMap, chipnum);
 }
 // to access the charge calibration value of a channel
 float AlibavaBaseProcessor::getChargeCalAtChannel(int chipnum, int channum){
 	if (_isCalibrationValid){
-		EVENT::FloatVec vec_float = getChargeCalOfChip(chipnum);
-		return vec_float[channum];
+		return getChargeCalOfChip(chipnum)[channum];
 	}
 	else {
 		streamlog_out(ERROR5)<< "The noise values for chip "<<chipnum<<" is not set properly!"<<endl;
@@ -352,6 +333,14 @@ float AlibavaBaseProcessor::getChargeCalAtChannel(int chipnum, int channum){
 
 
 
+// returns the values of a chip in one of the maps, empty if there are none
+const EVENT::FloatVec & AlibavaBaseProcessor::getValuesOfChip(const map<int, const EVENT::FloatVec *> & valueMap, int chipnum) const{
+	static const EVENT::FloatVec noValues;
+	map<int, const EVENT::FloatVec *>::const_iterator it = valueMap.find(chipnum);
+	return it != valueMap.end() ? *(it->second) : noValues;
+}
+
+
 ///////////////////////////
 // Others
 ///////////////////////////
@@ -45,6 +45,7 @@
 #include "TProfile.h"
 
 // system includes <>
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <stdlib.h>
@@ -70,7 +71,14 @@ _etaHistoNameCSgt5("hEtaCSgt5"),
 _clusterSizeHistoName("hClusterSize"),
 _hitAmplitudeHistoName("hHitAmplitude"),
 _etaVSCoG("hEta_vs_CoG"),
-_etaVSClusterSize("hEta_vs_ClusterSize")
+_etaVSClusterSize("hEta_vs_ClusterSize"),
+_maskedEventsHisto(0),
+_etaHistos(),
+_etaHistosPerClusterSize(),
+_clusterSizeHistos(),
+_hitAmplitudeHistos(),
+_etaVSCoGHistos(),
+_etaVSClusterSizeHistos()
 {
 	
 	// modify processor description
@@ -251,6 +259,7 @@ void AlibavaClusterHistogramMaker::fillListOfHistos(){
 void AlibavaClusterHistogramMaker::bookHistos(){
 	// create histograms defined in HistoXMLFile
 	processHistoXMLFile();
+	resolveHistos();
 	
 	
 	// If you set _plotEvents or _plotXPercentOfEvents
@@ -286,8 +295,7 @@ void AlibavaClusterHistogramMaker::processEvent (LCEvent * anEvent) { // HERE lo
 		_numberOfSkippedEvents++;
 		
 		// Fill number of masked events histogram
-		TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[_maskedEventsHistoName]);
-		histo->Fill(eventnum);
+		_maskedEventsHisto->Fill(eventnum);
 		
 		return;
 	}
@@ -347,57 +355,51 @@ void AlibavaClusterHistogramMaker::fillHistos(TrackerDataImpl * trkdata ){
 	AlibavaCluster anAlibavaCluster(trkdata);
 	int ichip = anAlibavaCluster.getChipNum();
 	
-	TH1D * histo;
-	TProfile * profile;
-		
 	// Lets fill Hit Amplitude histogram
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_hitAmplitudeHistoName,ichip)]);
-	histo->Fill( _multiplySignalby * anAlibavaCluster.getTotalSignal());
+	_hitAmplitudeHistos.get(ichip)->Fill( _multiplySignalby * anAlibavaCluster.getTotalSignal());
 	
 	// Lets fill Cluster size histogram
 	int clusterSize = anAlibavaCluster.getClusterSize();
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_clusterSizeHistoName,ichip)]);
-	histo->Fill( clusterSize );
+	_clusterSizeHistos.get(ichip)->Fill( clusterSize );
 	
 	// Then fill eta histograms
 	float eta = anAlibavaCluster.getEta();
-	histo= dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoName,ichip)]);
-	histo->Fill(eta);
+	_etaHistos.get(ichip)->Fill(eta);
 
 	// center of gravity
 	float CoG = anAlibavaCluster.getCenterOfGravity();
-	profile = dynamic_cast<TProfile*> (_rootObjectMap[getHistoNameForChip(_etaVSCoG,ichip)]);
-	profile->Fill(CoG, eta);
+	_etaVSCoGHistos.get(ichip)->Fill(CoG, eta);
 
 	// center of gravity
-	profile = dynamic_cast<TProfile*> (_rootObjectMap[getHistoNameForChip(_etaVSClusterSize,ichip)]);
-	profile->Fill(clusterSize, eta);
+	_etaVSClusterSizeHistos.get(ichip)->Fill(clusterSize, eta);
 	
 	// Fill histos depending on their Cluster size
-
-	if (clusterSize == 2) {
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoNameCS2,ichip)]);
-		histo->Fill(eta);
-	}
-	else if (clusterSize == 3){
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoNameCS3,ichip)]);
-		histo->Fill(eta);
-	}
-	else if (clusterSize == 4){
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoNameCS4,ichip)]);
-		histo->Fill(eta);
-	}
-	else if (clusterSize == 5){
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoNameCS5,ichip)]);
-		histo->Fill(eta);
-	}
-	else if (clusterSize > 5){
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_etaHistoNameCSgt5,ichip)]);
-		histo->Fill(eta);
+	if (clusterSize >= 2) {
+		_etaHistosPerClusterSize.get(ichip, std::min(clusterSize, 6))->Fill(eta);
 	}
 	
 }
 
+void AlibavaClusterHistogramMaker::resolveHistos(){
+	_maskedEventsHisto = findRootObject<TH1D>(_maskedEventsHistoName);
+	
+	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		int ichip=chipSelection[i];
+		
+		_etaHistos.set(ichip, findRootObject<TH1D>(getHistoNameForChip(_etaHistoName,ichip)));
+		_etaHistosPerClusterSize.set(ichip, 2, findRootObject<TH1D>(getHistoNameForChip(_etaHistoNameCS2,ichip)));
+		_etaHistosPerClusterSize.set(ichip, 3, findRootObject<TH1D>(getHistoNameForChip(_etaHistoNameCS3,ichip)));
+		_etaHistosPerClusterSize.set(ichip, 4, findRootObject<TH1D>(getHistoNameForChip(_etaHistoNameCS4,ichip)));
+		_etaHistosPerClusterSize.set(ichip, 5, findRootObject<TH1D>(getHistoNameForChip(_etaHistoNameCS5,ichip)));
+		_etaHistosPerClusterSize.set(ichip, 6, findRootObject<TH1D>(getHistoNameForChip(_etaHistoNameCSgt5,ichip)));
+		_clusterSizeHistos.set(ichip, findRootObject<TH1D>(getHistoNameForChip(_clusterSizeHistoName,ichip)));
+		_hitAmplitudeHistos.set(ichip, findRootObject<TH1D>(getHistoNameForChip(_hitAmplitudeHistoName,ichip)));
+		_etaVSCoGHistos.set(ichip, findRootObject<TProfile>(getHistoNameForChip(_etaVSCoG,ichip)));
+		_etaVSClusterSizeHistos.set(ichip, findRootObject<TProfile>(getHistoNameForChip(_etaVSClusterSize,ichip)));
+	}
+}
+
 void AlibavaClusterHistogramMaker::check (LCEvent * /* evt */ ) {
 	// nothing to check here
 }
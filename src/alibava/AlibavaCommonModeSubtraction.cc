@@ -60,7 +60,9 @@ AlibavaCommonModeSubtraction::AlibavaCommonModeSubtraction () :
 AlibavaBaseProcessor("AlibavaCommonModeSubtraction"),
 _commonmodeCollectionName(ALIBAVA::NOTSET),
 _commonmodeerrorCollectionName(ALIBAVA::NOTSET),
-_chanDataHistoName ("Common_and_Pedestal_subtracted_data_channel")
+_chanDataHistoName ("Common_and_Pedestal_subtracted_data_channel"),
+_chanDataHistos(),
+_signalCorrectionHisto(0)
 {
 	
 	// modify processor description
@@ -258,13 +260,11 @@ void AlibavaCommonModeSubtraction::fillHistos(TrackerDataImpl * trkdata){
 	{
 		if ( isMasked(chipnum, ichan) ) continue;
 		
-		string tempHistoName = getChanDataHistoName(chipnum, ichan);
-		if ( TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]) )
+		if ( TH1D * histo = _chanDataHistos.get(chipnum, ichan) )
 			histo->Fill(datavec[ichan]);
 		
-		string tempHistoName1 = getSignalCorrectionName();
-		if ( TH1D * histo1 = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName1]) )
-			histo1->Fill(datavec[ichan]);
+		if ( _signalCorrectionHisto )
+			_signalCorrectionHisto->Fill(datavec[ichan]);
 	}
 
 }
@@ -292,7 +292,8 @@ void AlibavaCommonModeSubtraction::bookHistos(){
 
 	TH1D * signalHisto =
 	new TH1D (tempHistoName.c_str(),"",2000,-1000,1000);
-	_rootObjectMap.insert(make_pair(tempHistoName, signalHisto));
+	signalHisto = registerRootObject(tempHistoName, signalHisto);
+	_signalCorrectionHisto = signalHisto;
 	string tmp_string1 = tempHistoTitle1.str();
 	signalHisto->SetTitle(tmp_string1.c_str());
 
@@ -316,7 +317,8 @@ void AlibavaCommonModeSubtraction::bookHistos(){
 			
 			TH1D * chanDataHisto =
 			new TH1D (tempHistoName.c_str(),"",2000,-1000,1000);
-			_rootObjectMap.insert(make_pair(tempHistoName, chanDataHisto));
+			chanDataHisto = registerRootObject(tempHistoName, chanDataHisto);
+			_chanDataHistos.set(chipnum, ichan, chanDataHisto);
 			string tmp_string = tempHistoTitle.str();
 			chanDataHisto->SetTitle(tmp_string.c_str());
 		}
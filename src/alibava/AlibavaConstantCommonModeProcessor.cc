@@ -67,7 +67,9 @@ _NoiseDeviation(2.5),
 _commonmodeHistoName ("hcommonmode"),
 _commonmodeerrorHistoName ("hcommonmodeerror"),
 _commonmode(),
-_commonmodeerror()
+_commonmodeerror(),
+_commonCorrectionHisto(0),
+_commonCorrectionVsEventHisto(0)
 {
 	
 	// modify processor description
@@ -319,12 +321,11 @@ void AlibavaConstantCommonModeProcessor::fillHistos(TrackerDataImpl * trkdata, i
 	{
 		if ( isMasked(chipnum,ichan) ) continue;
 		
-		string tempHistoName = getCommonCorrectionName();
-		if ( TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]) )
-			histo->Fill(datavec[ichan]);
+		if ( _commonCorrectionHisto )
+			_commonCorrectionHisto->Fill(datavec[ichan]);
 		
-		if (TH2D * histo = dynamic_cast<TH2D*> (_rootObjectMap["Common Mode Correction Values over Events"]) )
-			histo->Fill(event,datavec[ichan]);
+		if ( _commonCorrectionVsEventHisto )
+			_commonCorrectionVsEventHisto->Fill(event,datavec[ichan]);
 		
 	}
 }
@@ -384,7 +385,8 @@ void AlibavaConstantCommonModeProcessor::bookHistos(){
 
 	TH1D * signalHisto =
 	new TH1D (tempHistoName.c_str(),"",1000,-500,500);
-	_rootObjectMap.insert(make_pair(tempHistoName, signalHisto));
+	signalHisto = registerRootObject(tempHistoName, signalHisto);
+	_commonCorrectionHisto = signalHisto;
 	string tmp_string = tempHistoTitle.str();
 	signalHisto->SetTitle(tmp_string.c_str());
 	
@@ -394,7 +396,8 @@ void AlibavaConstantCommonModeProcessor::bookHistos(){
 	tempHistoTitle2 << "Common Mode Correction Values over Events" << ";ADCs;NumberofEntries";
 
 	TH2D * signalHisto2 = new TH2D ("Common Mode Correction Values over Events","",5000,0,500000,1000,-500,500);
-	_rootObjectMap.insert(make_pair("Common Mode Correction Values over Events", signalHisto2));
+	signalHisto2 = registerRootObject("Common Mode Correction Values over Events", signalHisto2);
+	_commonCorrectionVsEventHisto = signalHisto2;
 	string tmp_string2 = tempHistoTitle2.str();
 	signalHisto2->SetTitle(tmp_string2.c_str());
 
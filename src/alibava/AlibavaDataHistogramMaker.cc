@@ -72,7 +72,20 @@ _timeHistoName("hTDCTime"),
 _timeVsEventNumHistoName("hTDCTime_vs_EventNum"),
 // Temperature
 _temperatureHistoName("hEventTemperatures"),
-_temperatureVsEventNumHistoName("hEventTemperature_vs_EventNum")
+_temperatureVsEventNumHistoName("hEventTemperature_vs_EventNum"),
+_maskedEventsHisto(0),
+_timeHisto(0),
+_timeVsEventNumHisto(0),
+_temperatureHisto(0),
+_temperatureVsEventNumHisto(0),
+_calChargeHisto(0),
+_delayHisto(0),
+_signalHistos(),
+_signalVsTimeHistos(),
+_signalVsTempHistos(),
+_snrHistos(),
+_snrVsTimeHistos(),
+_snrVsTempHistos()
 {
 	
 	// modify processor description
@@ -205,8 +218,6 @@ void AlibavaDataHistogramMaker::processRunHeader (LCRunHeader * rdr) {
 }
 
 void AlibavaDataHistogramMaker::processEvent (LCEvent * anEvent) {
-	TH1D * histo;
-	TProfile * profile;
 	
 	AlibavaEventImpl * alibavaEvent = static_cast<AlibavaEventImpl*> (anEvent);
 	int eventnum = alibavaEvent->getEventNumber();
@@ -215,8 +226,7 @@ void AlibavaDataHistogramMaker::processEvent (LCEvent * anEvent) {
 		_numberOfSkippedEvents++;
 
 		// Fill number of masked events histogram
-		histo = dynamic_cast<TH1D*> (_rootObjectMap[_maskedEventsHistoName]);
-		histo->Fill(eventnum);
+		_maskedEventsHisto->Fill(eventnum);
 
 		return;
 	}
@@ -228,28 +238,22 @@ void AlibavaDataHistogramMaker::processEvent (LCEvent * anEvent) {
 	// fill the histograms common for the event //
 
 	// TDC time
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[_timeHistoName]);
-	histo->Fill(tdctime);
+	_timeHisto->Fill(tdctime);
 
 	// TDC time vs EventNum
-	profile = dynamic_cast<TProfile*>(_rootObjectMap[_timeVsEventNumHistoName]);
-	profile->Fill(eventnum, tdctime);
+	_timeVsEventNumHisto->Fill(eventnum, tdctime);
 
 	// Temperature
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[_temperatureHistoName]);
-	histo->Fill(temperature);
+	_temperatureHisto->Fill(temperature);
 	
 	// Temperature vs EventNum
-	profile = dynamic_cast<TProfile*>(_rootObjectMap[_temperatureVsEventNumHistoName]);
-	profile->Fill(eventnum, temperature);
+	_temperatureVsEventNumHisto->Fill(eventnum, temperature);
 	
 	// Calibration charge values
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[_calChargeHistoName]);
-	histo->Fill(alibavaEvent->getCalCharge());
+	_calChargeHisto->Fill(alibavaEvent->getCalCharge());
 
 	// Calibration delay values
-	histo = dynamic_cast<TH1D*> (_rootObjectMap[_delayHistoName]);
-	histo->Fill(alibavaEvent->getCalDelay());
+	_delayHisto->Fill(alibavaEvent->getCalDelay());
 	
 	bool plotThisEvent = false;
 	if(isEventToBePlotted(eventnum)){
@@ -295,12 +299,35 @@ void AlibavaDataHistogramMaker::bookHistos(){
 			
 	// create histograms defined in HistoXMLFile
 	processHistoXMLFile();
+	resolveHistos();
 	
 	streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
 }
 
 
 
+void AlibavaDataHistogramMaker::resolveHistos(){
+	_maskedEventsHisto = findRootObject<TH1D>(_maskedEventsHistoName);
+	_timeHisto = findRootObject<TH1D>(_timeHistoName);
+	_timeVsEventNumHisto = findRootObject<TProfile>(_timeVsEventNumHistoName);
+	_temperatureHisto = findRootObject<TH1D>(_temperatureHistoName);
+	_temperatureVsEventNumHisto = findRootObject<TProfile>(_temperatureVsEventNumHistoName);
+	_calChargeHisto = findRootObject<TH1D>(_calChargeHistoName);
+	_delayHisto = findRootObject<TH1D>(_delayHistoName);
+	
+	EVENT::IntVec chipSelection = getChipSelection();
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		int ichip=chipSelection[i];
+		
+		_signalHistos.set(ichip, findRootObject<TH1D>(getHistoNameForChip(_signalHistoName,ichip)));
+		_signalVsTimeHistos.set(ichip, findRootObject<TH2D>(getHistoNameForChip(_signalVsTimeHistoName,ichip)));
+		_signalVsTempHistos.set(ichip, findRootObject<TH2D>(getHistoNameForChip(_signalVsTempHistoName,ichip)));
+		_snrHistos.set(ichip, findRootObject<TH1D>(getHistoNameForChip(_snrHistoName,ichip)));
+		_snrVsTimeHistos.set(ichip, findRootObject<TH2D>(getHistoNameForChip(_snrVsTimeHistoName,ichip)));
+		_snrVsTempHistos.set(ichip, findRootObject<TH2D>(getHistoNameForChip(_snrVsTempHistoName,ichip)));
+	}
+}
+
 void AlibavaDataHistogramMaker::fillListOfHistos(){
 	// Checks if all the histograms needed by this processor is defined in _histoXMLFileName
 	// Unfortunately histogram names are hard coded, so we are checking if all histo names exists in the _rootObjectMap
@@ -357,25 +384,24 @@ void AlibavaDataHistogramMaker::fillOtherHistos(TrackerDataImpl * trkdata, float
 	datavec = trkdata->getChargeValues();
 	int ichip = getChipNum(trkdata);
 	
-	FloatVec noiseVec;
-	if (isNoiseValid())
-		noiseVec= getNoiseOfChip(ichip);
+	// empty if the noise is not set
+	const FloatVec & noiseVec = getNoiseOfChip(ichip);
 	
-	TH1D * histoSignal = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_signalHistoName,ichip)]);
-	TH2D * histoSignalVsTime = dynamic_cast<TH2D*> (_rootObjectMap[getHistoNameForChip(_signalVsTimeHistoName,ichip)]);
-	TH2D * histoSignalVsTemp = dynamic_cast<TH2D*> (_rootObjectMap[getHistoNameForChip(_signalVsTempHistoName,ichip)]);
+	TH1D * histoSignal = _signalHistos.get(ichip);
+	TH2D * histoSignalVsTime = _signalVsTimeHistos.get(ichip);
+	TH2D * histoSignalVsTemp = _signalVsTempHistos.get(ichip);
 
 
-	TH1D * histoSNR = dynamic_cast<TH1D*> (_rootObjectMap[getHistoNameForChip(_snrHistoName,ichip)]);
-	TH2D * histoSNRVsTime = dynamic_cast<TH2D*> (_rootObjectMap[getHistoNameForChip(_snrVsTimeHistoName,ichip)]);
-	TH2D * histoSNRVsTemp = dynamic_cast<TH2D*> (_rootObjectMap[getHistoNameForChip(_snrVsTempHistoName,ichip)]);
+	TH1D * histoSNR = _snrHistos.get(ichip);
+	TH2D * histoSNRVsTime = _snrVsTimeHistos.get(ichip);
+	TH2D * histoSNRVsTemp = _snrVsTempHistos.get(ichip);
 	
 	for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
 		// if channel is masked, do not fill histo
 		if (isMasked(ichip,ichan)) continue;
 		
 		float data = _multiplySignalby*datavec[ichan];
-		float noise = noiseVec[ichan];
+		float noise = ichan < int(noiseVec.size()) ? noiseVec[ichan] : 0;
 		
 		histoSignal->Fill(data);
 		histoSignalVsTime->Fill(tdctime,data);
@@ -24,6 +24,8 @@
 #include <IMPL/TrackerDataImpl.h>
 
 // system includes <>
+#include <map>
+#include <mutex>
 #include <string>
 #include <sys/stat.h>
 
@@ -37,22 +39,6 @@ AlibavaPedNoiCalIOManager::AlibavaPedNoiCalIOManager(){
 AlibavaPedNoiCalIOManager::~AlibavaPedNoiCalIOManager(){
 }
 
-EVENT::FloatVec AlibavaPedNoiCalIOManager::getDataFromEventForChip(LCEvent* evt, string collectionName, unsigned int chipnum){
-	
-	EVENT::FloatVec tmp_vec;
-	tmp_vec.clear();
-	
-	LCCollectionVec* col = dynamic_cast< LCCollectionVec * > (evt->getCollection(collectionName)) ;
-	
-	int ielement = getElementNumberOfChip(col,chipnum);
-	if (ielement!=-1) {
-		TrackerDataImpl * trkdata = dynamic_cast< TrackerDataImpl * > ( col->getElementAt( ielement ) ) ;
-		tmp_vec = trkdata->getChargeValues();
-	}
-	
-	return tmp_vec;
-}
-
 int AlibavaPedNoiCalIOManager::getElementNumberOfChip(LCCollectionVec* col, int chipnum){
 	int ielement = -1;
 	CellIDDecoder<TrackerDataImpl> chipIDDecoder(col);
@@ -71,14 +57,35 @@ int AlibavaPedNoiCalIOManager::getElementNumberOfChip(LCCollectionVec* col, int
 }
 
 
-EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip(string filename, string collectionName, unsigned int chipnum){
+namespace {
+	// protects the file cache and the write buffer
+	std::mutex gCacheMutex;
+}
+
+map<string, AlibavaPedNoiCalIOManager::CachedFile> & AlibavaPedNoiCalIOManager::fileCache(){
+	static map<string, CachedFile> cache;
+	return cache;
+}
+
+map<string, AlibavaPedNoiCalIOManager::CollectionData> & AlibavaPedNoiCalIOManager::writeBuffer(){
+	static map<string, CollectionData> buffer;
+	return buffer;
+}
+
+AlibavaPedNoiCalIOManager::CachedFile & AlibavaPedNoiCalIOManager::getCachedFile(string filename){
+	CachedFile & cached = fileCache()[filename];
+	if (!cached.isRead) {
+		readFile(filename, cached.data);
+		cached.isRead = true;
+	}
+	return cached;
+}
+
+void AlibavaPedNoiCalIOManager::readFile(string filename, CollectionData & data){
 	
 	// open pedestal file
 	LCReader* lcReader = LCFactory::getInstance()->createLCReader() ;
 	
-	EVENT::FloatVec tmp_vec;
-	tmp_vec.clear();
-	
 	try{
 		lcReader->open( filename ) ;
 		
@@ -90,12 +97,19 @@ EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip(string filename,
 		
 		LCEvent*  evt = lcReader->readNextEvent();
 		
-		tmp_vec = getDataFromEventForChip(evt,collectionName,chipnum);
-		
-		// if datavec is empty
-		if (tmp_vec.size()==0)
-			streamlog_out( ERROR5 ) <<"Trying to access"<<collectionName<<" for non existing chip ("<<chipnum<<")."<< endl;
-		
+		// keep all the collections, when a chip appears twice the last one is used
+		const StringVec * colnames = evt ? evt->getCollectionNames() : 0;
+		for (unsigned int icol=0; colnames && icol<colnames->size(); icol++) {
+			LCCollectionVec* col = dynamic_cast< LCCollectionVec * > (evt->getCollection(colnames->at(icol)));
+			if (!col || col->getTypeName() != LCIO::TRACKERDATA) continue;
+			
+			CellIDDecoder<TrackerDataImpl> chipIDDecoder(col);
+			for (int i = 0; i < col->getNumberOfElements(); ++i) {
+				TrackerDataImpl * trkdata = dynamic_cast< TrackerDataImpl * > ( col->getElementAt( i ) ) ;
+				const int ichip = static_cast<int> ( chipIDDecoder( trkdata )[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] );
+				data[colnames->at(icol)][ichip] = trkdata->getChargeValues();
+			}
+		}
 		
 		lcReader->close() ;
 	}
@@ -104,8 +118,41 @@ EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip(string filename,
 	}
 	
 	//delete lcReader;
-	return tmp_vec;
+}
+
+EVENT::FloatVec AlibavaPedNoiCalIOManager::getPedNoiCalForChip(string filename, string collectionName, unsigned int chipnum){
+	return getPedNoiCalViewForChip(filename, collectionName, chipnum);
+}
+
+const EVENT::FloatVec & AlibavaPedNoiCalIOManager::getPedNoiCalViewForChip(string filename, string collectionName, unsigned int chipnum){
+	std::lock_guard<std::mutex> lock(gCacheMutex);
+	
+	// the entry is created if needed, so that the returned reference
+	// is filled in place if the values are added to the file later
+	EVENT::FloatVec & values = getCachedFile(filename).data[collectionName][chipnum];
 	
+	// if datavec is empty
+	if (values.size()==0)
+		streamlog_out( ERROR5 ) <<"Trying to access"<<collectionName<<" for non existing chip ("<<chipnum<<")."<< endl;
+	
+	return values;
+}
+
+void AlibavaPedNoiCalIOManager::addToBuffer(string filename, string collectionName, int chipnum, EVENT::FloatVec datavec){
+	std::lock_guard<std::mutex> lock(gCacheMutex);
+	writeBuffer()[filename][collectionName][chipnum] = datavec;
+}
+
+void AlibavaPedNoiCalIOManager::flush(string filename){
+	CollectionData data;
+	{
+		std::lock_guard<std::mutex> lock(gCacheMutex);
+		map<string, CollectionData>::iterator it = writeBuffer().find(filename);
+		if (it == writeBuffer().end()) return;
+		data.swap(it->second);
+		writeBuffer().erase(it);
+	}
+	addToFile(filename, data);
 }
 
 void AlibavaPedNoiCalIOManager::createFile(string filename, IMPL::LCRunHeaderImpl* runHeader){
@@ -123,12 +170,26 @@ void AlibavaPedNoiCalIOManager::createFile(string filename, IMPL::LCRunHeaderImp
 	lcWriter->writeRunHeader(runHeader);
 	
 	lcWriter->close();
+	
+	// the new file has no values, the existing views are emptied
+	std::lock_guard<std::mutex> lock(gCacheMutex);
+	CachedFile & cached = fileCache()[filename];
+	for (CollectionData::iterator icol = cached.data.begin(); icol != cached.data.end(); ++icol)
+		for (map<int, FloatVec>::iterator ichip = icol->second.begin(); ichip != icol->second.end(); ++ichip)
+			ichip->second.clear();
+	cached.isRead = true;
 }
 
 
 
 
 void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionName, int chipnum, EVENT::FloatVec datavec){
+	CollectionData data;
+	data[collectionName][chipnum] = datavec;
+	addToFile(filename, data);
+}
+
+void AlibavaPedNoiCalIOManager::addToFile( string filename, const CollectionData & data){
 
 	// if file doesn't exist
 	if (!doesFileExist(filename)) {
@@ -141,9 +202,6 @@ void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionNam
 	LCRunHeaderImpl* runHeader = getRunHeader(filename);
 	LCEventImpl*  evt = getEvent(filename);
 	
-	FloatVec tmp_vec;
-	tmp_vec.clear();
-		
 	LCWriter * lcWriter = LCFactory::getInstance()->createLCWriter();
 	// we will write a new lcio file with the copied run header and event
 	try {
@@ -152,47 +210,63 @@ void AlibavaPedNoiCalIOManager::addToFile( string filename, string collectionNam
 		// first write runheader
 		lcWriter->writeRunHeader(runHeader);
 		
-		// check if the collection exists
-		LCCollectionVec* newCol = new LCCollectionVec(LCIO::TRACKERDATA);
-
-
-		if (doesCollectionExist(evt,collectionName)){
-			LCCollectionVec* col = dynamic_cast < LCCollectionVec * > (evt->getCollection(collectionName));
-			*newCol = *col;
-			evt->removeCollection(collectionName);
-		}
-
-		// check if the data exists for this chip in this event
-		// if exists remove it
-		int ielement=0;
-		do {
-			ielement= getElementNumberOfChip(newCol,chipnum);
-			if (ielement!=-1)
-				newCol->removeElementAt(ielement);
-		} while (ielement!=-1);
-
+		// all the collections are updated in the event, then it is written once
+		for (CollectionData::const_iterator icol = data.begin(); icol != data.end(); ++icol) {
+			const string & collectionName = icol->first;
+			
+			// check if the collection exists
+			LCCollectionVec* newCol = new LCCollectionVec(LCIO::TRACKERDATA);
+			
+			if (doesCollectionExist(evt,collectionName)){
+				LCCollectionVec* col = dynamic_cast < LCCollectionVec * > (evt->getCollection(collectionName));
+				*newCol = *col;
+				evt->removeCollection(collectionName);
+			}
+			
+			// set Cell ID encode
+			CellIDEncoder<TrackerDataImpl> chipIDEncoder(ALIBAVA::ALIBAVADATA_ENCODE,newCol);
+			
+			for (map<int, FloatVec>::const_iterator ichip = icol->second.begin(); ichip != icol->second.end(); ++ichip) {
+				int chipnum = ichip->first;
 				
-		// now, add data vector to the collecton
-		TrackerDataImpl * tmp_data = new TrackerDataImpl();
-		tmp_data->setChargeValues(datavec);
-		
-		// set Cell ID encode
-		CellIDEncoder<TrackerDataImpl> chipIDEncoder(ALIBAVA::ALIBAVADATA_ENCODE,newCol);
-		
-		chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
-		chipIDEncoder.setCellID(tmp_data);
-
-		newCol->push_back(tmp_data);
-		evt->addCollection(newCol, collectionName);
+				// check if the data exists for this chip in this event
+				// if exists remove it
+				int ielement=0;
+				do {
+					ielement= getElementNumberOfChip(newCol,chipnum);
+					if (ielement!=-1)
+						newCol->removeElementAt(ielement);
+				} while (ielement!=-1);
+				
+				// now, add data vector to the collecton
+				TrackerDataImpl * tmp_data = new TrackerDataImpl();
+				tmp_data->setChargeValues(ichip->second);
+				
+				chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = chipnum;
+				chipIDEncoder.setCellID(tmp_data);
+				
+				newCol->push_back(tmp_data);
+			}
+			evt->addCollection(newCol, collectionName);
+		}
 		
 		lcWriter->writeEvent(evt);
 		lcWriter->close();
 	}
 	catch (IOException& e) {
 		cerr << e.what() << endl;
+		return;
 	}
 	//delete lcWriter;
 	
+	// keep the cache in sync, if the file was not read yet it will be on first access
+	std::lock_guard<std::mutex> lock(gCacheMutex);
+	map<string, CachedFile>::iterator it = fileCache().find(filename);
+	if (it != fileCache().end() && it->second.isRead) {
+		for (CollectionData::const_iterator icol = data.begin(); icol != data.end(); ++icol)
+			for (map<int, FloatVec>::const_iterator ichip = icol->second.begin(); ichip != icol->second.end(); ++ichip)
+				it->second.data[icol->first][ichip->first] = ichip->second;
+	}
 }
 
 bool AlibavaPedNoiCalIOManager::doesCollectionExist(LCEvent* evt, string collectionName){
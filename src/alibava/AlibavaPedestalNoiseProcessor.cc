@@ -13,6 +13,10 @@
 #include "ALIBAVA.h"
 #include "AlibavaPedNoiCalIOManager.h"
 
+// eutelescope includes ".h"
+#include "EUTelThreadPool.h"
+#include "EUTelExceptions.h"
+
 // marlin includes ".h"
 #include "marlin/Processor.h"
 #include "marlin/Exceptions.h"
@@ -45,6 +49,9 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 
 using namespace std;
@@ -52,6 +59,18 @@ using namespace lcio;
 using namespace marlin;
 using namespace alibava;
 
+namespace {
+	// range of the channel histograms, the truncated moments use the same unit wide bins
+	const int kAdcBins = 1000;
+	const double kAdcMin = 0.;
+	const double kAdcMax = 1000.;
+	
+	// the truncated moments keep the readings within this many noise values from the pedestal
+	const double kTruncation = 3.;
+	// maximum number of iterations of the truncated moments
+	const int kTruncationIterations = 20;
+}
+
 
 AlibavaPedestalNoiseProcessor::AlibavaPedestalNoiseProcessor () :
 AlibavaBaseProcessor("AlibavaPedestalNoiseProcessor"),
@@ -59,7 +78,17 @@ _pedestalHistoName ("hpedestal"),
 _noiseHistoName ("hnoise"),
 _temperatureHistoName("htemperature"),
 _chanDataHistoName ("Data_chan"),
-_chanDataFitName ("Fit_chan")
+_chanDataFitName ("Fit_chan"),
+_chanDataHistos(),
+_chanDataFits(),
+_pedestalHistos(),
+_noiseHistos(),
+_temperatureHisto(0),
+_pedestalNoiseMethod("Fit"),
+_nThreads(1),
+_adcCounts(),
+_adcSums(),
+_adcSquares()
 {
 	
 	// modify processor description
@@ -85,6 +114,14 @@ _chanDataFitName ("Fit_chan")
 										"Noise collection name, better not to change",
 										_noiseCollectionName, string ("noise"));
 
+	registerOptionalParameter ("PedestalNoiseMethod",
+										"How pedestal and noise are extracted from the readings of each channel: Fit (Gaussian fit of the channel histogram) or TruncatedMean (iterative 3 sigma truncated mean and RMS, computed in parallel)",
+										_pedestalNoiseMethod, string ("Fit"));
+	
+	registerOptionalParameter ("NumberOfThreads",
+										"Number of threads computing the TruncatedMean pedestal and noise, 1 is serial, 0 uses all cores",
+										_nThreads, static_cast<int>(1));
+
 }
 
 
@@ -115,6 +152,18 @@ void AlibavaPedestalNoiseProcessor::init () {
 	// this method is called only once even when the rewind is active
 	// usually a good idea to
 	printParameters ();
+	
+	if (_pedestalNoiseMethod != "Fit" && _pedestalNoiseMethod != "TruncatedMean")
+		throw eutelescope::InvalidParameterException("PedestalNoiseMethod has to be Fit or TruncatedMean, not " + _pedestalNoiseMethod);
+	if (_nThreads < 0)
+		throw eutelescope::InvalidParameterException("NumberOfThreads has to be positive or 0 for all cores");
+	
+	if (_pedestalNoiseMethod == "TruncatedMean") {
+		size_t noOfBins = static_cast<size_t>(ALIBAVA::NOOFCHIPS) * ALIBAVA::NOOFCHANNELS * kAdcBins;
+		_adcCounts.assign(noOfBins, 0);
+		_adcSums.assign(noOfBins, 0.);
+		_adcSquares.assign(noOfBins, 0.);
+	}
 
 }
 void AlibavaPedestalNoiseProcessor::processRunHeader (LCRunHeader * rdr) {
@@ -154,8 +203,7 @@ void AlibavaPedestalNoiseProcessor::processEvent (LCEvent * anEvent) {
 		noOfDetector = collectionVec->getNumberOfElements();
 		
 		// fill temperature histogram
-		TH1D * temperatureHisto = dynamic_cast<TH1D*> (_rootObjectMap[_temperatureHistoName]);
-		temperatureHisto->Fill(alibavaEvent->getEventTemp());
+		_temperatureHisto->Fill(alibavaEvent->getEventTemp());
 		
 		
 		for ( size_t i = 0; i < noOfDetector; ++i )
@@ -187,32 +235,55 @@ void AlibavaPedestalNoiseProcessor::end() {
 }
 
 void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
-	string tempHistoName,tempFitName;
-	TCanvas *cc = new TCanvas("cc","cc",800,600);
-	
 	EVENT::IntVec chipSelection = getChipSelection();
+	
+	// the channels to be computed, index is chip index * NOOFCHANNELS + channel
+	// the masked ones are left with pedestal and noise 0
+	std::vector<double> pedestals(chipSelection.size()*ALIBAVA::NOOFCHANNELS, 0.);
+	std::vector<double> noises(chipSelection.size()*ALIBAVA::NOOFCHANNELS, 0.);
+	std::vector<size_t> channels;
+	for (unsigned int i=0; i<chipSelection.size(); i++) {
+		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
+			if (!isMasked(chipSelection[i],ichan)) channels.push_back(i*ALIBAVA::NOOFCHANNELS + ichan);
+		}
+	}
+	
+	if (_pedestalNoiseMethod == "TruncatedMean") {
+		// the channels are independent and only read the accumulated readings
+		eutelescope::EUTelThreadPool threadPool(static_cast<unsigned>(_nThreads));
+		threadPool.run(channels.size(), [&](size_t itask){
+			size_t index = channels[itask];
+			calculateTruncatedMoments(chipSelection[index/ALIBAVA::NOOFCHANNELS], index%ALIBAVA::NOOFCHANNELS, pedestals[index], noises[index]);
+		});
+	}
+	else {
+		TCanvas *cc = new TCanvas("cc","cc",800,600);
+		for (size_t itask=0; itask<channels.size(); itask++) {
+			size_t index = channels[itask];
+			int ichip = chipSelection[index/ALIBAVA::NOOFCHANNELS];
+			int ichan = index%ALIBAVA::NOOFCHANNELS;
+			TH1D * histo = _chanDataHistos.get(ichip, ichan);
+			TF1 * tempfit = _chanDataFits.get(ichip, ichan);
+			histo->Fit(tempfit,"Q");
+			pedestals[index] = tempfit->GetParameter(1);
+			noises[index] = tempfit->GetParameter(2);
+		}
+		delete cc;
+	}
+	
+	// fill the histograms and write all the chips at once
+	AlibavaPedNoiCalIOManager man;
 	for (unsigned int i=0; i<chipSelection.size(); i++) {
 		unsigned int ichip=chipSelection[i];
 		
-		TH1D * hped = dynamic_cast<TH1D*> (_rootObjectMap[getPedestalHistoName(ichip)]);
-		TH1D * hnoi = dynamic_cast<TH1D*> (_rootObjectMap[getNoiseHistoName(ichip)]);
+		TH1D * hped = _pedestalHistos.get(ichip);
+		TH1D * hnoi = _noiseHistos.get(ichip);
 		EVENT::FloatVec pedestalVec,noiseVec;
 		
-		
 		for (int ichan=0; ichan<ALIBAVA::NOOFCHANNELS; ichan++) {
-			double ped, noi;
-			// if channel is masked, set pedestal and noise to 0
-			if (isMasked(ichip,ichan)){
-				ped=0; noi=0;
-			}
-			else {
-				tempFitName = getChanDataFitName(ichip, ichan);
-				tempHistoName = getChanDataHistoName(ichip, ichan);
-				TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]);
-				TF1 * tempfit = dynamic_cast<TF1*> (_rootObjectMap[tempFitName]);
-				histo->Fit(tempfit,"Q");
-				ped = tempfit->GetParameter(1);
-				noi = tempfit->GetParameter(2);
+			double ped = pedestals[i*ALIBAVA::NOOFCHANNELS + ichan];
+			double noi = noises[i*ALIBAVA::NOOFCHANNELS + ichan];
+			if (!isMasked(ichip,ichan)) {
 				hped->SetBinContent(ichan+1,ped);
 				hnoi->SetBinContent(ichan+1,noi);
 			}
@@ -220,11 +291,70 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise(){
 			noiseVec.push_back(noi);
 		}
 		
-		AlibavaPedNoiCalIOManager man;
-		man.addToFile(_pedestalFile,_pedestalCollectionName, ichip, pedestalVec);
-		man.addToFile(_pedestalFile,_noiseCollectionName, ichip, noiseVec);
+		man.addToBuffer(_pedestalFile, _pedestalCollectionName, ichip, pedestalVec);
+		man.addToBuffer(_pedestalFile, _noiseCollectionName, ichip, noiseVec);
+	}
+	
+	man.flush(_pedestalFile);
+}
+
+void AlibavaPedestalNoiseProcessor::accumulateReadings(TrackerDataImpl * trkdata){
+	const FloatVec & datavec = trkdata->getChargeValues();
+	int chipnum = getChipNum(trkdata);
+	if (chipnum < 0 || chipnum >= ALIBAVA::NOOFCHIPS) return;
+	
+	size_t noOfChannels = std::min(datavec.size(), static_cast<size_t>(ALIBAVA::NOOFCHANNELS));
+	for (size_t ichan=0; ichan<noOfChannels; ichan++) {
+		double value = datavec[ichan];
+		// same range as the channel histograms, the rest is ignored as by the fit
+		if (!(value >= kAdcMin && value < kAdcMax)) continue;
+		size_t bin = (static_cast<size_t>(chipnum)*ALIBAVA::NOOFCHANNELS + ichan)*kAdcBins + static_cast<size_t>(value - kAdcMin);
+		_adcCounts[bin]++;
+		_adcSums[bin] += value;
+		_adcSquares[bin] += value*value;
+	}
+}
+
+void AlibavaPedestalNoiseProcessor::calculateTruncatedMoments(int ichip, int ichan, double & pedestal, double & noise) const {
+	const size_t first = (static_cast<size_t>(ichip)*ALIBAVA::NOOFCHANNELS + ichan)*kAdcBins;
+	const unsigned int * counts = &_adcCounts[first];
+	const double * sums = &_adcSums[first];
+	const double * squares = &_adcSquares[first];
+	
+	// the RMS of a Gaussian truncated at +-k sigma is smaller than sigma by this factor
+	const double density = std::exp(-0.5*kTruncation*kTruncation)/std::sqrt(2.*M_PI);
+	const double truncationFactor = std::sqrt(1. - 2.*kTruncation*density/std::erf(kTruncation/std::sqrt(2.)));
+	
+	int binMin = 0;
+	int binMax = kAdcBins - 1;
+	pedestal = 0.;
+	noise = 0.;
+	for (int iteration=0; iteration<kTruncationIterations; iteration++) {
+		double n = 0., sum = 0., square = 0.;
+		for (int ibin=binMin; ibin<=binMax; ibin++) {
+			n += counts[ibin];
+			sum += sums[ibin];
+			square += squares[ibin];
+		}
+		if (n == 0.) return;
+		
+		pedestal = sum/n;
+		double variance = square/n - pedestal*pedestal;
+		noise = variance > 0. ? std::sqrt(variance) : 0.;
+		// the first pass uses all the readings
+		if (iteration > 0) noise /= truncationFactor;
+		
+		// keep the bins with their centre inside the window
+		int newBinMin = std::max(0, static_cast<int>(std::ceil(pedestal - kTruncation*noise - kAdcMin - 0.5)));
+		int newBinMax = std::min(kAdcBins - 1, static_cast<int>(std::floor(pedestal + kTruncation*noise - kAdcMin - 0.5)));
+		if (newBinMax < newBinMin) {
+			// all the readings in less than a bin, keep the one of the pedestal
+			newBinMin = newBinMax = std::min(kAdcBins - 1, std::max(0, static_cast<int>(pedestal - kAdcMin)));
+		}
+		if (newBinMin == binMin && newBinMax == binMax) break;
+		binMin = newBinMin;
+		binMax = newBinMax;
 	}
-	delete cc;
 }
 
 string AlibavaPedestalNoiseProcessor::getChanDataHistoName(unsigned int ichip, unsigned int ichan){
@@ -259,10 +389,11 @@ void AlibavaPedestalNoiseProcessor::fillHistos(TrackerDataImpl * trkdata){
 	for (size_t ichan=0; ichan<datavec.size();ichan++) {
 		if(isMasked(chipnum, ichan)) continue;
 		
-		string tempHistoName = getChanDataHistoName(chipnum, ichan);
-		if ( TH1D * histo = dynamic_cast<TH1D*> (_rootObjectMap[tempHistoName]) )
+		if ( TH1D * histo = _chanDataHistos.get(chipnum, ichan) )
 			histo->Fill(datavec[ichan]);
 	}
+	
+	if (_pedestalNoiseMethod == "TruncatedMean") accumulateReadings(trkdata);
 
 }
 
@@ -276,13 +407,14 @@ void AlibavaPedestalNoiseProcessor::bookHistos(){
 	
 	// temperature of event
 	TH1D * temperatureHisto = new TH1D(_temperatureHistoName.c_str(),"Temperature",1000,-50,50);
-	_rootObjectMap.insert(make_pair(_temperatureHistoName,temperatureHisto));
+	_temperatureHisto = registerRootObject(_temperatureHistoName, temperatureHisto);
 	
 	for (unsigned int i=0; i<chipSelection.size(); i++) {
 		unsigned int ichip=chipSelection[i];
 		
 		TH1D * pedestalHisto = new TH1D (getPedestalHistoName(ichip).c_str(),"",ALIBAVA::NOOFCHANNELS, -0.5, ALIBAVA::NOOFCHANNELS-0.5);
-		_rootObjectMap.insert(make_pair(getPedestalHistoName(ichip), pedestalHisto));
+		pedestalHisto = registerRootObject(getPedestalHistoName(ichip), pedestalHisto);
+		_pedestalHistos.set(ichip, pedestalHisto);
 
 		stringstream sp; //title string for pedestal histogram
 		sp<< "Pedestal (chip "<<ichip<<");Channel Number;Pedestal (ADCs)";
@@ -290,7 +422,8 @@ void AlibavaPedestalNoiseProcessor::bookHistos(){
 		
 		TH1D * noiseHisto = new TH1D (getNoiseHistoName(ichip).c_str(),"",ALIBAVA::NOOFCHANNELS, -0.5, ALIBAVA::NOOFCHANNELS-0.5);
 
-		_rootObjectMap.insert(make_pair(getNoiseHistoName(ichip),noiseHisto));
+		noiseHisto = registerRootObject(getNoiseHistoName(ichip), noiseHisto);
+		_noiseHistos.set(ichip, noiseHisto);
 		
 		stringstream sn; //title string for noise histogram
 		sn<< "Noise (chip "<<ichip<<");Channel Number;Pedestal (ADCs)";
@@ -318,12 +451,13 @@ void AlibavaPedestalNoiseProcessor::bookHistos(){
 			
 			TH1D * chanDataHisto =
 			new TH1D (tempHistoName.c_str(),"",1000,0,1000);
-			_rootObjectMap.insert(make_pair(tempHistoName, chanDataHisto));
+			chanDataHisto = registerRootObject(tempHistoName, chanDataHisto);
+			_chanDataHistos.set(ichip, ichan, chanDataHisto);
 			string tmp_string = tempHistoTitle.str();
 			chanDataHisto->SetTitle(tmp_string.c_str());
 			
 			TF1 *chanDataFit = new TF1(tempFitName.c_str(),"gaus");
-			_rootObjectMap.insert(make_pair(tempFitName, chanDataFit));
+			_chanDataFits.set(ichip, ichan, registerRootObject(tempFitName, chanDataFit));
 			
 			
 		}
@@ -172,7 +172,7 @@ void AlibavaPedestalSubtraction::processEvent (LCEvent * anEvent) {
 			FloatVec newdatavec;
 			newdatavec.clear();
 			
-			FloatVec pedVec = getPedestalOfChip(chipnum);
+			const FloatVec & pedVec = getPedestalOfChip(chipnum);
 			
 			// now subtract pedestal values from all channels
 			for (size_t ichan=0; ichan<datavec.size();ichan++) {
@@ -261,7 +261,7 @@ vector<AlibavaCluster> AlibavaSeedClustering::findClusters(TrackerDataImpl * trk
 	dataVec = trkdata->getChargeValues();
 	
 	// we will need noise vector too
-	FloatVec noiseVec = getNoiseOfChip(chipnum);
+	const FloatVec & noiseVec = getNoiseOfChip(chipnum);
 	
 	// then check which channels we can add to a cluster
 	// obviously not the ones masked
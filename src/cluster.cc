@@ -2,6 +2,8 @@
 
 #include "cluster.h"
 
+#include <cstring>
+
 using namespace std;
 
 Cluster aCluster;
@@ -12,36 +14,32 @@ Cluster::Cluster()
     y(0){
 } 
 
-bool Cluster::operator==(Cluster c2) {
-  int x1Min = *min_element(x.begin(), x.end());                       
-  int x2Min = *min_element(c2.x.begin(), c2.x.end());                 
-  int y1Min = *min_element(y.begin(), y.end());                       
-  int y2Min = *min_element(c2.y.begin(), c2.y.end());                 
-  if (size != c2.Size()) return false;                                
-  bool isEqual = false;                                               
-  for (int i=0; i<size; i++)                                          
-  {                                                                   
-    for (int j=0; j<size; j++)                                        
-    {                                                                 
-      if (x[i]-x1Min == c2.x[j]-x2Min && y[i]-y1Min == c2.y[j]-y2Min) 
-      {                                                               
-        isEqual = true;                                               
-        break;                                                        
-      }                                                               
-    }                                                                 
-    if (isEqual)                                                      
-    {                                                                 
-      isEqual = false;                                                
-      continue;                                                       
-    }                                                                 
-    else return false;                                                
-  }                                                                   
-  return true;                                                        
-}                                                                     
-
+bool Cluster::operator==(const Cluster &c2) const {
+  if (size != c2.Size()) return false;
+  return getShapeKey() == c2.getShapeKey();
+}
 
+Cluster::ShapeKey Cluster::getShapeKey() const {
+  if (size == 0) return ShapeKey();
+  int xMin = *min_element(x.begin(), x.begin()+size);
+  int xMax = *max_element(x.begin(), x.begin()+size);
+  int yMin = *min_element(y.begin(), y.begin()+size);
+  int yMax = *max_element(y.begin(), y.begin()+size);
+  int width  = xMax-xMin+1;
+  int height = yMax-yMin+1;
+  const size_t header = 2*sizeof(int);
+  ShapeKey key(header+(static_cast<size_t>(width)*height+7)/8, '\0');
+  memcpy(&key[0], &width, sizeof(int));
+  memcpy(&key[sizeof(int)], &height, sizeof(int));
+  for (int i=0; i<size; i++)
+  {
+    size_t bit = static_cast<size_t>(y[i]-yMin)*width + (x[i]-xMin);
+    key[header+bit/8] |= static_cast<char>(1 << (bit%8));
+  }
+  return key;
+}
 
-Cluster Cluster::mirrorX() {
+Cluster Cluster::mirrorX() const {
   vector<int> xNew(size);
   vector<int> yNew(size);
   int yMax = *max_element(y.begin(), y.end());
@@ -55,7 +53,7 @@ Cluster Cluster::mirrorX() {
   return clusterNew;
 }
 
-Cluster Cluster::mirrorY() {
+Cluster Cluster::mirrorY() const {
   vector<int> xNew(size);
   vector<int> yNew(size);
   int xMax = *max_element(x.begin(), x.end());
@@ -69,7 +67,7 @@ Cluster Cluster::mirrorY() {
   return clusterNew;
 }
 
-Cluster Cluster::rotate90(){
+Cluster Cluster::rotate90() const {
   vector<int> xNew(size);
   vector<int> yNew(size);
   for (int i=0; i<size; i++)
@@ -113,7 +111,7 @@ void Cluster::set_values (int s, vector<int> a, vector<int> b) {
       }
 }
 
-void Cluster::NeighbourPixels(int x, int y, vector<int> xOriginal, vector<int> yOriginal, vector<int> &xNeighbour, vector<int> &yNeighbour)
+void Cluster::NeighbourPixels(int x, int y, const vector<int> &xOriginal, const vector<int> &yOriginal, vector<int> &xNeighbour, vector<int> &yNeighbour)
 {
   int yTmp = 0;
   for (int xTmp=x-1; xTmp<=x+1; xTmp++)
@@ -163,6 +161,9 @@ void Cluster::NeighbourPixels(int x, int y, vector<int> xOriginal, vector<int> y
 
 void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
 {
+  // the shapes found so far are looked up by their key, the
+  // generation order and hence the shape IDs are unchanged
+  ShapeIndex shapeIndex = BuildShapeIndex(clusterVec);
   vector<int> xTmp(1);
   vector<int> yTmp(1);
   xTmp[0]=0;
@@ -170,46 +171,38 @@ void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
   Cluster cTmp;
   cTmp.set_values(1,xTmp,yTmp);
   clusterVec.push_back(cTmp);
+  shapeIndex.insert(make_pair(cTmp.getShapeKey(),clusterVec.size()-1));
+  size_t levelBegin = 0;
   for (int size=2; size<=sizeMax; size++)
   {
     cout << "Looking for clusters with size: " << size << endl;
-    int clusterVecSize = clusterVec.size();
-    for (int iCluster=0; iCluster<clusterVecSize; iCluster++)
+    // only the clusters found at the previous size can grow
+    size_t levelEnd = clusterVec.size();
+    for (size_t iCluster=levelBegin; iCluster<levelEnd; iCluster++)
     {
       if (clusterVec[iCluster].Size() < size-1) continue;
-      Cluster cluster; 
       vector<int> x = clusterVec[iCluster].getX();
       vector<int> y = clusterVec[iCluster].getY();
-      for (int iPixel=0; iPixel<clusterVec[iCluster].Size(); iPixel++)
+      int parentSize = clusterVec[iCluster].Size();
+      for (int iPixel=0; iPixel<parentSize; iPixel++)
       {
         vector<int> xNeighbour;
         vector<int> yNeighbour;
         NeighbourPixels(x[iPixel],y[iPixel],x,y,xNeighbour,yNeighbour);
         for (unsigned int i=0; i<xNeighbour.size();i++)
         {
-          bool areadyExists = false;
-          if (x.size() < (unsigned int)size) 
-          {
-            x.push_back(xNeighbour[i]);
-            y.push_back(yNeighbour[i]);
-          }
-          else
-          {
-            x[size-1] = xNeighbour[i];
-            y[size-1] = yNeighbour[i];
-          }
-          cluster.set_values(size,x,y);
-          for (unsigned int k=0; k<clusterVec.size(); k++)
-            if (cluster == clusterVec[k]) 
-            {
-              areadyExists = true; 
-              break;
-            }
-          if (!areadyExists)
+          vector<int> xNew(x);
+          vector<int> yNew(y);
+          xNew.push_back(xNeighbour[i]);
+          yNew.push_back(yNeighbour[i]);
+          Cluster cluster;
+          cluster.set_values(size,xNew,yNew);
+          if (shapeIndex.insert(make_pair(cluster.getShapeKey(),clusterVec.size())).second)
             clusterVec.push_back(cluster);
         }
       }
     }
+    levelBegin = levelEnd;
   }
   for (unsigned int iCluster = 0; iCluster<clusterVec.size();iCluster++)
   {
@@ -230,91 +223,59 @@ void Cluster::FindReferenceClusters(vector<Cluster> &clusterVec, int sizeMax)
   cout << "All shapes found!" << endl;
 }
 
-std::map<int,int> Cluster::SymmetryPairs(vector<Cluster> clusterVec, const char* type){
+Cluster::ShapeIndex Cluster::BuildShapeIndex(const vector<Cluster> &clusterVec)
+{
+  ShapeIndex shapeIndex;
+  shapeIndex.reserve(clusterVec.size());
+  // in case of duplicates the first shape wins, as in a linear search
+  for (unsigned int i=0; i<clusterVec.size(); i++)
+    shapeIndex.insert(make_pair(clusterVec[i].getShapeKey(),i));
+  return shapeIndex;
+}
+
+std::map<int,int> Cluster::SymmetryPairs(const vector<Cluster> &clusterVec, const char* type){
   std::map<int,int> pair;
-  const char* typeX = "x";
-  const char* typeY = "y";
-  if (type != typeX && type != typeY)   
+  string typeName(type);
+  if (typeName != "x" && typeName != "y")
   {
     cerr << "Type has to be y or x, assuming x" << endl;
-    type = "x";
+    typeName = "x";
   }
+  ShapeIndex shapeIndex = BuildShapeIndex(clusterVec);
+  // mirroring is an involution, every pair is stored once with the
+  // lower ID as key and self symmetric shapes are not stored
   for (unsigned int i=0; i<clusterVec.size(); i++)
   {
-    Cluster cluster;
-    if (type == typeX) cluster = clusterVec[i].mirrorX();
-    else if (type == typeY) cluster = clusterVec[i].mirrorY();
-    for (unsigned int j=0; j<clusterVec.size(); j++)
-    {
-      bool alreadyAdded = false;
-      for(map<int,int>::iterator it = pair.begin(); it != pair.end(); ++it)
-        if (it->first == (int)j)
-        {
-          alreadyAdded = true;
-          break;
-        }
-      if (alreadyAdded) continue;
-      if (cluster == clusterVec[j]) 
-      {
-        if (i == j) break;
-        pair.insert(make_pair(i,j));
-      }
-    }
+    Cluster cluster = (typeName == "x") ? clusterVec[i].mirrorX() : clusterVec[i].mirrorY();
+    ShapeIndex::const_iterator it = shapeIndex.find(cluster.getShapeKey());
+    if (it != shapeIndex.end() && it->second > (int)i)
+      pair.insert(make_pair(i,it->second));
   }
   return pair;
 }
 
-vector< vector<int> > Cluster::sameShape(vector<Cluster> clusterVec){
+vector< vector<int> > Cluster::sameShape(const vector<Cluster> &clusterVec){
   vector< vector<int> > symmetryGroups;
+  ShapeIndex shapeIndex = BuildShapeIndex(clusterVec);
+  vector<bool> alreadyAdded(clusterVec.size(),false);
   for (unsigned int i=0; i<clusterVec.size(); i++)
   {
+    if (alreadyAdded[i]) continue;
     vector<int> group;
-    Cluster clusterOriginal = clusterVec[i];
-    bool alreadyAdded = false;
-    for (unsigned int k=0; k<symmetryGroups.size(); k++)
-    {
-      for (unsigned int l=0; l<symmetryGroups[k].size(); l++)
-        if (symmetryGroups[k][l] == (int)i)
-        {
-          alreadyAdded = true;
-          break;
-        }
-      if (alreadyAdded) break;
-    }
-    if (alreadyAdded) continue;
-    else group.push_back(i);
-    Cluster cluster2;
+    group.push_back(i);
+    alreadyAdded[i] = true;
+    // the group is the orbit of the shape under rotations and mirroring
     for (int mir=0; mir<2; mir++)
     {
-      if (mir == 0)  cluster2 = clusterOriginal;
-      else  cluster2 = clusterOriginal.mirrorX();
+      Cluster cluster2 = (mir == 0) ? clusterVec[i] : clusterVec[i].mirrorX();
       for (int rot=0; rot<4; rot++)
       {
         cluster2 = cluster2.rotate90();
-        if (cluster2 == clusterOriginal) break;
-        for (unsigned int j=0; j<clusterVec.size(); j++)
+        ShapeIndex::const_iterator it = shapeIndex.find(cluster2.getShapeKey());
+        if (it != shapeIndex.end() && !alreadyAdded[it->second])
         {
-          if (clusterVec[j] == cluster2)
-          {
-            alreadyAdded = false;
-            for (unsigned int k=0; k<group.size(); k++)
-              if (group[k] == (int)j)
-              {
-                alreadyAdded = true;
-                break;
-              }
-            for (unsigned int k=0; k<symmetryGroups.size() && !alreadyAdded; k++)
-            {
-              for (unsigned int l=0; l<symmetryGroups[k].size(); l++)
-                if (symmetryGroups[k][l] == (int)j)
-                {
-                  alreadyAdded = true;
-                  break;
-                }
-              if (alreadyAdded) break;
-            }
-            if (!alreadyAdded) group.push_back(j);
-          }
+          group.push_back(it->second);
+          alreadyAdded[it->second] = true;
         }
       }
     }
@@ -325,10 +286,10 @@ vector< vector<int> > Cluster::sameShape(vector<Cluster> clusterVec){
 }
 
 
-int Cluster::WhichClusterShape(Cluster cluster, vector<Cluster> clusterVec)
+int Cluster::WhichClusterShape(const Cluster &cluster, const ShapeIndex &shapeIndex) const
 {
-  for (unsigned int iCluster=0; iCluster<clusterVec.size(); iCluster++)
-    if (cluster == clusterVec[iCluster]) return iCluster;
+  ShapeIndex::const_iterator it = shapeIndex.find(cluster.getShapeKey());
+  if (it != shapeIndex.end()) return it->second;
   return -1;
 }
 
@@ -0,0 +1,185 @@
+//STL
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelAssignmentSolver.h"
+#include "EUTelExceptions.h"
+
+using eutelescope::EUTelAssignmentSolver;
+
+// Compares the Hungarian assignment solver with the enumeration of all
+// the assignments on small random gated cost matrices.
+class assignmentSolverTest : public ::testing::Test {
+protected:
+
+	//the cost matrix of a problem, negative costs are forbidden pairs
+	struct Problem {
+		int noOfRows;
+		int noOfColumns;
+		std::vector<double> cost;
+	};
+
+	struct Solution {
+		int noOfAssigned;
+		double totalCost;
+	};
+
+	assignmentSolverTest(): noOfProblem(2000), maxSize(6) {}
+
+	//random problem, some pairs are forbidden, some costs are repeated
+	//so that several optimal assignments exist
+	Problem randomProblem(std::mt19937 & gen) const {
+		std::uniform_int_distribution<int> sizeDist(1, maxSize);
+		std::uniform_real_distribution<double> flat(0., 1.);
+		std::uniform_int_distribution<int> integerCost(0, 3);
+
+		Problem problem;
+		problem.noOfRows = sizeDist(gen);
+		problem.noOfColumns = sizeDist(gen);
+		double forbiddenFraction = flat(gen);
+		bool integerCosts = flat(gen) < 0.3;
+		for( int i = 0; i < problem.noOfRows*problem.noOfColumns; ++i ) {
+			if( flat(gen) < forbiddenFraction ) problem.cost.push_back(-1.);
+			else problem.cost.push_back(integerCosts ? integerCost(gen) : 10.*flat(gen));
+		}
+		return problem;
+	}
+
+	//the largest number of pairs, then the smallest total cost, from
+	//all the assignments of the remaining rows
+	static void enumerate(Problem const & problem, int row, std::vector<char> & columnUsed,
+	                      int noOfAssigned, double totalCost, Solution & best) {
+		if( row == problem.noOfRows ) {
+			if( noOfAssigned > best.noOfAssigned ||
+			    ( noOfAssigned == best.noOfAssigned && totalCost < best.totalCost ) ) {
+				best.noOfAssigned = noOfAssigned;
+				best.totalCost = totalCost;
+			}
+			return;
+		}
+		enumerate(problem, row + 1, columnUsed, noOfAssigned, totalCost, best);
+		for( int column = 0; column < problem.noOfColumns; ++column ) {
+			double cost = problem.cost[row*problem.noOfColumns + column];
+			if( columnUsed[column] || cost < 0. ) continue;
+			columnUsed[column] = 1;
+			enumerate(problem, row + 1, columnUsed, noOfAssigned + 1, totalCost + cost, best);
+			columnUsed[column] = 0;
+		}
+	}
+
+	static Solution bruteForce(Problem const & problem) {
+		Solution best = { 0, 0. };
+		std::vector<char> columnUsed(problem.noOfColumns, 0);
+		enumerate(problem, 0, columnUsed, 0, 0., best);
+		return best;
+	}
+
+	//the solver result has to be a valid assignment of allowed pairs
+	//with the optimal number of pairs and total cost
+	static void check(Problem const & problem, EUTelAssignmentSolver const & solver,
+	                  int noOfAssigned, int iProblem) {
+		Solution expected = bruteForce(problem);
+		EXPECT_EQ(expected.noOfAssigned, noOfAssigned) << "problem " << iProblem;
+		EXPECT_NEAR(expected.totalCost, solver.getTotalCost(), 1.e-9) << "problem " << iProblem;
+
+		int noOfPair = 0;
+		double totalCost = 0.;
+		for( int row = 0; row < problem.noOfRows; ++row ) {
+			int column = solver.getColumn(row);
+			if( column < 0 ) continue;
+			ASSERT_LT(column, problem.noOfColumns) << "problem " << iProblem;
+			EXPECT_EQ(row, solver.getRow(column)) << "problem " << iProblem;
+			double cost = problem.cost[row*problem.noOfColumns + column];
+			EXPECT_GE(cost, 0.) << "problem " << iProblem << " forbidden pair " << row << ", " << column;
+			++noOfPair;
+			totalCost += cost;
+		}
+		for( int column = 0; column < problem.noOfColumns; ++column ) {
+			int row = solver.getRow(column);
+			if( row >= 0 ) EXPECT_EQ(column, solver.getColumn(row)) << "problem " << iProblem;
+		}
+		EXPECT_EQ(noOfAssigned, noOfPair) << "problem " << iProblem;
+		EXPECT_NEAR(solver.getTotalCost(), totalCost, 1.e-9) << "problem " << iProblem;
+	}
+
+	int noOfProblem;
+	int maxSize;
+};
+
+TEST_F(assignmentSolverTest, randomProblems) {
+	//fixed seed, the test has to be reproducible
+	std::mt19937 gen(20161018);
+	EUTelAssignmentSolver solver;
+	for( int iProblem = 0; iProblem < noOfProblem; ++iProblem ) {
+		Problem problem = randomProblem(gen);
+		solver.reset(problem.noOfRows, problem.noOfColumns);
+		for( int row = 0; row < problem.noOfRows; ++row ) {
+			for( int column = 0; column < problem.noOfColumns; ++column ) {
+				double cost = problem.cost[row*problem.noOfColumns + column];
+				if( cost >= 0. ) solver.addCandidate(row, column, cost);
+			}
+		}
+		int noOfAssigned = solver.solve();
+		check(problem, solver, noOfAssigned, iProblem);
+	}
+}
+
+TEST_F(assignmentSolverTest, repeatedCandidates) {
+	//the same pair given more than once keeps its smallest cost
+	std::mt19937 gen(20161018);
+	std::uniform_real_distribution<double> flat(0., 1.);
+	EUTelAssignmentSolver solver;
+	for( int iProblem = 0; iProblem < noOfProblem/10; ++iProblem ) {
+		Problem problem = randomProblem(gen);
+		solver.reset(problem.noOfRows, problem.noOfColumns);
+		for( int row = 0; row < problem.noOfRows; ++row ) {
+			for( int column = 0; column < problem.noOfColumns; ++column ) {
+				double cost = problem.cost[row*problem.noOfColumns + column];
+				if( cost < 0. ) continue;
+				solver.addCandidate(row, column, cost + 5.*flat(gen));
+				solver.addCandidate(row, column, cost);
+				solver.addCandidate(row, column, cost + 5.*flat(gen));
+			}
+		}
+		int noOfAssigned = solver.solve();
+		check(problem, solver, noOfAssigned, iProblem);
+	}
+}
+
+TEST_F(assignmentSolverTest, morePairsBeatLowerCost) {
+	//the cheap pair 0-0 blocks the second pair, the optimum uses the
+	//two expensive pairs
+	EUTelAssignmentSolver solver;
+	solver.reset(2, 2);
+	solver.addCandidate(0, 0, 0.);
+	solver.addCandidate(0, 1, 100.);
+	solver.addCandidate(1, 0, 100.);
+	EXPECT_EQ(2, solver.solve());
+	EXPECT_EQ(1, solver.getColumn(0));
+	EXPECT_EQ(0, solver.getColumn(1));
+	EXPECT_DOUBLE_EQ(200., solver.getTotalCost());
+}
+
+TEST_F(assignmentSolverTest, noCandidate) {
+	EUTelAssignmentSolver solver;
+	solver.reset(3, 2);
+	EXPECT_EQ(0, solver.solve());
+	for( int row = 0; row < 3; ++row ) EXPECT_EQ(-1, solver.getColumn(row));
+	for( int column = 0; column < 2; ++column ) EXPECT_EQ(-1, solver.getRow(column));
+	EXPECT_EQ(0., solver.getTotalCost());
+}
+
+TEST_F(assignmentSolverTest, invalidCandidate) {
+	EUTelAssignmentSolver solver;
+	solver.reset(2, 3);
+	EXPECT_THROW(solver.addCandidate(2, 0, 1.), eutelescope::InvalidParameterException);
+	EXPECT_THROW(solver.addCandidate(0, 3, 1.), eutelescope::InvalidParameterException);
+	EXPECT_THROW(solver.addCandidate(-1, 0, 1.), eutelescope::InvalidParameterException);
+	EXPECT_THROW(solver.addCandidate(0, 0, -1.), eutelescope::InvalidParameterException);
+}
@@ -0,0 +1,132 @@
+//STL
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelCalibrationKernel.h"
+
+using eutelescope::EUTelCalibrationKernel;
+
+// Compares the array based calibration kernel with the iterator based
+// scalar loops of EUTelCalibrateEventProcessor on simulated frames.
+class calibrationKernelTest : public ::testing::Test {
+protected:
+
+	calibrationKernelTest():
+	rowLength(67), noOfRow(53), noOfPixel(rowLength*noOfRow),
+	hitRejectionCut(3.5), goodStatus(0), badStatus(1) {}
+
+	virtual void SetUp() {
+		//fixed seed, the test has to be reproducible
+		std::mt19937 gen(20161018);
+		std::normal_distribution<float> noiseDist(0., 1.);
+		std::uniform_real_distribution<float> flat(0., 1.);
+
+		adc.resize(noOfPixel);
+		pedestal.resize(noOfPixel);
+		noise.resize(noOfPixel);
+		status.resize(noOfPixel);
+
+		for( size_t i = 0; i < noOfPixel; ++i ) {
+			size_t row = i/rowLength;
+			pedestal[i] = 1000.f + 50.f*flat(gen);
+			noise[i] = 2.f + 2.f*flat(gen);
+			status[i] = flat(gen) < 0.02 ? badStatus : goodStatus;
+			float signal = noise[i]*noiseDist(gen) + 0.5f*row - 10.f;
+			//some hits, and a row full of them to be rejected
+			if( flat(gen) < 0.01 || row == 7 ) signal += 200.f*flat(gen) + 20.f*noise[i];
+			adc[i] = static_cast<short>( std::lround( pedestal[i] + signal ) );
+		}
+	}
+
+	//the scalar reduction, as in the processor
+	EUTelCalibrationKernel::Reduction scalarReduce(size_t begin, size_t end) const {
+		EUTelCalibrationKernel::Reduction result = { 0., 0, 0 };
+		for( size_t i = begin; i < end; ++i ) {
+			bool isHit = ( adc[i] - pedestal[i] ) > hitRejectionCut * noise[i];
+			bool isGood = ( status[i] == goodStatus );
+			if( !isHit && isGood ) {
+				result.sum += adc[i] - pedestal[i];
+				++result.goodPixel;
+			} else if( isHit ) {
+				++result.hitPixel;
+			}
+		}
+		return result;
+	}
+
+	size_t rowLength;
+	size_t noOfRow;
+	size_t noOfPixel;
+	float hitRejectionCut;
+	short goodStatus;
+	short badStatus;
+
+	std::vector<short> adc;
+	std::vector<float> pedestal;
+	std::vector<float> noise;
+	std::vector<short> status;
+};
+
+TEST_F(calibrationKernelTest, hitMask) {
+	EUTelCalibrationKernel kernel;
+	kernel.prepare(adc.data(), pedestal.data(), noise.data(), status.data(), noOfPixel, hitRejectionCut, goodStatus);
+
+	ASSERT_EQ(noOfPixel, kernel.getHitMask().size());
+	for( size_t i = 0; i < noOfPixel; ++i ) {
+		int isHit = ( adc[i] - pedestal[i] ) > hitRejectionCut * noise[i];
+		EXPECT_EQ(isHit, kernel.getHitMask()[i]) << "pixel " << i;
+		EXPECT_EQ(adc[i] - pedestal[i], kernel.getSignal()[i]) << "pixel " << i;
+	}
+}
+
+TEST_F(calibrationKernelTest, fullFrameCommonMode) {
+	EUTelCalibrationKernel kernel;
+	kernel.prepare(adc.data(), pedestal.data(), noise.data(), status.data(), noOfPixel, hitRejectionCut, goodStatus);
+
+	EUTelCalibrationKernel::Reduction scalar = scalarReduce(0, noOfPixel);
+	EUTelCalibrationKernel::Reduction frame = kernel.reduce(0, noOfPixel);
+
+	ASSERT_GT(scalar.goodPixel, 0);
+	EXPECT_EQ(scalar.goodPixel, frame.goodPixel);
+	EXPECT_EQ(scalar.hitPixel, frame.hitPixel);
+
+	double scalarCommonMode = scalar.sum / scalar.goodPixel;
+	double commonMode = frame.sum / frame.goodPixel;
+	EXPECT_NEAR(scalarCommonMode, commonMode, 1.e-4);
+
+	std::vector<float> output(noOfPixel);
+	kernel.apply(commonMode, 0, noOfPixel, output.data());
+	for( size_t i = 0; i < noOfPixel; ++i ) {
+		EXPECT_NEAR(adc[i] - pedestal[i] - scalarCommonMode, output[i], 1.e-3) << "pixel " << i;
+	}
+}
+
+TEST_F(calibrationKernelTest, rowWiseCommonMode) {
+	EUTelCalibrationKernel kernel;
+	kernel.prepare(adc.data(), pedestal.data(), noise.data(), status.data(), noOfPixel, hitRejectionCut, goodStatus);
+
+	std::vector<float> output(noOfPixel);
+	for( size_t begin = 0; begin < noOfPixel; begin += rowLength ) {
+		size_t end = begin + rowLength;
+		EUTelCalibrationKernel::Reduction scalar = scalarReduce(begin, end);
+		EUTelCalibrationKernel::Reduction row = kernel.reduce(begin, end);
+
+		EXPECT_EQ(scalar.goodPixel, row.goodPixel) << "row starting at " << begin;
+		EXPECT_EQ(scalar.hitPixel, row.hitPixel) << "row starting at " << begin;
+
+		double scalarCommonMode = scalar.goodPixel != 0 ? scalar.sum / scalar.goodPixel : 0.;
+		double commonMode = row.goodPixel != 0 ? row.sum / row.goodPixel : 0.;
+		EXPECT_NEAR(scalarCommonMode, commonMode, 1.e-4) << "row starting at " << begin;
+
+		kernel.apply(commonMode, begin, end, output.data());
+		for( size_t i = begin; i < end; ++i ) {
+			EXPECT_NEAR(adc[i] - pedestal[i] - scalarCommonMode, output[i], 1.e-3) << "pixel " << i;
+		}
+	}
+}
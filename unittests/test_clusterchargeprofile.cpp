@@ -0,0 +1,161 @@
+//STL
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//EUTelescope
+#include "EUTelClusterChargeProfile.h"
+
+using eutelescope::EUTelClusterChargeProfile;
+
+// Compares the partial sort and summed area table of the cluster charge
+// profile with a full sort and a plain window sum on random clusters.
+class clusterChargeProfileTest : public ::testing::Test {
+protected:
+
+	struct Pixel {
+		int x, y;
+		float signal;
+	};
+
+	clusterChargeProfileTest():
+	noOfCluster(300), maxNoOfPixel(40), clusterSpread(6),
+	sizes({ -3, -1, 0, 1, 2, 3, 4, 5, 7, 8, 11, 25 }) {}
+
+	virtual void SetUp() {
+		//fixed seed, the test has to be reproducible
+		std::mt19937 gen(20161018);
+		std::uniform_int_distribution<int> noOfPixelDist(1, maxNoOfPixel);
+		std::uniform_int_distribution<int> offset(-clusterSpread, clusterSpread);
+		std::uniform_int_distribution<int> position(0, 1000);
+		std::exponential_distribution<float> signalDist(0.05);
+
+		clusters.resize(noOfCluster);
+		for( auto & cluster: clusters ) {
+			int x0 = position(gen), y0 = position(gen);
+			int noOfPixel = noOfPixelDist(gen);
+			std::set<std::pair<int, int> > used;
+			while( static_cast<int>( cluster.size() ) < noOfPixel ) {
+				int x = x0 + offset(gen), y = y0 + offset(gen);
+				if( !used.insert(std::make_pair(x, y)).second ) continue;
+				Pixel pixel = { x, y, signalDist(gen) };
+				cluster.push_back(pixel);
+			}
+		}
+	}
+
+	static EUTelClusterChargeProfile makeProfile(std::vector<Pixel> const & cluster) {
+		EUTelClusterChargeProfile profile;
+		profile.reserve(cluster.size());
+		for( auto const & pixel: cluster ) profile.addPixel(pixel.x, pixel.y, pixel.signal);
+		return profile;
+	}
+
+	//the charge of the n highest pixels from a full sort
+	static double bruteHighestCharge(std::vector<Pixel> const & cluster, int n) {
+		std::vector<float> sorted;
+		for( auto const & pixel: cluster ) sorted.push_back(pixel.signal);
+		std::sort(sorted.begin(), sorted.end(), std::greater<float>());
+		double charge = 0.;
+		for( int i = 0; i < n && i < static_cast<int>( sorted.size() ); ++i ) charge += sorted[i];
+		return charge;
+	}
+
+	//the charge of the pixels up to size/2 away from the centre
+	static double bruteWindowCharge(std::vector<Pixel> const & cluster, int xCenter, int yCenter, int size) {
+		double charge = 0.;
+		for( auto const & pixel: cluster ) {
+			if( std::abs(pixel.x - xCenter) <= size/2 && std::abs(pixel.y - yCenter) <= size/2 ) charge += pixel.signal;
+		}
+		return charge;
+	}
+
+	void compareWindows(std::vector<Pixel> const & cluster, EUTelClusterChargeProfile const & profile,
+	                    int xCenter, int yCenter) const {
+		std::vector<float> charges = profile.getWindowCharges(xCenter, yCenter, sizes);
+		ASSERT_EQ(sizes.size(), charges.size());
+		for( size_t i = 0; i < sizes.size(); ++i ) {
+			double expected = bruteWindowCharge(cluster, xCenter, yCenter, sizes[i]);
+			EXPECT_NEAR(expected, charges[i], 1.e-5*(1. + expected))
+				<< "centre " << xCenter << ", " << yCenter << " size " << sizes[i];
+		}
+	}
+
+	int noOfCluster;
+	int maxNoOfPixel;
+	int clusterSpread;
+	std::vector<int> sizes;
+	std::vector<std::vector<Pixel> > clusters;
+};
+
+TEST_F(clusterChargeProfileTest, highestCharges) {
+	for( auto const & cluster: clusters ) {
+		EUTelClusterChargeProfile profile = makeProfile(cluster);
+		int noOfPixel = static_cast<int>( cluster.size() );
+
+		//n <= 0, every n up to the size and beyond it, in any order
+		std::vector<int> nPixels = { noOfPixel + 5, -2, 0, 1, 3 };
+		for( int n = noOfPixel; n >= 1; --n ) nPixels.push_back(n);
+		std::vector<float> charges = profile.getHighestCharges(nPixels);
+		ASSERT_EQ(nPixels.size(), charges.size());
+
+		for( size_t i = 0; i < nPixels.size(); ++i ) {
+			int n = nPixels[i];
+			if( n >= noOfPixel ) {
+				EXPECT_EQ(profile.getTotalCharge(), charges[i]) << "n " << n;
+			} else {
+				double expected = n > 0 ? bruteHighestCharge(cluster, n) : 0.;
+				EXPECT_NEAR(expected, charges[i], 1.e-5*(1. + expected)) << "n " << n;
+			}
+		}
+	}
+}
+
+TEST_F(clusterChargeProfileTest, windowCharges) {
+	for( auto const & cluster: clusters ) {
+		EUTelClusterChargeProfile profile = makeProfile(cluster);
+		for( auto const & pixel: cluster ) compareWindows(cluster, profile, pixel.x, pixel.y);
+	}
+}
+
+TEST_F(clusterChargeProfileTest, windowCrossingBoundingBox) {
+	//centres around and outside the bounding box, the windows are
+	//clipped or fully outside the cluster
+	for( auto const & cluster: clusters ) {
+		EUTelClusterChargeProfile profile = makeProfile(cluster);
+		int xCenter = cluster[0].x, yCenter = cluster[0].y;
+		for( int dx = -3*clusterSpread; dx <= 3*clusterSpread; dx += 3 ) {
+			for( int dy = -3*clusterSpread; dy <= 3*clusterSpread; dy += 3 ) {
+				compareWindows(cluster, profile, xCenter + dx, yCenter + dy);
+			}
+		}
+	}
+}
+
+TEST_F(clusterChargeProfileTest, addPixelAfterRequest) {
+	//the summed area table has to be rebuilt when a pixel is added
+	std::vector<Pixel> cluster = clusters[0];
+	EUTelClusterChargeProfile profile = makeProfile(cluster);
+	compareWindows(cluster, profile, cluster[0].x, cluster[0].y);
+
+	Pixel pixel = { cluster[0].x + clusterSpread + 1, cluster[0].y - clusterSpread - 1, 42.f };
+	cluster.push_back(pixel);
+	profile.addPixel(pixel.x, pixel.y, pixel.signal);
+	compareWindows(cluster, profile, cluster[0].x, cluster[0].y);
+	compareWindows(cluster, profile, pixel.x, pixel.y);
+}
+
+TEST_F(clusterChargeProfileTest, emptyCluster) {
+	EUTelClusterChargeProfile profile;
+	std::vector<int> nPixels = { -1, 0, 1, 5 };
+	for( float charge: profile.getHighestCharges(nPixels) ) EXPECT_EQ(0.f, charge);
+	for( float charge: profile.getWindowCharges(0, 0, sizes) ) EXPECT_EQ(0.f, charge);
+}
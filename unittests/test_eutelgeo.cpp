@@ -3,6 +3,8 @@
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <array>
+#include <vector>
 
 //Eigen
 #include <Eigen/Core>
@@ -280,4 +282,85 @@ TEST_F(eutelgeotestTest, radLengthTest1) {
 	std::cout << "Rad: " << eugeo::gGeometry().FindRad(begin3, end3) << std::endl;
 }
 
+/** The interpolated material budget has to agree with the ray tracing within
+ *  the deviations found when sampling the map, for random points and angles
+ *  inside the sampled range.
+ */
+TEST_F(eutelgeotestTest, materialBudgetMapTest) {
+	auto& geo = eugeo::gGeometry();
+	auto sensorIDVec = geo.sensorIDsVec();
+
+	eugeo::EUTelMaterialBudgetMap::Binning binning;
+	std::uniform_real_distribution<double> unit(0.0,1.0);
+
+	//ray traced values, before the map is initialised
+	std::vector<std::array<double,5> > queries;
+	for( int sensorID: sensorIDVec ) {
+		for( int i = 0; i < 10; ++i ) {
+			double x = (unit(generator)-0.5)*geo.siPlaneXSize(sensorID);
+			double y = (unit(generator)-0.5)*geo.siPlaneYSize(sensorID);
+			double theta = unit(generator)*binning.maxAngle;
+			double phi = unit(generator)*2*PI;
+			queries.push_back( {{ static_cast<double>(sensorID), x, y, theta, phi }} );
+		}
+	}
+	std::vector<double> traced;
+	for( auto const & q: queries ) {
+		Eigen::Vector3d dir(std::sin(q[3])*std::cos(q[4]), std::sin(q[3])*std::sin(q[4]), std::cos(q[3]));
+		traced.push_back( geo.planeRadLength(static_cast<int>(q[0]), q[1], q[2], dir) );
+	}
+
+	geo.initializeMaterialBudgetMap(binning);
+	auto materialBudgetMap = geo.materialBudgetMap();
+	ASSERT_TRUE( materialBudgetMap != nullptr );
+
+	for( size_t i = 0; i < queries.size(); ++i ) {
+		auto const & q = queries[i];
+		int sensorID = static_cast<int>(q[0]);
+		Eigen::Vector3d dir(std::sin(q[3])*std::cos(q[4]), std::sin(q[3])*std::sin(q[4]), std::cos(q[3]));
+		double tolerance = 2*materialBudgetMap->getMaxAbsoluteError(sensorID) + 1e-6;
+		EXPECT_NEAR( geo.planeRadLength(sensorID, q[1], q[2], dir), traced[i], tolerance );
+	}
+}
+
+/** A snapshot shares the TGeo geometry it was created from: after the
+ *  description rebuilt its geometry it has to give the same answers, and a
+ *  new snapshot has to agree with it.
+ */
+TEST_F(eutelgeotestTest, snapshotGeometryRebuild) {
+	auto& geo = eugeo::gGeometry();
+	auto snapshot = geo.createSnapshot();
+	auto sensorIDVec = snapshot->sensorIDsVec();
+
+	Eigen::Vector3d begin = {0,0,-5};
+	Eigen::Vector3d end = {0,0,5};
+	double rad = snapshot->findRad(begin, end);
+	EXPECT_DOUBLE_EQ( geo.FindRad(begin, end), rad );
+
+	std::vector<Eigen::Vector3d> positions;
+	std::vector<Eigen::Vector3d> normals;
+	for( int sensorID: sensorIDVec ) {
+		positions.push_back( snapshot->siPlanePosition(sensorID) );
+		normals.push_back( snapshot->siPlaneNormal(sensorID) );
+	}
+
+	//replaces the TGeoManager of the description by a copy read back from file
+	std::string const fileName("snapshotGeometryRebuild.root");
+	geo._geoManager->Export( fileName.c_str() );
+	geo.initializeTGeoDescription( fileName );
+
+	EXPECT_DOUBLE_EQ( rad, snapshot->findRad(begin, end) );
+	EXPECT_NEAR( rad, geo.FindRad(begin, end), 1e-9 );
+
+	auto rebuilt = geo.createSnapshot();
+	EXPECT_NEAR( rad, rebuilt->findRad(begin, end), 1e-9 );
+	for( size_t i = 0; i < sensorIDVec.size(); ++i ) {
+		int sensorID = sensorIDVec[i];
+		for( int k = 0; k < 3; ++k ) {
+			EXPECT_NEAR( positions[i](k), rebuilt->siPlanePosition(sensorID)(k), 1e-9 );
+			EXPECT_NEAR( normals[i](k), rebuilt->siPlaneNormal(sensorID)(k), 1e-9 );
+		}
+	}
+}
+
 // }  // namespace - could surround eutelgeotestTest in a namespace
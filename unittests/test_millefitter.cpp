@@ -0,0 +1,190 @@
+//STL
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+//GTest
+#include "gtest/gtest.h"
+
+//ROOT
+#include <TMinuit.h>
+#include <TMath.h>
+
+//EUTelescope
+#include "EUTelMille.h"
+
+using eutelescope::EUTelMille;
+
+namespace {
+	//the chi2 minimised by Minuit, as in the former align mode 3 of EUTelMille
+	const EUTelMille::trackfitter * minuitFitter = 0;
+
+	void minuitFcn(int& /*npar*/, double* /*gin*/, double &f, double *par, int /*iflag*/) {
+		f = minuitFitter->fit(par);
+	}
+}
+
+// Compares the Gauss-Newton track fit of EUTelMille with the MIGRAD fit
+// of the same chi2 it replaced, on simulated straight tracks.
+class milleFitterTest : public ::testing::Test {
+protected:
+
+	milleFitterTest():
+	noOfPlane(6), noOfTrack(200), planeDistance(150.),
+	resolutionXY(0.004), resolutionZ(10.), missingResolution(1000000.) {}
+
+	//hits of a track with the given offsets and slopes, the hit on
+	//missingPlane is replaced by the zero hit the processor stores for
+	//planes without a hit
+	std::vector<EUTelMille::hit> simulateTrack(std::mt19937 & gen, int missingPlane) const {
+		std::normal_distribution<double> smear(0., resolutionXY);
+		std::uniform_real_distribution<double> offset(-8., 8.);
+		std::uniform_real_distribution<double> slope(-2.e-3, 2.e-3);
+
+		double x0 = offset(gen), y0 = offset(gen);
+		double dxdz = slope(gen), dydz = slope(gen);
+
+		std::vector<EUTelMille::hit> hits;
+		for( int plane = 0; plane < noOfPlane; ++plane ) {
+			double z = plane*planeDistance;
+			if( plane == missingPlane ) {
+				hits.push_back(EUTelMille::hit(0., 0., z, missingResolution, missingResolution, missingResolution, plane));
+			} else {
+				hits.push_back(EUTelMille::hit(x0 + dxdz*z + smear(gen), y0 + dydz*z + smear(gen), z,
+				                               resolutionXY, resolutionXY, resolutionZ, plane));
+			}
+		}
+		return hits;
+	}
+
+	//the analytic straight line estimate, as in the processor
+	void startValues(std::vector<EUTelMille::hit> const & hits, double par[4]) const {
+		double meanX = 0., meanY = 0., meanZ = 0.;
+		int n = 0;
+		for( size_t i = 0; i < hits.size(); ++i ) {
+			if( hits[i].resolution_x >= missingResolution ) continue;
+			meanX += hits[i].x;
+			meanY += hits[i].y;
+			meanZ += hits[i].z;
+			++n;
+		}
+		meanX /= n;
+		meanY /= n;
+		meanZ /= n;
+
+		double szz = 0., szx = 0., szy = 0.;
+		for( size_t i = 0; i < hits.size(); ++i ) {
+			if( hits[i].resolution_x >= missingResolution ) continue;
+			szz += (hits[i].z-meanZ)*(hits[i].z-meanZ);
+			szx += (hits[i].x-meanX)*(hits[i].z-meanZ);
+			szy += (hits[i].y-meanY)*(hits[i].z-meanZ);
+		}
+		double slopeX = szx/szz, slopeY = szy/szz;
+		par[0] = meanX - slopeX*meanZ;
+		par[1] = meanY - slopeY*meanZ;
+		par[2] = -1.0*std::atan(slopeY);
+		par[3] = std::atan(slopeX/std::sqrt(1.0+slopeY*slopeY));
+	}
+
+	//MIGRAD with the settings of the former processor code
+	bool minuitFit(EUTelMille::trackfitter const & fitter, double par[4], double error[4]) const {
+		minuitFitter = &fitter;
+		TMinuit minuit(4);
+		minuit.SetPrintLevel(-1);
+		minuit.SetFCN(minuitFcn);
+
+		double arglist[10];
+		int ierflg = 0;
+		arglist[0] = 2;
+		minuit.mnexcm("SET STR", arglist, 1, ierflg);
+		arglist[0] = 1;
+		minuit.mnexcm("SET ERR", arglist, 1, ierflg);
+
+		minuit.mnparm(0, "b0", par[0], 0.01, 0, 0, ierflg);
+		minuit.mnparm(1, "b1", par[1], 0.01, 0, 0, ierflg);
+		minuit.mnparm(2, "delta", par[2], 0.01, -1.0*TMath::Pi(), 1.0*TMath::Pi(), ierflg);
+		minuit.mnparm(3, "psi", par[3], 0.01, -1.0*TMath::Pi(), 1.0*TMath::Pi(), ierflg);
+
+		arglist[0] = 2000;
+		arglist[1] = 0.01;
+		minuit.mnexcm("MIGRAD", arglist, 1, ierflg);
+
+		for( int k = 0; k < 4; ++k ) minuit.GetParameter(k, par[k], error[k]);
+		minuitFitter = 0;
+		return ierflg == 0;
+	}
+
+	//fits all the tracks with both minimisers, MIGRAD stops when the
+	//estimated distance to the minimum is below its tolerance, the
+	//parameters have to agree within a small fraction of their errors
+	void compareFits(int missingPlane) const {
+		//fixed seed, the test has to be reproducible
+		std::mt19937 gen(20161018);
+		for( int track = 0; track < noOfTrack; ++track ) {
+			std::vector<EUTelMille::hit> hits = simulateTrack(gen, missingPlane);
+			EUTelMille::trackfitter fitter(&hits[0], hits.size());
+
+			double start[4];
+			startValues(hits, start);
+
+			double par[4] = { start[0], start[1], start[2], start[3] };
+			double chi2 = 0.;
+			ASSERT_TRUE(fitter.minimise(par, chi2)) << "track " << track;
+
+			double minuitPar[4] = { start[0], start[1], start[2], start[3] };
+			double minuitError[4];
+			ASSERT_TRUE(minuitFit(fitter, minuitPar, minuitError)) << "track " << track;
+			double minuitChi2 = fitter.fit(minuitPar);
+
+			EXPECT_NEAR(chi2, fitter.fit(par), 1.e-9*(1.+chi2)) << "track " << track;
+			EXPECT_LE(chi2, minuitChi2 + 1.e-6) << "track " << track;
+			for( int k = 0; k < 4; ++k ) {
+				EXPECT_NEAR(minuitPar[k], par[k], 0.05*minuitError[k]) << "track " << track << " parameter " << k;
+			}
+		}
+	}
+
+	int noOfPlane;
+	int noOfTrack;
+	double planeDistance;
+	double resolutionXY;
+	double resolutionZ;
+	double missingResolution;
+};
+
+TEST_F(milleFitterTest, allHits) {
+	compareFits(-1);
+}
+
+TEST_F(milleFitterTest, missingHit) {
+	compareFits(3);
+}
+
+TEST_F(milleFitterTest, missingHitIsIgnored) {
+	//a zero hit with the huge resolutions has to give the same track
+	//as the fit without that plane
+	std::mt19937 gen(20161018);
+	for( int track = 0; track < noOfTrack; ++track ) {
+		std::vector<EUTelMille::hit> hits = simulateTrack(gen, 3);
+		std::vector<EUTelMille::hit> presentHits;
+		for( size_t i = 0; i < hits.size(); ++i ) {
+			if( hits[i].planenumber != 3 ) presentHits.push_back(hits[i]);
+		}
+
+		double par[4], presentPar[4];
+		startValues(hits, par);
+		startValues(presentHits, presentPar);
+		double chi2 = 0., presentChi2 = 0.;
+		EUTelMille::trackfitter fitter(&hits[0], hits.size());
+		EUTelMille::trackfitter presentFitter(&presentHits[0], presentHits.size());
+		ASSERT_TRUE(fitter.minimise(par, chi2)) << "track " << track;
+		ASSERT_TRUE(presentFitter.minimise(presentPar, presentChi2)) << "track " << track;
+
+		EXPECT_NEAR(presentChi2, chi2, 1.e-6) << "track " << track;
+		EXPECT_NEAR(presentPar[0], par[0], 1.e-6) << "track " << track;
+		EXPECT_NEAR(presentPar[1], par[1], 1.e-6) << "track " << track;
+		EXPECT_NEAR(presentPar[2], par[2], 1.e-9) << "track " << track;
+		EXPECT_NEAR(presentPar[3], par[3], 1.e-9) << "track " << track;
+	}
+}